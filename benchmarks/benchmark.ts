@@ -0,0 +1,120 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+import * as instrument from "./instrument";
+/* Patch the binding before anything can call through it */
+instrument.install();
+
+import { run_crypto_benchmarks } from "./crypto_bench";
+import { run_http_benchmarks } from "./http_bench";
+import { run_mqtt_benchmarks } from "./mqtt_bench";
+import { BenchmarkResult, print_results } from "./stats";
+
+type Args = { [index: string]: any };
+
+const SUITES = ['http', 'mqtt', 'crypto'];
+
+const yargs = require('yargs');
+yargs.command('*', false, (yargs: any) => {
+    yargs.option('suite', {
+        description: `Benchmark suites to run: ${SUITES.join(', ')}`,
+        type: 'array',
+        default: SUITES,
+    })
+    .option('concurrency', {
+        alias: 'c',
+        description: 'INT: number of operations kept in flight at once',
+        type: 'number',
+        default: 16,
+    })
+    .option('duration', {
+        alias: 'd',
+        description: 'INT: milliseconds to measure each benchmark for',
+        type: 'number',
+        default: 5000,
+    })
+    .option('warmup', {
+        description: 'INT: milliseconds to run each benchmark for before measuring',
+        type: 'number',
+        default: 1000,
+    })
+    .option('body_size', {
+        description: 'INT: size in bytes of the HTTP response body served locally',
+        type: 'number',
+        default: 1024,
+    })
+    .option('upload_size', {
+        description: 'INT: size in bytes of the HTTP request body, 0 benchmarks GETs',
+        type: 'number',
+        default: 0,
+    })
+    .option('payload_size', {
+        description: 'INT: size in bytes of each MQTT payload',
+        type: 'number',
+        default: 256,
+    })
+    .option('mqtt_host', {
+        description: 'Broker to benchmark against instead of the built in local broker',
+        type: 'string',
+    })
+    .option('mqtt_port', {
+        description: 'INT: port of --mqtt_host',
+        type: 'number',
+        default: 1883,
+    })
+    .option('data_size', {
+        description: 'INT: size in bytes of the buffer hashed by the crypto suite',
+        type: 'number',
+        default: 1024 * 1024,
+    })
+    .option('json', {
+        description: 'Print results as JSON instead of a table',
+        type: 'boolean',
+        default: false,
+    })
+}, main).parse();
+
+async function main(argv: Args) {
+    const run_options = {
+        concurrency: argv.concurrency,
+        duration_ms: argv.duration,
+        warmup_ms: argv.warmup,
+    };
+
+    const results: BenchmarkResult[] = [];
+    const suites: string[] = argv.suite.map((suite: any) => suite.toString());
+    for (const suite of suites) {
+        switch (suite) {
+            case 'http':
+                results.push(...await run_http_benchmarks({
+                    ...run_options,
+                    body_size: argv.body_size,
+                    upload_size: argv.upload_size,
+                }));
+                break;
+            case 'mqtt':
+                results.push(...await run_mqtt_benchmarks({
+                    ...run_options,
+                    payload_size: argv.payload_size,
+                    host: argv.mqtt_host,
+                    port: argv.mqtt_port,
+                }));
+                break;
+            case 'crypto':
+                results.push(...await run_crypto_benchmarks({
+                    ...run_options,
+                    data_size: argv.data_size,
+                }));
+                break;
+            default:
+                console.error(`Unknown suite ${suite}, expected one of: ${SUITES.join(', ')}`);
+                process.exit(1);
+        }
+    }
+
+    print_results(results, argv.json);
+    /* Connection managers and clients keep the event loop alive while they shut down, don't wait on them */
+    process.exit(0);
+}
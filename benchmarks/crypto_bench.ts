@@ -0,0 +1,52 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+import { crypto } from "aws-crt";
+import * as checksums from "aws-crt/dist/native/checksums";
+import { BenchmarkResult, RunOptions, run_benchmark } from "./stats";
+
+export interface CryptoBenchmarkOptions extends RunOptions {
+    /** Size of the buffer hashed by each operation */
+    data_size: number;
+}
+
+export async function run_crypto_benchmarks(options: CryptoBenchmarkOptions): Promise<BenchmarkResult[]> {
+    const data = Buffer.alloc(options.data_size, 'h');
+    const size = options.data_size;
+    const secret = 'benchmark-secret';
+    const label = (name: string, concurrency: number) => `${name} ${size}B x${concurrency}`;
+
+    /* The synchronous variants block the event loop, running more than one at a time measures nothing */
+    const sync_options = { ...options, concurrency: 1 };
+    const sync = (fn: () => any) => () => {
+        fn();
+        return Promise.resolve(size);
+    };
+
+    const results: BenchmarkResult[] = [];
+    results.push(await run_benchmark(label('sha256', 1), sync_options, sync(() => crypto.hash_sha256(data))));
+    results.push(await run_benchmark(label('md5', 1), sync_options, sync(() => crypto.hash_md5(data))));
+    results.push(await run_benchmark(label('hmac_sha256', 1), sync_options, sync(() => crypto.hmac_sha256(secret, data))));
+    results.push(await run_benchmark(label('crc32', 1), sync_options, sync(() => checksums.crc32(data))));
+    results.push(await run_benchmark(label('crc32c', 1), sync_options, sync(() => checksums.crc32c(data))));
+
+    results.push(await run_benchmark(label('sha256_async', options.concurrency), options,
+        () => crypto.hash_sha256_async(data).then(() => size)));
+    results.push(await run_benchmark(label('hmac_sha256_async', options.concurrency), options,
+        () => crypto.hmac_sha256_async(secret, data).then(() => size)));
+    results.push(await run_benchmark(label('crc32c_async', options.concurrency), options,
+        () => checksums.crc32c_async(data).then(() => size)));
+
+    /* The same buffer split into one part per worker thread, checksummed in parallel and combined */
+    const parts: Buffer[] = [];
+    const part_size = Math.ceil(size / 4);
+    for (let offset = 0; offset < size; offset += part_size) {
+        parts.push(data.slice(offset, offset + part_size));
+    }
+    results.push(await run_benchmark(label('crc32c_parts_async(4)', options.concurrency), options,
+        () => checksums.crc32c_parts_async(parts).then(() => size)));
+
+    return results;
+}
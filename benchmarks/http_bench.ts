@@ -0,0 +1,94 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+import { http, io } from "aws-crt";
+import * as node_http from "http";
+import { AddressInfo } from "net";
+import { PassThrough } from "stream";
+import { BenchmarkResult, RunOptions, run_benchmark } from "./stats";
+
+export interface HttpBenchmarkOptions extends RunOptions {
+    /** Size of each response body served by the local server */
+    body_size: number;
+    /** Size of each request body, 0 sends GETs */
+    upload_size: number;
+}
+
+/* Serves a fixed body for GETs and drains the body of anything else, on an ephemeral port */
+function start_server(body: Buffer): Promise<node_http.Server> {
+    const server = node_http.createServer((request, response) => {
+        request.on('data', () => { });
+        request.on('end', () => {
+            const payload = request.method == 'GET' ? body : Buffer.alloc(0);
+            response.writeHead(200, { 'Content-Length': payload.length });
+            response.end(payload);
+        });
+    });
+    server.keepAliveTimeout = 60000;
+    return new Promise((resolve, reject) => {
+        server.once('error', reject);
+        server.listen(0, '127.0.0.1', () => resolve(server));
+    });
+}
+
+/* Acquires a connection, runs one request/response exchange on it and hands it back */
+async function make_request(
+    manager: http.HttpClientConnectionManager,
+    host: string,
+    upload: Buffer | undefined): Promise<number> {
+
+    const connection = await manager.acquire();
+    return new Promise<number>((resolve, reject) => {
+        const headers = new http.HttpHeaders([['host', host]]);
+        let body: io.InputStream | undefined = undefined;
+        if (upload) {
+            const source = new PassThrough();
+            source.end(upload);
+            body = new io.InputStream(source, io.InputStream.DEFAULT_HIGH_WATER_MARK, upload.length);
+        }
+
+        const request = new http.HttpRequest(upload ? 'PUT' : 'GET', '/', headers, body);
+        let received = 0;
+        const stream = connection.request(request);
+        stream.on('data', (data: ArrayBuffer) => {
+            received += data.byteLength;
+        });
+        stream.on('end', () => {
+            manager.release(connection);
+            resolve(received + (upload ? upload.length : 0));
+        });
+        stream.on('error', (error) => {
+            manager.release(connection);
+            reject(error);
+        });
+        stream.activate();
+    });
+}
+
+export async function run_http_benchmarks(options: HttpBenchmarkOptions): Promise<BenchmarkResult[]> {
+    const server = await start_server(Buffer.alloc(options.body_size, 'a'));
+    const port = (server.address() as AddressInfo).port;
+    const host = '127.0.0.1';
+    const manager = new http.HttpClientConnectionManager(
+        undefined,
+        host,
+        port,
+        options.concurrency,
+        16 * 1024,
+        new io.SocketOptions(io.SocketType.STREAM, io.SocketDomain.IPV4, 3000));
+
+    const upload = options.upload_size > 0 ? Buffer.alloc(options.upload_size, 'b') : undefined;
+    const results: BenchmarkResult[] = [];
+    try {
+        results.push(await run_benchmark(
+            `http ${upload ? 'PUT' : 'GET'} ${upload ? options.upload_size : options.body_size}B x${options.concurrency}`,
+            options,
+            () => make_request(manager, host, upload)));
+    } finally {
+        manager.close();
+        server.close();
+    }
+    return results;
+}
@@ -0,0 +1,61 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+/**
+ * Counts calls across the JS/native boundary by wrapping the functions exported by the native binding.
+ * Every call into a binding function is a JS->native crossing, every invocation of a function passed to one
+ * (callbacks, event handlers, threadsafe function targets) is a native->JS crossing.
+ *
+ * Methods of native classes (HttpHeaders, HttpRequest, ...) are not wrapped, so they are not counted.
+ */
+
+export interface Crossings {
+    js_to_native: number;
+    native_to_js: number;
+}
+
+export const crossings: Crossings = {
+    js_to_native: 0,
+    native_to_js: 0,
+};
+
+let installed = false;
+
+function wrap_callback(callback: Function) {
+    return function (this: any, ...args: any[]) {
+        crossings.native_to_js++;
+        return callback.apply(this, args);
+    };
+}
+
+/**
+ * Must be called before any benchmark runs. The library looks up binding functions at call time,
+ * so patching the shared binding object is enough to see every call made through it.
+ */
+export function install() {
+    if (installed) {
+        return;
+    }
+    installed = true;
+
+    const binding: any = require("aws-crt/dist/native/binding").default;
+    for (const name of Object.keys(binding)) {
+        const native_fn = binding[name];
+        /* Leave native classes alone, wrapping their constructors would break subclassing */
+        if (typeof native_fn !== 'function' || /^[A-Z]/.test(name)) {
+            continue;
+        }
+
+        binding[name] = function (this: any, ...args: any[]) {
+            crossings.js_to_native++;
+            for (let i = 0; i < args.length; ++i) {
+                if (typeof args[i] === 'function') {
+                    args[i] = wrap_callback(args[i]);
+                }
+            }
+            return native_fn.apply(this, args);
+        };
+    }
+}
@@ -0,0 +1,91 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+import { io, mqtt } from "aws-crt";
+import { MqttBroker } from "./mqtt_broker";
+import { BenchmarkResult, RunOptions, run_benchmark } from "./stats";
+
+export interface MqttBenchmarkOptions extends RunOptions {
+    /** Size of each published payload */
+    payload_size: number;
+    /** Broker to use instead of the built in one */
+    host?: string;
+    port?: number;
+}
+
+function new_connection(client: mqtt.MqttClient, host: string, port: number, client_id: string) {
+    return client.new_connection({
+        client_id,
+        host_name: host,
+        port,
+        socket_options: new io.SocketOptions(io.SocketType.STREAM, io.SocketDomain.IPV4, 3000),
+        clean_session: true,
+        keep_alive: 60,
+    });
+}
+
+export async function run_mqtt_benchmarks(options: MqttBenchmarkOptions): Promise<BenchmarkResult[]> {
+    let broker: MqttBroker | undefined = undefined;
+    let host = options.host;
+    let port = options.port;
+    if (!host) {
+        broker = new MqttBroker();
+        host = '127.0.0.1';
+        port = await broker.listen();
+    }
+
+    const suffix = `${Date.now()}-${process.pid}`;
+    const topic = `bench/${suffix}`;
+    const client = new mqtt.MqttClient();
+    const publisher = new_connection(client, host, port || 1883, `bench-pub-${suffix}`);
+    const subscriber = new_connection(client, host, port || 1883, `bench-sub-${suffix}`);
+    const results: BenchmarkResult[] = [];
+
+    try {
+        await publisher.connect();
+        await subscriber.connect();
+
+        /* Each payload carries a sequence number, so round trips can be matched up with concurrency > 1 */
+        const waiting = new Map<number, () => void>();
+        await subscriber.subscribe(topic, mqtt.QoS.AtMostOnce, (topic: string, payload: ArrayBuffer) => {
+            const sequence = new DataView(payload).getUint32(0);
+            const resolve = waiting.get(sequence);
+            if (resolve) {
+                waiting.delete(sequence);
+                resolve();
+            }
+        });
+
+        const payload_size = Math.max(4, options.payload_size);
+        let next_sequence = 0;
+        const next_payload = () => {
+            const payload = Buffer.alloc(payload_size, 'm');
+            const sequence = next_sequence++ >>> 0;
+            payload.writeUInt32BE(sequence, 0);
+            return { payload, sequence };
+        };
+
+        results.push(await run_benchmark(`mqtt publish QoS1 ${payload_size}B x${options.concurrency}`, options, async () => {
+            await publisher.publish(`${topic}/acked`, next_payload().payload, mqtt.QoS.AtLeastOnce);
+            return payload_size;
+        }));
+
+        results.push(await run_benchmark(`mqtt pub->sub QoS0 ${payload_size}B x${options.concurrency}`, options, () => {
+            const { payload, sequence } = next_payload();
+            const received = new Promise<void>((resolve) => waiting.set(sequence, resolve));
+            return Promise.all([
+                publisher.publish(topic, payload, mqtt.QoS.AtMostOnce),
+                received
+            ]).then(() => payload_size);
+        }));
+    } finally {
+        await publisher.disconnect().catch(() => { });
+        await subscriber.disconnect().catch(() => { });
+        if (broker) {
+            broker.close();
+        }
+    }
+    return results;
+}
@@ -0,0 +1,198 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+/**
+ * Just enough of an MQTT 3.1.1 broker to benchmark the client against without leaving the machine:
+ * CONNECT, PUBLISH (QoS 0/1 in, QoS 0 out), SUBSCRIBE, UNSUBSCRIBE, PINGREQ and DISCONNECT.
+ * No sessions, retained messages, wills or authentication.
+ */
+
+import * as net from "net";
+
+const CONNECT = 1;
+const PUBLISH = 3;
+const SUBSCRIBE = 8;
+const UNSUBSCRIBE = 10;
+const PINGREQ = 12;
+const DISCONNECT = 14;
+
+interface Client {
+    socket: net.Socket;
+    subscriptions: Set<string>;
+    pending: Buffer;
+}
+
+/* Matches a topic name against a subscription filter, honoring + and # wildcards */
+export function topic_matches(filter: string, topic: string) {
+    const filter_levels = filter.split('/');
+    const topic_levels = topic.split('/');
+    for (let i = 0; i < filter_levels.length; ++i) {
+        if (filter_levels[i] == '#') {
+            return true;
+        }
+        if (i >= topic_levels.length) {
+            return false;
+        }
+        if (filter_levels[i] != '+' && filter_levels[i] != topic_levels[i]) {
+            return false;
+        }
+    }
+    return filter_levels.length == topic_levels.length;
+}
+
+function encode_remaining_length(length: number) {
+    const bytes = [];
+    do {
+        let byte = length % 128;
+        length = Math.floor(length / 128);
+        if (length > 0) {
+            byte |= 0x80;
+        }
+        bytes.push(byte);
+    } while (length > 0);
+    return Buffer.from(bytes);
+}
+
+function packet(first_byte: number, body: Buffer) {
+    return Buffer.concat([Buffer.from([first_byte]), encode_remaining_length(body.length), body]);
+}
+
+function packet_id(id: number) {
+    const buffer = Buffer.alloc(2);
+    buffer.writeUInt16BE(id, 0);
+    return buffer;
+}
+
+export class MqttBroker {
+    private server: net.Server;
+    private clients = new Set<Client>();
+
+    constructor() {
+        this.server = net.createServer((socket) => this.on_connection(socket));
+    }
+
+    /** Listens on an ephemeral port on the loopback interface, resolves with the port */
+    listen(): Promise<number> {
+        return new Promise((resolve, reject) => {
+            this.server.once('error', reject);
+            this.server.listen(0, '127.0.0.1', () => {
+                resolve((this.server.address() as net.AddressInfo).port);
+            });
+        });
+    }
+
+    close() {
+        for (const client of this.clients) {
+            client.socket.destroy();
+        }
+        this.server.close();
+    }
+
+    private on_connection(socket: net.Socket) {
+        socket.setNoDelay(true);
+        const client: Client = { socket, subscriptions: new Set(), pending: Buffer.alloc(0) };
+        this.clients.add(client);
+        socket.on('data', (data: Buffer) => {
+            client.pending = client.pending.length ? Buffer.concat([client.pending, data]) : data;
+            this.process(client);
+        });
+        socket.on('close', () => this.clients.delete(client));
+        socket.on('error', () => socket.destroy());
+    }
+
+    /* Handles every complete packet in the client's receive buffer, leaves any partial packet for later */
+    private process(client: Client) {
+        let offset = 0;
+        const data = client.pending;
+        while (offset + 2 <= data.length) {
+            let length = 0;
+            let multiplier = 1;
+            let cursor = offset + 1;
+            let complete = false;
+            while (cursor < data.length) {
+                const byte = data[cursor++];
+                length += (byte & 0x7f) * multiplier;
+                multiplier *= 128;
+                if ((byte & 0x80) == 0) {
+                    complete = true;
+                    break;
+                }
+            }
+            if (!complete || cursor + length > data.length) {
+                break;
+            }
+
+            this.on_packet(client, data[offset], data.slice(cursor, cursor + length));
+            offset = cursor + length;
+        }
+        client.pending = data.slice(offset);
+    }
+
+    private on_packet(client: Client, first_byte: number, body: Buffer) {
+        switch (first_byte >> 4) {
+            case CONNECT:
+                client.socket.write(Buffer.from([0x20, 0x02, 0x00, 0x00]));
+                break;
+            case PUBLISH:
+                this.on_publish(client, first_byte, body);
+                break;
+            case SUBSCRIBE: {
+                const id = body.readUInt16BE(0);
+                const granted = [];
+                for (let offset = 2; offset < body.length;) {
+                    const length = body.readUInt16BE(offset);
+                    client.subscriptions.add(body.toString('utf8', offset + 2, offset + 2 + length));
+                    offset += 2 + length + 1;
+                    /* Everything is delivered at QoS 0, so that's all that's granted */
+                    granted.push(0);
+                }
+                client.socket.write(packet(0x90, Buffer.concat([packet_id(id), Buffer.from(granted)])));
+                break;
+            }
+            case UNSUBSCRIBE: {
+                const id = body.readUInt16BE(0);
+                for (let offset = 2; offset < body.length;) {
+                    const length = body.readUInt16BE(offset);
+                    client.subscriptions.delete(body.toString('utf8', offset + 2, offset + 2 + length));
+                    offset += 2 + length;
+                }
+                client.socket.write(packet(0xb0, packet_id(id)));
+                break;
+            }
+            case PINGREQ:
+                client.socket.write(Buffer.from([0xd0, 0x00]));
+                break;
+            case DISCONNECT:
+                client.socket.end();
+                break;
+        }
+    }
+
+    private on_publish(client: Client, first_byte: number, body: Buffer) {
+        const qos = (first_byte >> 1) & 0x3;
+        const topic_length = body.readUInt16BE(0);
+        const topic = body.toString('utf8', 2, 2 + topic_length);
+        let payload_offset = 2 + topic_length;
+        if (qos > 0) {
+            client.socket.write(packet(0x40, body.slice(payload_offset, payload_offset + 2)));
+            payload_offset += 2;
+        }
+
+        let outgoing: Buffer | undefined = undefined;
+        for (const subscriber of this.clients) {
+            for (const filter of subscriber.subscriptions) {
+                if (topic_matches(filter, topic)) {
+                    if (!outgoing) {
+                        outgoing = packet(0x30, Buffer.concat([
+                            body.slice(0, 2 + topic_length),
+                            body.slice(payload_offset)]));
+                    }
+                    subscriber.socket.write(outgoing);
+                    break;
+                }
+            }
+        }
+    }
+}
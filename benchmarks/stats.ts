@@ -0,0 +1,146 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+import { crt } from "aws-crt";
+import { crossings, Crossings } from "./instrument";
+
+/** Results of one benchmark run, everything per-op is averaged over the successful operations */
+export interface BenchmarkResult {
+    name: string;
+    operations: number;
+    errors: number;
+    elapsed_ms: number;
+    ops_per_sec: number;
+    bytes_per_sec: number;
+    p50_us: number;
+    p99_us: number;
+    max_us: number;
+    native_allocations_per_op: number;
+    js_to_native_per_op: number;
+    native_to_js_per_op: number;
+}
+
+/** A single operation, resolves with the number of payload bytes it moved */
+export type Operation = () => Promise<number>;
+
+export interface RunOptions {
+    /** Number of operations kept in flight at once */
+    concurrency: number;
+    /** How long to measure for, after warmup */
+    duration_ms: number;
+    /** How long to run before measuring, lets connection pools and caches fill */
+    warmup_ms: number;
+}
+
+function percentile(sorted: number[], p: number) {
+    if (sorted.length == 0) {
+        return 0;
+    }
+    const index = Math.min(sorted.length - 1, Math.ceil((p / 100) * sorted.length) - 1);
+    return sorted[Math.max(0, index)];
+}
+
+/* Monotonic time in milliseconds, with sub-millisecond precision */
+function now_ms() {
+    const [seconds, nanos] = process.hrtime();
+    return seconds * 1000 + nanos / 1000000;
+}
+
+/* Runs op with a fixed number of operations in flight (closed loop) until the deadline passes */
+async function run_for(op: Operation, concurrency: number, duration_ms: number, latencies?: number[]) {
+    const deadline = now_ms() + duration_ms;
+    let operations = 0;
+    let errors = 0;
+    let bytes = 0;
+
+    const worker = async () => {
+        while (now_ms() < deadline) {
+            const start = now_ms();
+            try {
+                bytes += await op();
+                operations++;
+                if (latencies) {
+                    latencies.push((now_ms() - start) * 1000);
+                }
+            } catch (e) {
+                errors++;
+            }
+        }
+    };
+
+    const workers = [];
+    for (let i = 0; i < concurrency; ++i) {
+        workers.push(worker());
+    }
+    await Promise.all(workers);
+    return { operations, errors, bytes };
+}
+
+export async function run_benchmark(name: string, options: RunOptions, op: Operation): Promise<BenchmarkResult> {
+    if (options.warmup_ms > 0) {
+        await run_for(op, options.concurrency, options.warmup_ms);
+    }
+
+    const latencies: number[] = [];
+    const allocations_before = crt.native_allocation_count();
+    const crossings_before: Crossings = { ...crossings };
+    const start = now_ms();
+
+    const totals = await run_for(op, options.concurrency, options.duration_ms, latencies);
+
+    const elapsed_ms = now_ms() - start;
+    const allocations = crt.native_allocation_count() - allocations_before;
+    const per_op = (value: number) => totals.operations ? value / totals.operations : 0;
+
+    latencies.sort((a, b) => a - b);
+    return {
+        name,
+        operations: totals.operations,
+        errors: totals.errors,
+        elapsed_ms,
+        ops_per_sec: totals.operations / (elapsed_ms / 1000),
+        bytes_per_sec: totals.bytes / (elapsed_ms / 1000),
+        p50_us: percentile(latencies, 50),
+        p99_us: percentile(latencies, 99),
+        max_us: latencies.length ? latencies[latencies.length - 1] : 0,
+        native_allocations_per_op: per_op(allocations),
+        js_to_native_per_op: per_op(crossings.js_to_native - crossings_before.js_to_native),
+        native_to_js_per_op: per_op(crossings.native_to_js - crossings_before.native_to_js),
+    };
+}
+
+function format_bytes(bytes_per_sec: number) {
+    const units = ['B/s', 'KiB/s', 'MiB/s', 'GiB/s'];
+    let unit = 0;
+    while (bytes_per_sec >= 1024 && unit < units.length - 1) {
+        bytes_per_sec /= 1024;
+        unit++;
+    }
+    return `${bytes_per_sec.toFixed(1)} ${units[unit]}`;
+}
+
+export function print_results(results: BenchmarkResult[], json: boolean) {
+    if (json) {
+        console.log(JSON.stringify(results, null, 2));
+        return;
+    }
+
+    console.table(results.map((result) => {
+        return {
+            name: result.name,
+            'ops/s': result.ops_per_sec.toFixed(0),
+            'p50 (us)': result.p50_us.toFixed(0),
+            'p99 (us)': result.p99_us.toFixed(0),
+            'throughput': format_bytes(result.bytes_per_sec),
+            'allocs/op': result.native_allocations_per_op.toFixed(1),
+            'js->native/op': result.js_to_native_per_op.toFixed(1),
+            'native->js/op': result.native_to_js_per_op.toFixed(1),
+            'errors': result.errors,
+        };
+    }));
+    if (crt.native_allocation_count() == 0) {
+        console.log("allocs/op is only collected when AWS_CRT_MEMORY_TRACING=1 is set");
+    }
+}
@@ -14,6 +14,7 @@ git submodule update --init
 cd $CODEBUILD_SRC_DIR
 
 export AWS_CRT_MEMORY_TRACING=2
+export AWS_CRT_CALLBACK_METRICS=1
 
 npm install
 npm run install
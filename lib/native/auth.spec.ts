@@ -8,7 +8,7 @@ import { io as native_io } from '../index';
 
 import { InputStream } from './io';
 import { PassThrough } from "stream";
-import { aws_sign_request, aws_verify_sigv4a_signing } from './auth';
+import { aws_sign_request, aws_sign_requests, aws_verify_sigv4a_signing } from './auth';
 
 const DATE_STR = '2015-08-30T12:36:00Z';
 
@@ -87,6 +87,87 @@ test('AWS Signer SigV4 Headers', async () => {
     expect(signed_headers).toEqual(expected_headers)
 });
 
+test('AWS Signer SigV4 Headers with reusable SigningConfig', async () => {
+
+    const credentials_provider = native.AwsCredentialsProvider.newStatic(
+        SIGV4TEST_ACCESS_KEY_ID,
+        SIGV4TEST_SECRET_ACCESS_KEY,
+    );
+
+    const signing_config = new native.SigningConfig({
+        algorithm: native.AwsSigningAlgorithm.SigV4,
+        signature_type: native.AwsSignatureType.HttpRequestViaHeaders,
+        provider: credentials_provider,
+        region: SIGV4TEST_REGION,
+        service: SIGV4TEST_SERVICE,
+        date: new Date(DATE_STR),
+        signed_body_value: native.AwsSignedBodyValue.EmptySha256,
+        signed_body_header: native.AwsSignedBodyHeaderType.None,
+    });
+    expect(signing_config.region).toBe(SIGV4TEST_REGION);
+    expect(signing_config.service).toBe(SIGV4TEST_SERVICE);
+
+    const requests = [0, 1, 2].map(() => new native_http.HttpRequest(
+        SIGV4TEST_METHOD,
+        SIGV4TEST_PATH,
+        new native_http.HttpHeaders(SIGV4TEST_UNSIGNED_HEADERS)));
+
+    const signed = await Promise.all(requests.map((request) => aws_sign_request(request, signing_config)));
+
+    const expected_headers = [...SIGV4TEST_SIGNED_HEADERS].sort();
+    signed.forEach((request, i) => {
+        expect(request).toBe(requests[i]);
+        expect([...request.headers._flatten()].sort()).toEqual(expected_headers);
+    });
+});
+
+test('AWS Signer SigV4 Headers batch', async () => {
+
+    const credentials_provider = native.AwsCredentialsProvider.newStatic(
+        SIGV4TEST_ACCESS_KEY_ID,
+        SIGV4TEST_SECRET_ACCESS_KEY,
+    );
+
+    const signing_config: native.AwsSigningConfig = {
+        algorithm: native.AwsSigningAlgorithm.SigV4,
+        signature_type: native.AwsSignatureType.HttpRequestViaHeaders,
+        provider: credentials_provider,
+        region: SIGV4TEST_REGION,
+        service: SIGV4TEST_SERVICE,
+        date: new Date(DATE_STR),
+        signed_body_value: native.AwsSignedBodyValue.EmptySha256,
+        signed_body_header: native.AwsSignedBodyHeaderType.None,
+    };
+
+    const requests = Array.from({ length: 64 }, () => new native_http.HttpRequest(
+        SIGV4TEST_METHOD,
+        SIGV4TEST_PATH,
+        new native_http.HttpHeaders(SIGV4TEST_UNSIGNED_HEADERS)));
+
+    const signed = await aws_sign_requests(requests, signing_config);
+    expect(signed).toBe(requests); // should be same array
+
+    const expected_headers = [...SIGV4TEST_SIGNED_HEADERS].sort();
+    for (const request of signed) {
+        expect([...request.headers._flatten()].sort()).toEqual(expected_headers);
+    }
+
+    expect(await aws_sign_requests([], signing_config)).toEqual([]);
+});
+
+test('SigningConfig requires a region', () => {
+    const credentials_provider = native.AwsCredentialsProvider.newStatic(
+        SIGV4TEST_ACCESS_KEY_ID,
+        SIGV4TEST_SECRET_ACCESS_KEY,
+    );
+
+    expect(() => new native.SigningConfig(<any>{
+        algorithm: native.AwsSigningAlgorithm.SigV4,
+        signature_type: native.AwsSignatureType.HttpRequestViaHeaders,
+        provider: credentials_provider,
+    })).toThrow();
+});
+
 test('AWS Signer SigV4 Request with body', async () => {
 
     const credentials_provider = native.AwsCredentialsProvider.newStatic(
@@ -176,6 +257,42 @@ test('AWS Signer SigV4A Headers', async () => {
     expect(verification_result).toBe(true);
 });
 
+test('AWS Signer SigV4 Headers with cached credentials provider', async () => {
+
+    const credentials_provider = native.AwsCredentialsProvider.newCached(
+        native.AwsCredentialsProvider.newStatic(SIGV4TEST_ACCESS_KEY_ID, SIGV4TEST_SECRET_ACCESS_KEY),
+        { refresh_ahead_in_milliseconds: 1000 });
+
+    const signing_config = new native.SigningConfig({
+        algorithm: native.AwsSigningAlgorithm.SigV4,
+        signature_type: native.AwsSignatureType.HttpRequestViaHeaders,
+        provider: credentials_provider,
+        region: SIGV4TEST_REGION,
+        service: SIGV4TEST_SERVICE,
+        date: new Date(DATE_STR),
+        signed_body_value: native.AwsSignedBodyValue.EmptySha256,
+        signed_body_header: native.AwsSignedBodyHeaderType.None,
+    });
+
+    /* Concurrent signers share the cached credentials */
+    const requests = [0, 1, 2, 3].map(() => new native_http.HttpRequest(
+        SIGV4TEST_METHOD,
+        SIGV4TEST_PATH,
+        new native_http.HttpHeaders(SIGV4TEST_UNSIGNED_HEADERS)));
+    const signed = await Promise.all(requests.map((request) => aws_sign_request(request, signing_config)));
+
+    const expected_headers = [...SIGV4TEST_SIGNED_HEADERS].sort();
+    for (const request of signed) {
+        expect([...request.headers._flatten()].sort()).toEqual(expected_headers);
+    }
+});
+
+test('Cached credentials provider rejects bad refresh times', () => {
+    const source = native.AwsCredentialsProvider.newStatic(SIGV4TEST_ACCESS_KEY_ID, SIGV4TEST_SECRET_ACCESS_KEY);
+
+    expect(() => native.AwsCredentialsProvider.newCached(source, { max_age_in_milliseconds: 0 })).toThrow();
+});
+
 // Without a binding for fetching credentials yet, so just check creation successful
 test('Default credentials provider create', async () => {
     const credentials_provider = native.AwsCredentialsProvider.newDefault(new native_io.ClientBootstrap());
@@ -115,6 +115,45 @@ export class AwsCredentialsProvider extends crt_native.AwsCredentialsProvider {
     static newDefault(bootstrap: ClientBootstrap | undefined = undefined): AwsCredentialsProvider {
         return super.newDefault(bootstrap != null ? bootstrap.native_handle() : null);
     }
+
+    /**
+     * Creates a provider that caches the credentials of another provider, to be shared between signers.
+     *
+     * Credentials are fetched from the source as soon as the provider is created. Queries made while
+     * no credentials are cached wait on that single fetch, rather than each starting their own. Shortly
+     * before the cached credentials expire, queries are still answered from the cache while fresh
+     * credentials are fetched in the background.
+     *
+     * @param source provider to fetch credentials from, such as {@link AwsCredentialsProvider.newDefault}
+     * @param options (optional) refresh timing
+     *
+     * @returns a new credentials provider caching the credentials of source
+     */
+    static newCached(source: AwsCredentialsProvider, options?: CachedCredentialsProviderOptions): AwsCredentialsProvider {
+        return super.newCached(
+            source,
+            options?.refresh_ahead_in_milliseconds ?? 5 * 60 * 1000,
+            options?.max_age_in_milliseconds ?? 15 * 60 * 1000);
+    }
+}
+
+/**
+ * Options for {@link AwsCredentialsProvider.newCached}
+ *
+ * @category Auth
+ */
+export interface CachedCredentialsProviderOptions {
+    /**
+     * How long before the cached credentials expire to start fetching new ones in the background.
+     * Defaults to 5 minutes.
+     */
+    refresh_ahead_in_milliseconds?: number;
+
+    /**
+     * How often to refresh credentials that never expire, such as static or environment credentials.
+     * Defaults to 15 minutes.
+     */
+    max_age_in_milliseconds?: number;
 }
 
 /**
@@ -194,6 +233,28 @@ export interface AwsSigningConfig {
     expiration_in_seconds?: number;
 }
 
+/**
+ * An {@link AwsSigningConfig} parsed once into native form, for signing many requests the same way.
+ *
+ * Signing with an AwsSigningConfig object converts every field of it to native on every call. When
+ * the same config is used at high request rates, construct a SigningConfig from it and pass that
+ * to {@link aws_sign_request} instead. Changes made to the AwsSigningConfig after construction are
+ * not seen.
+ *
+ * If the config has no date, each request is dated when it is signed, so unlike a plain
+ * AwsSigningConfig a SigningConfig does not go stale.
+ *
+ * @category Auth
+ */
+export class SigningConfig extends crt_native.SigningConfig {
+    /**
+     * @param config Configuration to sign with, the credentials provider is retained
+     */
+    constructor(config: AwsSigningConfig) {
+        super(config);
+    }
+}
+
 /**
  * Perform AWS HTTP request signing.
  *
@@ -202,7 +263,8 @@ export interface AwsSigningConfig {
  *
  * When signing:
  *  1.  It is good practice to use a new config for each signature,
- *      or the date might get too old.
+ *      or the date might get too old. A {@link SigningConfig} without a date
+ *      can be reused, it dates each signature when it is made.
  *
  *  2.  Do not add the following headers to requests before signing, they may be added by the signer:
  *      x-amz-content-sha256,
@@ -216,24 +278,66 @@ export interface AwsSigningConfig {
  *      X-Amz-Algorithm,
  *      X-Amz-SignedHeaders
  * @param request The HTTP request to sign.
- * @param config Configuration for signing.
+ * @param config Configuration for signing, either a plain {@link AwsSigningConfig} or a {@link SigningConfig}.
  * @returns A promise whose result will be the signed
  *       {@link HttpRequest}. The future will contain an exception
  *       if the signing process fails.
  *
  * @category Auth
  */
-export async function aws_sign_request(request: HttpRequest, config: AwsSigningConfig): Promise<HttpRequest> {
+export async function aws_sign_request(request: HttpRequest, config: AwsSigningConfig | SigningConfig): Promise<HttpRequest> {
     return new Promise((resolve, reject) => {
         try {
-            /* Note: if the body of request has not fully loaded, it will lead to an endless loop. 
-             * User should set the signed_body_value of config to prevent this endless loop in this case */
-            crt_native.aws_sign_request(request, config, (error_code) => {
+            const on_complete = (error_code: number) => {
                 if (error_code == 0) {
                     resolve(request);
                 } else {
                     reject(new CrtError(error_code));
                 }
+            };
+            /* Note: if the body of request has not fully loaded, it will lead to an endless loop. 
+             * User should set the signed_body_value of config to prevent this endless loop in this case */
+            if (config instanceof SigningConfig) {
+                crt_native.aws_sign_request_with_config(request, config, on_complete);
+            } else {
+                crt_native.aws_sign_request(request, config, on_complete);
+            }
+        } catch (error) {
+            reject(error);
+        }
+    });
+}
+
+/**
+ * Perform AWS HTTP request signing on a batch of requests.
+ *
+ * Every request is signed with the same config, by the same rules as {@link aws_sign_request}.
+ * Credentials are fetched once for the whole batch, every signature gets the same date, and the
+ * returned promise settles once, when every request has been signed. Prefer this to many calls to
+ * {@link aws_sign_request} when signing or presigning requests in bulk.
+ *
+ * @param requests The HTTP requests to sign.
+ * @param config Configuration for signing, either a plain {@link AwsSigningConfig} or a {@link SigningConfig}.
+ * @returns A promise whose result will be the signed requests, in the same order. The promise is
+ *       rejected with the error of the first request that failed to sign, if any did.
+ *
+ * @category Auth
+ */
+export async function aws_sign_requests(requests: HttpRequest[], config: AwsSigningConfig | SigningConfig): Promise<HttpRequest[]> {
+    if (requests.length == 0) {
+        return [];
+    }
+
+    return new Promise((resolve, reject) => {
+        try {
+            const signing_config = config instanceof SigningConfig ? config : new SigningConfig(config);
+            crt_native.aws_sign_requests(requests, signing_config, (error_codes) => {
+                const error_code = error_codes.find((error_code) => error_code != 0);
+                if (error_code === undefined) {
+                    resolve(requests);
+                } else {
+                    reject(new CrtError(error_code));
+                }
             });
         } catch (error) {
             reject(error);
@@ -11,10 +11,19 @@
  * @module http
  */
 
-import { InputStream } from "./io";
+import {
+    HostResolution,
+    HostResolverStats,
+    InputStream,
+    StreamChecksum,
+    StreamChecksumAlgorithm,
+    TlsContextCacheStats
+} from "./io";
 import { AwsSigningConfig } from "./auth";
 import { HttpHeader, HttpHeaders as CommonHttpHeaders } from "../common/http";
-import { OnMessageCallback, QoS } from "../common/mqtt";
+import { QoS } from "../common/mqtt";
+import { NativeMetrics } from "./crt";
+import { HttpConnectionManagerStats } from "./http";
 
 /**
  * Type used to store pointers to CRT native resources
@@ -31,18 +40,41 @@ export function native_memory(): number;
 /** @internal */
 export function native_memory_dump(): void;
 /** @internal */
+export function native_allocation_count(): number;
+/** @internal */
+export function native_metrics(): NativeMetrics;
+/** @internal */
 export function error_code_to_string(error_code: number): string;
 /** @internal */
 export function error_code_to_name(error_code: number): string;
 
 /* IO */
 /** @internal */
-export function io_logging_enable(log_level: number): void;
+export function io_logging_enable(log_level: number, destination?: string | number): void;
 /** @internal */
 export function is_alpn_available(): boolean;
+/** @internal */
+export function io_set_default_event_loop_group_options(num_threads: number, cpu_group?: number): void;
+/* wraps aws_event_loop_group #TODO: Wrap with ClassBinder */
+/** @internal */
+export function io_event_loop_group_new(num_threads: number, cpu_group?: number): NativeHandle;
 /* wraps aws_client_bootstrap #TODO: Wrap with ClassBinder */
 /** @internal */
-export function io_client_bootstrap_new(): NativeHandle;
+export function io_client_bootstrap_new(
+    event_loop_group?: NativeHandle,
+    max_entries?: number,
+    max_ttl_secs?: number,
+): NativeHandle;
+/** @internal */
+export function io_set_default_host_resolver_options(max_entries?: number, max_ttl_secs?: number): void;
+/** @internal */
+export function io_host_resolver_pre_resolve(
+    client_bootstrap: NativeHandle | undefined,
+    host_names: string[],
+    on_resolved: (results: HostResolution[]) => void,
+): void;
+/** @internal */
+export function io_host_resolver_get_stats(client_bootstrap: NativeHandle | undefined): HostResolverStats;
 /* wraps aws_tls_context #TODO: Wrap with ClassBinder */
 /** @internal */
 export function io_tls_ctx_new(
@@ -58,7 +90,10 @@ export function io_tls_ctx_new(
     pkcs12_filepath?: StringLike,
     pkcs12_password?: StringLike,
     verify_peer?: boolean,
+    share_context?: boolean,
 ): NativeHandle;
+/** @internal */
+export function io_tls_ctx_cache_get_stats(): TlsContextCacheStats;
 /* wraps aws_tls_connection_options #TODO: Wrap with ClassBinder */
 /** @internal */
 export function io_tls_connection_options_new(
@@ -80,9 +115,29 @@ export function io_socket_options_new(
 
 /* wraps aws_input_stream #TODO: Wrap with ClassBinder */
 /** @internal */
-export function io_input_stream_new(capacity: number): NativeHandle;
+export function io_input_stream_new(
+    high_water_mark: number,
+    length: number | undefined,
+    on_drain: () => void,
+    checksum: StreamChecksumAlgorithm | undefined,
+): NativeHandle;
+/** @internal */
+export function io_input_stream_append(stream: NativeHandle, data?: Buffer): boolean;
+/** @internal */
+export function io_file_input_stream_new(
+    path: string,
+    offset: number | undefined,
+    length: number | undefined,
+    checksum: StreamChecksumAlgorithm | undefined,
+): NativeHandle;
+/** @internal */
+export function io_input_stream_get_length(stream: NativeHandle): number | undefined;
+/** @internal */
+export function io_input_stream_get_checksum(stream: NativeHandle): StreamChecksum | undefined;
+/** @internal */
+export function io_input_stream_read(stream: NativeHandle, max_bytes: number): Buffer;
 /** @internal */
-export function io_input_stream_append(stream: NativeHandle, data?: Buffer): void;
+export function io_input_stream_seek(stream: NativeHandle, offset: number): void;
 
 /* Crypto */
 /* wraps aws_hash structures #TODO: Wrap with ClassBinder */
@@ -95,7 +150,13 @@ export function hash_sha1_new(): void;
 /** @internal */
 export function hash_update(handle: NativeHandle, data: StringLike): void;
 /** @internal */
+export function hash_update_many(handle: NativeHandle, data: StringLike[]): void;
+/** @internal */
 export function hash_digest(handle: NativeHandle, truncate_to?: number): DataView;
+/** @internal */
+export function hash_digest_into(handle: NativeHandle, output: ArrayBuffer | ArrayBufferView, truncate_to: number | undefined): number;
+/** @internal */
+export function hash_reset(handle: NativeHandle): void;
 
 /** @internal */
 export function hash_md5_compute(data: StringLike, truncate_to?: number): DataView;
@@ -104,6 +165,15 @@ export function hash_sha256_compute(data: StringLike, truncate_to?: number): Dat
 /** @internal */
 export function hash_sha1_compute(data: StringLike, truncate_to?: number): DataView;
 
+/** @internal */
+export type HashCompleteCallback = (error_code: number, digest?: DataView) => void;
+/** @internal */
+export function hash_md5_compute_async(data: StringLike, truncate_to: number | undefined, on_complete: HashCompleteCallback): void;
+/** @internal */
+export function hash_sha256_compute_async(data: StringLike, truncate_to: number | undefined, on_complete: HashCompleteCallback): void;
+/** @internal */
+export function hash_sha1_compute_async(data: StringLike, truncate_to: number | undefined, on_complete: HashCompleteCallback): void;
+
 /** @internal */
 export function hmac_md5_new(secret: StringLike): void;
 /** @internal */
@@ -111,12 +181,20 @@ export function hmac_sha256_new(secret: StringLike): void;
 /** @internal */
 export function hmac_update(handle: NativeHandle, data: StringLike): void;
 /** @internal */
+export function hmac_update_many(handle: NativeHandle, data: StringLike[]): void;
+/** @internal */
 export function hmac_digest(handle: NativeHandle, truncate_to?: number): DataView;
+/** @internal */
+export function hmac_digest_into(handle: NativeHandle, output: ArrayBuffer | ArrayBufferView, truncate_to: number | undefined): number;
+/** @internal */
+export function hmac_reset(handle: NativeHandle): void;
 
 /** @internal */
 export function hmac_md5_compute(secret: StringLike, data: StringLike, truncate_to?: number): DataView;
 /** @internal */
 export function hmac_sha256_compute(secret: StringLike, data: StringLike, truncate_to?: number): DataView;
+/** @internal */
+export function hmac_sha256_compute_async(secret: StringLike, data: StringLike, truncate_to: number | undefined, on_complete: HashCompleteCallback): void;
 
 /* Checksums */
 /* wraps aws_checksums functions */
@@ -125,6 +203,22 @@ export function hmac_sha256_compute(secret: StringLike, data: StringLike, trunca
 export function checksums_crc32(data: StringLike, previous?: number): number;
 /** @internal */
 export function checksums_crc32c(data: StringLike, previous?: number): number;
+/** @internal */
+export type ChecksumCompleteCallback = (error_code: number, checksum?: number) => void;
+/** @internal */
+export function checksums_crc32_async(data: StringLike, previous: number | undefined, on_complete: ChecksumCompleteCallback): void;
+/** @internal */
+export function checksums_crc32c_async(data: StringLike, previous: number | undefined, on_complete: ChecksumCompleteCallback): void;
+/** @internal */
+export function checksums_crc32_combine(crc1: number, crc2: number, length2: number): number;
+/** @internal */
+export function checksums_crc32c_combine(crc1: number, crc2: number, length2: number): number;
+/** @internal */
+export type ChecksumPartsCompleteCallback = (error_code: number, checksum?: number, part_checksums?: number[]) => void;
+/** @internal */
+export function checksums_crc32_parts_async(parts: StringLike[], on_complete: ChecksumPartsCompleteCallback): void;
+/** @internal */
+export function checksums_crc32c_parts_async(parts: StringLike[], on_complete: ChecksumPartsCompleteCallback): void;
 
 /* MQTT Client */
 /** @internal */
@@ -175,21 +269,64 @@ export function mqtt_client_connection_publish(
     on_publish?: (packet_id: number, error_code: number) => void,
 ): void;
 
+/** @internal */
+export function mqtt_client_connection_publish_batch(
+    connection: NativeHandle,
+    /** flattened (topic, payload, qos, retain) tuples */
+    messages: any[],
+    on_complete: (packet_ids: number[], error_codes: number[]) => void,
+): void;
+
 /** @internal */
 export function mqtt_client_connection_subscribe(
     connection: NativeHandle,
     topic: StringLike,
     qos: number,
-    on_publish?: OnMessageCallback,
+    on_publish?: (batch: any[]) => void,
     on_suback?: (packet_id: number, topic: string, qos: QoS, error_code: number) => void,
 ): void;
 
 /** @internal */
 export function mqtt_client_connection_on_message(
     connection: NativeHandle,
-    on_publish?: OnMessageCallback
+    on_publish?: (batch: any[]) => void
+): void;
+
+/** @internal */
+export function mqtt_client_connection_add_topic_handler(
+    connection: NativeHandle,
+    topic_filter: StringLike,
+    handler_id: number,
+): void;
+
+/** @internal */
+export function mqtt_client_connection_remove_topic_handler(
+    connection: NativeHandle,
+    topic_filter: StringLike,
+    handler_id: number,
+): void;
+
+/** @internal */
+export function mqtt_client_connection_forward_all_messages(
+    connection: NativeHandle,
+    forward_all: boolean,
 ): void;
 
+/** @internal */
+export function mqtt_client_connection_share_with_workers(
+    connection: NativeHandle,
+    distribution: number,
+): number;
+
+/** @internal */
+export function mqtt_message_worker_attach(
+    id: number,
+    on_publish: (batch: any[]) => void,
+): NativeHandle;
+
+/** @internal */
+export function mqtt_message_worker_detach(worker: NativeHandle): void;
+
 /** @internal */
 export function mqtt_client_connection_unsubscribe(
     connection: NativeHandle,
@@ -227,6 +364,8 @@ export function http_connection_new(
     socket_options?: NativeHandle,
     tls_options?: NativeHandle,
     proxy_options?: NativeHandle,
+    initial_window_size?: number,
+    manual_window_management?: boolean,
 ): NativeHandle;
 
 /** @internal */
@@ -237,9 +376,24 @@ export function http_connection_close(connection: NativeHandle): void;
 export function http_stream_new(
     stream: NativeHandle,
     request: HttpRequest,
-    on_complete: (error_code: Number) => void,
-    on_response: (status_code: Number, headers: HttpHeader[]) => void,
-    on_body: (data: ArrayBuffer) => void,
+    on_complete: (error_code: Number, body_length?: number, body_checksum?: StreamChecksum) => void,
+    on_response: (status_code: Number, headers: HttpHeaders) => void,
+    on_body: ((chunks: ArrayBuffer[]) => void) | undefined,
+    body_destination: string | number | undefined,
+    body_checksum: StreamChecksumAlgorithm | undefined,
+    manual_window_management: boolean,
+): NativeHandle;
+
+/** @internal */
+export function http_stream_new_from_manager(
+    manager: NativeHandle,
+    request: HttpRequest,
+    on_complete: (error_code: Number, body_length?: number, body_checksum?: StreamChecksum) => void,
+    on_response: (status_code: Number, headers: HttpHeaders) => void,
+    on_body: ((chunks: ArrayBuffer[]) => void) | undefined,
+    body_destination: string | number | undefined,
+    body_checksum: StreamChecksumAlgorithm | undefined,
+    manual_window_management: boolean,
 ): NativeHandle;
 
 /** @internal */
@@ -248,6 +402,9 @@ export function http_stream_activate(stream: NativeHandle): void;
 /** @internal */
 export function http_stream_close(stream: NativeHandle): void;
 
+/** @internal */
+export function http_stream_update_window(stream: NativeHandle, increment_size: number): void;
+
 /* wraps aws_http_connection_manager #TODO: Wrap with ClassBinder */
 /** @internal */
 export function http_connection_manager_new(
@@ -260,6 +417,10 @@ export function http_connection_manager_new(
     tls_options?: NativeHandle,
     proxy_options?: NativeHandle,
     on_shutdown?: () => void,
+    manual_window_management?: boolean,
+    body_buffer_pool_size?: number,
+    max_connection_idle_ms?: number,
+    max_pending_acquisitions?: number,
 ): NativeHandle;
 
 /** @internal */
@@ -268,12 +429,49 @@ export function http_connection_manager_close(manager: NativeHandle): void;
 /** @internal */
 export function http_connection_manager_acquire(
     manager: NativeHandle,
-    on_acquired: (handle: any, error_code: number) => void,
-): void;
+    acquire_id: number,
+    timeout_ms: number | undefined,
+    on_acquired: (acquire_id: number, handle: any, error_code: number) => void,
+): boolean;
+
+/** @internal */
+export function http_connection_manager_abandon_acquire(manager: NativeHandle, acquire_id: number): void;
 
 /** @internal */
 export function http_connection_manager_release(manager: NativeHandle, connection: NativeHandle): void;
 
+/** @internal */
+export function http_connection_manager_get_stats(manager: NativeHandle): HttpConnectionManagerStats;
+
+/** @internal */
+export function http_connection_manager_warm(
+    manager: NativeHandle,
+    num_connections: number,
+    on_complete: (num_connections: number, error_code: number) => void,
+): void;
+
+/* wraps aws_http2_stream_manager */
+/** @internal */
+export function http2_stream_manager_new(
+    bootstrap: NativeHandle | undefined,
+    host: StringLike,
+    port: number,
+    max_connections: number,
+    window_size: number,
+    socket_options?: NativeHandle,
+    tls_options?: NativeHandle,
+    proxy_options?: NativeHandle,
+    on_shutdown?: () => void,
+    manual_window_management?: boolean,
+    body_buffer_pool_size?: number,
+    ideal_concurrent_streams_per_connection?: number,
+    max_concurrent_streams_per_connection?: number,
+    http2_prior_knowledge?: boolean,
+): NativeHandle;
+
+/** @internal */
+export function http2_stream_manager_close(manager: NativeHandle): void;
+
 /**
  * A collection of HTTP headers
  *
@@ -371,6 +569,7 @@ export class AwsCredentialsProvider {
 
     static newDefault(bootstrap?: NativeHandle): AwsCredentialsProvider;
     static newStatic(access_key: StringLike, secret_key: StringLike, session_token?: StringLike): AwsCredentialsProvider;
+    static newCached(source: AwsCredentialsProvider, refresh_ahead_ms: number, max_age_ms: number): AwsCredentialsProvider;
 }
 
 /** @internal */
@@ -380,6 +579,28 @@ export function aws_sign_request(
     on_complete: (error_code: number) => void
 ): void;
 
+/** @internal */
+export class SigningConfig {
+    constructor(config: AwsSigningConfig);
+
+    public readonly region: string;
+    public readonly service: string;
+}
+
+/** @internal */
+export function aws_sign_request_with_config(
+    request: HttpRequest,
+    config: SigningConfig,
+    on_complete: (error_code: number) => void
+): void;
+
+/** @internal */
+export function aws_sign_requests(
+    requests: HttpRequest[],
+    config: SigningConfig,
+    on_complete: (error_codes: number[]) => void
+): void;
+
 /** @internal */
 export function aws_verify_sigv4a_signing(
     request: HttpRequest,
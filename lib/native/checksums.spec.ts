@@ -81,4 +81,52 @@ test('crc32c_large_buffer', () => {
     const output = checksums.crc32c(arr);
     const expected = 0xfb5b991d
     expect(output).toEqual(expected);
-});
\ No newline at end of file
+});
+test('crc32_async_large_buffer', async () => {
+    const arr = new Uint8Array(25 * 2**20);
+    const output = await checksums.crc32_async(arr);
+    const expected = 0x72103906
+    expect(output).toEqual(expected);
+});
+
+test('crc32c_async_matches_sync', async () => {
+    const arr = Uint8Array.from(Array(32).keys());
+    const sync_output = checksums.crc32c(arr.subarray(16), checksums.crc32c(arr.subarray(0, 16)));
+    const output = await checksums.crc32c_async(arr.subarray(16), await checksums.crc32c_async(arr.subarray(0, 16)));
+    expect(output).toEqual(sync_output);
+    expect(output).toEqual(0x46DD794E);
+});
+
+test('crc32_combine', () => {
+    const arr = Uint8Array.from(Array(32).keys());
+    const first = checksums.crc32(arr.subarray(0, 10));
+    const second = checksums.crc32(arr.subarray(10));
+    expect(checksums.crc32_combine(first, second, 22)).toEqual(0x91267E8A);
+    expect(checksums.crc32_combine(first, 0, 0)).toEqual(first);
+});
+
+test('crc32c_combine', () => {
+    const arr = Uint8Array.from(Array(32).keys());
+    const first = checksums.crc32c(arr.subarray(0, 5));
+    const second = checksums.crc32c(arr.subarray(5));
+    expect(checksums.crc32c_combine(first, second, 27)).toEqual(0x46DD794E);
+});
+
+test('crc32_parts_async', async () => {
+    const arr = new Uint8Array(25 * 2**20);
+    const part_size = 4 * 2**20;
+    const parts: Uint8Array[] = [];
+    for (let offset = 0; offset < arr.length; offset += part_size) {
+        parts.push(arr.subarray(offset, offset + part_size));
+    }
+    const result = await checksums.crc32_parts_async(parts);
+    expect(result.checksum).toEqual(0x72103906);
+    expect(result.part_checksums).toEqual(parts.map((part) => checksums.crc32(part)));
+});
+
+test('crc32c_parts_async', async () => {
+    const arr = Uint8Array.from(Array(32).keys());
+    const result = await checksums.crc32c_parts_async([arr.subarray(0, 7), arr.subarray(7, 20), arr.subarray(20)]);
+    expect(result.checksum).toEqual(0x46DD794E);
+    expect(result.part_checksums.length).toEqual(3);
+});
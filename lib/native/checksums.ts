@@ -8,8 +8,9 @@
  * @module crypto
  */
 
- import crt_native from './binding';
+ import crt_native, { ChecksumCompleteCallback, ChecksumPartsCompleteCallback } from './binding';
  import { Hashable } from "../common/crypto";
+ import { CrtError } from './error';
 
 
 /**
@@ -34,4 +35,145 @@ export function crc32(data: Hashable, previous?: number): number {
  */
  export function crc32c(data: Hashable, previous?: number): number {
     return crt_native.checksums_crc32c(data, previous);
-}
\ No newline at end of file
+}
+
+/** @internal */
+function checksum_async(compute: (on_complete: ChecksumCompleteCallback) => void): Promise<number> {
+    return new Promise<number>((resolve, reject) => {
+        try {
+            compute((error_code: number, checksum?: number) => {
+                if (error_code == 0 && checksum !== undefined) {
+                    resolve(checksum);
+                } else {
+                    reject(new CrtError(error_code));
+                }
+            });
+        } catch (error) {
+            reject(error);
+        }
+    });
+}
+
+/**
+ * Computes an crc32 checksum off the main thread, on the libuv worker pool. Buffer-like input is referenced rather
+ * than copied, so it must not be modified until the returned promise settles.
+ *
+ * @param data The data to checksum
+ * @param previous previous crc32 checksum result. Used if you are buffering large input.
+ *
+ * nodejs only.
+ *
+ * @category Crypto
+ */
+export function crc32_async(data: Hashable, previous?: number): Promise<number> {
+    return checksum_async((on_complete) => crt_native.checksums_crc32_async(data, previous, on_complete));
+}
+
+/**
+ * Computes a crc32c checksum off the main thread, on the libuv worker pool. Buffer-like input is referenced rather
+ * than copied, so it must not be modified until the returned promise settles.
+ *
+ * @param data The data to checksum
+ * @param previous previous crc32c checksum result. Used if you are buffering large input.
+ *
+ * nodejs only.
+ *
+ * @category Crypto
+ */
+export function crc32c_async(data: Hashable, previous?: number): Promise<number> {
+    return checksum_async((on_complete) => crt_native.checksums_crc32c_async(data, previous, on_complete));
+}
+
+/**
+ * Combines the checksum of a block of data with the checksum of the block that follows it, producing the checksum of
+ * both blocks together without rehashing either of them.
+ *
+ * @param crc1 crc32 checksum of the first block
+ * @param crc2 crc32 checksum of the second block
+ * @param length2 length of the second block, in bytes
+ *
+ * @category Crypto
+ */
+export function crc32_combine(crc1: number, crc2: number, length2: number): number {
+    return crt_native.checksums_crc32_combine(crc1, crc2, length2);
+}
+
+/**
+ * Combines the checksum of a block of data with the checksum of the block that follows it, producing the checksum of
+ * both blocks together without rehashing either of them.
+ *
+ * @param crc1 crc32c checksum of the first block
+ * @param crc2 crc32c checksum of the second block
+ * @param length2 length of the second block, in bytes
+ *
+ * @category Crypto
+ */
+export function crc32c_combine(crc1: number, crc2: number, length2: number): number {
+    return crt_native.checksums_crc32c_combine(crc1, crc2, length2);
+}
+
+/**
+ * Result of checksumming several parts of data at once
+ *
+ * @category Crypto
+ */
+export interface ChecksumParts {
+    /** Checksum of all of the parts, in order, as if they were one contiguous block */
+    checksum: number;
+
+    /** Checksum of each individual part */
+    part_checksums: number[];
+}
+
+/** @internal */
+function checksum_parts_async(
+    parts: Hashable[],
+    compute: (parts: Hashable[], on_complete: ChecksumPartsCompleteCallback) => void): Promise<ChecksumParts> {
+    if (parts.length == 0) {
+        return Promise.resolve({ checksum: 0, part_checksums: [] });
+    }
+
+    return new Promise<ChecksumParts>((resolve, reject) => {
+        try {
+            compute(parts, (error_code: number, checksum?: number, part_checksums?: number[]) => {
+                if (error_code == 0 && checksum !== undefined && part_checksums) {
+                    resolve({ checksum, part_checksums });
+                } else {
+                    reject(new CrtError(error_code));
+                }
+            });
+        } catch (error) {
+            reject(error);
+        }
+    });
+}
+
+/**
+ * Computes the crc32 checksum of each part concurrently on the libuv worker pool, then combines them into the checksum
+ * of the whole. Byte ranges of a single buffer can be passed as subarrays, buffer-like parts are referenced rather
+ * than copied and must not be modified until the returned promise settles.
+ *
+ * @param parts The data to checksum, in order
+ *
+ * nodejs only.
+ *
+ * @category Crypto
+ */
+export function crc32_parts_async(parts: Hashable[]): Promise<ChecksumParts> {
+    return checksum_parts_async(parts, crt_native.checksums_crc32_parts_async);
+}
+
+/**
+ * Computes the crc32c checksum of each part concurrently on the libuv worker pool, then combines them into the
+ * checksum of the whole. Byte ranges of a single buffer can be passed as subarrays, buffer-like parts are referenced
+ * rather than copied and must not be modified until the returned promise settles.
+ *
+ * @param parts The data to checksum, in order
+ *
+ * nodejs only.
+ *
+ * @category Crypto
+ */
+export function crc32c_parts_async(parts: Hashable[]): Promise<ChecksumParts> {
+    return checksum_parts_async(parts, crt_native.checksums_crc32c_parts_async);
+}
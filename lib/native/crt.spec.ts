@@ -18,3 +18,35 @@ test('Native Memory', () => {
     }
 });
 
+test('Native Allocation Count', () => {
+    let tracingLevel = 0;
+    try {
+        tracingLevel = parseInt(process.env['AWS_CRT_MEMORY_TRACING'] as string);
+    } catch (err) { }
+    const count = crt.native_allocation_count();
+    if (tracingLevel > 0) {
+        expect(count).toBeGreaterThan(0);
+    } else {
+        expect(count).toBe(0);
+    }
+});
+
+test('Native Metrics', () => {
+    const metrics = crt.native_metrics();
+    for (const subsystem of ['http_stream', 'mqtt', 'logger', 'input_stream']) {
+        expect(metrics.subsystems[subsystem].live_allocations).toBeGreaterThanOrEqual(0);
+        expect(metrics.subsystems[subsystem].allocations).toBeGreaterThanOrEqual(metrics.subsystems[subsystem].live_allocations);
+    }
+    for (const callback of metrics.callbacks) {
+        expect(callback.queue_depth).toBe(Math.max(0, callback.queued - callback.dispatched));
+        expect(callback.latency.counts.length).toBe(callback.latency.bounds_us.length + 1);
+    }
+});
+
+test('Native Metrics Prometheus', () => {
+    const text = crt.native_metrics_prometheus('test');
+    expect(text).toContain('# TYPE test_live_allocations gauge');
+    expect(text).toContain('test_live_allocations{subsystem="http_stream"}');
+    expect(text).toContain('# TYPE test_callback_latency_seconds histogram');
+    expect(text.endsWith('\n')).toBe(true);
+});
@@ -32,6 +32,19 @@ export function native_memory() {
     return crt_native.native_memory();
 }
 
+/**
+ * If the ```AWS_CRT_MEMORY_TRACING``` environment variable is set to 1 or 2,
+ * will return the number of native allocations made since the module was loaded,
+ * including ones that have since been freed. Otherwise, returns 0.
+ * Sample it before and after an operation to see how many allocations the operation costs.
+ * @returns The cumulative count of native allocations.
+ *
+ * @category System
+ */
+export function native_allocation_count() {
+    return crt_native.native_allocation_count();
+}
+
 /**
  * Dumps outstanding native memory allocations. If the ```AWS_CRT_MEMORY_TRACING```
  * environment variable is set to 1 or 2, will dump all active native memory to
@@ -42,3 +55,131 @@ export function native_memory() {
 export function native_memory_dump() {
     return crt_native.native_memory_dump();
 }
+
+/**
+ * Native allocations attributed to one subsystem of the bindings.
+ *
+ * @category System
+ */
+export interface SubsystemMetrics {
+    /** Allocations that have not been freed yet */
+    live_allocations: number;
+    /** Allocations made since the module was loaded */
+    allocations: number;
+}
+
+/**
+ * Histogram of how long calls into JS waited on the node thread, from being queued by a CRT thread
+ * to being dispatched.
+ *
+ * @category System
+ */
+export interface CallbackLatency {
+    /** Upper bound of each bucket, in microseconds */
+    bounds_us: number[];
+    /** Number of calls in each bucket, not cumulative. The last entry counts everything above the last bound. */
+    counts: number[];
+    /** Sum of all latencies, in microseconds */
+    sum_us: number;
+}
+
+/**
+ * Statistics for one type of callback from native code into JS, e.g. aws_http_stream_on_body.
+ *
+ * @category System
+ */
+export interface CallbackMetrics {
+    name: string;
+    /** Calls queued since the module was loaded */
+    queued: number;
+    /** Calls dispatched since the module was loaded */
+    dispatched: number;
+    /** Calls that are waiting on the node thread right now */
+    queue_depth: number;
+    latency: CallbackLatency;
+}
+
+/**
+ * Snapshot of the metrics returned by {@link native_metrics}.
+ *
+ * @category System
+ */
+export interface NativeMetrics {
+    /** Keyed by subsystem: http_stream, mqtt, logger, input_stream */
+    subsystems: { [subsystem: string]: SubsystemMetrics };
+    callbacks: CallbackMetrics[];
+}
+
+/**
+ * Returns a snapshot of the native metrics: live allocations per subsystem, and for every type of
+ * callback the number of calls waiting on the node thread along with a histogram of how long they waited.
+ * Growing queue depths and latencies mean the node thread is falling behind the CRT event loop.
+ *
+ * Subsystem allocations are always collected. Callback metrics cost a lock per call, so they are only collected when
+ * the AWS_CRT_CALLBACK_METRICS environment variable is set to 1, and callbacks is empty otherwise.
+ *
+ * @category System
+ */
+export function native_metrics(): NativeMetrics {
+    return crt_native.native_metrics();
+}
+
+function prometheus_label(value: string) {
+    return value.replace(/\\/g, '\\\\').replace(/"/g, '\\"').replace(/\n/g, '\\n');
+}
+
+/**
+ * Renders {@link native_metrics} (plus {@link native_memory}) in the Prometheus text exposition format,
+ * ready to be served from a /metrics endpoint.
+ *
+ * @param prefix Prefix for every metric name
+ * @returns The metrics, one sample per line
+ *
+ * @category System
+ */
+export function native_metrics_prometheus(prefix: string = 'aws_crt'): string {
+    const metrics = native_metrics();
+    const lines: string[] = [];
+    const metric = (name: string, type: string, help: string) => {
+        lines.push(`# HELP ${prefix}_${name} ${help}`);
+        lines.push(`# TYPE ${prefix}_${name} ${type}`);
+    };
+
+    metric('native_memory_bytes', 'gauge', 'Native memory allocated, only tracked when AWS_CRT_MEMORY_TRACING is set.');
+    lines.push(`${prefix}_native_memory_bytes ${native_memory()}`);
+
+    const subsystems = Object.keys(metrics.subsystems);
+    metric('live_allocations', 'gauge', 'Native allocations not yet freed, by subsystem.');
+    for (const subsystem of subsystems) {
+        lines.push(`${prefix}_live_allocations{subsystem="${prometheus_label(subsystem)}"} ${metrics.subsystems[subsystem].live_allocations}`);
+    }
+    metric('allocations_total', 'counter', 'Native allocations made, by subsystem.');
+    for (const subsystem of subsystems) {
+        lines.push(`${prefix}_allocations_total{subsystem="${prometheus_label(subsystem)}"} ${metrics.subsystems[subsystem].allocations}`);
+    }
+
+    metric('callback_queue_depth', 'gauge', 'Calls into JS waiting on the node thread, by callback.');
+    for (const callback of metrics.callbacks) {
+        lines.push(`${prefix}_callback_queue_depth{callback="${prometheus_label(callback.name)}"} ${callback.queue_depth}`);
+    }
+    metric('callback_dispatched_total', 'counter', 'Calls into JS dispatched on the node thread, by callback.');
+    for (const callback of metrics.callbacks) {
+        lines.push(`${prefix}_callback_dispatched_total{callback="${prometheus_label(callback.name)}"} ${callback.dispatched}`);
+    }
+
+    metric('callback_latency_seconds', 'histogram', 'Time calls into JS waited between being queued and dispatched.');
+    for (const callback of metrics.callbacks) {
+        const label = `callback="${prometheus_label(callback.name)}"`;
+        const latency = callback.latency;
+        let cumulative = 0;
+        for (let i = 0; i < latency.counts.length; ++i) {
+            cumulative += latency.counts[i];
+            const le = i < latency.bounds_us.length ? (latency.bounds_us[i] / 1e6).toString() : '+Inf';
+            lines.push(`${prefix}_callback_latency_seconds_bucket{${label},le="${le}"} ${cumulative}`);
+        }
+        lines.push(`${prefix}_callback_latency_seconds_sum{${label}} ${latency.sum_us / 1e6}`);
+        lines.push(`${prefix}_callback_latency_seconds_count{${label}} ${cumulative}`);
+    }
+
+    return lines.join('\n') + '\n';
+}
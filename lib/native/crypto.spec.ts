@@ -95,3 +95,86 @@ test('hmac-256 one-shot matches', () => {
 
     expect(native_hash).toEqual(browser_hash);
 });
+
+test('SHA256 async matches multi-part', async () => {
+    const data = Buffer.from('ABC123XYZ');
+    const native_sha256 = new native.Sha256Hash();
+    native_sha256.update(data);
+
+    const async_hash = await native.hash_sha256_async(data);
+    expect(async_hash).toEqual(native_sha256.finalize());
+});
+
+test('md5 async matches browser', async () => {
+    const data = 'ABC123XYZ';
+    const async_hash = await native.hash_md5_async(data);
+    const browser_hash = browser.hash_md5(data);
+
+    expect(async_hash).toEqual(browser_hash);
+});
+
+test('hmac-256 async matches browser', async () => {
+    const secret = Buffer.from('TEST');
+    const data = new Uint8Array(Buffer.from('ABC123XYZ'));
+    const async_hash = await native.hmac_sha256_async(secret, data);
+    const browser_hash = browser.hmac_sha256(secret, data);
+
+    expect(async_hash).toEqual(browser_hash);
+});
+
+test('string inputs hash the same as their UTF-8 bytes', () => {
+    const inputs = [
+        '',
+        'ABC123XYZ',
+        'é',
+        'ÀÉÎÕÜ-latin1',
+        '漢字かなカナ',
+        '\u{1F600}\u{1F680}',
+        'x'.repeat(127) + '漢',
+        'A'.repeat(4096),
+        '漢'.repeat(4096),
+    ];
+    for (const input of inputs) {
+        expect(native.hash_sha256(input)).toEqual(native.hash_sha256(Buffer.from(input, 'utf8')));
+        expect(native.hmac_sha256(input, input)).toEqual(
+            native.hmac_sha256(Buffer.from(input, 'utf8'), Buffer.from(input, 'utf8')));
+    }
+});
+
+test('SHA256 reset, update_many and finalize_into', () => {
+    const sha = new native.Sha256Hash();
+    sha.update('discarded');
+    sha.reset();
+    sha.update_many(['ABC', Buffer.from('123'), 'XYZ']);
+    const output = Buffer.alloc(40);
+    expect(sha.finalize_into(output)).toBe(32);
+    expect(output.subarray(0, 32)).toEqual(Buffer.from(native.hash_sha256('ABC123XYZ').buffer));
+
+    // reusable after finalizing
+    sha.reset();
+    sha.update('ABC123XYZ');
+    expect(sha.finalize_into(output, 16)).toBe(16);
+    expect(() => sha.finalize_into(Buffer.alloc(8))).toThrow();
+});
+
+test('one-shot digests honor truncate_to, treating 0 as the whole digest', async () => {
+    const data = 'ABC123XYZ';
+    expect(native.hash_md5(data, 0).byteLength).toBe(16);
+    expect(native.hash_sha1(data, 0).byteLength).toBe(20);
+    expect(native.hash_sha256(data, 0).byteLength).toBe(32);
+    expect(native.hmac_sha256('TEST', data, 0).byteLength).toBe(32);
+    expect((await native.hash_sha256_async(data, 0)).byteLength).toBe(32);
+    expect(native.hash_sha256(data, 8).byteLength).toBe(8);
+    expect((await native.hmac_sha256_async('TEST', data, 8)).byteLength).toBe(8);
+});
+
+test('hmac-256 reset reuses the secret', () => {
+    const secret = 'TEST';
+    const hmac = new native.Sha256Hmac(secret);
+    const expected = native.hmac_sha256(secret, 'ABC123XYZ');
+    for (let i = 0; i < 2; ++i) {
+        hmac.reset();
+        hmac.update_many(['ABC', '123', 'XYZ']);
+        expect(hmac.finalize()).toEqual(expected);
+    }
+});
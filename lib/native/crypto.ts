@@ -8,9 +8,10 @@
  * @module crypto
  */
 
-import crt_native from './binding';
+import crt_native, { HashCompleteCallback } from './binding';
 import { NativeResource } from "./native_resource";
 import { Hashable } from "../common/crypto";
+import { CrtError } from './error';
 
 /**
  * Object that allows for continuous hashing of data.
@@ -26,6 +27,14 @@ abstract class Hash extends NativeResource {
         crt_native.hash_update(this.native_handle(), data);
     }
 
+    /**
+     * Hash several pieces of additional data, in order, as if each were passed to {@link update}.
+     * @param data Additional data to hash
+     */
+    update_many(data: Hashable[]) {
+        crt_native.hash_update_many(this.native_handle(), data);
+    }
+
     /**
      * Completes the hash computation and returns the final hash digest.
      *
@@ -35,6 +44,24 @@ abstract class Hash extends NativeResource {
         return crt_native.hash_digest(this.native_handle(), truncate_to);
     }
 
+    /**
+     * Completes the hash computation, writing the digest to the start of output rather than a new buffer.
+     *
+     * @param output Where to write the digest, must be large enough to hold it
+     * @param truncate_to The maximum number of bytes to write. Leave as undefined or 0 to write the entire digest.
+     * @returns The number of bytes written
+     */
+    finalize_into(output: ArrayBuffer | ArrayBufferView, truncate_to?: number): number {
+        return crt_native.hash_digest_into(this.native_handle(), output, truncate_to);
+    }
+
+    /**
+     * Discards all data hashed so far, including after {@link finalize}, so the object can hash another message.
+     */
+    reset() {
+        crt_native.hash_reset(this.native_handle());
+    }
+
     constructor(hash_handle: any) {
         super(hash_handle);
     }
@@ -129,6 +156,15 @@ abstract class Hmac extends NativeResource {
         crt_native.hmac_update(this.native_handle(), data);
     }
 
+    /**
+     * Hash several pieces of additional data, in order, as if each were passed to {@link update}.
+     *
+     * @param data additional data to hash
+     */
+    update_many(data: Hashable[]) {
+        crt_native.hmac_update_many(this.native_handle(), data);
+    }
+
     /**
      * Completes the hash computation and returns the final hmac digest.
      *
@@ -138,6 +174,25 @@ abstract class Hmac extends NativeResource {
         return crt_native.hmac_digest(this.native_handle(), truncate_to);
     }
 
+    /**
+     * Completes the hash computation, writing the hmac digest to the start of output rather than a new buffer.
+     *
+     * @param output Where to write the digest, must be large enough to hold it
+     * @param truncate_to The maximum number of bytes to write. Leave as undefined or 0 to write the entire digest.
+     * @returns The number of bytes written
+     */
+    finalize_into(output: ArrayBuffer | ArrayBufferView, truncate_to?: number): number {
+        return crt_native.hmac_digest_into(this.native_handle(), output, truncate_to);
+    }
+
+    /**
+     * Discards all data hashed so far, including after {@link finalize}, so the object can hash another message
+     * with the same secret.
+     */
+    reset() {
+        crt_native.hmac_reset(this.native_handle());
+    }
+
     constructor(hash_handle: any) {
         super(hash_handle);
     }
@@ -167,3 +222,81 @@ export class Sha256Hmac extends Hmac {
 export function hmac_sha256(secret: Hashable, data: Hashable, truncate_to?: number): DataView {
     return crt_native.hmac_sha256_compute(secret, data, truncate_to);
 }
+
+/** @internal */
+function compute_async(compute: (on_complete: HashCompleteCallback) => void): Promise<DataView> {
+    return new Promise<DataView>((resolve, reject) => {
+        try {
+            compute((error_code: number, digest?: DataView) => {
+                if (error_code == 0 && digest) {
+                    resolve(digest);
+                } else {
+                    reject(new CrtError(error_code));
+                }
+            });
+        } catch (error) {
+            reject(error);
+        }
+    });
+}
+
+/**
+ * Computes an MD5 hash off the main thread, on the libuv worker pool. Buffer-like input is referenced rather than
+ * copied, so it must not be modified until the returned promise settles.
+ *
+ * @param data The data to hash
+ * @param truncate_to The maximum number of bytes to receive. Leave as undefined or 0 to receive the entire digest.
+ *
+ * nodejs only.
+ *
+ * @category Crypto
+ */
+export function hash_md5_async(data: Hashable, truncate_to?: number): Promise<DataView> {
+    return compute_async((on_complete) => crt_native.hash_md5_compute_async(data, truncate_to, on_complete));
+}
+
+/**
+ * Computes an SHA256 hash off the main thread, on the libuv worker pool. Buffer-like input is referenced rather than
+ * copied, so it must not be modified until the returned promise settles.
+ *
+ * @param data The data to hash
+ * @param truncate_to The maximum number of bytes to receive. Leave as undefined or 0 to receive the entire digest.
+ *
+ * nodejs only.
+ *
+ * @category Crypto
+ */
+export function hash_sha256_async(data: Hashable, truncate_to?: number): Promise<DataView> {
+    return compute_async((on_complete) => crt_native.hash_sha256_compute_async(data, truncate_to, on_complete));
+}
+
+/**
+ * Computes an SHA1 hash off the main thread, on the libuv worker pool. Buffer-like input is referenced rather than
+ * copied, so it must not be modified until the returned promise settles.
+ *
+ * @param data The data to hash
+ * @param truncate_to The maximum number of bytes to receive. Leave as undefined or 0 to receive the entire digest.
+ *
+ * nodejs only.
+ *
+ * @category Crypto
+ */
+export function hash_sha1_async(data: Hashable, truncate_to?: number): Promise<DataView> {
+    return compute_async((on_complete) => crt_native.hash_sha1_compute_async(data, truncate_to, on_complete));
+}
+
+/**
+ * Computes an SHA256 HMAC off the main thread, on the libuv worker pool. Buffer-like inputs are referenced rather than
+ * copied, so they must not be modified until the returned promise settles.
+ *
+ * @param secret The key to use for the HMAC process
+ * @param data The data to hash
+ * @param truncate_to The maximum number of bytes to receive. Leave as undefined or 0 to receive the entire digest.
+ *
+ * nodejs only.
+ *
+ * @category Crypto
+ */
+export function hmac_sha256_async(secret: Hashable, data: Hashable, truncate_to?: number): Promise<DataView> {
+    return compute_async((on_complete) => crt_native.hmac_sha256_compute_async(secret, data, truncate_to, on_complete));
+}
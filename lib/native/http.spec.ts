@@ -0,0 +1,200 @@
+/*
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+import { ClientTlsContext, SocketOptions, TlsConnectionOptions } from './io';
+import { Http2StreamManager, HttpClientConnectionManager, HttpHeaders, HttpRequest, HttpStreamBody } from './http';
+import { crc32c } from './checksums';
+import { hash_sha256 } from './crypto';
+import { mkdtempSync, readFileSync, unlinkSync } from 'fs';
+import { tmpdir } from 'os';
+import { join } from 'path';
+
+test('HTTP Headers from array with long values', () => {
+    const long_name = 'x-' + 'n'.repeat(300);
+    const long_value = 'v'.repeat(4096);
+    const headers = new HttpHeaders([[long_name, long_value], ['short', 'value']]);
+    expect(headers.get(long_name)).toBe(long_value);
+    expect(headers.get('short')).toBe('value');
+    expect(() => new HttpHeaders([['name', <any>42]])).toThrow();
+});
+
+test('HTTP/2 Stream Manager multiplexes GETs', async () => {
+    const host = 'www.amazon.com';
+    const manager = new Http2StreamManager({
+        host,
+        port: 443,
+        max_connections: 1,
+        socket_options: new SocketOptions(),
+        tls_opts: new TlsConnectionOptions(new ClientTlsContext(), host),
+    });
+
+    const num_requests = 8;
+    const status_codes = await Promise.all(Array.from({ length: num_requests }, () => new Promise<number>((resolve, reject) => {
+        const stream = manager.request(new HttpRequest('GET', '/', new HttpHeaders([['host', host]])));
+        let status_code = 0;
+        stream.on('response', (code) => { status_code = code; });
+        stream.on('data', () => {});
+        stream.on('end', () => { resolve(status_code); });
+        stream.on('error', reject);
+        stream.activate();
+    })));
+
+    expect(status_codes.length).toBe(num_requests);
+    for (const status_code of status_codes) {
+        expect(status_code).toBeGreaterThan(0);
+    }
+    manager.close();
+});
+
+test('HTTP Connection Manager warm', async () => {
+    const connection_manager = new HttpClientConnectionManager(
+        undefined,
+        'example.com',
+        80,
+        2,
+        16 * 1024,
+        new SocketOptions(),
+        undefined,
+        undefined,
+        false,
+        undefined,
+        60 * 1000,
+    );
+
+    const num_warmed = await connection_manager.warm(4);
+    expect(num_warmed).toBe(2);
+    expect(connection_manager.get_stats()).toMatchObject({ available: 2, leased: 0 });
+
+    const connection = await connection_manager.acquire();
+    expect(connection).toBeDefined();
+    connection_manager.release(connection);
+
+    connection_manager.close();
+});
+
+test('HTTP Connection Manager stats', async () => {
+    const connection_manager = new HttpClientConnectionManager(
+        undefined,
+        'example.com',
+        80,
+        1,
+        16 * 1024,
+        new SocketOptions(),
+    );
+
+    const connection = await connection_manager.acquire();
+    const pending = connection_manager.acquire();
+    let stats = connection_manager.get_stats();
+    expect(stats.leased).toBe(1);
+    expect(stats.pending_acquisitions).toBe(1);
+    expect(stats.acquires).toBe(1);
+
+    connection_manager.release(connection);
+    connection_manager.release(await pending);
+
+    stats = connection_manager.get_stats();
+    expect(stats.available).toBe(1);
+    expect(stats.leased).toBe(0);
+    expect(stats.pending_acquisitions).toBe(0);
+    expect(stats.acquires).toBe(2);
+    expect(stats.acquire_wait_us.p50).toBeLessThanOrEqual(stats.acquire_wait_us.p99);
+    expect(stats.acquire_wait_us.p99).toBeLessThanOrEqual(stats.acquire_wait_us.max);
+
+    connection_manager.close();
+});
+
+test('HTTP Connection Manager acquire deadline and pending limit', async () => {
+    const connection_manager = new HttpClientConnectionManager(
+        undefined,
+        'example.com',
+        80,
+        1,
+        16 * 1024,
+        new SocketOptions(),
+        undefined,
+        undefined,
+        false,
+        undefined,
+        undefined,
+        0,
+        1,
+    );
+
+    const connection = await connection_manager.acquire();
+    // the pool is exhausted, this waits and fills the pending queue
+    const timed_out = connection_manager.acquire(100);
+    await expect(connection_manager.acquire()).rejects.toThrow(/pending/);
+    await expect(timed_out).rejects.toThrow(/Timed out/);
+
+    // the expired acquire holds its place in the queue until the released connection reaches it, then gives it back
+    connection_manager.release(connection);
+    await new Promise((resolve) => setTimeout(resolve, 100));
+    const reacquired = await connection_manager.acquire(5000);
+    expect(reacquired).toBe(connection);
+    connection_manager.release(reacquired);
+
+    connection_manager.close();
+});
+
+test('HTTP Stream writes its body to a file', async () => {
+    const connection_manager = new HttpClientConnectionManager(
+        undefined,
+        'example.com',
+        80,
+        1,
+        16 * 1024,
+        new SocketOptions(),
+    );
+    const path = join(mkdtempSync(join(tmpdir(), 'crt-')), 'body');
+
+    try {
+        const connection = await connection_manager.acquire();
+        const body = await new Promise<HttpStreamBody | undefined>((resolve, reject) => {
+            const request = new HttpRequest('GET', '/', new HttpHeaders([['host', 'example.com']]));
+            const stream = connection.request(request, { body_destination: path, body_checksum: 'crc32c' });
+            stream.on('data', () => reject(new Error('body should not be delivered to js')));
+            stream.on('end', resolve);
+            stream.on('error', reject);
+            stream.activate();
+        });
+        connection_manager.release(connection);
+
+        const written = readFileSync(path);
+        expect(body?.length).toBe(written.length);
+        expect(body?.checksum).toBe(crc32c(written));
+    } finally {
+        unlinkSync(path);
+        connection_manager.close();
+    }
+});
+
+test('HTTP Stream checksums the body it delivers', async () => {
+    const connection_manager = new HttpClientConnectionManager(
+        undefined,
+        'example.com',
+        80,
+        1,
+        16 * 1024,
+        new SocketOptions(),
+    );
+
+    const connection = await connection_manager.acquire();
+    const chunks: Buffer[] = [];
+    const body = await new Promise<HttpStreamBody | undefined>((resolve, reject) => {
+        const request = new HttpRequest('GET', '/', new HttpHeaders([['host', 'example.com']]));
+        const stream = connection.request(request, { body_checksum: 'sha256' });
+        stream.on('data', (data) => chunks.push(Buffer.from(data)));
+        stream.on('end', resolve);
+        stream.on('error', reject);
+        stream.activate();
+    });
+    connection_manager.release(connection);
+
+    const received = Buffer.concat(chunks);
+    expect(body?.length).toBe(received.length);
+    expect(Buffer.from((body?.checksum as DataView).buffer)).toEqual(Buffer.from(hash_sha256(received).buffer));
+
+    connection_manager.close();
+});
@@ -11,7 +11,16 @@
 import crt_native from './binding';
 import { NativeResource, NativeResourceMixin } from "./native_resource";
 import { ResourceSafe } from '../common/resource_safety';
-import { ClientBootstrap, SocketOptions, TlsConnectionOptions, InputStream } from './io';
+import {
+    ClientBootstrap,
+    SocketOptions,
+    TlsConnectionOptions,
+    InputStream,
+    FileInputStream,
+    StreamChecksum,
+    StreamChecksumAlgorithm,
+    is_alpn_available
+} from './io';
 import { CrtError } from './error';
 import {
     CommonHttpProxyOptions,
@@ -19,7 +28,6 @@ import {
     HttpClientConnectionConnected,
     HttpClientConnectionError,
     HttpClientConnectionClosed,
-    HttpStreamComplete,
     HttpStreamData,
     HttpStreamError
 } from '../common/http';
@@ -51,11 +59,59 @@ const nativeHttpRequest = crt_native.HttpRequest;
  * @category HTTP
  */
 export class HttpRequest extends nativeHttpRequest {
-    constructor(method: string, path: string, headers?: HttpHeaders, body?: InputStream) {
+    /**
+     * Referenced so a {@link FileInputStream} body isn't closed while the request is still using it
+     * @internal
+     */
+    readonly body_stream?: InputStream | FileInputStream;
+
+    constructor(method: string, path: string, headers?: HttpHeaders, body?: InputStream | FileInputStream) {
         super(method, path, headers, body?.native_handle());
+        this.body_stream = body;
+        if (body?.length !== undefined && !this.headers.get('content-length')) {
+            this.headers.set('content-length', body.length.toString());
+        }
     }
 }
 
+/**
+ * Options for an individual {@link HttpClientStream}
+ *
+ * @category HTTP
+ */
+export interface HttpStreamOptions {
+    /**
+     * File path, or open file descriptor, to write the response body to natively rather than through 'data' events.
+     * A path is created or truncated. A descriptor is written from its current position and is left open.
+     */
+    body_destination?: string | number;
+    /** Checksum to compute over the response body as it is received, whether or not it goes to body_destination */
+    body_checksum?: StreamChecksumAlgorithm;
+}
+
+/**
+ * Summary of a response body, for streams with a {@link HttpStreamOptions.body_destination} or
+ * {@link HttpStreamOptions.body_checksum}
+ *
+ * @category HTTP
+ */
+export interface HttpStreamBody {
+    /** Number of body bytes received */
+    length: number;
+    /** The body's checksum, if {@link HttpStreamOptions.body_checksum} asked for one */
+    checksum?: StreamChecksum;
+}
+
+/**
+ * Listener signature for event emitted from an {@link HttpClientStream} when the stream has completed
+ *
+ * @param body summary of the response body, for streams with a body destination or checksum
+ *
+ * @asMemberOf HttpClientStream
+ * @category HTTP
+ */
+export type HttpClientStreamComplete = (body?: HttpStreamBody) => void;
+
 /**
  * Base class for HTTP connections
  *
@@ -222,6 +278,10 @@ export class HttpClientConnection extends HttpConnection {
      * @param socket_options Socket options
      * @param tls_opts Optional TLS connection options
      * @param proxy_options Optional proxy options
+     * @param manual_window_management Optional, set true to enable flow control of response bodies. Each stream
+     *          stops receiving data once `initial_window_size` bytes are outstanding, and the window is re-opened
+     *          as 'data' events are delivered. Default is false.
+     * @param initial_window_size Optional initial window size, only meaningful with manual window management
     */
     constructor(
         protected bootstrap: ClientBootstrap | undefined,
@@ -230,7 +290,9 @@ export class HttpClientConnection extends HttpConnection {
         protected socket_options: SocketOptions,
         protected tls_opts?: TlsConnectionOptions,
         proxy_options?: HttpProxyOptions,
-        handle?: any) {
+        handle?: any,
+        readonly manual_window_management: boolean = false,
+        initial_window_size?: number) {
 
         super(handle
             ? handle
@@ -247,6 +309,8 @@ export class HttpClientConnection extends HttpConnection {
                 socket_options.native_handle(),
                 tls_opts ? tls_opts.native_handle() : undefined,
                 proxy_options ? proxy_options.create_native_handle() : undefined,
+                initial_window_size,
+                manual_window_management,
             ));
     }
 
@@ -257,33 +321,65 @@ export class HttpClientConnection extends HttpConnection {
      * is called. Call {@link HttpStream.activate} when you're ready for
      * callbacks and events to fire.
      * @param request - The HttpRequest to attempt on this connection
+     * @param options - Optional settings for the stream
      * @returns A new stream that will deliver events for the request
      */
-    request(request: HttpRequest) {
-        let stream: HttpClientStream;
-        const on_response_impl = (status_code: Number, headers: [string, string][]) => {
-            stream._on_response(status_code, headers);
-        }
+    request(request: HttpRequest, options?: HttpStreamOptions) {
+        return new_client_stream(request, this, this.manual_window_management, options,
+            (on_complete, on_response, on_body) => crt_native.http_stream_new(
+                this.native_handle(),
+                request,
+                on_complete,
+                on_response,
+                on_body,
+                options?.body_destination,
+                options?.body_checksum,
+                this.manual_window_management
+            ));
+    }
+}
+
+/**
+ * Creates an {@link HttpClientStream} whose native stream is made by new_native, routing its callbacks to the
+ * stream's events
+ *
+ * @internal
+ */
+function new_client_stream(
+    request: HttpRequest,
+    connection: HttpClientConnection | undefined,
+    manual_window_management: boolean,
+    options: HttpStreamOptions | undefined,
+    new_native: (
+        on_complete: (error_code: Number, body_length?: number, body_checksum?: StreamChecksum) => void,
+        on_response: (status_code: Number, headers: HttpHeaders) => void,
+        on_body: ((chunks: ArrayBuffer[]) => void) | undefined) => any) {
+
+    let stream: HttpClientStream;
+    const on_response_impl = (status_code: Number, headers: HttpHeaders) => {
+        stream._on_response(status_code, headers);
+    }
 
-        const on_body_impl = (data: ArrayBuffer) => {
+    // chunks received since the last callback are delivered together
+    const on_body_impl = (chunks: ArrayBuffer[]) => {
+        for (const data of chunks) {
             stream._on_body(data);
         }
+    }
 
-        const on_complete_impl = (error_code: Number) => {
-            stream._on_complete(error_code);
-        }
-        const native_handle = crt_native.http_stream_new(
-            this.native_handle(),
-            request,
-            on_complete_impl,
-            on_response_impl,
-            on_body_impl
-        );
-        return stream = new HttpClientStream(
-            native_handle,
-            this,
-            request);
+    const on_complete_impl = (error_code: Number, body_length?: number, body_checksum?: StreamChecksum) => {
+        const body = body_length !== undefined ? { length: body_length, checksum: body_checksum } : undefined;
+        stream._on_complete(error_code, body);
     }
+    // a body written natively never reaches js
+    const has_body_destination = options?.body_destination !== undefined;
+    const native_handle = new_native(
+        on_complete_impl, on_response_impl, has_body_destination ? undefined : on_body_impl);
+    return stream = new HttpClientStream(
+        native_handle,
+        connection,
+        request,
+        manual_window_management);
 }
 
 /**
@@ -296,9 +392,13 @@ export class HttpClientConnection extends HttpConnection {
  * @category HTTP
  */
 export class HttpStream extends NativeResourceMixin(BufferedEventEmitter) implements ResourceSafe {
+    /**
+     * @param connection The connection the stream was made on, undefined for streams from an
+     *          {@link Http2StreamManager}, which picks a connection when the stream is activated
+     */
     protected constructor(
         native_handle: any,
-        readonly connection: HttpConnection) {
+        readonly connection: HttpConnection | undefined) {
         super();
         this._super(native_handle);
         this.cork();
@@ -323,13 +423,24 @@ export class HttpStream extends NativeResourceMixin(BufferedEventEmitter) implem
         crt_native.http_stream_close(this.native_handle());
     }
 
+    /**
+     * Increments the flow-control window of the stream, allowing up to `increment_size` more bytes of body data to
+     * be received. Only meaningful when the stream's connection uses manual window management, in which case
+     * the window is already re-opened automatically as each 'data' event is delivered.
+     *
+     * @param increment_size number of bytes to re-open the window by
+     */
+    update_window(increment_size: number) {
+        crt_native.http_stream_update_window(this.native_handle(), increment_size);
+    }
+
     /** @internal */
     _on_body(data: ArrayBuffer) {
         this.emit('data', data);
     }
 
     /** @internal */
-    _on_complete(error_code: Number) {
+    _on_complete(error_code: Number, body?: HttpStreamBody) {
         if (error_code) {
             this.emit('error', new CrtError(error_code));
             this.close();
@@ -339,7 +450,7 @@ export class HttpStream extends NativeResourceMixin(BufferedEventEmitter) implem
         this.on('end', () => {
             this.close();
         })
-        this.emit('end');
+        this.emit('end', body);
     }
 }
 
@@ -367,7 +478,7 @@ export type HttpStreamResponse = (status_code: number, headers: HttpHeaders) =>
 /**
  * Stream that sends a request and receives a response.
  *
- * Create an HttpClientStream with {@link HttpClientConnection.request}.
+ * Create an HttpClientStream with {@link HttpClientConnection.request} or {@link Http2StreamManager.request}.
  *
  * NOTE: The stream sends no data until {@link HttpStream.activate} is called.
  * Call {@link HttpStream.activate} when you're ready for callbacks and events to fire.
@@ -378,8 +489,9 @@ export class HttpClientStream extends HttpStream {
     private response_status_code?: Number;
     constructor(
         native_handle: any,
-        connection: HttpClientConnection,
-        readonly request: HttpRequest) {
+        connection: HttpClientConnection | undefined,
+        readonly request: HttpRequest,
+        private readonly manual_window_management: boolean = connection?.manual_window_management ?? false) {
         super(native_handle, connection);
     }
 
@@ -423,14 +535,15 @@ export class HttpClientStream extends HttpStream {
     on(event: 'error', listener: HttpStreamError): this;
 
     /**
-     * Emitted when the stream has completed
+     * Emitted when the stream has completed. Streams with a {@link HttpStreamOptions.body_destination} or
+     * {@link HttpStreamOptions.body_checksum} pass the listener a summary of the response body.
      *
      * @param event type of event (end)
      * @param listener event listener to use
      *
      * @event
      */
-    on(event: 'end', listener: HttpStreamComplete): this;
+    on(event: 'end', listener: HttpClientStreamComplete): this;
 
     /**
      * Emitted when inline headers are delivered while communicating over H2
@@ -454,13 +567,58 @@ export class HttpClientStream extends HttpStream {
     }
 
     /** @internal */
-    _on_response(status_code: Number, header_array: [string, string][]) {
+    _on_body(data: ArrayBuffer) {
+        super._on_body(data);
+        // the data listeners have run, so the consumed bytes can be let back into the window
+        if (this.manual_window_management) {
+            this.update_window(data.byteLength);
+        }
+    }
+
+    /** @internal */
+    _on_response(status_code: Number, headers: HttpHeaders) {
         this.response_status_code = status_code;
-        let headers = new HttpHeaders(header_array);
         this.emit('response', status_code, headers);
     }
 }
 
+/** @internal */
+interface PendingAcquire {
+    resolve: (connection: HttpClientConnection) => void;
+    reject: (error: CrtError) => void;
+    timer?: ReturnType<typeof setTimeout>;
+}
+
+/**
+ * Approximate percentiles of how long {@link HttpClientConnectionManager.acquire} calls waited for a connection, in
+ * microseconds. Each is the upper bound of the histogram bucket it fell in, capped at max.
+ *
+ * @category HTTP
+ */
+export interface AcquireWaitPercentiles {
+    p50: number;
+    p90: number;
+    p99: number;
+    max: number;
+}
+
+/**
+ * Snapshot of the pool returned by {@link HttpClientConnectionManager.get_stats}
+ *
+ * @category HTTP
+ */
+export interface HttpConnectionManagerStats {
+    /** Open connections idle in the pool */
+    available: number;
+    /** Connections currently acquired and not yet released */
+    leased: number;
+    /** Acquires waiting for a connection. If this stays above 0, the pool is exhausted. */
+    pending_acquisitions: number;
+    /** Acquires that have completed with a connection, those the wait percentiles cover */
+    acquires: number;
+    acquire_wait_us: AcquireWaitPercentiles;
+}
+
 /**
  * Creates, manages, and vends connections to a given host/port endpoint
  *
@@ -468,6 +626,12 @@ export class HttpClientStream extends HttpStream {
  */
 export class HttpClientConnectionManager extends NativeResource {
     private connections = new Map<any, HttpClientConnection>();
+    private pending_acquires = new Map<number, PendingAcquire>();
+    private next_acquire_id = 0;
+    // One callback for every acquire, so the native side only needs one threadsafe function
+    private on_acquired = (acquire_id: number, handle: any, error_code: number) => {
+        this._on_acquired(acquire_id, handle, error_code);
+    };
 
     /**
      * @param bootstrap Client bootstrap to use when initiating socket connections.  Leave undefined to use the
@@ -479,6 +643,18 @@ export class HttpClientConnectionManager extends NativeResource {
      * @param socket_options Socket options to use when initiating socket connections
      * @param tls_opts Optional TLS connection options
      * @param proxy_options Optional proxy options
+     * @param manual_window_management Optional, set true to enable flow control of response bodies. Each stream
+     *          stops receiving data once `initial_window_size` bytes are outstanding, and the window is re-opened
+     *          as 'data' events are delivered. Default is false.
+     * @param body_buffer_pool_size Optional number of idle response body buffers to keep for reuse across the
+     *          streams of this manager. Buffers are recycled once the ArrayBuffer delivered in a 'data' event is
+     *          garbage collected. 0 disables pooling. Default is 16.
+     * @param max_connection_idle_ms Optional, close connections that have been idle in the pool for this long.
+     *          Default is 0, which keeps them open until the server closes them.
+     * @param prewarm_connections Optional number of connections to open straight away, see {@link warm}.
+     *          Default is 0.
+     * @param max_pending_acquisitions Optional limit on acquires waiting for a connection. Beyond it,
+     *          {@link acquire} rejects immediately instead of queueing. Default is 0, no limit.
      */
     constructor(
         readonly bootstrap: ClientBootstrap | undefined,
@@ -489,6 +665,11 @@ export class HttpClientConnectionManager extends NativeResource {
         readonly socket_options: SocketOptions,
         readonly tls_opts?: TlsConnectionOptions,
         readonly proxy_options?: HttpProxyOptions,
+        readonly manual_window_management: boolean = false,
+        readonly body_buffer_pool_size?: number,
+        readonly max_connection_idle_ms?: number,
+        prewarm_connections: number = 0,
+        readonly max_pending_acquisitions?: number,
     ) {
         super(crt_native.http_connection_manager_new(
             bootstrap != null ? bootstrap.native_handle() : null,
@@ -499,45 +680,118 @@ export class HttpClientConnectionManager extends NativeResource {
             socket_options.native_handle(),
             tls_opts ? tls_opts.native_handle() : undefined,
             proxy_options ? proxy_options.create_native_handle() : undefined,
-            undefined /* on_shutdown */
+            undefined /* on_shutdown */,
+            manual_window_management,
+            body_buffer_pool_size,
+            max_connection_idle_ms,
+            max_pending_acquisitions,
         ));
+
+        if (prewarm_connections > 0) {
+            // a failed warm-up only means the first requests pay for their own connections
+            this.warm(prewarm_connections).catch(() => {});
+        }
+    }
+
+    /**
+     * Opens connections ahead of the requests that will use them, so those requests don't wait on TCP and TLS
+     * setup. The connections are acquired all at once, forcing the manager to open that many, then returned to
+     * the pool together. Connections already idle in the pool count towards the total.
+     *
+     * Warmed connections are subject to max_connection_idle_ms like any other idle connection.
+     *
+     * @param num_connections How many connections to have open, capped at max_connections. Defaults to
+     *          max_connections.
+     * @returns A promise resolving to the number of connections that were opened, rejected if none could be.
+     */
+    warm(num_connections: number = this.max_connections): Promise<number> {
+        return new Promise((resolve, reject) => {
+            crt_native.http_connection_manager_warm(this.native_handle(), num_connections, (num_warmed, error_code) => {
+                if (error_code && num_warmed == 0) {
+                    reject(new CrtError(error_code));
+                    return;
+                }
+                resolve(num_warmed);
+            });
+        });
     }
 
     /**
     * Vends a connection from the pool
+    * @param timeout_ms Optional, reject if no connection is available within this many milliseconds. A connection
+    *          that arrives after that goes straight back to the pool. Default is 0, wait indefinitely.
     * @returns A promise that results in an HttpClientConnection. When done with the connection, return
     *          it via {@link release}
     */
-    acquire(): Promise<HttpClientConnection> {
+    acquire(timeout_ms: number = 0): Promise<HttpClientConnection> {
         return new Promise((resolve, reject) => {
-            // Only create 1 connection in JS/TS from each native connection
-            const on_acquired = (handle: any, error_code: number) => {
-                if (error_code) {
-                    reject(new CrtError(error_code));
-                    return;
-                }
-                let connection = this.connections.get(handle);
-                if (!connection) {
-                    connection = new HttpClientConnection(
-                        this.bootstrap,
-                        this.host,
-                        this.port,
-                        this.socket_options,
-                        this.tls_opts,
-                        this.proxy_options,
-                        handle
-                    );
-                    this.connections.set(handle, connection as HttpClientConnection);
-                    connection.on('close', () => {
-                        this.connections.delete(handle);
-                    })
-                }
-                resolve(connection);
-            };
-            crt_native.http_connection_manager_acquire(this.native_handle(), on_acquired);
+            const acquire_id = this.next_acquire_id;
+            this.next_acquire_id = (this.next_acquire_id + 1) >>> 0;
+
+            if (!crt_native.http_connection_manager_acquire(
+                    this.native_handle(), acquire_id, timeout_ms, this.on_acquired)) {
+                reject(new CrtError(
+                    `Too many pending connection acquisitions, the limit is ${this.max_pending_acquisitions}`));
+                return;
+            }
+
+            const pending: PendingAcquire = { resolve, reject };
+            if (timeout_ms > 0) {
+                pending.timer = setTimeout(() => {
+                    // the native side releases the connection if it arrives later
+                    this.pending_acquires.delete(acquire_id);
+                    crt_native.http_connection_manager_abandon_acquire(this.native_handle(), acquire_id);
+                    reject(new CrtError(`Timed out acquiring a connection after ${timeout_ms}ms`));
+                }, timeout_ms);
+            }
+            this.pending_acquires.set(acquire_id, pending);
         });
     }
 
+    private _on_acquired(acquire_id: number, handle: any, error_code: number) {
+        const pending = this.pending_acquires.get(acquire_id);
+        if (!pending) {
+            // timed out in JS just before the native deadline passed, nobody is waiting for it
+            if (handle) {
+                crt_native.http_connection_manager_release(this.native_handle(), handle);
+            }
+            return;
+        }
+        this.pending_acquires.delete(acquire_id);
+        if (pending.timer) {
+            clearTimeout(pending.timer);
+        }
+
+        if (error_code) {
+            pending.reject(new CrtError(error_code));
+            return;
+        }
+        if (!handle) {
+            pending.reject(new CrtError('Timed out acquiring a connection'));
+            return;
+        }
+
+        // Only create 1 connection in JS/TS from each native connection
+        let connection = this.connections.get(handle);
+        if (!connection) {
+            connection = new HttpClientConnection(
+                this.bootstrap,
+                this.host,
+                this.port,
+                this.socket_options,
+                this.tls_opts,
+                this.proxy_options,
+                handle,
+                this.manual_window_management
+            );
+            this.connections.set(handle, connection as HttpClientConnection);
+            connection.on('close', () => {
+                this.connections.delete(handle);
+            })
+        }
+        pending.resolve(connection);
+    }
+
     /**
      * Returns an unused connection to the pool
      * @param connection - The connection to return
@@ -546,8 +800,120 @@ export class HttpClientConnectionManager extends NativeResource {
         crt_native.http_connection_manager_release(this.native_handle(), connection.native_handle());
     }
 
+    /**
+     * Returns the current state of the pool and how long acquires have been waiting. A high p99 wait alongside
+     * pending acquisitions means max_connections is too low; a high wait with connections available points elsewhere.
+     */
+    get_stats(): HttpConnectionManagerStats {
+        return crt_native.http_connection_manager_get_stats(this.native_handle());
+    }
+
     /** Closes all connections and rejects all pending requests */
     close() {
         crt_native.http_connection_manager_close(this.native_handle());
     }
 }
+
+/**
+ * Configuration for an {@link Http2StreamManager}
+ *
+ * @category HTTP
+ */
+export interface Http2StreamManagerOptions {
+    /** Client bootstrap to use when initiating socket connections. Leave undefined to use the default. */
+    bootstrap?: ClientBootstrap;
+    /** Host to connect to */
+    host: string;
+    /** Port to connect to on host */
+    port: number;
+    /** Maximum number of connections to open */
+    max_connections: number;
+    /** Initial flow-control window of each stream, defaults to 65535, the HTTP/2 default */
+    initial_window_size?: number;
+    /** Socket options to use when initiating socket connections */
+    socket_options: SocketOptions;
+    /**
+     * TLS connection options. Connections must negotiate h2 with ALPN, which is requested automatically unless
+     * these options already carry an ALPN list. Required unless http2_prior_knowledge is set.
+     */
+    tls_opts?: TlsConnectionOptions;
+    /** Optional proxy options */
+    proxy_options?: HttpProxyOptions;
+    /** Set true to speak HTTP/2 over cleartext connections without negotiating it, default is false */
+    http2_prior_knowledge?: boolean;
+    /**
+     * Streams a connection should carry before another connection is opened, up to max_connections.
+     * Default is to fill each connection to max_concurrent_streams_per_connection first.
+     */
+    ideal_concurrent_streams_per_connection?: number;
+    /** Most streams opened on one connection, also capped by what the server allows. Default is no extra limit. */
+    max_concurrent_streams_per_connection?: number;
+    /** Set true to enable flow control of response bodies, see {@link HttpClientConnectionManager} */
+    manual_window_management?: boolean;
+    /** Number of idle response body buffers to keep for reuse, see {@link HttpClientConnectionManager} */
+    body_buffer_pool_size?: number;
+}
+
+/**
+ * Multiplexes many {@link HttpClientStream}s over a few HTTP/2 connections to a given host/port endpoint.
+ * Connections are opened as needed, up to max_connections, so concurrent requests share TCP and TLS
+ * handshakes rather than each needing a connection of their own.
+ *
+ * @category HTTP
+ */
+export class Http2StreamManager extends NativeResource {
+    private readonly manual_window_management: boolean;
+
+    constructor(readonly options: Http2StreamManagerOptions) {
+        if (options.tls_opts && !is_alpn_available()) {
+            throw new Error("HTTP/2 over TLS needs ALPN, which is not available on this platform");
+        }
+        super(crt_native.http2_stream_manager_new(
+            options.bootstrap != null ? options.bootstrap.native_handle() : null,
+            options.host,
+            options.port,
+            options.max_connections,
+            options.initial_window_size ?? 65535,
+            options.socket_options.native_handle(),
+            options.tls_opts ? options.tls_opts.native_handle() : undefined,
+            options.proxy_options ? options.proxy_options.create_native_handle() : undefined,
+            undefined /* on_shutdown */,
+            options.manual_window_management,
+            options.body_buffer_pool_size,
+            options.ideal_concurrent_streams_per_connection,
+            options.max_concurrent_streams_per_connection,
+            options.http2_prior_knowledge,
+        ));
+        this.manual_window_management = options.manual_window_management ?? false;
+    }
+
+    /**
+     * Create {@link HttpClientStream} to carry out the request/response exchange. Requests made for HTTP/1.1 are
+     * translated to HTTP/2, using the Host header as the authority.
+     *
+     * NOTE: The stream does nothing until {@link HttpStream.activate} is called, at which point it waits for
+     * capacity on one of the manager's connections. Failing to get one is reported as a stream 'error'.
+     *
+     * @param request - The HttpRequest to send
+     * @param options - Optional settings for the stream
+     * @returns A new stream that will deliver events for the request
+     */
+    request(request: HttpRequest, options?: HttpStreamOptions) {
+        return new_client_stream(request, undefined, this.manual_window_management, options,
+            (on_complete, on_response, on_body) => crt_native.http_stream_new_from_manager(
+                this.native_handle(),
+                request,
+                on_complete,
+                on_response,
+                on_body,
+                options?.body_destination,
+                options?.body_checksum,
+                this.manual_window_management
+            ));
+    }
+
+    /** Stops opening streams, connections close once every stream in flight has completed */
+    close() {
+        crt_native.http2_stream_manager_close(this.native_handle());
+    }
+}
@@ -4,7 +4,15 @@
  */
 
 import * as io from './io';
+import crt_native from './binding';
 import { CrtError } from './error';
+import { crc32c } from './checksums';
+import { hash_sha256 } from './crypto';
+import { HttpHeaders, HttpRequest } from './http';
+import { PassThrough } from 'stream';
+import { closeSync, mkdtempSync, openSync, readFileSync, unlinkSync, writeFileSync, writeSync } from 'fs';
+import { tmpdir } from 'os';
+import { join } from 'path';
 
 test('Error Resolve', () => {
     const err = new CrtError(0);
@@ -16,3 +24,133 @@ test('Error Resolve', () => {
 test('ALPN availability', () => {
     expect(io.is_alpn_available()).toBeDefined();
 });
+
+test('ClientBootstrap with its own EventLoopGroup', () => {
+    const elg = new io.EventLoopGroup(2);
+    const bootstrap = new io.ClientBootstrap(elg);
+    expect(bootstrap.native_handle()).toBeDefined();
+});
+
+test('ClientBootstrap pre-resolves hosts and counts cache hits', async () => {
+    const bootstrap = new io.ClientBootstrap(undefined, { max_entries: 8, max_ttl_secs: 60 });
+    const [resolution] = await io.pre_resolve_hosts(['example.com'], bootstrap);
+    expect(resolution.host_name).toBe('example.com');
+    expect(resolution.error_code).toBe(0);
+    expect(resolution.addresses.length).toBeGreaterThan(0);
+
+    await io.pre_resolve_hosts(['example.com'], bootstrap);
+    const stats = io.get_host_resolver_stats(bootstrap);
+    expect(stats.cache_misses).toBe(1);
+    expect(stats.cache_hits).toBe(1);
+    expect(stats.dns_queries).toBeGreaterThanOrEqual(1);
+});
+
+test('TlsContexts with share_context reuse one native context', () => {
+    const options = new io.TlsContextOptions();
+    options.alpn_list = ['h2'];
+    options.share_context = true;
+
+    const before = io.get_tls_context_cache_stats();
+    const first = new io.ClientTlsContext(options);
+    const second = new io.ClientTlsContext(options);
+    const after = io.get_tls_context_cache_stats();
+
+    expect(second.native_handle()).toBeDefined();
+    expect(after.hits - before.hits).toBe(1);
+    expect(after.misses - before.misses).toBe(1);
+    expect(after.entries).toBeGreaterThanOrEqual(1);
+    expect(first.native_handle()).toBeDefined();
+});
+
+test('InputStream pauses its source above the high water mark', () => {
+    const source = new PassThrough();
+    const stream = new io.InputStream(source, 8);
+    expect(stream.high_water_mark).toBe(8);
+    source.write(Buffer.alloc(16));
+    expect(source.isPaused()).toBe(true);
+});
+
+test('InputStream of known length sets Content-Length', () => {
+    const body = new io.InputStream(new PassThrough(), undefined, 42);
+    const request = new HttpRequest('PUT', '/', new HttpHeaders(), body);
+    expect(request.headers.get('content-length')).toBe('42');
+});
+
+test('FileInputStream reads a range of a file', () => {
+    const path = join(mkdtempSync(join(tmpdir(), 'crt-')), 'body');
+    writeFileSync(path, Buffer.alloc(100));
+    try {
+        expect(new io.FileInputStream(path).length).toBe(100);
+        const part = new io.FileInputStream(path, 40, 10);
+        expect(part.length).toBe(10);
+        const request = new HttpRequest('PUT', '/', new HttpHeaders(), part);
+        expect(request.headers.get('content-length')).toBe('10');
+        expect(() => new io.FileInputStream(path, 95, 10)).toThrow();
+        expect(() => new io.FileInputStream(join(path, 'missing'))).toThrow();
+    } finally {
+        unlinkSync(path);
+    }
+});
+
+test('FileInputStream checksums what is read since it was last rewound', () => {
+    const path = join(mkdtempSync(join(tmpdir(), 'crt-')), 'body');
+    const contents = Buffer.from(Array.from({ length: 100 }, (_, i) => i));
+    writeFileSync(path, contents);
+    try {
+        const part = new io.FileInputStream(path, 40, 10, 'crc32c');
+        const handle = part.native_handle();
+        expect(crt_native.io_input_stream_read(handle, 4)).toEqual(contents.subarray(40, 44));
+        // only available once every byte has been read
+        expect(() => part.checksum()).toThrow();
+        expect(crt_native.io_input_stream_read(handle, 64)).toEqual(contents.subarray(44, 50));
+        expect(part.checksum()).toBe(crc32c(contents.subarray(40, 50)));
+        expect(part.checksum()).toBe(crc32c(contents.subarray(40, 50)));
+
+        // a retry rewinds the stream, and the checksum starts over
+        crt_native.io_input_stream_seek(handle, 2);
+        expect(crt_native.io_input_stream_read(handle, 64)).toEqual(contents.subarray(42, 50));
+        expect(part.checksum()).toBe(crc32c(contents.subarray(42, 50)));
+    } finally {
+        unlinkSync(path);
+    }
+});
+
+test('InputStream checksums what is read since it was last rewound', async () => {
+    const contents = Buffer.from('the quick brown fox jumps over the lazy dog');
+    const source = new PassThrough();
+    const stream = new io.InputStream(source, 0, contents.length, 'sha256');
+    const handle = stream.native_handle();
+    source.end(contents);
+    await new Promise((resolve) => source.on('end', resolve));
+
+    const sha256 = (data: Buffer) => Buffer.from(hash_sha256(data).buffer);
+    const checksum = () => Buffer.from((stream.checksum() as DataView).buffer);
+
+    expect(crt_native.io_input_stream_read(handle, 4)).toEqual(contents.subarray(0, 4));
+    expect(() => stream.checksum()).toThrow();
+    // buffered bytes can still be skipped, the checksum covers only what is read after the seek
+    crt_native.io_input_stream_seek(handle, 10);
+    expect(crt_native.io_input_stream_read(handle, 1024)).toEqual(contents.subarray(10));
+    expect(checksum()).toEqual(sha256(contents.subarray(10)));
+    expect(checksum()).toEqual(sha256(contents.subarray(10)));
+});
+
+test('enable_logging rejects invalid destinations', () => {
+    expect(() => io.enable_logging(io.LogLevel.NONE, {} as any)).toThrow();
+    expect(() => io.enable_logging(io.LogLevel.NONE, -1)).toThrow();
+});
+
+test('enable_logging leaves the caller\'s file descriptor open', () => {
+    const path = join(mkdtempSync(join(tmpdir(), 'crt-')), 'log');
+    const fd = openSync(path, 'a');
+    try {
+        io.enable_logging(io.LogLevel.NONE, fd);
+        // disabling logging closes the native destination, which must not take the caller's fd with it
+        io.enable_logging(io.LogLevel.NONE);
+        writeSync(fd, 'still open');
+    } finally {
+        closeSync(fd);
+    }
+    expect(readFileSync(path, 'utf8')).toEqual('still open');
+    unlinkSync(path);
+});
@@ -69,12 +69,18 @@ export enum LogLevel {
 /**
  * Enables logging of the native AWS CRT libraries.
  * @param level - The logging level to filter to. It is not possible to log less than WARN.
+ * @param destination - Optional file path to append to, or open file descriptor, to write logs to natively.
+ *          By default logs are written via `process._rawDebug()` on the node thread. A native destination is
+ *          written to directly from whichever thread logs, which keeps high volume (DEBUG/TRACE) logging off the
+ *          node thread. A later call with a destination replaces (and closes) the previous one, and
+ *          disabling logging with {@link LogLevel.NONE} and no destination closes it. A file descriptor is duplicated,
+ *          so the caller remains responsible for closing the one passed in.
  *
  * nodejs only.
  * @category Logging
  */
-export function enable_logging(level: LogLevel) {
-    crt_native.io_logging_enable(level);
+export function enable_logging(level: LogLevel, destination?: string | number) {
+    crt_native.io_logging_enable(level, destination);
 }
 
 /**
@@ -88,24 +94,228 @@ export function is_alpn_available(): boolean {
     return crt_native.is_alpn_available();
 }
 
+/**
+ * Configures the event loop group shared by every {@link ClientBootstrap} created without an explicit
+ * {@link EventLoopGroup}, and by all connections that leave their bootstrap undefined.
+ *
+ * Must be called before any client bootstrap, connection, or credentials provider is created, otherwise
+ * an error is thrown. By default, the shared event loop group has a single thread.
+ *
+ * @param num_threads - Number of event loop threads to use. 0 means one thread per processor.
+ * @param cpu_group - Optional cpu group (NUMA node) to pin the event loop threads to.
+ *
+ * nodejs only.
+ * @category IO
+ */
+export function set_default_event_loop_group_options(num_threads: number, cpu_group?: number) {
+    crt_native.io_set_default_event_loop_group_options(num_threads, cpu_group);
+}
+
+/**
+ * A collection of event loop threads that drive network IO (TLS, socket reads and writes, protocol decoding).
+ * Most applications can rely on the default event loop group (see {@link set_default_event_loop_group_options}),
+ * use this to give a {@link ClientBootstrap} its own threads.
+ *
+ * nodejs only.
+ * @category IO
+ */
+export class EventLoopGroup extends NativeResource {
+    /**
+     * @param num_threads - Number of event loop threads to use. 0 (the default) means one thread per processor.
+     * @param cpu_group - Optional cpu group (NUMA node) to pin the event loop threads to.
+     */
+    constructor(num_threads: number = 0, cpu_group?: number) {
+        super(crt_native.io_event_loop_group_new(num_threads, cpu_group));
+    }
+}
+
+/**
+ * Checksum that can be computed over a body in the same pass as it streams
+ *
+ * nodejs only.
+ * @category IO
+ */
+export type StreamChecksumAlgorithm = 'crc32c' | 'sha256';
+
+/**
+ * Value of a {@link StreamChecksumAlgorithm} checksum: a number for CRC32C, the digest for SHA256
+ *
+ * nodejs only.
+ * @category IO
+ */
+export type StreamChecksum = number | DataView;
+
 /**
  * Wraps a ```Readable``` for reading by native code, used to stream
  *  data into the AWS CRT libraries.
  *
+ * Chunks read from the source are handed to native code without being copied, so the source must not reuse the
+ * Buffers it emits. Once more than `high_water_mark` bytes are waiting to be read, the source is paused until native
+ * code catches up.
+ *
  * nodejs only.
  * @category IO
  */
 export class InputStream extends NativeResource {
-    constructor(private source: Readable) {
-        super(crt_native.io_input_stream_new(16 * 1024));
+    /** Default number of bytes buffered natively before the source is paused */
+    static readonly DEFAULT_HIGH_WATER_MARK = 1024 * 1024;
+
+    /**
+     * @param source - Stream to read the data from
+     * @param high_water_mark - Number of bytes that may be waiting to be read before the source is paused,
+     *          0 for no limit
+     * @param length - Total number of bytes the source will produce, if known up front. Requests with a body of known
+     *          length are sent with a Content-Length header rather than needing chunked encoding.
+     * @param checksum_algorithm - Checksum to compute over the bytes as they are sent, see {@link checksum}
+     */
+    constructor(
+        private source: Readable,
+        readonly high_water_mark: number = InputStream.DEFAULT_HIGH_WATER_MARK,
+        readonly length?: number,
+        readonly checksum_algorithm?: StreamChecksumAlgorithm) {
+        super(crt_native.io_input_stream_new(high_water_mark, length, () => {
+            source.resume();
+        }, checksum_algorithm));
         this.source.on('data', (data) => {
             data = Buffer.isBuffer(data) ? data : new Buffer(data.toString(), 'utf8');
-            crt_native.io_input_stream_append(this.native_handle(), data);
+            if (!crt_native.io_input_stream_append(this.native_handle(), data)) {
+                this.source.pause();
+            }
         });
         this.source.on('end', () => {
             crt_native.io_input_stream_append(this.native_handle(), undefined);
         })
     }
+
+    /**
+     * Checksum of the bytes sent, if a checksum_algorithm was given. Read it once the request has completed, it throws
+     * if the stream hasn't been read to the end. Should the request have been retried, it covers only what was sent
+     * after the stream was last rewound.
+     */
+    checksum(): StreamChecksum | undefined {
+        return crt_native.io_input_stream_get_checksum(this.native_handle());
+    }
+}
+
+/**
+ * Request body read natively from a file, or a range of one. The bytes go straight from the file to the connection
+ * without passing through the JS heap, and the stream can be rewound should the request need to be retried.
+ *
+ * nodejs only.
+ * @category IO
+ */
+export class FileInputStream extends NativeResource {
+    /** Number of bytes the stream will produce */
+    readonly length: number;
+
+    /**
+     * @param path - Path of the file to read
+     * @param offset - Position in the file to start reading from, default 0
+     * @param length - Number of bytes to read, default the remainder of the file after offset. Useful along with
+     *          offset to send one part of a multipart upload.
+     * @param checksum_algorithm - Checksum to compute over the bytes as they are sent, see {@link checksum}
+     */
+    constructor(
+        readonly path: string,
+        readonly offset: number = 0,
+        length?: number,
+        readonly checksum_algorithm?: StreamChecksumAlgorithm) {
+        super(crt_native.io_file_input_stream_new(path, offset, length, checksum_algorithm));
+        this.length = crt_native.io_input_stream_get_length(this.native_handle()) as number;
+    }
+
+    /**
+     * Checksum of the bytes sent, if a checksum_algorithm was given. Read it once the request has completed, it throws
+     * if the stream hasn't been read to the end. Should the request have been retried, it covers only what was sent
+     * after the stream was last rewound.
+     */
+    checksum(): StreamChecksum | undefined {
+        return crt_native.io_input_stream_get_checksum(this.native_handle());
+    }
+}
+
+/**
+ * Caching behaviour of a host resolver
+ *
+ * nodejs only.
+ * @category IO
+ */
+export interface HostResolverOptions {
+    /** Number of hosts whose addresses are cached, default 64 */
+    max_entries?: number;
+    /** Seconds a resolved address is used for before it must be resolved again, default 30 */
+    max_ttl_secs?: number;
+}
+
+/**
+ * Counters of a host resolver, since it was created
+ *
+ * nodejs only.
+ * @category IO
+ */
+export interface HostResolverStats {
+    /** Resolves, usually for new connections, answered from the cache */
+    cache_hits: number;
+    /** Resolves that had to wait on a DNS query */
+    cache_misses: number;
+    /** DNS queries made, including the background refreshes of cached hosts */
+    dns_queries: number;
+    dns_failures: number;
+}
+
+/**
+ * Outcome of resolving one host with {@link pre_resolve_hosts}
+ *
+ * nodejs only.
+ * @category IO
+ */
+export interface HostResolution {
+    host_name: string;
+    /** Every address cached for the host, IPv4 and IPv6 */
+    addresses: string[];
+    /** 0 if the host resolved */
+    error_code: number;
+}
+
+/**
+ * Configures the host resolver of the default client bootstrap, used wherever a bootstrap is left undefined.
+ * Must be called before anything uses it, otherwise an error is thrown.
+ *
+ * nodejs only.
+ * @category IO
+ */
+export function set_default_host_resolver_options(options: HostResolverOptions) {
+    crt_native.io_set_default_host_resolver_options(options.max_entries, options.max_ttl_secs);
+}
+
+/**
+ * Resolves hosts ahead of connecting to them, so that connections made within the TTL don't wait on DNS.
+ * A host that fails to resolve doesn't fail the others, check each result's error_code.
+ *
+ * @param host_names - Hosts to resolve
+ * @param bootstrap - Bootstrap whose resolver should cache the addresses. Leave undefined for the default
+ *          bootstrap.
+ * @returns A promise resolving to the addresses of each host, in the same order as host_names
+ *
+ * nodejs only.
+ * @category IO
+ */
+export function pre_resolve_hosts(host_names: string[], bootstrap?: ClientBootstrap): Promise<HostResolution[]> {
+    return new Promise((resolve) => {
+        crt_native.io_host_resolver_pre_resolve(bootstrap?.native_handle(), host_names, resolve);
+    });
+}
+
+/**
+ * Returns the cache hit and miss counts of a bootstrap's host resolver.
+ *
+ * @param bootstrap - Leave undefined for the default bootstrap
+ *
+ * nodejs only.
+ * @category IO
+ */
+export function get_host_resolver_stats(bootstrap?: ClientBootstrap): HostResolverStats {
+    return crt_native.io_host_resolver_get_stats(bootstrap?.native_handle());
 }
 
 /**
@@ -117,8 +327,17 @@ export class InputStream extends NativeResource {
  * @category IO
  */
 export class ClientBootstrap extends NativeResource {
-    constructor() {
-        super(crt_native.io_client_bootstrap_new());
+    /**
+     * @param event_loop_group - Optional event loop group to use. Leave undefined to use the default
+     *          event loop group.
+     * @param host_resolver_options - Optional caching behaviour of this bootstrap's host resolver
+     */
+    constructor(event_loop_group?: EventLoopGroup, host_resolver_options?: HostResolverOptions) {
+        super(crt_native.io_client_bootstrap_new(
+            event_loop_group ? event_loop_group.native_handle() : undefined,
+            host_resolver_options?.max_entries,
+            host_resolver_options?.max_ttl_secs,
+        ));
     }
 }
 
@@ -187,6 +406,14 @@ export class TlsContextOptions {
      * set this to true.
      */
     public verify_peer: boolean = true;
+    /**
+     * Share the native context with every other TlsContext created from identical options while any of them is
+     * alive, rather than building a new one. Worthwhile when contexts are created per connection or per reconnect,
+     * as building one loads the trust store and parses the certificate and key. Contexts read files when they are
+     * built, so a shared context won't see changes to files on disk until every TlsContext using it is collected.
+     * See {@link get_tls_context_cache_stats}.
+     */
+    public share_context: boolean = false;
 
     /**
      * Overrides the default system trust store.
@@ -307,10 +534,36 @@ export abstract class TlsContext extends NativeResource {
             ctx_opt.private_key,
             ctx_opt.pkcs12_filepath,
             ctx_opt.pkcs12_password,
-            ctx_opt.verify_peer));
+            ctx_opt.verify_peer,
+            ctx_opt.share_context));
     }
 }
 
+/**
+ * Counters of the TLS contexts shared by {@link TlsContextOptions.share_context}
+ *
+ * nodejs only.
+ * @category TLS
+ */
+export interface TlsContextCacheStats {
+    /** TlsContexts that reused an existing native context */
+    hits: number;
+    /** TlsContexts that had to build a new one */
+    misses: number;
+    /** Native contexts currently shared */
+    entries: number;
+}
+
+/**
+ * Returns how often TlsContexts created with share_context found a context to reuse.
+ *
+ * nodejs only.
+ * @category TLS
+ */
+export function get_tls_context_cache_stats(): TlsContextCacheStats {
+    return crt_native.io_tls_ctx_cache_get_stats();
+}
+
 /**
  * TLS context used for client TLS communications over sockets. If no
  * options are supplied, the context will default to enabling peer verification
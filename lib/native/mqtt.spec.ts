@@ -3,8 +3,8 @@
  * SPDX-License-Identifier: Apache-2.0.
  */
 
-import { ClientBootstrap, TlsContextOptions } from '@awscrt/io';
-import { MqttClient } from '@awscrt/mqtt';
+import { ClientBootstrap, SocketOptions, TlsContextOptions } from '@awscrt/io';
+import { MqttClient, MqttMessageWorker, MqttWorkerDistribution, QoS } from '@awscrt/mqtt';
 import { AwsIotMqttConnectionConfigBuilder, WebsocketConfig } from '@awscrt/aws_iot';
 import { AwsCredentialsProvider } from '@awscrt/auth';
 import { Config, fetch_credentials } from '@test/credentials';
@@ -83,3 +83,108 @@ test('MQTT Native Websocket Connect/Disconnect with TLS Context Options', async
         ),
     }, new MqttClient(new ClientBootstrap()));
 });
+
+test('MQTT Native Publish Batch', async () => {
+    const aws_opts: Config = await fetch_credentials();
+
+    const config = AwsIotMqttConnectionConfigBuilder.new_mtls_builder(aws_opts.certificate, aws_opts.private_key)
+        .with_clean_session(true)
+        .with_client_id(`node-mqtt-unit-test-${uuid()}`)
+        .with_endpoint(aws_opts.endpoint)
+        .with_ping_timeout_ms(5000)
+        .build()
+    const connection = new MqttClient(new ClientBootstrap()).new_connection(config);
+    await connection.connect();
+
+    const test_topic = `/test/me/senpai/${uuid()}`;
+    const num_messages = 32;
+    let received = 0;
+    let on_all_received: (value: boolean) => void;
+    const all_received = new Promise((resolve) => { on_all_received = resolve; });
+    await connection.subscribe(test_topic, QoS.AtLeastOnce, () => {
+        if (++received == num_messages) {
+            on_all_received(true);
+        }
+    });
+
+    const messages = Array.from({ length: num_messages }, (_, i) => ({
+        topic: test_topic,
+        payload: i % 2 ? `message ${i}` : Buffer.alloc(1024, i),
+        qos: QoS.AtLeastOnce,
+    }));
+    const results = await connection.publish_batch(messages);
+    expect(results.length).toBe(num_messages);
+    for (const result of results) {
+        expect(result.error_code).toBe(0);
+        expect(result.packet_id).toBeTruthy();
+    }
+    await expect(all_received).resolves.toBeTruthy();
+
+    expect(await connection.publish_batch([])).toEqual([]);
+    await connection.disconnect();
+});
+
+test('MQTT Native Topic Handlers', async () => {
+    const aws_opts: Config = await fetch_credentials();
+
+    const config = AwsIotMqttConnectionConfigBuilder.new_mtls_builder(aws_opts.certificate, aws_opts.private_key)
+        .with_clean_session(true)
+        .with_client_id(`node-mqtt-unit-test-${uuid()}`)
+        .with_endpoint(aws_opts.endpoint)
+        .with_ping_timeout_ms(5000)
+        .build()
+    const connection = new MqttClient(new ClientBootstrap()).new_connection(config);
+    expect(() => connection.add_topic_handler('bad/#/filter', () => {})).toThrow();
+    await connection.connect();
+
+    const base_topic = `test/me/senpai/${uuid()}`;
+    const temperatures: string[] = [];
+    const fleet: string[] = [];
+    let on_marker: (value: boolean) => void = () => {};
+    const next_marker = () => new Promise((resolve) => { on_marker = resolve; });
+
+    const temperature_handler = connection.add_topic_handler(`${base_topic}/+/temperature`, (topic) => { temperatures.push(topic); });
+    connection.add_topic_handler(`${base_topic}/a/#`, (topic) => { fleet.push(topic); });
+    connection.add_topic_handler(`${base_topic}/marker`, () => { on_marker(true); });
+    await connection.subscribe(`${base_topic}/#`, QoS.AtLeastOnce);
+
+    let marker = next_marker();
+    await connection.publish(`${base_topic}/a/temperature`, 'a', QoS.AtLeastOnce);
+    await connection.publish(`${base_topic}/b/temperature`, 'b', QoS.AtLeastOnce);
+    await connection.publish(`${base_topic}/b/humidity`, 'b', QoS.AtLeastOnce);
+    await connection.publish(`${base_topic}/a`, 'a', QoS.AtLeastOnce);
+    await connection.publish(`${base_topic}/marker`, '', QoS.AtLeastOnce);
+    await expect(marker).resolves.toBeTruthy();
+
+    expect(temperatures.sort()).toEqual([`${base_topic}/a/temperature`, `${base_topic}/b/temperature`]);
+    expect(fleet.sort()).toEqual([`${base_topic}/a`, `${base_topic}/a/temperature`]);
+
+    connection.remove_topic_handler(`${base_topic}/+/temperature`, temperature_handler);
+    marker = next_marker();
+    await connection.publish(`${base_topic}/c/temperature`, 'c', QoS.AtLeastOnce);
+    await connection.publish(`${base_topic}/marker`, '', QoS.AtLeastOnce);
+    await expect(marker).resolves.toBeTruthy();
+    expect(temperatures.length).toBe(2);
+
+    await connection.disconnect();
+});
+
+test('MQTT Native Message Workers', () => {
+    const connection = new MqttClient().new_connection({
+        client_id: `node-mqtt-unit-test-${uuid()}`,
+        host_name: 'localhost',
+        port: 1883,
+        socket_options: new SocketOptions(),
+    });
+
+    const id = connection.share_with_workers(MqttWorkerDistribution.TopicHash);
+    expect(connection.share_with_workers(MqttWorkerDistribution.TopicHash)).toBe(id);
+    expect(() => connection.share_with_workers(MqttWorkerDistribution.RoundRobin)).toThrow();
+
+    /* workers are normally attached from worker_threads, but any env can attach */
+    const worker = new MqttMessageWorker(id, () => {});
+    worker.detach();
+    worker.detach();
+
+    expect(() => new MqttMessageWorker(id + 1000, () => {})).toThrow();
+});
@@ -30,6 +30,91 @@ import {
 } from "../common/mqtt";
 export { QoS, Payload, MqttRequest, MqttSubscribeRequest, MqttWill, OnMessageCallback } from "../common/mqtt";
 
+/**
+ * Unpacks a batch of incoming messages, delivered from native as flattened (topic, payload, dup, qos, retain)
+ * tuples, into individual calls to on_message. Every message in the batch is delivered even if a handler throws,
+ * the first error is rethrown afterwards.
+ *
+ * @internal
+ */
+function deliver_publish_batch(on_message: OnMessageCallback, batch: any[]) {
+    let error: any = undefined;
+    for (let i = 0; i < batch.length; i += 5) {
+        try {
+            on_message(batch[i], batch[i + 1], batch[i + 2], batch[i + 3], batch[i + 4]);
+        } catch (e) {
+            if (error === undefined) {
+                error = e;
+            }
+        }
+    }
+    if (error !== undefined) {
+        throw error;
+    }
+}
+
+/**
+ * Like {@link deliver_publish_batch}, for the connection-wide handler. Each tuple carries one more element, the ids
+ * of the topic handlers the message matched in native, or null.
+ *
+ * @internal
+ */
+function deliver_any_publish_batch(
+    on_message: (topic: string, payload: ArrayBuffer, dup: boolean, qos: QoS, retain: boolean, handler_ids: number[] | null) => void,
+    batch: any[]) {
+    let error: any = undefined;
+    for (let i = 0; i < batch.length; i += 6) {
+        try {
+            on_message(batch[i], batch[i + 1], batch[i + 2], batch[i + 3], batch[i + 4], batch[i + 5]);
+        } catch (e) {
+            if (error === undefined) {
+                error = e;
+            }
+        }
+    }
+    if (error !== undefined) {
+        throw error;
+    }
+}
+
+/**
+ * A message published by {@link MqttClientConnection.publish_batch}
+ *
+ * @category MQTT
+ */
+export interface MqttPublishBatchMessage {
+    /** Topic name */
+    topic: string;
+    /** Contents of message, see {@link MqttClientConnection.publish} */
+    payload: Payload;
+    /** Quality of Service for delivering this message */
+    qos: QoS;
+    /** If true, the server will store the message and its QoS, defaults to false */
+    retain?: boolean;
+}
+
+/**
+ * Outcome of one message published by {@link MqttClientConnection.publish_batch}
+ *
+ * @category MQTT
+ */
+export interface MqttPublishBatchResult extends MqttRequest {
+    /** 0 if the message was published, otherwise the error that prevented it */
+    error_code: number;
+}
+
+/**
+ * How a connection shared by {@link MqttClientConnection.share_with_workers} picks the worker for each message
+ *
+ * @category MQTT
+ */
+export enum MqttWorkerDistribution {
+    /** Each message goes to the next worker in turn */
+    RoundRobin = 0,
+    /** Every message on a topic goes to the same worker, so messages on a topic are processed in order */
+    TopicHash = 1,
+}
+
 /**
  * MQTT client
  *
@@ -175,6 +260,9 @@ function normalize_payload(payload: Payload): StringLike {
  */
 export class MqttClientConnection extends NativeResourceMixin(BufferedEventEmitter) {
     readonly tls_ctx?: io.ClientTlsContext; // this reference keeps the tls_ctx alive beyond the life of the connection
+    private topic_handlers = new Map<number, OnMessageCallback>();
+    private next_topic_handler_id = 0;
+    private forwarding_all_messages = true;
 
     /**
      * @param client The client that owns this connection
@@ -205,7 +293,19 @@ export class MqttClientConnection extends NativeResourceMixin(BufferedEventEmitt
             config.websocket_handshake_transform,
         ));
         this.tls_ctx = config.tls_ctx;
-        crt_native.mqtt_client_connection_on_message(this.native_handle(), this._on_any_publish.bind(this));
+        crt_native.mqtt_client_connection_on_message(this.native_handle(), deliver_any_publish_batch.bind(undefined, this._on_any_publish.bind(this)));
+
+        /* While there are topic handlers, messages only need to reach node for everything else if someone's listening */
+        this.addListener('newListener', (event: string | symbol) => {
+            if (event == 'message') {
+                this._set_forwarding_all_messages(true);
+            }
+        });
+        this.addListener('removeListener', (event: string | symbol) => {
+            if (event == 'message') {
+                this._update_message_forwarding();
+            }
+        });
 
         /*
          * Failed mqtt operations (which is normal) emit error events as well as rejecting the original promise.
@@ -345,7 +445,9 @@ export class MqttClientConnection extends NativeResourceMixin(BufferedEventEmitt
      * If the device is offline, the PUBLISH packet will be sent once the connection resumes.
      *
      * @param topic Topic name
-     * @param payload Contents of message
+     * @param payload Contents of message. Buffers, ArrayBuffers and other views are published
+     *                from their own memory, without being copied by the binding, and are kept alive
+     *                until the returned promise settles. Don't modify them before then.
      * @param qos Quality of Service for delivering this message
      * @param retain If true, the server will store the message and its QoS so that it can be
      *               delivered to future subscribers whose subscriptions match the topic name
@@ -367,6 +469,40 @@ export class MqttClientConnection extends NativeResourceMixin(BufferedEventEmitt
         });
     }
 
+    /**
+     * Publish many messages (async), with a single call into native code and a single completion.
+     *
+     * Each message is published as if by {@link publish}. The returned promise resolves once every
+     * message has completed, with one result per message, in the same order. A message that fails
+     * doesn't fail the batch, check the error_code of each result.
+     *
+     * @param messages Messages to publish
+     * @returns Promise which returns the {@link MqttPublishBatchResult} of each message
+     */
+    async publish_batch(messages: MqttPublishBatchMessage[]) {
+        return new Promise<MqttPublishBatchResult[]>((resolve, reject) => {
+            if (messages.length == 0) {
+                return resolve([]);
+            }
+
+            reject = this._reject(reject);
+            try {
+                const flattened: any[] = new Array(messages.length * 4);
+                messages.forEach((message, i) => {
+                    flattened[i * 4] = message.topic;
+                    flattened[i * 4 + 1] = normalize_payload(message.payload);
+                    flattened[i * 4 + 2] = message.qos;
+                    flattened[i * 4 + 3] = message.retain ?? false;
+                });
+                crt_native.mqtt_client_connection_publish_batch(this.native_handle(), flattened, (packet_ids, error_codes) => {
+                    resolve(packet_ids.map((packet_id, i) => ({ packet_id, error_code: error_codes[i] })));
+                });
+            } catch (e) {
+                reject(e);
+            }
+        });
+    }
+
     /**
      * Subscribe to a topic filter (async).
      * The client sends a SUBSCRIBE packet and the server responds with a SUBACK.
@@ -391,13 +527,61 @@ export class MqttClientConnection extends NativeResourceMixin(BufferedEventEmitt
             reject = this._reject(reject);
 
             try {
-                crt_native.mqtt_client_connection_subscribe(this.native_handle(), topic, qos, on_message, this._on_suback_callback.bind(this, resolve, reject));
+                crt_native.mqtt_client_connection_subscribe(this.native_handle(), topic, qos, on_message ? deliver_publish_batch.bind(undefined, on_message) : undefined, this._on_suback_callback.bind(this, resolve, reject));
             } catch (e) {
                 reject(e);
             }
         });
     }
 
+    /**
+     * Registers a handler for incoming messages whose topic matches a filter. This does not subscribe to anything:
+     * it routes messages from existing subscriptions, for example many handlers beneath a single subscription to `#`.
+     *
+     * Topics are matched against every handler's filter in native code. While any topic handler is registered and
+     * there are no 'message' listeners, messages that match no handler are dropped without being delivered to
+     * JavaScript at all.
+     *
+     * @param topic_filter Topic filter to match, which may include wildcards
+     * @param on_message Callback invoked for each matching message
+     * @returns An id for the handler, to pass to {@link MqttClientConnection.remove_topic_handler}
+     */
+    add_topic_handler(topic_filter: string, on_message: OnMessageCallback): number {
+        const handler_id = this.next_topic_handler_id++;
+        crt_native.mqtt_client_connection_add_topic_handler(this.native_handle(), topic_filter, handler_id);
+        this.topic_handlers.set(handler_id, on_message);
+        this._update_message_forwarding();
+        return handler_id;
+    }
+
+    /**
+     * Unregisters a handler added by {@link MqttClientConnection.add_topic_handler}
+     *
+     * @param topic_filter The filter the handler was registered with
+     * @param handler_id The id returned when the handler was registered
+     */
+    remove_topic_handler(topic_filter: string, handler_id: number) {
+        if (this.topic_handlers.delete(handler_id)) {
+            crt_native.mqtt_client_connection_remove_topic_handler(this.native_handle(), topic_filter, handler_id);
+            this._update_message_forwarding();
+        }
+    }
+
+    /**
+     * Shares this connection's incoming messages with {@link MqttMessageWorker}s in other threads, such as
+     * `worker_threads`, so that processing can be spread across cores over a single connection.
+     *
+     * Once any worker has attached, each message that would have been emitted as a 'message' event or routed to a
+     * topic handler is instead delivered to exactly one worker. Messages are handled here again if every worker
+     * detaches. Callbacks passed to {@link MqttClientConnection.subscribe} are unaffected.
+     *
+     * @param distribution How to pick the worker for each message. Subsequent calls must use the same distribution.
+     * @returns An id to pass to each worker, for example with `postMessage()`, to attach with
+     */
+    share_with_workers(distribution: MqttWorkerDistribution = MqttWorkerDistribution.RoundRobin): number {
+        return crt_native.mqtt_client_connection_share_with_workers(this.native_handle(), distribution);
+    }
+
     /**
      * Unsubscribe from a topic filter (async).
      * The client sends an UNSUBSCRIBE packet, and the server responds with an UNSUBACK.
@@ -456,8 +640,36 @@ export class MqttClientConnection extends NativeResourceMixin(BufferedEventEmitt
         this.emit('resume', return_code, session_present);
     }
 
-    private _on_any_publish(topic: string, payload: ArrayBuffer, dup: boolean, qos: QoS, retain: boolean) {
+    private _on_any_publish(topic: string, payload: ArrayBuffer, dup: boolean, qos: QoS, retain: boolean, handler_ids: number[] | null) {
         this.emit('message', topic, payload, dup, qos, retain);
+
+        if (handler_ids) {
+            // same as deliver_publish_batch: every handler gets the message even if one throws
+            let error: any = undefined;
+            for (const handler_id of handler_ids) {
+                try {
+                    this.topic_handlers.get(handler_id)?.(topic, payload, dup, qos, retain);
+                } catch (e) {
+                    if (error === undefined) {
+                        error = e;
+                    }
+                }
+            }
+            if (error !== undefined) {
+                throw error;
+            }
+        }
+    }
+
+    private _set_forwarding_all_messages(forward_all: boolean) {
+        if (forward_all != this.forwarding_all_messages) {
+            crt_native.mqtt_client_connection_forward_all_messages(this.native_handle(), forward_all);
+            this.forwarding_all_messages = forward_all;
+        }
+    }
+
+    private _update_message_forwarding() {
+        this._set_forwarding_all_messages(this.topic_handlers.size == 0 || this.listenerCount('message') > 0);
     }
 
     private _on_connect_callback(resolve : (value?: (boolean | PromiseLike<boolean> | undefined)) => void, reject : (reason?: any) => void, error_code: number, return_code: number, session_present: boolean) {
@@ -501,3 +713,25 @@ export class MqttClientConnection extends NativeResourceMixin(BufferedEventEmitt
         this.close();
     }
 }
+
+/**
+ * Receives a share of the messages arriving on a {@link MqttClientConnection} owned by another thread, see
+ * {@link MqttClientConnection.share_with_workers}. The worker keeps its thread alive until it is detached, or the
+ * connection is closed.
+ *
+ * @category MQTT
+ */
+export class MqttMessageWorker extends NativeResource {
+    /**
+     * @param id The id returned by {@link MqttClientConnection.share_with_workers}
+     * @param on_message Callback invoked for each message delivered to this worker
+     */
+    constructor(id: number, on_message: OnMessageCallback) {
+        super(crt_native.mqtt_message_worker_attach(id, deliver_publish_batch.bind(undefined, on_message)));
+    }
+
+    /** Stops delivery to this worker, messages are distributed between the remaining workers */
+    detach() {
+        crt_native.mqtt_message_worker_detach(this.native_handle());
+    }
+}
@@ -0,0 +1,151 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include "async_work.h"
+
+napi_status aws_napi_byte_buf_pin_from_napi(napi_env env, napi_value node_value, struct aws_byte_buf *buf, napi_ref *pin) {
+    AWS_ZERO_STRUCT(*buf);
+    *pin = NULL;
+    AWS_NAPI_CALL(env, aws_byte_buf_init_from_napi(buf, env, node_value), { return status; });
+
+    /* Anything without an allocator was referenced in place, keep its backing store alive until we're done with it */
+    if (!buf->allocator) {
+        AWS_NAPI_CALL(env, napi_create_reference(env, node_value, 1, pin), {
+            AWS_ZERO_STRUCT(*buf);
+            return status;
+        });
+    }
+
+    return napi_ok;
+}
+
+void aws_napi_byte_buf_unpin(napi_env env, struct aws_byte_buf *buf, napi_ref pin) {
+    if (pin) {
+        napi_delete_reference(env, pin);
+        AWS_ZERO_STRUCT(*buf);
+    } else {
+        aws_byte_buf_clean_up_secure(buf);
+    }
+}
+
+struct aws_napi_async_job *aws_napi_async_job_new(
+    struct aws_allocator *allocator,
+    const struct aws_napi_async_job_vtable *vtable,
+    void *impl) {
+
+    AWS_FATAL_ASSERT(vtable && vtable->execute && vtable->complete);
+
+    struct aws_napi_async_job *job = aws_mem_calloc(allocator, 1, sizeof(struct aws_napi_async_job));
+    AWS_FATAL_ASSERT(job);
+
+    job->allocator = allocator;
+    job->vtable = vtable;
+    job->impl = impl;
+    return job;
+}
+
+napi_status aws_napi_async_job_add_input(
+    napi_env env,
+    struct aws_napi_async_job *job,
+    napi_value node_input,
+    struct aws_byte_buf **input_buf) {
+
+    AWS_FATAL_ASSERT(job->num_inputs < AWS_NAPI_ASYNC_JOB_MAX_INPUTS);
+
+    struct aws_byte_buf *buf = &job->inputs[job->num_inputs];
+    napi_ref pin = NULL;
+    AWS_NAPI_CALL(env, aws_napi_byte_buf_pin_from_napi(env, node_input, buf, &pin), { return status; });
+
+    job->input_refs[job->num_inputs++] = pin;
+    *input_buf = buf;
+    return napi_ok;
+}
+
+static void s_async_job_execute(napi_env env, void *data) {
+    (void)env;
+    struct aws_napi_async_job *job = data;
+
+    if (job->vtable->execute(job)) {
+        job->error_code = aws_last_error();
+        AWS_FATAL_ASSERT(job->error_code != AWS_ERROR_SUCCESS);
+    }
+}
+
+static void s_async_job_complete(napi_env env, napi_status work_status, void *data) {
+    struct aws_napi_async_job *job = data;
+
+    if (work_status == napi_cancelled && !job->error_code) {
+        job->error_code = AWS_ERROR_INVALID_STATE;
+    }
+
+    napi_value node_args[2];
+    AWS_NAPI_ENSURE(env, napi_create_uint32(env, job->error_code, &node_args[0]));
+    AWS_NAPI_ENSURE(env, napi_get_undefined(env, &node_args[1]));
+    if (!job->error_code) {
+        bool completed = true;
+        AWS_NAPI_CALL(env, job->vtable->complete(env, job, &node_args[1]), { completed = false; });
+        if (!completed) {
+            AWS_NAPI_ENSURE(env, napi_create_uint32(env, AWS_ERROR_UNKNOWN, &node_args[0]));
+            AWS_NAPI_ENSURE(env, napi_get_undefined(env, &node_args[1]));
+        }
+    }
+
+    napi_value node_on_complete = NULL;
+    napi_value this_ptr = NULL;
+    AWS_NAPI_ENSURE(env, napi_get_reference_value(env, job->on_complete, &node_on_complete));
+    AWS_NAPI_ENSURE(env, napi_get_undefined(env, &this_ptr));
+    if (node_on_complete) {
+        /* an exception thrown from on_complete is left pending, node will report it as uncaught */
+        napi_call_function(env, this_ptr, node_on_complete, AWS_ARRAY_SIZE(node_args), node_args, NULL);
+    }
+
+    napi_delete_async_work(env, job->work);
+    job->work = NULL;
+    aws_napi_async_job_destroy(env, job);
+}
+
+napi_status aws_napi_async_job_queue(
+    napi_env env,
+    struct aws_napi_async_job *job,
+    const char *name,
+    napi_value node_on_complete) {
+
+    AWS_NAPI_CALL(env, napi_create_reference(env, node_on_complete, 1, &job->on_complete), { return status; });
+
+    napi_value resource_name = NULL;
+    AWS_NAPI_ENSURE(env, napi_create_string_utf8(env, name, NAPI_AUTO_LENGTH, &resource_name));
+
+    AWS_NAPI_CALL(
+        env,
+        napi_create_async_work(env, NULL, resource_name, s_async_job_execute, s_async_job_complete, job, &job->work),
+        { return status; });
+
+    AWS_NAPI_CALL(env, napi_queue_async_work(env, job->work), {
+        napi_delete_async_work(env, job->work);
+        job->work = NULL;
+        return status;
+    });
+
+    return napi_ok;
+}
+
+void aws_napi_async_job_destroy(napi_env env, struct aws_napi_async_job *job) {
+    if (!job) {
+        return;
+    }
+
+    if (job->vtable->destroy) {
+        job->vtable->destroy(job);
+    }
+
+    for (size_t i = 0; i < job->num_inputs; ++i) {
+        aws_napi_byte_buf_unpin(env, &job->inputs[i], job->input_refs[i]);
+    }
+
+    if (job->on_complete) {
+        napi_delete_reference(env, job->on_complete);
+    }
+
+    aws_mem_release(job->allocator, job);
+}
@@ -0,0 +1,78 @@
+#ifndef AWS_CRT_NODEJS_ASYNC_WORK_H
+#define AWS_CRT_NODEJS_ASYNC_WORK_H
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "module.h"
+
+/* Increment this as you find jobs that require more inputs */
+#define AWS_NAPI_ASYNC_JOB_MAX_INPUTS 2
+
+struct aws_napi_async_job;
+
+/**
+ * Gets the bytes of a string or buffer-like value for use off the node thread. Strings are copied, anything else is
+ * referenced in place and *pin is set to a reference keeping it alive. Release with aws_napi_byte_buf_unpin().
+ */
+napi_status aws_napi_byte_buf_pin_from_napi(napi_env env, napi_value node_value, struct aws_byte_buf *buf, napi_ref *pin);
+void aws_napi_byte_buf_unpin(napi_env env, struct aws_byte_buf *buf, napi_ref pin);
+
+struct aws_napi_async_job_vtable {
+    /* Runs on a libuv worker thread, must not touch napi. Returns AWS_OP_ERR with aws_last_error() set on failure */
+    int (*execute)(struct aws_napi_async_job *job);
+    /* Runs on the node thread after a successful execute, produces the value passed to on_complete */
+    napi_status (*complete)(napi_env env, struct aws_napi_async_job *job, napi_value *result);
+    /* Releases whatever impl owns, the job itself is released by the caller */
+    void (*destroy)(struct aws_napi_async_job *job);
+};
+
+/**
+ * A unit of work that runs off the node thread, on the libuv worker pool. Inputs are referenced rather than copied
+ * when they are Buffers/TypedArrays/DataViews, and stay pinned until the job completes. Once finished,
+ * on_complete(error_code, result) is invoked on the node thread.
+ */
+struct aws_napi_async_job {
+    struct aws_allocator *allocator;
+    const struct aws_napi_async_job_vtable *vtable;
+    void *impl;
+
+    napi_async_work work;
+    napi_ref on_complete;
+
+    struct aws_byte_buf inputs[AWS_NAPI_ASYNC_JOB_MAX_INPUTS];
+    napi_ref input_refs[AWS_NAPI_ASYNC_JOB_MAX_INPUTS];
+    size_t num_inputs;
+
+    int error_code;
+};
+
+struct aws_napi_async_job *aws_napi_async_job_new(
+    struct aws_allocator *allocator,
+    const struct aws_napi_async_job_vtable *vtable,
+    void *impl);
+
+/**
+ * Adds an input to the job and returns its bytes via input_buf, which stay valid until the job completes.
+ * Strings are copied, anything buffer-like is referenced in place: callers must not modify it until completion.
+ */
+napi_status aws_napi_async_job_add_input(
+    napi_env env,
+    struct aws_napi_async_job *job,
+    napi_value node_input,
+    struct aws_byte_buf **input_buf);
+
+/**
+ * Queues the job onto the worker pool. On success, ownership of the job passes to the pool. On failure the caller
+ * must destroy it with aws_napi_async_job_destroy().
+ */
+napi_status aws_napi_async_job_queue(
+    napi_env env,
+    struct aws_napi_async_job *job,
+    const char *name,
+    napi_value node_on_complete);
+
+void aws_napi_async_job_destroy(napi_env env, struct aws_napi_async_job *job);
+
+#endif /* AWS_CRT_NODEJS_ASYNC_WORK_H */
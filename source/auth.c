@@ -6,6 +6,7 @@
 #include "auth.h"
 
 #include "class_binder.h"
+#include "credentials_cache.h"
 #include "http_message.h"
 #include "io.h"
 
@@ -15,6 +16,7 @@
 #include <aws/auth/signing_config.h>
 #include <aws/auth/signing_result.h>
 
+#include <aws/common/atomics.h>
 #include <aws/common/condition_variable.h>
 #include <aws/common/mutex.h>
 
@@ -22,8 +24,16 @@ static struct aws_napi_class_info s_creds_provider_class_info;
 static aws_napi_method_fn s_creds_provider_constructor;
 static aws_napi_method_fn s_creds_provider_new_default;
 static aws_napi_method_fn s_creds_provider_new_static;
+static aws_napi_method_fn s_creds_provider_new_cached;
+
+static struct aws_napi_class_info s_signing_config_class_info;
+static aws_napi_method_fn s_signing_config_constructor;
+static aws_napi_property_get_fn s_signing_config_region_get;
+static aws_napi_property_get_fn s_signing_config_service_get;
 
 static aws_napi_method_fn s_aws_sign_request;
+static aws_napi_method_fn s_aws_sign_request_with_config;
+static aws_napi_method_fn s_aws_sign_requests;
 static aws_napi_method_fn s_aws_verify_sigv4a_signing;
 
 napi_status aws_napi_auth_bind(napi_env env, napi_value exports) {
@@ -49,6 +59,13 @@ napi_status aws_napi_auth_bind(napi_env env, napi_value exports) {
             .arg_types = {napi_string, napi_string, napi_string},
             .attributes = napi_static,
         },
+        {
+            .name = "newCached",
+            .method = s_creds_provider_new_cached,
+            .num_arguments = 3,
+            .arg_types = {napi_object, napi_number, napi_number},
+            .attributes = napi_static,
+        },
     };
 
     AWS_NAPI_CALL(
@@ -73,6 +90,60 @@ napi_status aws_napi_auth_bind(napi_env env, napi_value exports) {
 
     AWS_NAPI_CALL(env, aws_napi_define_function(env, exports, &s_signer_request_method), { return status; });
 
+    static const struct aws_napi_method_info s_signing_config_constructor_info = {
+        .name = "SigningConfig",
+        .method = s_signing_config_constructor,
+        .num_arguments = 1,
+        .arg_types = {napi_object},
+    };
+
+    static const struct aws_napi_property_info s_signing_config_properties[] = {
+        {
+            .name = "region",
+            .type = napi_string,
+            .getter = s_signing_config_region_get,
+            .attributes = napi_enumerable,
+        },
+        {
+            .name = "service",
+            .type = napi_string,
+            .getter = s_signing_config_service_get,
+            .attributes = napi_enumerable,
+        },
+    };
+
+    AWS_NAPI_CALL(
+        env,
+        aws_napi_define_class(
+            env,
+            exports,
+            &s_signing_config_constructor_info,
+            s_signing_config_properties,
+            AWS_ARRAY_SIZE(s_signing_config_properties),
+            NULL,
+            0,
+            &s_signing_config_class_info),
+        { return status; });
+
+    static struct aws_napi_method_info s_signer_request_with_config_method = {
+        .name = "aws_sign_request_with_config",
+        .method = s_aws_sign_request_with_config,
+        .num_arguments = 3,
+        .arg_types = {napi_object, napi_object, napi_function},
+    };
+
+    AWS_NAPI_CALL(
+        env, aws_napi_define_function(env, exports, &s_signer_request_with_config_method), { return status; });
+
+    static struct aws_napi_method_info s_signer_requests_method = {
+        .name = "aws_sign_requests",
+        .method = s_aws_sign_requests,
+        .num_arguments = 3,
+        .arg_types = {napi_object, napi_object, napi_function},
+    };
+
+    AWS_NAPI_CALL(env, aws_napi_define_function(env, exports, &s_signer_requests_method), { return status; });
+
     static struct aws_napi_method_info s_verify_sigv4a_signing_method = {
         .name = "aws_verify_sigv4a_signing",
         .method = s_aws_verify_sigv4a_signing,
@@ -187,14 +258,76 @@ static napi_value s_creds_provider_new_static(napi_env env, const struct aws_nap
     return node_this;
 }
 
+static napi_value s_creds_provider_new_cached(napi_env env, const struct aws_napi_callback_info *cb_info) {
+
+    AWS_FATAL_ASSERT(cb_info->num_args == 3);
+
+    struct aws_allocator *allocator = aws_napi_get_allocator();
+    const struct aws_napi_argument *arg = NULL;
+
+    struct aws_napi_credentials_cache_options options;
+    AWS_ZERO_STRUCT(options);
+
+    aws_napi_method_next_argument(napi_object, cb_info, &arg);
+    options.source = aws_napi_credentials_provider_unwrap(env, arg->node);
+    if (!options.source) {
+        napi_throw_type_error(env, NULL, "source must be an AwsCredentialsProvider");
+        return NULL;
+    }
+
+    aws_napi_method_next_argument(napi_number, cb_info, &arg);
+    const int64_t refresh_ahead_ms = arg->native.number;
+    aws_napi_method_next_argument(napi_number, cb_info, &arg);
+    const int64_t max_age_ms = arg->native.number;
+    if (refresh_ahead_ms < 0 || max_age_ms <= 0) {
+        aws_credentials_provider_release(options.source);
+        napi_throw_range_error(env, NULL, "Credentials cache refresh times must be positive");
+        return NULL;
+    }
+    options.refresh_ahead_ms = (uint64_t)refresh_ahead_ms;
+    options.max_age_ms = (uint64_t)max_age_ms;
+
+    struct aws_credentials_provider *provider = aws_napi_credentials_cache_new(allocator, &options);
+    /* The cache holds its own reference to the source */
+    aws_credentials_provider_release(options.source);
+    if (!provider) {
+        aws_napi_throw_last_error(env);
+        return NULL;
+    }
+
+    napi_value node_this = NULL;
+    AWS_NAPI_CALL(env, aws_napi_credentials_provider_wrap(env, provider, &node_this), {
+        napi_throw_error(env, NULL, "Failed to wrap CredentialsProvider");
+        return NULL;
+    });
+
+    /* Reference is now held by the node object */
+    aws_credentials_provider_release(provider);
+
+    return node_this;
+}
+
 /***********************************************************************************************************************
  * Signing
  **********************************************************************************************************************/
 
-struct signer_sign_request_state {
-    napi_ref node_request;
-    struct aws_http_message *request;
-    struct aws_signable *signable;
+/* Strings a signing config borrows while it's in use, short ones are kept in the inline storage */
+struct signing_config_strings {
+    struct aws_byte_buf region;
+    struct aws_byte_buf service;
+    struct aws_byte_buf signed_body_value;
+    uint8_t region_storage[AWS_NAPI_SMALL_STRING_SIZE];
+    uint8_t service_storage[AWS_NAPI_SMALL_STRING_SIZE];
+    uint8_t signed_body_value_storage[AWS_NAPI_SMALL_STRING_SIZE];
+};
+
+/*
+ * A signing config parsed from JS, and everything it borrows. Either owned by a single signing operation, or wrapped
+ * by a SigningConfig so that it is parsed once and reused for every request signed with it.
+ */
+struct signing_config_binding {
+    struct aws_signing_config_aws config;
+    struct signing_config_strings strings;
 
     /**
      * aws_string *
@@ -203,20 +336,33 @@ struct signer_sign_request_state {
      */
     struct aws_array_list header_blacklist;
 
+    /* If no date was configured, each signature is dated when it is made */
+    bool has_date;
+};
+
+struct signer_sign_request_state {
+    napi_ref node_request;
+    struct aws_http_message *request;
+    struct aws_signable *signable;
+
+    /* The SigningConfig being signed with, or NULL if the config was parsed for this request alone */
+    napi_ref node_config;
+    struct signing_config_binding *owned_config;
+
     napi_threadsafe_function on_complete;
 
     int error_code;
 };
 
 static bool s_should_sign_header(const struct aws_byte_cursor *name, void *userdata) {
-    struct signer_sign_request_state *state = userdata;
+    const struct signing_config_binding *binding = userdata;
 
     /* If there are params in the black_list, check them all */
-    if (state->header_blacklist.length) {
-        const size_t num_blacklisted = aws_array_list_length(&state->header_blacklist);
+    if (binding->header_blacklist.length) {
+        const size_t num_blacklisted = aws_array_list_length(&binding->header_blacklist);
         for (size_t i = 0; i < num_blacklisted; ++i) {
             struct aws_string *blacklisted = NULL;
-            aws_array_list_get_at(&state->header_blacklist, &blacklisted, i);
+            aws_array_list_get_at(&binding->header_blacklist, &blacklisted, i);
             AWS_ASSUME(blacklisted);
 
             if (aws_string_eq_byte_cursor_ignore_case(blacklisted, name)) {
@@ -228,6 +374,24 @@ static bool s_should_sign_header(const struct aws_byte_cursor *name, void *userd
     return true;
 }
 
+static void s_signing_config_binding_clean_up(struct signing_config_binding *binding) {
+    aws_credentials_provider_release(binding->config.credentials_provider);
+
+    aws_byte_buf_clean_up(&binding->strings.region);
+    aws_byte_buf_clean_up(&binding->strings.service);
+    aws_byte_buf_clean_up(&binding->strings.signed_body_value);
+
+    const size_t num_blacklisted = binding->header_blacklist.length;
+    for (size_t i = 0; i < num_blacklisted; ++i) {
+        struct aws_string *blacklisted = NULL;
+        aws_array_list_get_at(&binding->header_blacklist, &blacklisted, i);
+        aws_string_destroy(blacklisted);
+    }
+    aws_array_list_clean_up(&binding->header_blacklist);
+
+    AWS_ZERO_STRUCT(*binding);
+}
+
 static void s_destroy_signing_binding(
     napi_env env,
     struct aws_allocator *allocator,
@@ -238,14 +402,14 @@ static void s_destroy_signing_binding(
 
     /* Release references */
     napi_delete_reference(env, binding->node_request);
+    if (binding->node_config) {
+        napi_delete_reference(env, binding->node_config);
+    }
 
-    const size_t num_blacklisted = binding->header_blacklist.length;
-    for (size_t i = 0; i < num_blacklisted; ++i) {
-        struct aws_string *blacklisted = NULL;
-        aws_array_list_get_at(&binding->header_blacklist, &blacklisted, i);
-        aws_string_destroy(blacklisted);
+    if (binding->owned_config) {
+        s_signing_config_binding_clean_up(binding->owned_config);
+        aws_mem_release(allocator, binding->owned_config);
     }
-    aws_array_list_clean_up(&binding->header_blacklist);
 
     aws_signable_destroy(binding->signable);
 
@@ -310,16 +474,15 @@ static bool s_get_named_property(
     return true;
 }
 
+/* On failure an exception has been thrown, and the binding must still be cleaned up */
 static int s_get_config_from_js_config(
     napi_env env,
-    struct aws_signing_config_aws *config,
+    struct signing_config_binding *binding,
     napi_value js_config,
-    struct aws_byte_buf *region_buf,
-    struct aws_byte_buf *service_buf,
-    struct aws_byte_buf *signed_body_value_buf,
-    struct signer_sign_request_state *state,
     struct aws_allocator *allocator) {
 
+    struct aws_signing_config_aws *config = &binding->config;
+    struct signing_config_strings *strings = &binding->strings;
     config->config_type = AWS_SIGNING_CONFIG_AWS;
     int result = AWS_OP_SUCCESS;
 
@@ -365,22 +528,24 @@ static int s_get_config_from_js_config(
         result = AWS_OP_ERR;
         goto done;
     }
-    if (aws_byte_buf_init_from_napi(region_buf, env, current_value)) {
+    if (aws_byte_buf_init_from_napi_with_storage(
+            &strings->region, env, current_value, strings->region_storage, sizeof(strings->region_storage))) {
         napi_throw_error(env, NULL, "Failed to build region buffer");
         result = AWS_OP_ERR;
         goto done;
     }
-    config->region = aws_byte_cursor_from_buf(region_buf);
+    config->region = aws_byte_cursor_from_buf(&strings->region);
 
     /* Get service */
     if (s_get_named_property(env, js_config, "service", napi_string, &current_value)) {
-        if (aws_byte_buf_init_from_napi(service_buf, env, current_value)) {
+        if (aws_byte_buf_init_from_napi_with_storage(
+                &strings->service, env, current_value, strings->service_storage, sizeof(strings->service_storage))) {
             napi_throw_error(env, NULL, "Failed to build service buffer");
             result = AWS_OP_ERR;
             goto done;
         }
 
-        config->service = aws_byte_cursor_from_buf(service_buf);
+        config->service = aws_byte_cursor_from_buf(&strings->service);
     }
 
     /* Get date */
@@ -415,6 +580,7 @@ static int s_get_config_from_js_config(
         });
 
         aws_date_time_init_epoch_millis(&config->date, (uint64_t)ms_since_epoch);
+        binding->has_date = true;
     } else {
         aws_date_time_init_now(&config->date);
     }
@@ -443,7 +609,7 @@ static int s_get_config_from_js_config(
 
         /* Initialize the string array */
         int err = aws_array_list_init_dynamic(
-            &state->header_blacklist, allocator, blacklist_length, sizeof(struct aws_string *));
+            &binding->header_blacklist, allocator, blacklist_length, sizeof(struct aws_string *));
         if (err == AWS_OP_ERR) {
             aws_napi_throw_last_error(env);
             result = AWS_OP_ERR;
@@ -466,7 +632,7 @@ static int s_get_config_from_js_config(
                 goto done;
             }
 
-            if (aws_array_list_push_back(&state->header_blacklist, &header_name)) {
+            if (aws_array_list_push_back(&binding->header_blacklist, &header_name)) {
                 aws_string_destroy(header_name);
                 aws_napi_throw_last_error(env);
                 result = AWS_OP_ERR;
@@ -475,7 +641,7 @@ static int s_get_config_from_js_config(
         }
 
         config->should_sign_header = s_should_sign_header;
-        config->should_sign_header_ud = state;
+        config->should_sign_header_ud = binding;
     }
 
     /* Get bools */
@@ -505,12 +671,17 @@ static int s_get_config_from_js_config(
 
     /* Get signed body value */
     if (s_get_named_property(env, js_config, "signed_body_value", napi_string, &current_value)) {
-        if (aws_byte_buf_init_from_napi(signed_body_value_buf, env, current_value)) {
+        if (aws_byte_buf_init_from_napi_with_storage(
+                &strings->signed_body_value,
+                env,
+                current_value,
+                strings->signed_body_value_storage,
+                sizeof(strings->signed_body_value_storage))) {
             napi_throw_error(env, NULL, "Failed to build signed_body_value buffer");
             result = AWS_OP_ERR;
             goto done;
         }
-        config->signed_body_value = aws_byte_cursor_from_buf(signed_body_value_buf);
+        config->signed_body_value = aws_byte_cursor_from_buf(&strings->signed_body_value);
     }
 
     /* Get signed body header */
@@ -538,81 +709,435 @@ done:
     return result;
 }
 
-static napi_value s_aws_sign_request(napi_env env, const struct aws_napi_callback_info *cb_info) {
+/* Starts signing state->request with signing_config, which must stay alive until the signing completes */
+static void s_sign_request(
+    napi_env env,
+    struct aws_allocator *allocator,
+    struct signer_sign_request_state *state,
+    const struct signing_config_binding *signing_config,
+    napi_value node_on_complete) {
 
-    struct aws_allocator *allocator = aws_napi_get_allocator();
-    const struct aws_napi_argument *arg = NULL;
+    AWS_NAPI_CALL(
+        env,
+        aws_napi_create_threadsafe_function(
+            env,
+            node_on_complete,
+            "aws_signer_on_signing_complete",
+            s_aws_sign_request_complete_call,
+            state,
+            &state->on_complete),
+        {
+            napi_throw_type_error(env, NULL, "on_shutdown must be a valid callback or undefined");
+            s_destroy_signing_binding(env, allocator, state);
+            return;
+        });
+
+    /* The signer copies the config, so a shared one can be dated per request without being modified */
+    struct aws_signing_config_aws config = signing_config->config;
+    if (!signing_config->has_date) {
+        aws_date_time_init_now(&config.date);
+    }
+
+    if (aws_sign_request_aws(
+            allocator,
+            state->signable,
+            (struct aws_signing_config_base *)&config,
+            s_aws_sign_request_complete,
+            state)) {
+        aws_napi_throw_last_error(env);
+        AWS_NAPI_ENSURE(env, aws_napi_release_threadsafe_function(state->on_complete, napi_tsfn_abort));
+    }
+}
+
+static struct signer_sign_request_state *s_signer_sign_request_state_new(
+    napi_env env,
+    struct aws_allocator *allocator,
+    napi_value node_request) {
 
     struct signer_sign_request_state *state = aws_mem_calloc(allocator, 1, sizeof(struct signer_sign_request_state));
     if (!state) {
+        aws_napi_throw_last_error(env);
         return NULL;
     }
 
-    /* Temp buffers */
-    struct aws_byte_buf region_buf;
-    AWS_ZERO_STRUCT(region_buf);
-    struct aws_byte_buf service_buf;
-    AWS_ZERO_STRUCT(service_buf);
-    struct aws_byte_buf signed_body_value_buf;
-    AWS_ZERO_STRUCT(signed_body_value_buf);
+    napi_create_reference(env, node_request, 1, &state->node_request);
+    state->request = aws_napi_http_message_unwrap(env, node_request);
+    state->signable = aws_signable_new_http_request(allocator, state->request);
+
+    return state;
+}
+
+static napi_value s_aws_sign_request(napi_env env, const struct aws_napi_callback_info *cb_info) {
+
+    struct aws_allocator *allocator = aws_napi_get_allocator();
+    const struct aws_napi_argument *arg = NULL;
 
     /* Get request */
     aws_napi_method_next_argument(napi_object, cb_info, &arg);
-    napi_create_reference(env, arg->node, 1, &state->node_request);
-    state->request = aws_napi_http_message_unwrap(env, arg->node);
-    state->signable = aws_signable_new_http_request(allocator, state->request);
+    struct signer_sign_request_state *state = s_signer_sign_request_state_new(env, allocator, arg->node);
+    if (!state) {
+        return NULL;
+    }
 
-    /* Populate config */
-    struct aws_signing_config_aws config;
-    AWS_ZERO_STRUCT(config);
+    /* Populate config, it only lives as long as this signing operation */
+    state->owned_config = aws_mem_calloc(allocator, 1, sizeof(struct signing_config_binding));
+    if (!state->owned_config) {
+        aws_napi_throw_last_error(env);
+        goto error;
+    }
 
     aws_napi_method_next_argument(napi_object, cb_info, &arg);
     napi_value js_config = arg->node;
 
-    if (s_get_config_from_js_config(
-            env, &config, js_config, &region_buf, &service_buf, &signed_body_value_buf, state, allocator)) {
+    if (s_get_config_from_js_config(env, state->owned_config, js_config, allocator)) {
         /* error already raised */
         goto error;
     }
+
+    aws_napi_method_next_argument(napi_function, cb_info, &arg);
+    s_sign_request(env, allocator, state, state->owned_config, arg->node);
+    return NULL;
+
+error:
+    s_destroy_signing_binding(env, allocator, state);
+    return NULL;
+}
+
+static napi_value s_aws_sign_request_with_config(napi_env env, const struct aws_napi_callback_info *cb_info) {
+
+    struct aws_allocator *allocator = aws_napi_get_allocator();
+    const struct aws_napi_argument *arg = NULL;
+
+    /* Get request */
+    aws_napi_method_next_argument(napi_object, cb_info, &arg);
+    struct signer_sign_request_state *state = s_signer_sign_request_state_new(env, allocator, arg->node);
+    if (!state) {
+        return NULL;
+    }
+
+    /* Get config, and keep it alive until signing completes */
+    aws_napi_method_next_argument(napi_object, cb_info, &arg);
+    struct signing_config_binding *signing_config = NULL;
+    AWS_NAPI_CALL(env, napi_unwrap(env, arg->node, (void **)&signing_config), {
+        napi_throw_type_error(env, NULL, "config must be a SigningConfig");
+        s_destroy_signing_binding(env, allocator, state);
+        return NULL;
+    });
+    AWS_NAPI_CALL(env, napi_create_reference(env, arg->node, 1, &state->node_config), {
+        napi_throw_error(env, NULL, "Unable to reference SigningConfig");
+        s_destroy_signing_binding(env, allocator, state);
+        return NULL;
+    });
+
+    aws_napi_method_next_argument(napi_function, cb_info, &arg);
+    s_sign_request(env, allocator, state, signing_config, arg->node);
+    return NULL;
+}
+
+/*
+ * A batch of requests signed with the same config. Credentials are fetched once for the whole batch, and node is
+ * called back once, when every request has been signed.
+ */
+struct signer_sign_requests_state;
+
+struct signer_sign_requests_item {
+    struct signer_sign_requests_state *batch;
+    napi_ref node_request;
+    struct aws_http_message *request;
+    struct aws_signable *signable;
+    int error_code;
+};
+
+struct signer_sign_requests_state {
+    struct aws_allocator *allocator;
+    napi_ref node_config;
+    const struct signing_config_binding *signing_config;
+    struct aws_date_time date;
+    struct aws_credentials *credentials;
+
+    napi_threadsafe_function on_complete;
+
+    /* Requests still being signed, whoever completes the last one calls back to node */
+    struct aws_atomic_var pending;
+
+    size_t num_items;
+    struct signer_sign_requests_item *items;
+};
+
+/* Without env (node is shutting down), the refs can't be deleted, node reclaims them along with the environment */
+static void s_destroy_sign_requests_state(napi_env env, struct signer_sign_requests_state *batch) {
+    for (size_t i = 0; i < batch->num_items; ++i) {
+        struct signer_sign_requests_item *item = &batch->items[i];
+        if (env && item->node_request) {
+            napi_delete_reference(env, item->node_request);
+        }
+        aws_signable_destroy(item->signable);
+    }
+
+    if (env && batch->node_config) {
+        napi_delete_reference(env, batch->node_config);
+    }
+    aws_credentials_release(batch->credentials);
+
+    if (env) {
+        AWS_NAPI_ENSURE(env, aws_napi_unref_threadsafe_function(env, batch->on_complete));
+    }
+    aws_mem_release(batch->allocator, batch);
+}
+
+static void s_aws_sign_requests_complete_call(napi_env env, napi_value on_complete, void *context, void *user_data) {
+    (void)user_data;
+    struct signer_sign_requests_state *batch = context;
+
+    if (env) {
+        napi_value args[1];
+        AWS_NAPI_ENSURE(env, napi_create_array_with_length(env, batch->num_items, &args[0]));
+        for (size_t i = 0; i < batch->num_items; ++i) {
+            napi_value error_code = NULL;
+            AWS_NAPI_ENSURE(env, napi_create_int32(env, batch->items[i].error_code, &error_code));
+            AWS_NAPI_ENSURE(env, napi_set_element(env, args[0], (uint32_t)i, error_code));
+        }
+
+        AWS_NAPI_ENSURE(
+            env,
+            aws_napi_dispatch_threadsafe_function(
+                env, batch->on_complete, NULL, on_complete, AWS_ARRAY_SIZE(args), args));
+    }
+
+    s_destroy_sign_requests_state(env, batch);
+}
+
+static void s_sign_requests_item_done(struct signer_sign_requests_state *batch) {
+    if (aws_atomic_fetch_sub(&batch->pending, 1) == 1) {
+        AWS_NAPI_ENSURE(NULL, aws_napi_queue_threadsafe_function(batch->on_complete, NULL));
+    }
+}
+
+static void s_aws_sign_requests_item_complete(struct aws_signing_result *result, int error_code, void *userdata) {
+    struct signer_sign_requests_item *item = userdata;
+    struct signer_sign_requests_state *batch = item->batch;
+
+    item->error_code = error_code;
+    if (error_code == AWS_ERROR_SUCCESS &&
+        aws_apply_signing_result_to_http_request(item->request, batch->allocator, result)) {
+        item->error_code = aws_last_error();
+    }
+
+    s_sign_requests_item_done(batch);
+}
+
+static void s_aws_sign_requests_on_get_credentials(
+    struct aws_credentials *credentials,
+    int error_code,
+    void *user_data) {
+
+    struct signer_sign_requests_state *batch = user_data;
+
+    if (!credentials && error_code == AWS_ERROR_SUCCESS) {
+        error_code = AWS_AUTH_SIGNING_NO_CREDENTIALS;
+    }
+
+    if (error_code) {
+        for (size_t i = 0; i < batch->num_items; ++i) {
+            batch->items[i].error_code = error_code;
+        }
+        aws_atomic_store_int(&batch->pending, 1);
+        s_sign_requests_item_done(batch);
+        return;
+    }
+
+    batch->credentials = credentials;
+    aws_credentials_acquire(credentials);
+
+    /* Every request shares the fetched credentials and the batch's date, the signer copies what it needs */
+    struct aws_signing_config_aws config = batch->signing_config->config;
+    config.credentials = credentials;
+    config.date = batch->date;
+
+    /*
+     * Hold one extra count while kicking off the signs: a request can complete, and the last one free the batch,
+     * before this loop has finished reading it
+     */
+    aws_atomic_fetch_add(&batch->pending, 1);
+    for (size_t i = 0; i < batch->num_items; ++i) {
+        struct signer_sign_requests_item *item = &batch->items[i];
+        if (aws_sign_request_aws(
+                batch->allocator,
+                item->signable,
+                (struct aws_signing_config_base *)&config,
+                s_aws_sign_requests_item_complete,
+                item)) {
+            item->error_code = aws_last_error();
+            s_sign_requests_item_done(batch);
+        }
+    }
+    s_sign_requests_item_done(batch);
+}
+
+static napi_value s_aws_sign_requests(napi_env env, const struct aws_napi_callback_info *cb_info) {
+
+    struct aws_allocator *allocator = aws_napi_get_allocator();
+    const struct aws_napi_argument *arg = NULL;
+
+    aws_napi_method_next_argument(napi_object, cb_info, &arg);
+    napi_value node_requests = arg->node;
+    bool is_array = false;
+    uint32_t num_requests = 0;
+    if (napi_is_array(env, node_requests, &is_array) || !is_array ||
+        napi_get_array_length(env, node_requests, &num_requests) || num_requests == 0) {
+        napi_throw_type_error(env, NULL, "requests must be a non-empty array of HttpRequests");
+        return NULL;
+    }
+
+    struct signer_sign_requests_state *batch = NULL;
+    struct signer_sign_requests_item *items = NULL;
+    if (!aws_mem_acquire_many(
+            allocator,
+            2,
+            &batch,
+            sizeof(struct signer_sign_requests_state),
+            &items,
+            num_requests * sizeof(struct signer_sign_requests_item))) {
+        aws_napi_throw_last_error(env);
+        return NULL;
+    }
+    AWS_ZERO_STRUCT(*batch);
+    memset(items, 0, num_requests * sizeof(struct signer_sign_requests_item));
+    batch->allocator = allocator;
+    batch->items = items;
+    batch->num_items = num_requests;
+    aws_atomic_init_int(&batch->pending, num_requests);
+
+    for (uint32_t i = 0; i < num_requests; ++i) {
+        struct signer_sign_requests_item *item = &batch->items[i];
+        item->batch = batch;
+
+        napi_value node_request = NULL;
+        AWS_NAPI_CALL(env, napi_get_element(env, node_requests, i, &node_request), {
+            napi_throw_error(env, NULL, "Failed to get request from requests array");
+            goto error;
+        });
+        item->request = aws_napi_http_message_unwrap(env, node_request);
+        if (!item->request) {
+            napi_throw_type_error(env, NULL, "requests must be a non-empty array of HttpRequests");
+            goto error;
+        }
+        AWS_NAPI_CALL(env, napi_create_reference(env, node_request, 1, &item->node_request), {
+            napi_throw_error(env, NULL, "Unable to reference HttpRequest");
+            goto error;
+        });
+        item->signable = aws_signable_new_http_request(allocator, item->request);
+        if (!item->signable) {
+            aws_napi_throw_last_error(env);
+            goto error;
+        }
+    }
+
+    /* Get config, and keep it alive until every request has been signed */
+    aws_napi_method_next_argument(napi_object, cb_info, &arg);
+    struct signing_config_binding *signing_config = NULL;
+    AWS_NAPI_CALL(env, napi_unwrap(env, arg->node, (void **)&signing_config), {
+        napi_throw_type_error(env, NULL, "config must be a SigningConfig");
+        goto error;
+    });
+    AWS_NAPI_CALL(env, napi_create_reference(env, arg->node, 1, &batch->node_config), {
+        napi_throw_error(env, NULL, "Unable to reference SigningConfig");
+        goto error;
+    });
+    batch->signing_config = signing_config;
+    if (signing_config->has_date) {
+        batch->date = signing_config->config.date;
+    } else {
+        aws_date_time_init_now(&batch->date);
+    }
+
     aws_napi_method_next_argument(napi_function, cb_info, &arg);
     AWS_NAPI_CALL(
         env,
         aws_napi_create_threadsafe_function(
             env,
             arg->node,
-            "aws_signer_on_signing_complete",
-            s_aws_sign_request_complete_call,
-            state,
-            &state->on_complete),
+            "aws_signer_on_sign_requests_complete",
+            s_aws_sign_requests_complete_call,
+            batch,
+            &batch->on_complete),
         {
-            napi_throw_type_error(env, NULL, "on_shutdown must be a valid callback or undefined");
+            napi_throw_type_error(env, NULL, "on_complete must be a valid callback");
             goto error;
         });
 
-    if (aws_sign_request_aws(
-            allocator,
-            state->signable,
-            (struct aws_signing_config_base *)&config,
-            s_aws_sign_request_complete,
-            state)) {
-        aws_napi_throw_last_error(env);
-        AWS_NAPI_ENSURE(env, aws_napi_release_threadsafe_function(state->on_complete, napi_tsfn_abort));
+    if (aws_credentials_provider_get_credentials(
+                   signing_config->config.credentials_provider, s_aws_sign_requests_on_get_credentials, batch)) {
+        s_aws_sign_requests_on_get_credentials(NULL, aws_last_error(), batch);
     }
 
-    goto done;
+    return NULL;
 
 error:
-    // Additional cleanup needed when we didn't successfully bind the on_complete function
-    s_destroy_signing_binding(env, allocator, state);
+    s_destroy_sign_requests_state(env, batch);
+    return NULL;
+}
 
-done:
-    // Shared cleanup
-    aws_credentials_provider_release(config.credentials_provider);
+/***********************************************************************************************************************
+ * Signing Config
+ **********************************************************************************************************************/
+
+static napi_value s_signing_config_cursor_get(napi_env env, struct aws_byte_cursor cursor) {
+    napi_value result = NULL;
+    const char *str = cursor.ptr ? (const char *)cursor.ptr : "";
+    AWS_NAPI_CALL(env, napi_create_string_utf8(env, str, cursor.len, &result), {
+        aws_napi_throw_last_error(env);
+    });
+    return result;
+}
+
+static napi_value s_signing_config_region_get(napi_env env, void *native_this) {
+    const struct signing_config_binding *binding = native_this;
+    return s_signing_config_cursor_get(env, binding->config.region);
+}
+
+static napi_value s_signing_config_service_get(napi_env env, void *native_this) {
+    const struct signing_config_binding *binding = native_this;
+    return s_signing_config_cursor_get(env, binding->config.service);
+}
+
+static void s_napi_signing_config_finalize(napi_env env, void *finalize_data, void *finalize_hint) {
+    (void)env;
+    (void)finalize_hint;
+
+    struct signing_config_binding *binding = finalize_data;
+    s_signing_config_binding_clean_up(binding);
+    aws_mem_release(aws_napi_get_allocator(), binding);
+}
+
+static napi_value s_signing_config_constructor(napi_env env, const struct aws_napi_callback_info *cb_info) {
 
-    aws_byte_buf_clean_up(&region_buf);
-    aws_byte_buf_clean_up(&service_buf);
-    aws_byte_buf_clean_up(&signed_body_value_buf);
+    struct aws_allocator *allocator = aws_napi_get_allocator();
+    const struct aws_napi_argument *arg = NULL;
+    aws_napi_method_next_argument(napi_object, cb_info, &arg);
+
+    struct signing_config_binding *binding = aws_mem_calloc(allocator, 1, sizeof(struct signing_config_binding));
+    if (!binding) {
+        aws_napi_throw_last_error(env);
+        return NULL;
+    }
+
+    if (s_get_config_from_js_config(env, binding, arg->node, allocator)) {
+        /* error already raised */
+        goto error;
+    }
+
+    napi_value node_this = cb_info->node_this;
+    AWS_NAPI_CALL(env, napi_wrap(env, node_this, binding, s_napi_signing_config_finalize, NULL, NULL), {
+        napi_throw_error(env, NULL, "Failed to wrap SigningConfig");
+        goto error;
+    });
+
+    return node_this;
 
+error:
+    s_signing_config_binding_clean_up(binding);
+    aws_mem_release(allocator, binding);
     return NULL;
 }
 
@@ -665,12 +1190,8 @@ static napi_value s_aws_verify_sigv4a_signing(napi_env env, const struct aws_nap
     }
 
     /* Temp buffers */
-    struct aws_byte_buf region_buf;
-    AWS_ZERO_STRUCT(region_buf);
-    struct aws_byte_buf service_buf;
-    AWS_ZERO_STRUCT(service_buf);
-    struct aws_byte_buf signed_body_value_buf;
-    AWS_ZERO_STRUCT(signed_body_value_buf);
+    struct signing_config_binding signing_config;
+    AWS_ZERO_STRUCT(signing_config);
     struct aws_byte_buf expected_canonical_request_buf;
     AWS_ZERO_STRUCT(expected_canonical_request_buf);
     struct aws_byte_buf signature_buf;
@@ -686,14 +1207,12 @@ static napi_value s_aws_verify_sigv4a_signing(napi_env env, const struct aws_nap
     state->signable = aws_signable_new_http_request(allocator, state->request);
 
     /* Populate config */
-    struct aws_signing_config_aws config;
-    AWS_ZERO_STRUCT(config);
+    struct aws_signing_config_aws *config = &signing_config.config;
 
     aws_napi_method_next_argument(napi_object, cb_info, &arg);
     napi_value js_config = arg->node;
 
-    if (s_get_config_from_js_config(
-            env, &config, js_config, &region_buf, &service_buf, &signed_body_value_buf, state, allocator)) {
+    if (s_get_config_from_js_config(env, &signing_config, js_config, allocator)) {
         /* error already raised */
         goto done;
     }
@@ -729,17 +1248,17 @@ static napi_value s_aws_verify_sigv4a_signing(napi_env env, const struct aws_nap
     struct sigv4a_credentail_getter_state credential_state;
     AWS_ZERO_STRUCT(credential_state);
     credential_state.allocator = allocator;
-    credential_state.config = &config;
+    credential_state.config = config;
     aws_condition_variable_init(&credential_state.cvar);
     aws_mutex_init(&credential_state.lock);
     /* get credential from provider for the verification */
     if (aws_credentials_provider_get_credentials(
-            config.credentials_provider, s_aws_signv4a_on_get_credentials, &credential_state)) {
+            config->credentials_provider, s_aws_signv4a_on_get_credentials, &credential_state)) {
         goto done;
     }
     /* wait for credential provider getting the credential */
     s_wait_for_get_credential_to_complete(&credential_state);
-    if (!config.credentials) {
+    if (!config->credentials) {
         napi_throw_type_error(env, NULL, "Failed to get credentials from credential provider");
         goto done;
     }
@@ -747,7 +1266,7 @@ static napi_value s_aws_verify_sigv4a_signing(napi_env env, const struct aws_nap
     if (aws_verify_sigv4a_signing(
             allocator,
             state->signable,
-            (struct aws_signing_config_base *)&config,
+            (struct aws_signing_config_base *)config,
             aws_byte_cursor_from_buf(&expected_canonical_request_buf),
             aws_byte_cursor_from_buf(&signature_buf),
             aws_byte_cursor_from_buf(&ecc_key_pub_x_buf),
@@ -763,10 +1282,7 @@ static napi_value s_aws_verify_sigv4a_signing(napi_env env, const struct aws_nap
 done:
     s_destroy_signing_binding(env, allocator, state);
 
-    aws_credentials_provider_release(config.credentials_provider);
-    aws_byte_buf_clean_up(&region_buf);
-    aws_byte_buf_clean_up(&service_buf);
-    aws_byte_buf_clean_up(&signed_body_value_buf);
+    s_signing_config_binding_clean_up(&signing_config);
     aws_byte_buf_clean_up(&expected_canonical_request_buf);
     aws_byte_buf_clean_up(&signature_buf);
     aws_byte_buf_clean_up(&ecc_key_pub_x_buf);
@@ -0,0 +1,133 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include "buffer_pool.h"
+
+#include <aws/common/atomics.h>
+#include <aws/common/mutex.h>
+
+struct aws_napi_buffer_pool {
+    struct aws_allocator *allocator;
+    struct aws_atomic_var ref_count;
+    size_t slab_size;
+    size_t max_free_slabs;
+
+    struct {
+        struct aws_mutex lock;
+        struct aws_linked_list free_slabs;
+        size_t num_free_slabs;
+    } synced_data;
+};
+
+static struct aws_napi_buffer_slab *s_slab_new(struct aws_allocator *allocator, size_t capacity) {
+    struct aws_napi_buffer_slab *slab = aws_mem_acquire(allocator, sizeof(struct aws_napi_buffer_slab) + capacity);
+    AWS_FATAL_ASSERT(slab);
+    AWS_ZERO_STRUCT(*slab);
+    slab->allocator = allocator;
+    slab->buffer.buffer = (uint8_t *)(slab + 1);
+    slab->buffer.capacity = capacity;
+    /* buffer.allocator stays NULL: the storage is owned by the slab, aws_byte_buf_clean_up() must not touch it */
+    return slab;
+}
+
+struct aws_napi_buffer_pool *aws_napi_buffer_pool_new(
+    struct aws_allocator *allocator,
+    size_t slab_size,
+    size_t max_free_slabs) {
+
+    struct aws_napi_buffer_pool *pool = aws_mem_calloc(allocator, 1, sizeof(struct aws_napi_buffer_pool));
+    if (!pool) {
+        return NULL;
+    }
+
+    pool->allocator = allocator;
+    pool->slab_size = slab_size;
+    pool->max_free_slabs = max_free_slabs;
+    aws_atomic_init_int(&pool->ref_count, 1);
+    aws_mutex_init(&pool->synced_data.lock);
+    aws_linked_list_init(&pool->synced_data.free_slabs);
+
+    return pool;
+}
+
+struct aws_napi_buffer_pool *aws_napi_buffer_pool_acquire(struct aws_napi_buffer_pool *pool) {
+    if (pool) {
+        aws_atomic_fetch_add(&pool->ref_count, 1);
+    }
+    return pool;
+}
+
+void aws_napi_buffer_pool_release(struct aws_napi_buffer_pool *pool) {
+    if (!pool || aws_atomic_fetch_sub(&pool->ref_count, 1) != 1) {
+        return;
+    }
+
+    /* last reference, nobody else can be touching the free list */
+    while (!aws_linked_list_empty(&pool->synced_data.free_slabs)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&pool->synced_data.free_slabs);
+        struct aws_napi_buffer_slab *slab = AWS_CONTAINER_OF(node, struct aws_napi_buffer_slab, node);
+        aws_mem_release(slab->allocator, slab);
+    }
+
+    aws_mutex_clean_up(&pool->synced_data.lock);
+    aws_mem_release(pool->allocator, pool);
+}
+
+struct aws_napi_buffer_slab *aws_napi_buffer_slab_acquire(
+    struct aws_allocator *allocator,
+    struct aws_napi_buffer_pool *pool,
+    size_t size) {
+
+    /* small requests, such as the tail of a response body, would otherwise pin a whole slab each */
+    if (!pool || size > pool->slab_size || size < pool->slab_size / AWS_NAPI_BUFFER_POOL_SMALL_FRACTION) {
+        return s_slab_new(allocator, size);
+    }
+
+    struct aws_napi_buffer_slab *slab = NULL;
+    aws_mutex_lock(&pool->synced_data.lock);
+    if (!aws_linked_list_empty(&pool->synced_data.free_slabs)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&pool->synced_data.free_slabs);
+        slab = AWS_CONTAINER_OF(node, struct aws_napi_buffer_slab, node);
+        --pool->synced_data.num_free_slabs;
+    }
+    aws_mutex_unlock(&pool->synced_data.lock);
+
+    if (!slab) {
+        slab = s_slab_new(pool->allocator, pool->slab_size);
+    }
+
+    /* each outstanding slab keeps the pool alive */
+    slab->pool = aws_napi_buffer_pool_acquire(pool);
+    slab->buffer.len = 0;
+    slab->user_data = NULL;
+    return slab;
+}
+
+void aws_napi_buffer_slab_release(struct aws_napi_buffer_slab *slab) {
+    if (!slab) {
+        return;
+    }
+
+    struct aws_napi_buffer_pool *pool = slab->pool;
+    if (!pool) {
+        aws_mem_release(slab->allocator, slab);
+        return;
+    }
+
+    slab->pool = NULL;
+    bool recycled = false;
+    aws_mutex_lock(&pool->synced_data.lock);
+    if (pool->synced_data.num_free_slabs < pool->max_free_slabs) {
+        aws_linked_list_push_back(&pool->synced_data.free_slabs, &slab->node);
+        ++pool->synced_data.num_free_slabs;
+        recycled = true;
+    }
+    aws_mutex_unlock(&pool->synced_data.lock);
+
+    if (!recycled) {
+        aws_mem_release(slab->allocator, slab);
+    }
+
+    aws_napi_buffer_pool_release(pool);
+}
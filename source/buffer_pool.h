@@ -0,0 +1,57 @@
+#ifndef AWS_CRT_NODEJS_BUFFER_POOL_H
+#define AWS_CRT_NODEJS_BUFFER_POOL_H
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "module.h"
+
+#include <aws/common/linked_list.h>
+
+/* Default size of each slab handed out by a pool, matches the usual size of a TLS record/socket read */
+#define AWS_NAPI_BUFFER_POOL_DEFAULT_SLAB_SIZE (16 * 1024)
+
+/* Requests smaller than this fraction of a pool's slab size are allocated to size rather than taking a slab */
+#define AWS_NAPI_BUFFER_POOL_SMALL_FRACTION 8
+
+struct aws_napi_buffer_pool;
+
+/**
+ * A single allocation holding a byte_buf header and its storage. Slabs come from a pool when the requested size fits
+ * and isn't small, otherwise they are allocated (and freed) individually.
+ */
+struct aws_napi_buffer_slab {
+    struct aws_allocator *allocator;
+    struct aws_napi_buffer_pool *pool; /* NULL if this slab is not pooled */
+    struct aws_linked_list_node node;
+    struct aws_byte_buf buffer; /* points at the storage immediately following this struct */
+    void *user_data;
+};
+
+/**
+ * Creates a pool of fixed size slabs. At most max_free_slabs idle slabs are kept around for reuse, anything released
+ * beyond that is freed. The pool is ref counted, outstanding slabs keep it alive.
+ */
+struct aws_napi_buffer_pool *aws_napi_buffer_pool_new(
+    struct aws_allocator *allocator,
+    size_t slab_size,
+    size_t max_free_slabs);
+
+struct aws_napi_buffer_pool *aws_napi_buffer_pool_acquire(struct aws_napi_buffer_pool *pool);
+void aws_napi_buffer_pool_release(struct aws_napi_buffer_pool *pool);
+
+/**
+ * Vends a slab with capacity of at least size bytes. pool may be NULL. Safe to call from any thread.
+ */
+struct aws_napi_buffer_slab *aws_napi_buffer_slab_acquire(
+    struct aws_allocator *allocator,
+    struct aws_napi_buffer_pool *pool,
+    size_t size);
+
+/**
+ * Returns a slab to its pool, or frees it. Safe to call from any thread.
+ */
+void aws_napi_buffer_slab_release(struct aws_napi_buffer_slab *slab);
+
+#endif /* AWS_CRT_NODEJS_BUFFER_POOL_H */
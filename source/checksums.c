@@ -5,11 +5,29 @@
  */
 #include "checksums.h"
 
+#include "async_work.h"
+
+#include <aws/cal/hash.h>
 #include <aws/checksums/crc.h>
 
+#include <string.h>
+
+typedef uint32_t(crc_fn)(const uint8_t *, int, uint32_t);
+
+static uint32_t s_crc_buffer(crc_fn *checksum_fn, const uint8_t *buffer, size_t length, uint32_t previous) {
+    uint32_t val = previous;
+    while (length > INT_MAX) {
+        val = checksum_fn(buffer, INT_MAX, val);
+        buffer += (size_t)INT_MAX;
+        length -= (size_t)INT_MAX;
+    }
+    return checksum_fn(buffer, (int)length, val);
+}
+
 napi_value crc_common(napi_env env, napi_callback_info info, uint32_t (*checksum_fn)(const uint8_t *, int, uint32_t)) {
     napi_value node_args[2];
     size_t num_args = AWS_ARRAY_SIZE(node_args);
+    uint8_t to_hash_storage[AWS_NAPI_SMALL_STRING_SIZE];
     struct aws_byte_buf to_hash;
     AWS_ZERO_STRUCT(to_hash);
     // struct aws_byte_buf *to_hash_ptr = (struct aws_byte_buf*)NULL;
@@ -24,7 +42,8 @@ napi_value crc_common(napi_env env, napi_callback_info info, uint32_t (*checksum
         goto done;
     }
 
-    if (aws_byte_buf_init_from_napi(&to_hash, env, node_args[0])) {
+    if (aws_byte_buf_init_from_napi_with_storage(
+            &to_hash, env, node_args[0], to_hash_storage, sizeof(to_hash_storage))) {
         napi_throw_type_error(env, NULL, "to_hash argument must be a string or array");
         goto done;
     }
@@ -39,13 +58,7 @@ napi_value crc_common(napi_env env, napi_callback_info info, uint32_t (*checksum
         }
     }
 
-    uint32_t val = previous;
-    while (length > INT_MAX) {
-        val = checksum_fn(buffer, INT_MAX, val);
-        buffer += (size_t)INT_MAX;
-        length -= (size_t)INT_MAX;
-    }
-    val = checksum_fn(buffer, (int)length, val);
+    uint32_t val = s_crc_buffer(checksum_fn, buffer, length, previous);
     AWS_NAPI_CALL(env, napi_create_uint32(env, val, &node_val), { goto done; });
 
 done:
@@ -61,3 +74,465 @@ napi_value aws_napi_checksums_crc32(napi_env env, napi_callback_info info) {
 napi_value aws_napi_checksums_crc32c(napi_env env, napi_callback_info info) {
     return crc_common(env, info, aws_checksums_crc32c);
 }
+
+struct crc_job {
+    struct aws_allocator *allocator;
+    crc_fn *checksum_fn;
+    struct aws_byte_buf *to_hash;
+    uint32_t value;
+};
+
+static int s_crc_job_execute(struct aws_napi_async_job *job) {
+    struct crc_job *crc = job->impl;
+    crc->value = s_crc_buffer(crc->checksum_fn, crc->to_hash->buffer, crc->to_hash->len, crc->value);
+    return AWS_OP_SUCCESS;
+}
+
+static napi_status s_crc_job_complete(napi_env env, struct aws_napi_async_job *job, napi_value *result) {
+    struct crc_job *crc = job->impl;
+    return napi_create_uint32(env, crc->value, result);
+}
+
+static void s_crc_job_destroy(struct aws_napi_async_job *job) {
+    struct crc_job *crc = job->impl;
+    aws_mem_release(crc->allocator, crc);
+}
+
+static const struct aws_napi_async_job_vtable s_crc_job_vtable = {
+    .execute = s_crc_job_execute,
+    .complete = s_crc_job_complete,
+    .destroy = s_crc_job_destroy,
+};
+
+/* (to_hash, previous, on_complete), the checksum is computed on the libuv worker pool */
+static napi_value s_crc_async(napi_env env, napi_callback_info info, crc_fn *checksum_fn) {
+    napi_value node_args[3];
+    size_t num_args = AWS_ARRAY_SIZE(node_args);
+
+    if (napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL)) {
+        napi_throw_error(env, NULL, "Failed to retreive callback information");
+        return NULL;
+    }
+    if (num_args != AWS_ARRAY_SIZE(node_args)) {
+        napi_throw_error(env, NULL, "aws_napi_checksums_crc_async needs exactly 3 arguments");
+        return NULL;
+    }
+
+    uint32_t previous = 0;
+    if (!aws_napi_is_null_or_undefined(env, node_args[1])) {
+        if (napi_get_value_uint32(env, node_args[1], &previous)) {
+            napi_throw_type_error(env, NULL, "previous argument must be undefined or a positive number");
+            return NULL;
+        }
+    }
+
+    struct aws_allocator *allocator = aws_napi_get_allocator();
+    struct crc_job *crc = aws_mem_calloc(allocator, 1, sizeof(struct crc_job));
+    AWS_FATAL_ASSERT(crc);
+    crc->allocator = allocator;
+    crc->checksum_fn = checksum_fn;
+    crc->value = previous;
+
+    struct aws_napi_async_job *job = aws_napi_async_job_new(allocator, &s_crc_job_vtable, crc);
+
+    if (aws_napi_async_job_add_input(env, job, node_args[0], &crc->to_hash)) {
+        napi_throw_type_error(env, NULL, "to_hash argument must be a string or array");
+        goto failed;
+    }
+
+    if (aws_napi_async_job_queue(env, job, "aws_checksums_crc", node_args[2])) {
+        napi_throw_error(env, NULL, "Failed to queue checksum computation");
+        goto failed;
+    }
+
+    return NULL;
+
+failed:
+    aws_napi_async_job_destroy(env, job);
+    return NULL;
+}
+
+napi_value aws_napi_checksums_crc32_async(napi_env env, napi_callback_info info) {
+    return s_crc_async(env, info, aws_checksums_crc32);
+}
+
+napi_value aws_napi_checksums_crc32c_async(napi_env env, napi_callback_info info) {
+    return s_crc_async(env, info, aws_checksums_crc32c);
+}
+
+/*******************************************************************************
+ * Combine
+ ******************************************************************************/
+
+/* Both crcs are reflected, so their polynomials are stored bit-reversed */
+#define CRC32_POLY_REFLECTED 0xEDB88320u
+#define CRC32C_POLY_REFLECTED 0x82F63B78u
+
+/* (a * b) modulo poly, in GF(2) with the reflected bit order used by the crcs */
+static uint32_t s_multmodp(uint32_t a, uint32_t b, uint32_t poly) {
+    uint32_t m = (uint32_t)1 << 31;
+    uint32_t p = 0;
+    for (;;) {
+        if (a & m) {
+            p ^= b;
+            if ((a & (m - 1)) == 0) {
+                break;
+            }
+        }
+        m >>= 1;
+        b = (b & 1) ? (b >> 1) ^ poly : b >> 1;
+    }
+    return p;
+}
+
+/*
+ * Combines crc1 of part A with crc2 of part B into the crc of A followed by B, where len2 is the length of B in bytes.
+ * Shifting crc1 over len2 zero bytes is a multiplication by x^(8 * len2), computed by repeated squaring.
+ */
+static uint32_t s_crc_combine(uint32_t poly, uint32_t crc1, uint32_t crc2, uint64_t len2) {
+    uint32_t x2n = (uint32_t)1 << 30; /* x^1 */
+    for (int i = 0; i < 3; ++i) {
+        x2n = s_multmodp(x2n, x2n, poly); /* x^8, one byte */
+    }
+
+    uint32_t shift = (uint32_t)1 << 31; /* x^0 */
+    while (len2) {
+        if (len2 & 1) {
+            shift = s_multmodp(x2n, shift, poly);
+        }
+        len2 >>= 1;
+        x2n = s_multmodp(x2n, x2n, poly);
+    }
+
+    return s_multmodp(shift, crc1, poly) ^ crc2;
+}
+
+/* (crc1, crc2, len2) */
+static napi_value s_crc_combine_common(napi_env env, napi_callback_info info, uint32_t poly) {
+    napi_value node_args[3];
+    size_t num_args = AWS_ARRAY_SIZE(node_args);
+
+    if (napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL)) {
+        napi_throw_error(env, NULL, "Failed to retreive callback information");
+        return NULL;
+    }
+    if (num_args != AWS_ARRAY_SIZE(node_args)) {
+        napi_throw_error(env, NULL, "aws_napi_checksums_crc_combine needs exactly 3 arguments");
+        return NULL;
+    }
+
+    uint32_t crc1 = 0;
+    uint32_t crc2 = 0;
+    if (napi_get_value_uint32(env, node_args[0], &crc1) || napi_get_value_uint32(env, node_args[1], &crc2)) {
+        napi_throw_type_error(env, NULL, "crc arguments must be positive numbers");
+        return NULL;
+    }
+
+    int64_t len2 = 0;
+    if (napi_get_value_int64(env, node_args[2], &len2) || len2 < 0) {
+        napi_throw_type_error(env, NULL, "length argument must be a positive number");
+        return NULL;
+    }
+
+    napi_value node_val = NULL;
+    AWS_NAPI_CALL(env, napi_create_uint32(env, s_crc_combine(poly, crc1, crc2, (uint64_t)len2), &node_val), {
+        return NULL;
+    });
+    return node_val;
+}
+
+napi_value aws_napi_checksums_crc32_combine(napi_env env, napi_callback_info info) {
+    return s_crc_combine_common(env, info, CRC32_POLY_REFLECTED);
+}
+
+napi_value aws_napi_checksums_crc32c_combine(napi_env env, napi_callback_info info) {
+    return s_crc_combine_common(env, info, CRC32C_POLY_REFLECTED);
+}
+
+/*******************************************************************************
+ * Parallel parts
+ ******************************************************************************/
+
+struct crc_parts;
+
+struct crc_part {
+    struct crc_parts *parts;
+    napi_async_work work;
+    struct aws_byte_buf data;
+    napi_ref pin;
+    uint32_t crc;
+};
+
+/* Each part is queued as its own async work, so parts are checksummed concurrently across the libuv worker pool */
+struct crc_parts {
+    struct aws_allocator *allocator;
+    crc_fn *checksum_fn;
+    uint32_t poly;
+    napi_ref on_complete;
+    int error_code;
+    size_t num_parts;
+    size_t num_pending; /* only touched on the node thread */
+    struct crc_part *part;
+};
+
+static void s_crc_parts_destroy(napi_env env, struct crc_parts *parts) {
+    for (size_t i = 0; i < parts->num_parts; ++i) {
+        struct crc_part *part = &parts->part[i];
+        if (part->work) {
+            napi_delete_async_work(env, part->work);
+        }
+        aws_napi_byte_buf_unpin(env, &part->data, part->pin);
+    }
+
+    if (parts->on_complete) {
+        napi_delete_reference(env, parts->on_complete);
+    }
+
+    aws_mem_release(parts->allocator, parts->part);
+    aws_mem_release(parts->allocator, parts);
+}
+
+static void s_crc_part_execute(napi_env env, void *data) {
+    (void)env;
+    struct crc_part *part = data;
+    part->crc = s_crc_buffer(part->parts->checksum_fn, part->data.buffer, part->data.len, 0);
+}
+
+static void s_crc_part_complete(napi_env env, napi_status work_status, void *data) {
+    struct crc_part *part = data;
+    struct crc_parts *parts = part->parts;
+
+    if (work_status != napi_ok && !parts->error_code) {
+        parts->error_code = AWS_ERROR_INVALID_STATE;
+    }
+
+    if (--parts->num_pending > 0) {
+        return;
+    }
+
+    /* all parts are done, fold them together in order */
+    napi_value node_args[3];
+    AWS_NAPI_ENSURE(env, napi_create_uint32(env, parts->error_code, &node_args[0]));
+    AWS_NAPI_ENSURE(env, napi_get_undefined(env, &node_args[1]));
+    AWS_NAPI_ENSURE(env, napi_get_undefined(env, &node_args[2]));
+
+    if (!parts->error_code) {
+        uint32_t crc = parts->part[0].crc;
+        AWS_NAPI_ENSURE(env, napi_create_array_with_length(env, parts->num_parts, &node_args[2]));
+        for (size_t i = 0; i < parts->num_parts; ++i) {
+            const struct crc_part *current = &parts->part[i];
+            if (i > 0) {
+                crc = s_crc_combine(parts->poly, crc, current->crc, current->data.len);
+            }
+
+            napi_value node_part_crc = NULL;
+            AWS_NAPI_ENSURE(env, napi_create_uint32(env, current->crc, &node_part_crc));
+            AWS_NAPI_ENSURE(env, napi_set_element(env, node_args[2], (uint32_t)i, node_part_crc));
+        }
+        AWS_NAPI_ENSURE(env, napi_create_uint32(env, crc, &node_args[1]));
+    }
+
+    napi_value node_on_complete = NULL;
+    napi_value this_ptr = NULL;
+    AWS_NAPI_ENSURE(env, napi_get_reference_value(env, parts->on_complete, &node_on_complete));
+    AWS_NAPI_ENSURE(env, napi_get_undefined(env, &this_ptr));
+    if (node_on_complete) {
+        /* an exception thrown from on_complete is left pending, node will report it as uncaught */
+        napi_call_function(env, this_ptr, node_on_complete, AWS_ARRAY_SIZE(node_args), node_args, NULL);
+    }
+
+    s_crc_parts_destroy(env, parts);
+}
+
+/* (parts[], on_complete(error_code, crc, part_crcs[])) */
+static napi_value s_crc_parts_async(napi_env env, napi_callback_info info, crc_fn *checksum_fn, uint32_t poly) {
+    napi_value node_args[2];
+    size_t num_args = AWS_ARRAY_SIZE(node_args);
+
+    if (napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL)) {
+        napi_throw_error(env, NULL, "Failed to retreive callback information");
+        return NULL;
+    }
+    if (num_args != AWS_ARRAY_SIZE(node_args)) {
+        napi_throw_error(env, NULL, "aws_napi_checksums_crc_parts_async needs exactly 2 arguments");
+        return NULL;
+    }
+
+    bool is_array = false;
+    uint32_t num_parts = 0;
+    if (napi_is_array(env, node_args[0], &is_array) || !is_array ||
+        napi_get_array_length(env, node_args[0], &num_parts) || num_parts == 0) {
+        napi_throw_type_error(env, NULL, "parts argument must be a non-empty array");
+        return NULL;
+    }
+
+    struct aws_allocator *allocator = aws_napi_get_allocator();
+    struct crc_parts *parts = aws_mem_calloc(allocator, 1, sizeof(struct crc_parts));
+    AWS_FATAL_ASSERT(parts);
+    parts->part = aws_mem_calloc(allocator, num_parts, sizeof(struct crc_part));
+    AWS_FATAL_ASSERT(parts->part);
+    parts->allocator = allocator;
+    parts->checksum_fn = checksum_fn;
+    parts->poly = poly;
+    parts->num_parts = num_parts;
+
+    napi_value resource_name = NULL;
+    AWS_NAPI_ENSURE(env, napi_create_string_utf8(env, "aws_checksums_crc_parts", NAPI_AUTO_LENGTH, &resource_name));
+
+    /* pin every part and create its work up front, so that nothing has been queued if any of them fail */
+    for (uint32_t i = 0; i < num_parts; ++i) {
+        struct crc_part *part = &parts->part[i];
+        part->parts = parts;
+
+        napi_value node_part = NULL;
+        if (napi_get_element(env, node_args[0], i, &node_part) ||
+            aws_napi_byte_buf_pin_from_napi(env, node_part, &part->data, &part->pin)) {
+            napi_throw_type_error(env, NULL, "parts must be strings or arrays");
+            goto failed;
+        }
+
+        AWS_NAPI_CALL(
+            env,
+            napi_create_async_work(env, NULL, resource_name, s_crc_part_execute, s_crc_part_complete, part, &part->work),
+            {
+                napi_throw_error(env, NULL, "Failed to create checksum work");
+                goto failed;
+            });
+    }
+
+    AWS_NAPI_CALL(env, napi_create_reference(env, node_args[1], 1, &parts->on_complete), {
+        napi_throw_error(env, NULL, "Failed to reference on_complete");
+        goto failed;
+    });
+
+    parts->num_pending = num_parts;
+    for (uint32_t i = 0; i < num_parts; ++i) {
+        AWS_NAPI_CALL(env, napi_queue_async_work(env, parts->part[i].work), {
+            /* the parts already queued will complete, the rest are accounted for as failed right away */
+            parts->error_code = AWS_ERROR_INVALID_STATE;
+            parts->num_pending -= (num_parts - i);
+            if (parts->num_pending == 0) {
+                napi_throw_error(env, NULL, "Failed to queue checksum work");
+                goto failed;
+            }
+            return NULL;
+        });
+    }
+
+    return NULL;
+
+failed:
+    s_crc_parts_destroy(env, parts);
+    return NULL;
+}
+
+napi_value aws_napi_checksums_crc32_parts_async(napi_env env, napi_callback_info info) {
+    return s_crc_parts_async(env, info, aws_checksums_crc32, CRC32_POLY_REFLECTED);
+}
+
+napi_value aws_napi_checksums_crc32c_parts_async(napi_env env, napi_callback_info info) {
+    return s_crc_parts_async(env, info, aws_checksums_crc32c, CRC32C_POLY_REFLECTED);
+}
+
+bool aws_napi_checksum_algorithm_from_napi(
+    napi_env env,
+    napi_value node_algorithm,
+    enum aws_napi_checksum_algorithm *out_algorithm) {
+
+    *out_algorithm = AWS_NAPI_CHECKSUM_NONE;
+    if (aws_napi_is_null_or_undefined(env, node_algorithm)) {
+        return true;
+    }
+
+    char name[8];
+    size_t length = 0;
+    if (napi_get_value_string_utf8(env, node_algorithm, name, sizeof(name), &length) == napi_ok) {
+        if (strcmp(name, "crc32c") == 0) {
+            *out_algorithm = AWS_NAPI_CHECKSUM_CRC32C;
+            return true;
+        }
+        if (strcmp(name, "sha256") == 0) {
+            *out_algorithm = AWS_NAPI_CHECKSUM_SHA256;
+            return true;
+        }
+    }
+
+    napi_throw_type_error(env, NULL, "checksum must be 'crc32c', 'sha256' or undefined");
+    return false;
+}
+
+int aws_napi_running_checksum_init(
+    struct aws_napi_running_checksum *checksum,
+    struct aws_allocator *allocator,
+    enum aws_napi_checksum_algorithm algorithm) {
+
+    AWS_ZERO_STRUCT(*checksum);
+    checksum->algorithm = algorithm;
+    if (algorithm == AWS_NAPI_CHECKSUM_SHA256) {
+        checksum->hash = aws_sha256_new(allocator);
+        if (!checksum->hash) {
+            return AWS_OP_ERR;
+        }
+    }
+    return AWS_OP_SUCCESS;
+}
+
+void aws_napi_running_checksum_clean_up(struct aws_napi_running_checksum *checksum) {
+    if (checksum->hash) {
+        aws_hash_destroy(checksum->hash);
+    }
+    AWS_ZERO_STRUCT(*checksum);
+}
+
+int aws_napi_running_checksum_update(struct aws_napi_running_checksum *checksum, struct aws_byte_cursor data) {
+    if (checksum->finalized) {
+        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    }
+
+    switch (checksum->algorithm) {
+        case AWS_NAPI_CHECKSUM_CRC32C:
+            checksum->crc = s_crc_buffer(aws_checksums_crc32c, data.ptr, data.len, checksum->crc);
+            return AWS_OP_SUCCESS;
+        case AWS_NAPI_CHECKSUM_SHA256:
+            return aws_hash_update(checksum->hash, &data);
+        default:
+            return AWS_OP_SUCCESS;
+    }
+}
+
+int aws_napi_running_checksum_reset(struct aws_napi_running_checksum *checksum, struct aws_allocator *allocator) {
+    enum aws_napi_checksum_algorithm algorithm = checksum->algorithm;
+    aws_napi_running_checksum_clean_up(checksum);
+    return aws_napi_running_checksum_init(checksum, allocator, algorithm);
+}
+
+napi_status aws_napi_running_checksum_finalize(
+    struct aws_napi_running_checksum *checksum,
+    napi_env env,
+    napi_value *result) {
+
+    switch (checksum->algorithm) {
+        case AWS_NAPI_CHECKSUM_CRC32C:
+            checksum->finalized = true;
+            return napi_create_uint32(env, checksum->crc, result);
+        case AWS_NAPI_CHECKSUM_SHA256: {
+            const size_t digest_size = checksum->hash->digest_size;
+            AWS_FATAL_ASSERT(digest_size <= sizeof(checksum->digest));
+            if (!checksum->finalized) {
+                struct aws_byte_buf digest_buf = aws_byte_buf_from_empty_array(checksum->digest, digest_size);
+                if (aws_hash_finalize(checksum->hash, &digest_buf, digest_size)) {
+                    return napi_generic_failure;
+                }
+                checksum->finalized = true;
+            }
+
+            napi_value arraybuffer = NULL;
+            void *data = NULL;
+            AWS_NAPI_CALL(env, napi_create_arraybuffer(env, digest_size, &data, &arraybuffer), { return status; });
+            memcpy(data, checksum->digest, digest_size);
+            return napi_create_dataview(env, digest_size, arraybuffer, 0, result);
+        }
+        default:
+            return napi_get_undefined(env, result);
+    }
+}
@@ -7,7 +7,56 @@
 
 #include "module.h"
 
+#include <aws/cal/hash.h>
+
+enum aws_napi_checksum_algorithm {
+    AWS_NAPI_CHECKSUM_NONE,
+    AWS_NAPI_CHECKSUM_CRC32C,
+    AWS_NAPI_CHECKSUM_SHA256,
+};
+
+/* A checksum updated as data streams past, so the data needs no second pass */
+struct aws_napi_running_checksum {
+    enum aws_napi_checksum_algorithm algorithm;
+    uint32_t crc;
+    struct aws_hash *hash;
+    bool finalized;
+    uint8_t digest[AWS_SHA256_LEN]; /* the SHA256 once finalized */
+};
+
+/* Parses 'crc32c', 'sha256' or undefined (AWS_NAPI_CHECKSUM_NONE), throws and returns false on anything else */
+bool aws_napi_checksum_algorithm_from_napi(
+    napi_env env,
+    napi_value node_algorithm,
+    enum aws_napi_checksum_algorithm *out_algorithm);
+
+int aws_napi_running_checksum_init(
+    struct aws_napi_running_checksum *checksum,
+    struct aws_allocator *allocator,
+    enum aws_napi_checksum_algorithm algorithm);
+void aws_napi_running_checksum_clean_up(struct aws_napi_running_checksum *checksum);
+
+int aws_napi_running_checksum_update(struct aws_napi_running_checksum *checksum, struct aws_byte_cursor data);
+
+/* Starts the checksum over, as when the data it covers is rewound */
+int aws_napi_running_checksum_reset(struct aws_napi_running_checksum *checksum, struct aws_allocator *allocator);
+
+/*
+ * Finishes the checksum, as a number for CRC32C or a DataView of the digest for SHA256. result is undefined if there
+ * is no checksum. Finalizing again gives the same result, but the checksum can't be updated again until it is reset.
+ */
+napi_status aws_napi_running_checksum_finalize(
+    struct aws_napi_running_checksum *checksum,
+    napi_env env,
+    napi_value *result);
+
 napi_value aws_napi_checksums_crc32(napi_env env, napi_callback_info info);
 napi_value aws_napi_checksums_crc32c(napi_env env, napi_callback_info info);
+napi_value aws_napi_checksums_crc32_async(napi_env env, napi_callback_info info);
+napi_value aws_napi_checksums_crc32c_async(napi_env env, napi_callback_info info);
+napi_value aws_napi_checksums_crc32_combine(napi_env env, napi_callback_info info);
+napi_value aws_napi_checksums_crc32c_combine(napi_env env, napi_callback_info info);
+napi_value aws_napi_checksums_crc32_parts_async(napi_env env, napi_callback_info info);
+napi_value aws_napi_checksums_crc32c_parts_async(napi_env env, napi_callback_info info);
 
 #endif /* AWS_CRT_NODEJS_CHECKSUMS_H */
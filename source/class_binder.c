@@ -68,7 +68,15 @@ static napi_status s_argument_parse(
         }
 
         case napi_string: {
-            AWS_NAPI_CALL(env, aws_byte_buf_init_from_napi(&out_value->native.string, env, value), { return status; });
+            AWS_NAPI_CALL(
+                env,
+                aws_byte_buf_init_from_napi_with_storage(
+                    &out_value->native.string,
+                    env,
+                    value,
+                    out_value->string_storage,
+                    sizeof(out_value->string_storage)),
+                { return status; });
 
             break;
         }
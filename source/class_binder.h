@@ -9,6 +9,7 @@
 
 /* Increment this as you find functions that require more arguments */
 #define AWS_NAPI_METHOD_MAX_ARGS 9
+#define AWS_NAPI_ARGUMENT_STRING_STORAGE_SIZE 64
 
 /**
  * Expected to be stored statically, but is for internal usage only.
@@ -29,6 +30,8 @@ struct aws_napi_argument {
         struct aws_byte_buf string;
         void *external;
     } native;
+    /* Short string arguments are converted here, so most calls don't need an allocation */
+    uint8_t string_storage[AWS_NAPI_ARGUMENT_STRING_STORAGE_SIZE];
 };
 
 /**
@@ -0,0 +1,211 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include "credentials_cache.h"
+
+#include <aws/auth/credentials.h>
+#include <aws/common/clock.h>
+#include <aws/common/linked_list.h>
+#include <aws/common/mutex.h>
+
+struct credentials_cache {
+    struct aws_allocator *allocator;
+    /* The delegate provider this is the implementation of, not referenced: it owns the cache */
+    struct aws_credentials_provider *provider;
+    struct aws_credentials_provider *source;
+    uint64_t refresh_ahead_ns;
+    uint64_t max_age_ns;
+
+    struct {
+        struct aws_mutex lock;
+        struct aws_credentials *credentials;
+        /* Wall clock times, in the same units as the credentials' expiration */
+        uint64_t refresh_at_ns;
+        uint64_t expires_at_ns;
+        bool fetch_in_flight;
+        /* struct credentials_query, waiting on the fetch in flight */
+        struct aws_linked_list pending_queries;
+    } synced_data;
+};
+
+struct credentials_query {
+    struct aws_linked_list_node node;
+    aws_on_get_credentials_callback_fn *callback;
+    void *user_data;
+};
+
+static uint64_t s_now_ns(void) {
+    uint64_t now = 0;
+    aws_sys_clock_get_ticks(&now);
+    return now;
+}
+
+static uint64_t s_saturating_add(uint64_t a, uint64_t b) {
+    return (a > UINT64_MAX - b) ? UINT64_MAX : a + b;
+}
+
+/* must be called with the lock held */
+static struct aws_credentials *s_acquire_usable_credentials(struct credentials_cache *cache, uint64_t now) {
+    if (cache->synced_data.credentials && now < cache->synced_data.expires_at_ns) {
+        aws_credentials_acquire(cache->synced_data.credentials);
+        return cache->synced_data.credentials;
+    }
+    return NULL;
+}
+
+static void s_on_credentials_fetched(struct aws_credentials *credentials, int error_code, void *user_data) {
+    struct credentials_cache *cache = user_data;
+    const uint64_t now = s_now_ns();
+
+    struct aws_linked_list queries;
+    aws_linked_list_init(&queries);
+
+    aws_mutex_lock(&cache->synced_data.lock);
+    if (credentials) {
+        aws_credentials_acquire(credentials);
+        aws_credentials_release(cache->synced_data.credentials);
+        cache->synced_data.credentials = credentials;
+
+        const uint64_t expiration_secs = aws_credentials_get_expiration_timepoint_seconds(credentials);
+        if (expiration_secs == UINT64_MAX) {
+            cache->synced_data.expires_at_ns = UINT64_MAX;
+            cache->synced_data.refresh_at_ns = s_saturating_add(now, cache->max_age_ns);
+        } else {
+            cache->synced_data.expires_at_ns =
+                aws_timestamp_convert(expiration_secs, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+            cache->synced_data.refresh_at_ns = cache->synced_data.expires_at_ns > cache->refresh_ahead_ns
+                                                   ? cache->synced_data.expires_at_ns - cache->refresh_ahead_ns
+                                                   : 0;
+        }
+    }
+    /* If the fetch failed, credentials that haven't expired yet are still better than nothing */
+    struct aws_credentials *result = s_acquire_usable_credentials(cache, now);
+    cache->synced_data.fetch_in_flight = false;
+    aws_linked_list_swap_contents(&queries, &cache->synced_data.pending_queries);
+    aws_mutex_unlock(&cache->synced_data.lock);
+
+    if (!result && error_code == AWS_ERROR_SUCCESS) {
+        error_code = AWS_AUTH_CREDENTIALS_PROVIDER_SOURCE_FAILURE;
+    }
+
+    while (!aws_linked_list_empty(&queries)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&queries);
+        struct credentials_query *query = AWS_CONTAINER_OF(node, struct credentials_query, node);
+        query->callback(result, result ? AWS_ERROR_SUCCESS : error_code, query->user_data);
+        aws_mem_release(cache->allocator, query);
+    }
+
+    aws_credentials_release(result);
+
+    /* Taken when the fetch started */
+    aws_credentials_provider_release(cache->provider);
+}
+
+/* fetch_in_flight must have been set by the caller */
+static void s_fetch_credentials(struct credentials_cache *cache) {
+    /* The cache can't be destroyed with a fetch in flight */
+    aws_credentials_provider_acquire(cache->provider);
+
+    if (aws_credentials_provider_get_credentials(cache->source, s_on_credentials_fetched, cache)) {
+        s_on_credentials_fetched(NULL, aws_last_error(), cache);
+    }
+}
+
+static int s_cache_get_credentials(
+    void *delegate_user_data,
+    aws_on_get_credentials_callback_fn callback,
+    void *callback_user_data) {
+
+    struct credentials_cache *cache = delegate_user_data;
+    const uint64_t now = s_now_ns();
+
+    aws_mutex_lock(&cache->synced_data.lock);
+    struct aws_credentials *credentials = s_acquire_usable_credentials(cache, now);
+    bool start_fetch = false;
+    if (credentials) {
+        /* Close to expiry, answer from the cache and refresh in the background */
+        start_fetch = now >= cache->synced_data.refresh_at_ns && !cache->synced_data.fetch_in_flight;
+    } else {
+        struct credentials_query *query = aws_mem_calloc(cache->allocator, 1, sizeof(struct credentials_query));
+        if (!query) {
+            aws_mutex_unlock(&cache->synced_data.lock);
+            return AWS_OP_ERR;
+        }
+        query->callback = callback;
+        query->user_data = callback_user_data;
+        aws_linked_list_push_back(&cache->synced_data.pending_queries, &query->node);
+        start_fetch = !cache->synced_data.fetch_in_flight;
+    }
+    if (start_fetch) {
+        cache->synced_data.fetch_in_flight = true;
+    }
+    aws_mutex_unlock(&cache->synced_data.lock);
+
+    if (credentials) {
+        callback(credentials, AWS_ERROR_SUCCESS, callback_user_data);
+        aws_credentials_release(credentials);
+    }
+
+    if (start_fetch) {
+        s_fetch_credentials(cache);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_cache_destroy(void *user_data) {
+    struct credentials_cache *cache = user_data;
+
+    AWS_FATAL_ASSERT(aws_linked_list_empty(&cache->synced_data.pending_queries));
+    aws_credentials_release(cache->synced_data.credentials);
+    aws_credentials_provider_release(cache->source);
+    aws_mutex_clean_up(&cache->synced_data.lock);
+    aws_mem_release(cache->allocator, cache);
+}
+
+struct aws_credentials_provider *aws_napi_credentials_cache_new(
+    struct aws_allocator *allocator,
+    const struct aws_napi_credentials_cache_options *options) {
+
+    AWS_FATAL_ASSERT(options->source);
+
+    struct credentials_cache *cache = aws_mem_calloc(allocator, 1, sizeof(struct credentials_cache));
+    if (!cache) {
+        return NULL;
+    }
+
+    cache->allocator = allocator;
+    cache->refresh_ahead_ns =
+        aws_timestamp_convert(options->refresh_ahead_ms, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+    cache->max_age_ns = aws_timestamp_convert(options->max_age_ms, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+    aws_mutex_init(&cache->synced_data.lock);
+    aws_linked_list_init(&cache->synced_data.pending_queries);
+
+    struct aws_credentials_provider_delegate_options delegate_options = {
+        .shutdown_options =
+            {
+                .shutdown_callback = s_cache_destroy,
+                .shutdown_user_data = cache,
+            },
+        .get_credentials = s_cache_get_credentials,
+        .delegate_user_data = cache,
+    };
+    cache->provider = aws_credentials_provider_new_delegate(allocator, &delegate_options);
+    if (!cache->provider) {
+        aws_mutex_clean_up(&cache->synced_data.lock);
+        aws_mem_release(allocator, cache);
+        return NULL;
+    }
+
+    cache->source = options->source;
+    aws_credentials_provider_acquire(cache->source);
+
+    /* Start fetching straight away, so the first signers don't wait on the source */
+    aws_mutex_lock(&cache->synced_data.lock);
+    cache->synced_data.fetch_in_flight = true;
+    aws_mutex_unlock(&cache->synced_data.lock);
+    s_fetch_credentials(cache);
+
+    return cache->provider;
+}
@@ -0,0 +1,35 @@
+#ifndef AWS_CRT_NODEJS_CREDENTIALS_CACHE_H
+#define AWS_CRT_NODEJS_CREDENTIALS_CACHE_H
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "module.h"
+
+struct aws_credentials_provider;
+
+struct aws_napi_credentials_cache_options {
+    /* Provider credentials are fetched from, a reference is held for the life of the cache */
+    struct aws_credentials_provider *source;
+
+    /*
+     * How long before credentials expire to start fetching new ones. Queries in this window are answered from the
+     * cache while the fetch happens in the background.
+     */
+    uint64_t refresh_ahead_ms;
+
+    /* How often to refresh credentials that never expire, such as static or environment credentials */
+    uint64_t max_age_ms;
+};
+
+/**
+ * Creates a provider that caches the credentials from options->source and shares them between all of its callers.
+ * Queries made while no usable credentials are cached wait on a single fetch from the source, rather than each
+ * starting their own. The first fetch is started immediately, so credentials are usually ready before they're needed.
+ */
+struct aws_credentials_provider *aws_napi_credentials_cache_new(
+    struct aws_allocator *allocator,
+    const struct aws_napi_credentials_cache_options *options);
+
+#endif /* AWS_CRT_NODEJS_CREDENTIALS_CACHE_H */
@@ -4,164 +4,305 @@
  */
 #include "crypto.h"
 
+#include "async_work.h"
+
 #include <aws/cal/hash.h>
 #include <aws/cal/hmac.h>
 
-/*******************************************************************************
- * Hash
- ******************************************************************************/
-
-/** Finalizer for an hash external */
-static void s_hash_finalize(napi_env env, void *finalize_data, void *finalize_hint) {
+/*
+ * The streaming hash and hmac objects below share their argument handling, with update/finalize adapted to these
+ * signatures
+ */
+typedef int(hasher_update_fn)(void *hasher, const struct aws_byte_cursor *data);
+typedef int(hasher_finalize_fn)(void *hasher, struct aws_byte_buf *output, size_t truncate_to);
 
-    (void)env;
-    (void)finalize_hint;
+/* Reads an optional truncate_to argument, returning the number of digest bytes to produce or 0 having thrown */
+static size_t s_get_digest_size(napi_env env, napi_value node_truncate_to, size_t digest_size) {
+    if (!aws_napi_is_null_or_undefined(env, node_truncate_to)) {
 
-    struct aws_hash *hash = finalize_data;
-    AWS_ASSERT(hash);
+        uint32_t truncate_to = 0;
+        if (napi_get_value_uint32(env, node_truncate_to, &truncate_to)) {
+            napi_throw_type_error(env, NULL, "truncate_to argument must be undefined or a positive number");
+            return 0;
+        }
 
-    aws_hash_destroy(hash);
+        if (truncate_to > 0 && digest_size > truncate_to) {
+            digest_size = truncate_to;
+        }
+    }
+    return digest_size;
 }
 
-napi_value aws_napi_hash_md5_new(napi_env env, napi_callback_info info) {
+/* Feeds one string or buffer to the hasher, buffers are hashed in place */
+static bool s_hasher_update(napi_env env, napi_value node_data, hasher_update_fn *update_fn, void *hasher) {
+    uint8_t to_hash_storage[AWS_NAPI_SMALL_STRING_SIZE];
+    struct aws_byte_buf to_hash;
+    if (aws_byte_buf_init_from_napi_with_storage(&to_hash, env, node_data, to_hash_storage, sizeof(to_hash_storage))) {
+        napi_throw_type_error(env, NULL, "data to hash must be a string or array");
+        return false;
+    }
 
-    (void)info;
-    struct aws_allocator *allocator = aws_napi_get_allocator();
+    struct aws_byte_cursor to_hash_cur = aws_byte_cursor_from_buf(&to_hash);
+    bool success = update_fn(hasher, &to_hash_cur) == AWS_OP_SUCCESS;
+    if (!success) {
+        aws_napi_throw_last_error(env);
+    }
 
-    struct aws_hash *hash = aws_md5_new(allocator);
-    if (!hash) {
-        return NULL;
+    aws_byte_buf_clean_up(&to_hash);
+    return success;
+}
+
+/* Feeds every element of an array to the hasher, in order, so a message in several parts takes one call */
+static void s_hasher_update_many(napi_env env, napi_value node_array, hasher_update_fn *update_fn, void *hasher) {
+    uint32_t num_parts = 0;
+    if (napi_get_array_length(env, node_array, &num_parts)) {
+        napi_throw_type_error(env, NULL, "data to hash must be an array of strings or arrays");
+        return;
     }
 
-    napi_value node_external = NULL;
-    if (napi_create_external(env, hash, s_hash_finalize, NULL, &node_external)) {
-        napi_throw_error(env, NULL, "Failed create n-api external");
+    for (uint32_t i = 0; i < num_parts; ++i) {
+        napi_value node_part = NULL;
+        AWS_NAPI_ENSURE(env, napi_get_element(env, node_array, i, &node_part));
+        if (!s_hasher_update(env, node_part, update_fn, hasher)) {
+            return;
+        }
     }
-    return node_external;
 }
 
-napi_value aws_napi_hash_sha1_new(napi_env env, napi_callback_info info) {
+/* Writes the digest to the start of a caller's buffer rather than a new one, returning the number of bytes written */
+static napi_value s_hasher_finalize_into(
+    napi_env env,
+    napi_value node_output,
+    napi_value node_truncate_to,
+    size_t digest_size,
+    hasher_finalize_fn *finalize_fn,
+    void *hasher) {
 
-    (void)info;
-    struct aws_allocator *allocator = aws_napi_get_allocator();
+    napi_valuetype output_type = napi_undefined;
+    AWS_NAPI_ENSURE(env, napi_typeof(env, node_output, &output_type));
 
-    struct aws_hash *hash = aws_sha1_new(allocator);
-    if (!hash) {
+    struct aws_byte_buf output;
+    AWS_ZERO_STRUCT(output);
+    if (output_type != napi_object || aws_byte_buf_init_from_napi(&output, env, node_output)) {
+        napi_throw_type_error(env, NULL, "output must be an ArrayBuffer, DataView or TypedArray");
         return NULL;
     }
 
-    napi_value node_external = NULL;
-    if (napi_create_external(env, hash, s_hash_finalize, NULL, &node_external)) {
-        napi_throw_error(env, NULL, "Failed create n-api external");
+    digest_size = s_get_digest_size(env, node_truncate_to, digest_size);
+    if (digest_size == 0) {
+        return NULL;
     }
-    return node_external;
+    if (output.len < digest_size) {
+        napi_throw_range_error(env, NULL, "output is too small for the digest");
+        return NULL;
+    }
+
+    /* output references the caller's memory */
+    struct aws_byte_buf out_buf = aws_byte_buf_from_empty_array(output.buffer, digest_size);
+    if (finalize_fn(hasher, &out_buf, digest_size)) {
+        aws_napi_throw_last_error(env);
+        return NULL;
+    }
+
+    napi_value node_written = NULL;
+    AWS_NAPI_ENSURE(env, napi_create_uint32(env, (uint32_t)out_buf.len, &node_written));
+    return node_written;
 }
 
-napi_value aws_napi_hash_sha256_new(napi_env env, napi_callback_info info) {
+/* Returns the digest as a DataView, or NULL having thrown */
+static napi_value s_hasher_finalize(
+    napi_env env,
+    napi_value node_truncate_to,
+    size_t digest_size,
+    hasher_finalize_fn *finalize_fn,
+    void *hasher) {
 
-    (void)info;
-    struct aws_allocator *allocator = aws_napi_get_allocator();
+    digest_size = s_get_digest_size(env, node_truncate_to, digest_size);
+    if (digest_size == 0) {
+        return NULL;
+    }
 
-    struct aws_hash *hash = aws_sha256_new(allocator);
-    if (!hash) {
+    napi_value arraybuffer;
+    void *data = NULL;
+    if (napi_create_arraybuffer(env, digest_size, &data, &arraybuffer)) {
+        napi_throw_error(env, NULL, "Failed to create output arraybuffer");
         return NULL;
     }
 
-    napi_value node_external = NULL;
-    if (napi_create_external(env, hash, s_hash_finalize, NULL, &node_external)) {
-        napi_throw_error(env, NULL, "Failed create n-api external");
+    struct aws_byte_buf out_buf = aws_byte_buf_from_empty_array(data, digest_size);
+    if (finalize_fn(hasher, &out_buf, digest_size)) {
+        aws_napi_throw_last_error(env);
+        return NULL;
     }
-    return node_external;
+
+    napi_value dataview;
+    if (napi_create_dataview(env, digest_size, arraybuffer, 0, &dataview)) {
+        napi_throw_error(env, NULL, "Failed to create output dataview");
+        return NULL;
+    }
+
+    return dataview;
 }
 
-napi_value aws_napi_hash_update(napi_env env, napi_callback_info info) {
+/* Checks the argument count and extracts the binding from the first argument, throwing and returning NULL on failure */
+static void *s_get_binding_args(
+    napi_env env,
+    napi_callback_info info,
+    napi_value *node_args,
+    size_t expected_args,
+    const char *arity_error) {
 
-    napi_value node_args[2];
-    size_t num_args = AWS_ARRAY_SIZE(node_args);
+    size_t num_args = expected_args;
     if (napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL)) {
         napi_throw_error(env, NULL, "Failed to retreive callback information");
         return NULL;
     }
-    if (num_args != AWS_ARRAY_SIZE(node_args)) {
-        napi_throw_error(env, NULL, "hash_update needs exactly 2 arguments");
+    if (num_args != expected_args) {
+        napi_throw_error(env, NULL, arity_error);
         return NULL;
     }
 
-    struct aws_hash *hash = NULL;
-    if (napi_get_value_external(env, node_args[0], (void **)&hash)) {
+    void *binding = NULL;
+    if (napi_get_value_external(env, node_args[0], &binding)) {
         napi_throw_error(env, NULL, "Failed to extract hash from first argument");
         return NULL;
     }
+    return binding;
+}
 
-    struct aws_byte_buf to_hash;
-    if (aws_byte_buf_init_from_napi(&to_hash, env, node_args[1])) {
-        napi_throw_type_error(env, NULL, "to_hash argument must be a string or array");
-        return NULL;
-    }
+/*******************************************************************************
+ * Hash
+ ******************************************************************************/
 
-    struct aws_byte_cursor to_hash_cur = aws_byte_cursor_from_buf(&to_hash);
-    if (aws_hash_update(hash, &to_hash_cur)) {
-        aws_napi_throw_last_error(env);
-    }
+typedef struct aws_hash *(hash_new_fn)(struct aws_allocator *allocator);
 
-    aws_byte_buf_clean_up(&to_hash);
+/* cal hashes can't be used again once finalized, so resetting swaps in a new one behind the same external */
+struct hash_binding {
+    struct aws_allocator *allocator;
+    hash_new_fn *new_fn;
+    struct aws_hash *hash;
+};
 
-    return NULL;
+/** Finalizer for an hash external */
+static void s_hash_finalize(napi_env env, void *finalize_data, void *finalize_hint) {
+
+    (void)env;
+    (void)finalize_hint;
+
+    struct hash_binding *binding = finalize_data;
+    AWS_ASSERT(binding);
+
+    aws_hash_destroy(binding->hash);
+    aws_mem_release(binding->allocator, binding);
 }
 
-napi_value aws_napi_hash_digest(napi_env env, napi_callback_info info) {
+static napi_value s_hash_new(napi_env env, hash_new_fn *new_fn) {
 
-    napi_value node_args[2];
-    size_t num_args = AWS_ARRAY_SIZE(node_args);
-    if (napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL)) {
-        napi_throw_error(env, NULL, "Failed to retreive callback information");
+    struct aws_allocator *allocator = aws_napi_get_allocator();
+
+    struct hash_binding *binding = aws_mem_calloc(allocator, 1, sizeof(struct hash_binding));
+    if (!binding) {
+        aws_napi_throw_last_error(env);
         return NULL;
     }
-    if (num_args != AWS_ARRAY_SIZE(node_args)) {
-        napi_throw_error(env, NULL, "hash_digest needs exactly 2 arguments");
+    binding->allocator = allocator;
+    binding->new_fn = new_fn;
+
+    binding->hash = new_fn(allocator);
+    if (!binding->hash) {
+        aws_napi_throw_last_error(env);
+        aws_mem_release(allocator, binding);
         return NULL;
     }
 
-    struct aws_hash *hash = NULL;
-    if (napi_get_value_external(env, node_args[0], (void **)&hash)) {
-        napi_throw_error(env, NULL, "Failed to extract hash from first argument");
-        return NULL;
+    napi_value node_external = NULL;
+    if (napi_create_external(env, binding, s_hash_finalize, NULL, &node_external)) {
+        napi_throw_error(env, NULL, "Failed create n-api external");
+        s_hash_finalize(env, binding, NULL);
     }
+    return node_external;
+}
 
-    size_t digest_size = hash->digest_size;
-    if (!aws_napi_is_null_or_undefined(env, node_args[1])) {
+napi_value aws_napi_hash_md5_new(napi_env env, napi_callback_info info) {
+    (void)info;
+    return s_hash_new(env, aws_md5_new);
+}
 
-        uint32_t truncate_to = 0;
-        if (napi_get_value_uint32(env, node_args[1], &truncate_to)) {
-            napi_throw_type_error(env, NULL, "truncate_to argument must be undefined or a positive number");
-            return NULL;
-        }
+napi_value aws_napi_hash_sha1_new(napi_env env, napi_callback_info info) {
+    (void)info;
+    return s_hash_new(env, aws_sha1_new);
+}
 
-        if (digest_size > truncate_to) {
-            digest_size = truncate_to;
-        }
+napi_value aws_napi_hash_sha256_new(napi_env env, napi_callback_info info) {
+    (void)info;
+    return s_hash_new(env, aws_sha256_new);
+}
+
+static int s_hash_update_fn(void *hasher, const struct aws_byte_cursor *data) {
+    return aws_hash_update(hasher, data);
+}
+
+static int s_hash_finalize_fn(void *hasher, struct aws_byte_buf *output, size_t truncate_to) {
+    return aws_hash_finalize(hasher, output, truncate_to);
+}
+
+napi_value aws_napi_hash_update(napi_env env, napi_callback_info info) {
+    napi_value node_args[2];
+    struct hash_binding *binding = s_get_binding_args(
+        env, info, node_args, AWS_ARRAY_SIZE(node_args), "hash_update needs exactly 2 arguments");
+    if (binding) {
+        s_hasher_update(env, node_args[1], s_hash_update_fn, binding->hash);
     }
+    return NULL;
+}
 
-    napi_value arraybuffer;
-    void *data = NULL;
-    if (napi_create_arraybuffer(env, digest_size, &data, &arraybuffer)) {
-        napi_throw_error(env, NULL, "Failed to create output arraybuffer");
+napi_value aws_napi_hash_update_many(napi_env env, napi_callback_info info) {
+    napi_value node_args[2];
+    struct hash_binding *binding = s_get_binding_args(
+        env, info, node_args, AWS_ARRAY_SIZE(node_args), "hash_update_many needs exactly 2 arguments");
+    if (binding) {
+        s_hasher_update_many(env, node_args[1], s_hash_update_fn, binding->hash);
+    }
+    return NULL;
+}
+
+napi_value aws_napi_hash_digest(napi_env env, napi_callback_info info) {
+    napi_value node_args[2];
+    struct hash_binding *binding = s_get_binding_args(
+        env, info, node_args, AWS_ARRAY_SIZE(node_args), "hash_digest needs exactly 2 arguments");
+    if (!binding) {
         return NULL;
     }
+    return s_hasher_finalize(env, node_args[1], binding->hash->digest_size, s_hash_finalize_fn, binding->hash);
+}
 
-    struct aws_byte_buf out_buf = aws_byte_buf_from_empty_array(data, digest_size);
-    if (aws_hash_finalize(hash, &out_buf, digest_size)) {
-        aws_napi_throw_last_error(env);
+napi_value aws_napi_hash_digest_into(napi_env env, napi_callback_info info) {
+    napi_value node_args[3];
+    struct hash_binding *binding = s_get_binding_args(
+        env, info, node_args, AWS_ARRAY_SIZE(node_args), "hash_digest_into needs exactly 3 arguments");
+    if (!binding) {
         return NULL;
     }
+    return s_hasher_finalize_into(
+        env, node_args[1], node_args[2], binding->hash->digest_size, s_hash_finalize_fn, binding->hash);
+}
 
-    napi_value dataview;
-    if (napi_create_dataview(env, digest_size, arraybuffer, 0, &dataview)) {
-        napi_throw_error(env, NULL, "Failed to create output dataview");
+napi_value aws_napi_hash_reset(napi_env env, napi_callback_info info) {
+    napi_value node_args[1];
+    struct hash_binding *binding = s_get_binding_args(
+        env, info, node_args, AWS_ARRAY_SIZE(node_args), "hash_reset needs exactly 1 argument");
+    if (!binding) {
         return NULL;
     }
 
-    return dataview;
+    struct aws_hash *hash = binding->new_fn(binding->allocator);
+    if (!hash) {
+        aws_napi_throw_last_error(env);
+        return NULL;
+    }
+    aws_hash_destroy(binding->hash);
+    binding->hash = hash;
+    return NULL;
 }
 
 napi_value aws_napi_hash_md5_compute(napi_env env, napi_callback_info info) {
@@ -177,45 +318,41 @@ napi_value aws_napi_hash_md5_compute(napi_env env, napi_callback_info info) {
         return NULL;
     }
 
+    uint8_t to_hash_storage[AWS_NAPI_SMALL_STRING_SIZE];
     struct aws_byte_buf to_hash;
-    if (aws_byte_buf_init_from_napi(&to_hash, env, node_args[0])) {
+    if (aws_byte_buf_init_from_napi_with_storage(
+            &to_hash, env, node_args[0], to_hash_storage, sizeof(to_hash_storage))) {
         napi_throw_type_error(env, NULL, "to_hash argument must be a string or array");
         return NULL;
     }
 
-    size_t digest_size = AWS_MD5_LEN;
-    if (!aws_napi_is_null_or_undefined(env, node_args[1])) {
-
-        uint32_t truncate_to = 0;
-        if (napi_get_value_uint32(env, node_args[1], &truncate_to)) {
-            napi_throw_type_error(env, NULL, "truncate_to argument must be undefined or a positive number");
-            return NULL;
-        }
-
-        if (digest_size > truncate_to) {
-            digest_size = truncate_to;
-        }
+    const size_t digest_size = s_get_digest_size(env, node_args[1], AWS_MD5_LEN);
+    if (digest_size == 0) {
+        aws_byte_buf_clean_up(&to_hash);
+        return NULL;
     }
 
+    napi_value dataview = NULL;
     napi_value arraybuffer;
     void *data = NULL;
     if (napi_create_arraybuffer(env, digest_size, &data, &arraybuffer)) {
         napi_throw_error(env, NULL, "Failed to create output arraybuffer");
-        return NULL;
+        goto done;
     }
 
     struct aws_byte_cursor to_hash_cur = aws_byte_cursor_from_buf(&to_hash);
     struct aws_byte_buf out_buf = aws_byte_buf_from_empty_array(data, digest_size);
     if (aws_md5_compute(aws_napi_get_allocator(), &to_hash_cur, &out_buf, digest_size)) {
         aws_napi_throw_last_error(env);
+        goto done;
     }
 
-    napi_value dataview;
     if (napi_create_dataview(env, digest_size, arraybuffer, 0, &dataview)) {
         napi_throw_error(env, NULL, "Failed to create output dataview");
-        return NULL;
+        dataview = NULL;
     }
 
+done:
     aws_byte_buf_clean_up(&to_hash);
 
     return dataview;
@@ -234,45 +371,41 @@ napi_value aws_napi_hash_sha256_compute(napi_env env, napi_callback_info info) {
         return NULL;
     }
 
+    uint8_t to_hash_storage[AWS_NAPI_SMALL_STRING_SIZE];
     struct aws_byte_buf to_hash;
-    if (aws_byte_buf_init_from_napi(&to_hash, env, node_args[0])) {
+    if (aws_byte_buf_init_from_napi_with_storage(
+            &to_hash, env, node_args[0], to_hash_storage, sizeof(to_hash_storage))) {
         napi_throw_type_error(env, NULL, "to_hash argument must be a string or array");
         return NULL;
     }
 
-    size_t digest_size = AWS_MD5_LEN;
-    if (!aws_napi_is_null_or_undefined(env, node_args[1])) {
-
-        uint32_t truncate_to = 0;
-        if (napi_get_value_uint32(env, node_args[1], &truncate_to)) {
-            napi_throw_type_error(env, NULL, "truncate_to argument must be undefined or a positive number");
-            return NULL;
-        }
-
-        if (digest_size > truncate_to) {
-            digest_size = truncate_to;
-        }
+    const size_t digest_size = s_get_digest_size(env, node_args[1], AWS_SHA256_LEN);
+    if (digest_size == 0) {
+        aws_byte_buf_clean_up(&to_hash);
+        return NULL;
     }
 
+    napi_value dataview = NULL;
     napi_value arraybuffer;
     void *data = NULL;
     if (napi_create_arraybuffer(env, digest_size, &data, &arraybuffer)) {
         napi_throw_error(env, NULL, "Failed to create output arraybuffer");
-        return NULL;
+        goto done;
     }
 
     struct aws_byte_cursor to_hash_cur = aws_byte_cursor_from_buf(&to_hash);
     struct aws_byte_buf out_buf = aws_byte_buf_from_empty_array(data, digest_size);
     if (aws_sha256_compute(aws_napi_get_allocator(), &to_hash_cur, &out_buf, digest_size)) {
         aws_napi_throw_last_error(env);
+        goto done;
     }
 
-    napi_value dataview;
     if (napi_create_dataview(env, digest_size, arraybuffer, 0, &dataview)) {
         napi_throw_error(env, NULL, "Failed to create output dataview");
-        return NULL;
+        dataview = NULL;
     }
 
+done:
     aws_byte_buf_clean_up(&to_hash);
 
     return dataview;
@@ -291,45 +424,41 @@ napi_value aws_napi_hash_sha1_compute(napi_env env, napi_callback_info info) {
         return NULL;
     }
 
+    uint8_t to_hash_storage[AWS_NAPI_SMALL_STRING_SIZE];
     struct aws_byte_buf to_hash;
-    if (aws_byte_buf_init_from_napi(&to_hash, env, node_args[0])) {
+    if (aws_byte_buf_init_from_napi_with_storage(
+            &to_hash, env, node_args[0], to_hash_storage, sizeof(to_hash_storage))) {
         napi_throw_type_error(env, NULL, "to_hash argument must be a string or array");
         return NULL;
     }
 
-    size_t digest_size = AWS_MD5_LEN;
-    if (!aws_napi_is_null_or_undefined(env, node_args[1])) {
-
-        uint32_t truncate_to = 0;
-        if (napi_get_value_uint32(env, node_args[1], &truncate_to)) {
-            napi_throw_type_error(env, NULL, "truncate_to argument must be undefined or a positive number");
-            return NULL;
-        }
-
-        if (digest_size > truncate_to) {
-            digest_size = truncate_to;
-        }
+    const size_t digest_size = s_get_digest_size(env, node_args[1], AWS_SHA1_LEN);
+    if (digest_size == 0) {
+        aws_byte_buf_clean_up(&to_hash);
+        return NULL;
     }
 
+    napi_value dataview = NULL;
     napi_value arraybuffer;
     void *data = NULL;
     if (napi_create_arraybuffer(env, digest_size, &data, &arraybuffer)) {
         napi_throw_error(env, NULL, "Failed to create output arraybuffer");
-        return NULL;
+        goto done;
     }
 
     struct aws_byte_cursor to_hash_cur = aws_byte_cursor_from_buf(&to_hash);
     struct aws_byte_buf out_buf = aws_byte_buf_from_empty_array(data, digest_size);
     if (aws_sha1_compute(aws_napi_get_allocator(), &to_hash_cur, &out_buf, digest_size)) {
         aws_napi_throw_last_error(env);
+        goto done;
     }
 
-    napi_value dataview;
     if (napi_create_dataview(env, digest_size, arraybuffer, 0, &dataview)) {
         napi_throw_error(env, NULL, "Failed to create output dataview");
-        return NULL;
+        dataview = NULL;
     }
 
+done:
     aws_byte_buf_clean_up(&to_hash);
 
     return dataview;
@@ -339,21 +468,38 @@ napi_value aws_napi_hash_sha1_compute(napi_env env, napi_callback_info info) {
  * HMAC
  ******************************************************************************/
 
-/** Finalizer for an hash external */
+/* Only wipe secrets that were copied out of a string, buffers referenced in place belong to the caller */
+static void s_secret_clean_up(struct aws_byte_buf *secret, const uint8_t *storage) {
+    if (secret->allocator || secret->buffer == storage) {
+        aws_byte_buf_clean_up_secure(secret);
+    } else {
+        aws_byte_buf_clean_up(secret);
+    }
+}
+
+/* cal hmacs can't be used again once finalized, so resetting swaps in a new one keyed with the retained secret */
+struct hmac_binding {
+    struct aws_allocator *allocator;
+    struct aws_byte_buf secret;
+    struct aws_hmac *hmac;
+};
+
+/** Finalizer for an hmac external */
 static void s_hmac_finalize(napi_env env, void *finalize_data, void *finalize_hint) {
 
     (void)env;
     (void)finalize_hint;
 
-    struct aws_hmac *hmac = finalize_data;
-    AWS_ASSERT(hmac);
+    struct hmac_binding *binding = finalize_data;
+    AWS_ASSERT(binding);
 
-    aws_hmac_destroy(hmac);
+    aws_hmac_destroy(binding->hmac);
+    aws_byte_buf_clean_up_secure(&binding->secret);
+    aws_mem_release(binding->allocator, binding);
 }
 
 napi_value aws_napi_hmac_sha256_new(napi_env env, napi_callback_info info) {
 
-    (void)info;
     struct aws_allocator *allocator = aws_napi_get_allocator();
 
     napi_value node_args[1];
@@ -367,178 +513,323 @@ napi_value aws_napi_hmac_sha256_new(napi_env env, napi_callback_info info) {
         return NULL;
     }
 
+    uint8_t secret_storage[AWS_NAPI_SMALL_STRING_SIZE];
     struct aws_byte_buf secret;
-    if (aws_byte_buf_init_from_napi(&secret, env, node_args[0])) {
+    if (aws_byte_buf_init_from_napi_with_storage(
+            &secret, env, node_args[0], secret_storage, sizeof(secret_storage))) {
         napi_throw_type_error(env, NULL, "secret argument must be a string or array");
         return NULL;
     }
     struct aws_byte_cursor secret_cur = aws_byte_cursor_from_buf(&secret);
 
-    struct aws_hmac *hmac = aws_sha256_hmac_new(allocator, &secret_cur);
-    if (!hmac) {
-        aws_byte_buf_clean_up(&secret);
+    struct hmac_binding *binding = aws_mem_calloc(allocator, 1, sizeof(struct hmac_binding));
+    if (!binding) {
+        aws_napi_throw_last_error(env);
+        s_secret_clean_up(&secret, secret_storage);
+        return NULL;
+    }
+    binding->allocator = allocator;
+
+    /* the binding keeps a copy of the key to re-key on reset */
+    if (aws_byte_buf_init_copy_from_cursor(&binding->secret, allocator, secret_cur)) {
+        aws_napi_throw_last_error(env);
+        s_secret_clean_up(&secret, secret_storage);
+        aws_mem_release(allocator, binding);
+        return NULL;
+    }
+    s_secret_clean_up(&secret, secret_storage);
+
+    secret_cur = aws_byte_cursor_from_buf(&binding->secret);
+    binding->hmac = aws_sha256_hmac_new(allocator, &secret_cur);
+    if (!binding->hmac) {
+        aws_napi_throw_last_error(env);
+        s_hmac_finalize(env, binding, NULL);
         return NULL;
     }
 
     napi_value node_external = NULL;
-    if (napi_create_external(env, hmac, s_hmac_finalize, NULL, &node_external)) {
+    if (napi_create_external(env, binding, s_hmac_finalize, NULL, &node_external)) {
         napi_throw_error(env, NULL, "Failed create n-api external");
-        aws_hmac_destroy(hmac);
-        aws_byte_buf_clean_up_secure(&secret);
+        s_hmac_finalize(env, binding, NULL);
     }
     return node_external;
 }
 
+static int s_hmac_update_fn(void *hasher, const struct aws_byte_cursor *data) {
+    return aws_hmac_update(hasher, data);
+}
+
+static int s_hmac_finalize_fn(void *hasher, struct aws_byte_buf *output, size_t truncate_to) {
+    return aws_hmac_finalize(hasher, output, truncate_to);
+}
+
 napi_value aws_napi_hmac_update(napi_env env, napi_callback_info info) {
+    napi_value node_args[2];
+    struct hmac_binding *binding = s_get_binding_args(
+        env, info, node_args, AWS_ARRAY_SIZE(node_args), "hmac_update needs exactly 2 arguments");
+    if (binding) {
+        s_hasher_update(env, node_args[1], s_hmac_update_fn, binding->hmac);
+    }
+    return NULL;
+}
 
+napi_value aws_napi_hmac_update_many(napi_env env, napi_callback_info info) {
     napi_value node_args[2];
-    size_t num_args = AWS_ARRAY_SIZE(node_args);
-    if (napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL)) {
-        napi_throw_error(env, NULL, "Failed to retreive callback information");
-        return NULL;
+    struct hmac_binding *binding = s_get_binding_args(
+        env, info, node_args, AWS_ARRAY_SIZE(node_args), "hmac_update_many needs exactly 2 arguments");
+    if (binding) {
+        s_hasher_update_many(env, node_args[1], s_hmac_update_fn, binding->hmac);
     }
-    if (num_args != AWS_ARRAY_SIZE(node_args)) {
-        napi_throw_error(env, NULL, "hmac_update needs exactly 2 arguments");
+    return NULL;
+}
+
+napi_value aws_napi_hmac_digest(napi_env env, napi_callback_info info) {
+    napi_value node_args[2];
+    struct hmac_binding *binding = s_get_binding_args(
+        env, info, node_args, AWS_ARRAY_SIZE(node_args), "hmac_digest needs exactly 2 arguments");
+    if (!binding) {
         return NULL;
     }
+    return s_hasher_finalize(env, node_args[1], binding->hmac->digest_size, s_hmac_finalize_fn, binding->hmac);
+}
 
-    struct aws_hmac *hmac = NULL;
-    if (napi_get_value_external(env, node_args[0], (void **)&hmac)) {
-        napi_throw_error(env, NULL, "Failed to extract hmac from first argument");
+napi_value aws_napi_hmac_digest_into(napi_env env, napi_callback_info info) {
+    napi_value node_args[3];
+    struct hmac_binding *binding = s_get_binding_args(
+        env, info, node_args, AWS_ARRAY_SIZE(node_args), "hmac_digest_into needs exactly 3 arguments");
+    if (!binding) {
         return NULL;
     }
+    return s_hasher_finalize_into(
+        env, node_args[1], node_args[2], binding->hmac->digest_size, s_hmac_finalize_fn, binding->hmac);
+}
 
-    struct aws_byte_buf to_hash;
-    if (aws_byte_buf_init_from_napi(&to_hash, env, node_args[1])) {
-        napi_throw_type_error(env, NULL, "to_hmac argument must be a string or array");
+napi_value aws_napi_hmac_reset(napi_env env, napi_callback_info info) {
+    napi_value node_args[1];
+    struct hmac_binding *binding = s_get_binding_args(
+        env, info, node_args, AWS_ARRAY_SIZE(node_args), "hmac_reset needs exactly 1 argument");
+    if (!binding) {
         return NULL;
     }
 
-    struct aws_byte_cursor to_hash_cur = aws_byte_cursor_from_buf(&to_hash);
-    if (aws_hmac_update(hmac, &to_hash_cur)) {
+    struct aws_byte_cursor secret_cur = aws_byte_cursor_from_buf(&binding->secret);
+    struct aws_hmac *hmac = aws_sha256_hmac_new(binding->allocator, &secret_cur);
+    if (!hmac) {
         aws_napi_throw_last_error(env);
+        return NULL;
     }
-
-    aws_byte_buf_clean_up(&to_hash);
-
+    aws_hmac_destroy(binding->hmac);
+    binding->hmac = hmac;
     return NULL;
 }
 
-napi_value aws_napi_hmac_digest(napi_env env, napi_callback_info info) {
+napi_value aws_napi_hmac_sha256_compute(napi_env env, napi_callback_info info) {
 
-    napi_value node_args[2];
+    napi_value node_args[3];
     size_t num_args = AWS_ARRAY_SIZE(node_args);
     if (napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL)) {
         napi_throw_error(env, NULL, "Failed to retreive callback information");
         return NULL;
     }
     if (num_args != AWS_ARRAY_SIZE(node_args)) {
-        napi_throw_error(env, NULL, "hmac_digest needs exactly 2 arguments");
+        napi_throw_error(env, NULL, "hmac_sha256_compute needs exactly 3 arguments");
         return NULL;
     }
 
-    struct aws_hmac *hmac = NULL;
-    if (napi_get_value_external(env, node_args[0], (void **)&hmac)) {
-        napi_throw_error(env, NULL, "Failed to extract hmac from first argument");
+    uint8_t secret_storage[AWS_NAPI_SMALL_STRING_SIZE];
+    struct aws_byte_buf secret;
+    if (aws_byte_buf_init_from_napi_with_storage(
+            &secret, env, node_args[0], secret_storage, sizeof(secret_storage))) {
+        napi_throw_type_error(env, NULL, "secret argument must be a string or array");
         return NULL;
     }
+    struct aws_byte_cursor secret_cur = aws_byte_cursor_from_buf(&secret);
 
-    size_t digest_size = hmac->digest_size;
-    if (!aws_napi_is_null_or_undefined(env, node_args[1])) {
-
-        uint32_t truncate_to = 0;
-        if (napi_get_value_uint32(env, node_args[1], &truncate_to)) {
-            napi_throw_type_error(env, NULL, "truncate_to argument must be undefined or a positive number");
-            return NULL;
-        }
+    uint8_t to_hash_storage[AWS_NAPI_SMALL_STRING_SIZE];
+    struct aws_byte_buf to_hash;
+    if (aws_byte_buf_init_from_napi_with_storage(
+            &to_hash, env, node_args[1], to_hash_storage, sizeof(to_hash_storage))) {
+        napi_throw_type_error(env, NULL, "to_hash argument must be a string or array");
+        s_secret_clean_up(&secret, secret_storage);
+        return NULL;
+    }
 
-        if (digest_size > truncate_to) {
-            digest_size = truncate_to;
-        }
+    const size_t digest_size = s_get_digest_size(env, node_args[2], AWS_SHA256_HMAC_LEN);
+    if (digest_size == 0) {
+        s_secret_clean_up(&secret, secret_storage);
+        aws_byte_buf_clean_up(&to_hash);
+        return NULL;
     }
 
+    napi_value dataview = NULL;
     napi_value arraybuffer;
     void *data = NULL;
     if (napi_create_arraybuffer(env, digest_size, &data, &arraybuffer)) {
         napi_throw_error(env, NULL, "Failed to create output arraybuffer");
-        return NULL;
+        goto done;
     }
 
+    struct aws_byte_cursor to_hash_cur = aws_byte_cursor_from_buf(&to_hash);
     struct aws_byte_buf out_buf = aws_byte_buf_from_empty_array(data, digest_size);
-    if (aws_hmac_finalize(hmac, &out_buf, digest_size)) {
+    if (aws_sha256_hmac_compute(aws_napi_get_allocator(), &secret_cur, &to_hash_cur, &out_buf, digest_size)) {
         aws_napi_throw_last_error(env);
-        return NULL;
+        goto done;
     }
 
-    napi_value dataview;
     if (napi_create_dataview(env, digest_size, arraybuffer, 0, &dataview)) {
         napi_throw_error(env, NULL, "Failed to create output dataview");
-        return NULL;
+        dataview = NULL;
     }
 
+done:
+    s_secret_clean_up(&secret, secret_storage);
+    aws_byte_buf_clean_up(&to_hash);
+
     return dataview;
 }
 
-napi_value aws_napi_hmac_sha256_compute(napi_env env, napi_callback_info info) {
+/*******************************************************************************
+ * Async compute
+ ******************************************************************************/
 
-    napi_value node_args[3];
+typedef int(hash_compute_fn)(
+    struct aws_allocator *allocator,
+    const struct aws_byte_cursor *input,
+    struct aws_byte_buf *output,
+    size_t truncate_to);
+
+struct hash_compute_job {
+    struct aws_allocator *allocator;
+    hash_compute_fn *hash_fn;
+    struct aws_byte_buf *secret; /* only set for hmac */
+    struct aws_byte_buf *to_hash;
+    size_t digest_size;
+    uint8_t digest_storage[AWS_SHA256_LEN];
+    struct aws_byte_buf digest;
+};
+
+static int s_hash_compute_job_execute(struct aws_napi_async_job *job) {
+    struct hash_compute_job *compute = job->impl;
+
+    struct aws_byte_cursor to_hash_cur = aws_byte_cursor_from_buf(compute->to_hash);
+    compute->digest = aws_byte_buf_from_empty_array(compute->digest_storage, sizeof(compute->digest_storage));
+
+    if (compute->secret) {
+        struct aws_byte_cursor secret_cur = aws_byte_cursor_from_buf(compute->secret);
+        return aws_sha256_hmac_compute(
+            compute->allocator, &secret_cur, &to_hash_cur, &compute->digest, compute->digest_size);
+    }
+
+    return compute->hash_fn(compute->allocator, &to_hash_cur, &compute->digest, compute->digest_size);
+}
+
+static napi_status s_hash_compute_job_complete(napi_env env, struct aws_napi_async_job *job, napi_value *result) {
+    struct hash_compute_job *compute = job->impl;
+
+    napi_value arraybuffer = NULL;
+    void *data = NULL;
+    AWS_NAPI_CALL(env, napi_create_arraybuffer(env, compute->digest.len, &data, &arraybuffer), { return status; });
+    if (compute->digest.len) {
+        memcpy(data, compute->digest.buffer, compute->digest.len);
+    }
+
+    return napi_create_dataview(env, compute->digest.len, arraybuffer, 0, result);
+}
+
+static void s_hash_compute_job_destroy(struct aws_napi_async_job *job) {
+    struct hash_compute_job *compute = job->impl;
+    aws_secure_zero(compute->digest_storage, sizeof(compute->digest_storage));
+    aws_mem_release(compute->allocator, compute);
+}
+
+static const struct aws_napi_async_job_vtable s_hash_compute_job_vtable = {
+    .execute = s_hash_compute_job_execute,
+    .complete = s_hash_compute_job_complete,
+    .destroy = s_hash_compute_job_destroy,
+};
+
+/**
+ * Shared by all the *_compute_async functions: (secret?, to_hash, truncate_to, on_complete). The output is computed on
+ * the libuv worker pool, buffer-like inputs are referenced rather than copied.
+ */
+static napi_value s_hash_compute_async(
+    napi_env env,
+    napi_callback_info info,
+    const char *name,
+    hash_compute_fn *hash_fn,
+    size_t digest_size) {
+
+    const bool is_hmac = hash_fn == NULL;
+    napi_value node_args[4];
     size_t num_args = AWS_ARRAY_SIZE(node_args);
+    const size_t expected_args = is_hmac ? 4 : 3;
     if (napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL)) {
         napi_throw_error(env, NULL, "Failed to retreive callback information");
         return NULL;
     }
-    if (num_args != AWS_ARRAY_SIZE(node_args)) {
-        napi_throw_error(env, NULL, "hmac_sha256_compute needs exactly 3 arguments");
+    if (num_args != expected_args) {
+        napi_throw_error(
+            env,
+            NULL,
+            is_hmac ? "hmac_sha256_compute_async needs exactly 4 arguments"
+                    : "hash_*_compute_async needs exactly 3 arguments");
         return NULL;
     }
 
-    struct aws_byte_buf secret;
-    if (aws_byte_buf_init_from_napi(&secret, env, node_args[0])) {
-        napi_throw_type_error(env, NULL, "secret argument must be a string or array");
-        return NULL;
-    }
-    struct aws_byte_cursor secret_cur = aws_byte_cursor_from_buf(&secret);
+    napi_value *arg = &node_args[0];
+    napi_value node_secret = is_hmac ? *arg++ : NULL;
+    napi_value node_to_hash = *arg++;
+    napi_value node_truncate_to = *arg++;
+    napi_value node_on_complete = *arg++;
 
-    struct aws_byte_buf to_hash;
-    if (aws_byte_buf_init_from_napi(&to_hash, env, node_args[1])) {
-        napi_throw_type_error(env, NULL, "to_hash argument must be a string or array");
+    digest_size = s_get_digest_size(env, node_truncate_to, digest_size);
+    if (digest_size == 0) {
         return NULL;
     }
 
-    size_t digest_size = AWS_MD5_LEN;
-    if (!aws_napi_is_null_or_undefined(env, node_args[2])) {
+    struct aws_allocator *allocator = aws_napi_get_allocator();
+    struct hash_compute_job *compute = aws_mem_calloc(allocator, 1, sizeof(struct hash_compute_job));
+    AWS_FATAL_ASSERT(compute);
+    compute->allocator = allocator;
+    compute->hash_fn = hash_fn;
+    compute->digest_size = digest_size;
 
-        uint32_t truncate_to = 0;
-        if (napi_get_value_uint32(env, node_args[2], &truncate_to)) {
-            napi_throw_type_error(env, NULL, "truncate_to argument must be undefined or a positive number");
-            return NULL;
-        }
+    struct aws_napi_async_job *job = aws_napi_async_job_new(allocator, &s_hash_compute_job_vtable, compute);
 
-        if (digest_size > truncate_to) {
-            digest_size = truncate_to;
-        }
+    if (node_secret && aws_napi_async_job_add_input(env, job, node_secret, &compute->secret)) {
+        napi_throw_type_error(env, NULL, "secret argument must be a string or array");
+        goto failed;
     }
 
-    napi_value arraybuffer;
-    void *data = NULL;
-    if (napi_create_arraybuffer(env, digest_size, &data, &arraybuffer)) {
-        napi_throw_error(env, NULL, "Failed to create output arraybuffer");
-        return NULL;
+    if (aws_napi_async_job_add_input(env, job, node_to_hash, &compute->to_hash)) {
+        napi_throw_type_error(env, NULL, "to_hash argument must be a string or array");
+        goto failed;
     }
 
-    struct aws_byte_cursor to_hash_cur = aws_byte_cursor_from_buf(&to_hash);
-    struct aws_byte_buf out_buf = aws_byte_buf_from_empty_array(data, digest_size);
-    if (aws_sha256_hmac_compute(aws_napi_get_allocator(), &secret_cur, &to_hash_cur, &out_buf, digest_size)) {
-        aws_napi_throw_last_error(env);
+    if (aws_napi_async_job_queue(env, job, name, node_on_complete)) {
+        napi_throw_error(env, NULL, "Failed to queue hash computation");
+        goto failed;
     }
 
-    napi_value dataview;
-    if (napi_create_dataview(env, digest_size, arraybuffer, 0, &dataview)) {
-        napi_throw_error(env, NULL, "Failed to create output dataview");
-        return NULL;
-    }
+    return NULL;
 
-    aws_byte_buf_clean_up(&to_hash);
+failed:
+    aws_napi_async_job_destroy(env, job);
+    return NULL;
+}
 
-    return dataview;
+napi_value aws_napi_hash_md5_compute_async(napi_env env, napi_callback_info info) {
+    return s_hash_compute_async(env, info, "hash_md5_compute_async", aws_md5_compute, AWS_MD5_LEN);
+}
+
+napi_value aws_napi_hash_sha1_compute_async(napi_env env, napi_callback_info info) {
+    return s_hash_compute_async(env, info, "hash_sha1_compute_async", aws_sha1_compute, AWS_SHA1_LEN);
+}
+
+napi_value aws_napi_hash_sha256_compute_async(napi_env env, napi_callback_info info) {
+    return s_hash_compute_async(env, info, "hash_sha256_compute_async", aws_sha256_compute, AWS_SHA256_LEN);
+}
+
+napi_value aws_napi_hmac_sha256_compute_async(napi_env env, napi_callback_info info) {
+    return s_hash_compute_async(env, info, "hmac_sha256_compute_async", NULL, AWS_SHA256_HMAC_LEN);
 }
@@ -13,17 +13,28 @@ napi_value aws_napi_hash_md5_new(napi_env env, napi_callback_info info);
 napi_value aws_napi_hash_sha1_new(napi_env env, napi_callback_info info);
 napi_value aws_napi_hash_sha256_new(napi_env env, napi_callback_info info);
 napi_value aws_napi_hash_update(napi_env env, napi_callback_info info);
+napi_value aws_napi_hash_update_many(napi_env env, napi_callback_info info);
 napi_value aws_napi_hash_digest(napi_env env, napi_callback_info info);
+napi_value aws_napi_hash_digest_into(napi_env env, napi_callback_info info);
+napi_value aws_napi_hash_reset(napi_env env, napi_callback_info info);
 
 napi_value aws_napi_hash_md5_compute(napi_env env, napi_callback_info info);
 napi_value aws_napi_hash_sha1_compute(napi_env env, napi_callback_info info);
 napi_value aws_napi_hash_sha256_compute(napi_env env, napi_callback_info info);
 
+napi_value aws_napi_hash_md5_compute_async(napi_env env, napi_callback_info info);
+napi_value aws_napi_hash_sha1_compute_async(napi_env env, napi_callback_info info);
+napi_value aws_napi_hash_sha256_compute_async(napi_env env, napi_callback_info info);
+
 napi_value aws_napi_hmac_sha256_new(napi_env env, napi_callback_info info);
 napi_value aws_napi_hmac_update(napi_env env, napi_callback_info info);
+napi_value aws_napi_hmac_update_many(napi_env env, napi_callback_info info);
 napi_value aws_napi_hmac_digest(napi_env env, napi_callback_info info);
+napi_value aws_napi_hmac_digest_into(napi_env env, napi_callback_info info);
+napi_value aws_napi_hmac_reset(napi_env env, napi_callback_info info);
 
 napi_value aws_napi_hmac_sha256_compute(napi_env env, napi_callback_info info);
+napi_value aws_napi_hmac_sha256_compute_async(napi_env env, napi_callback_info info);
 
 AWS_EXTERN_C_END
 
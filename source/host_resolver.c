@@ -0,0 +1,161 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include "host_resolver.h"
+
+#include <aws/common/atomics.h>
+#include <aws/common/ref_count.h>
+#include <aws/io/host_resolver.h>
+
+/*
+ * aws-c-io has no hooks for observing its default resolver, so this wraps one: resolves go through here to be
+ * counted, and the resolution config routes DNS queries through here too.
+ */
+struct counting_host_resolver {
+    struct aws_host_resolver base;
+    /* a copy of the default resolver's, so any entry not overridden below still works on base.impl */
+    struct aws_host_resolver_vtable vtable;
+    struct aws_host_resolver *inner;
+    struct aws_host_resolution_config config;
+
+    struct aws_atomic_var cache_hits;
+    struct aws_atomic_var cache_misses;
+    struct aws_atomic_var dns_queries;
+    struct aws_atomic_var dns_failures;
+};
+
+static int s_resolve_host(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name,
+    aws_on_host_resolved_result_fn *res,
+    const struct aws_host_resolution_config *config,
+    void *user_data) {
+
+    struct counting_host_resolver *counting = (struct counting_host_resolver *)resolver;
+    const uint32_t record_types =
+        AWS_GET_HOST_ADDRESS_COUNT_RECORD_TYPE_A | AWS_GET_HOST_ADDRESS_COUNT_RECORD_TYPE_AAAA;
+    if (aws_host_resolver_get_host_address_count(counting->inner, host_name, record_types) > 0) {
+        aws_atomic_fetch_add(&counting->cache_hits, 1);
+    } else {
+        aws_atomic_fetch_add(&counting->cache_misses, 1);
+    }
+
+    /* the bootstrap passes its own copy of our config, NULL would fall back to the system resolver untracked */
+    return aws_host_resolver_resolve_host(
+        counting->inner, host_name, res, config ? config : &counting->config, user_data);
+}
+
+static int s_record_connection_failure(struct aws_host_resolver *resolver, const struct aws_host_address *address) {
+    struct counting_host_resolver *counting = (struct counting_host_resolver *)resolver;
+    return aws_host_resolver_record_connection_failure(counting->inner, address);
+}
+
+static int s_purge_cache(struct aws_host_resolver *resolver) {
+    struct counting_host_resolver *counting = (struct counting_host_resolver *)resolver;
+    return aws_host_resolver_purge_cache(counting->inner);
+}
+
+static size_t s_get_host_address_count(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name,
+    uint32_t flags) {
+    struct counting_host_resolver *counting = (struct counting_host_resolver *)resolver;
+    return aws_host_resolver_get_host_address_count(counting->inner, host_name, flags);
+}
+
+static int s_dns_resolve(
+    struct aws_allocator *allocator,
+    const struct aws_string *host_name,
+    struct aws_array_list *output_addresses,
+    void *user_data) {
+
+    struct counting_host_resolver *counting = user_data;
+    aws_atomic_fetch_add(&counting->dns_queries, 1);
+    if (aws_default_dns_resolve(allocator, host_name, output_addresses, NULL)) {
+        aws_atomic_fetch_add(&counting->dns_failures, 1);
+        return AWS_OP_ERR;
+    }
+    return AWS_OP_SUCCESS;
+}
+
+/* The inner resolver's threads may still be making DNS queries through this after the wrapper is released */
+static void s_on_inner_shutdown(void *user_data) {
+    struct counting_host_resolver *counting = user_data;
+    aws_mem_release(counting->base.allocator, counting);
+}
+
+static void s_destroy(struct aws_host_resolver *resolver) {
+    struct counting_host_resolver *counting = (struct counting_host_resolver *)resolver;
+    aws_host_resolver_release(counting->inner);
+}
+
+static void s_on_zero_ref_count(void *user_data) {
+    s_destroy(user_data);
+}
+
+struct aws_host_resolver *aws_napi_host_resolver_new(
+    struct aws_allocator *allocator,
+    const struct aws_napi_host_resolver_options *options) {
+
+    struct counting_host_resolver *counting = aws_mem_calloc(allocator, 1, sizeof(struct counting_host_resolver));
+    if (!counting) {
+        return NULL;
+    }
+
+    struct aws_shutdown_callback_options shutdown_options = {
+        .shutdown_callback_fn = s_on_inner_shutdown,
+        .shutdown_callback_user_data = counting,
+    };
+    struct aws_host_resolver_default_options resolver_options = {
+        .max_entries = options->max_entries,
+        .el_group = options->el_group,
+        .shutdown_options = &shutdown_options,
+    };
+    counting->inner = aws_host_resolver_new_default(allocator, &resolver_options);
+    if (!counting->inner) {
+        aws_mem_release(allocator, counting);
+        return NULL;
+    }
+
+    counting->vtable = *counting->inner->vtable;
+    counting->vtable.destroy = s_destroy;
+    counting->vtable.resolve_host = s_resolve_host;
+    counting->vtable.record_connection_failure = s_record_connection_failure;
+    counting->vtable.purge_cache = s_purge_cache;
+    counting->vtable.get_host_address_count = s_get_host_address_count;
+
+    counting->base.allocator = allocator;
+    counting->base.impl = counting->inner->impl;
+    counting->base.vtable = &counting->vtable;
+    aws_ref_count_init(&counting->base.ref_count, &counting->base, s_on_zero_ref_count);
+
+    counting->config.impl = s_dns_resolve;
+    counting->config.max_ttl = options->max_ttl_secs;
+    counting->config.impl_data = counting;
+
+    aws_atomic_init_int(&counting->cache_hits, 0);
+    aws_atomic_init_int(&counting->cache_misses, 0);
+    aws_atomic_init_int(&counting->dns_queries, 0);
+    aws_atomic_init_int(&counting->dns_failures, 0);
+
+    return &counting->base;
+}
+
+const struct aws_host_resolution_config *aws_napi_host_resolver_get_config(const struct aws_host_resolver *resolver) {
+    AWS_FATAL_ASSERT(resolver->vtable->resolve_host == s_resolve_host);
+    const struct counting_host_resolver *counting = (const struct counting_host_resolver *)resolver;
+    return &counting->config;
+}
+
+void aws_napi_host_resolver_get_stats(
+    const struct aws_host_resolver *resolver,
+    struct aws_napi_host_resolver_stats *out_stats) {
+
+    AWS_FATAL_ASSERT(resolver->vtable->resolve_host == s_resolve_host);
+    struct counting_host_resolver *counting = (struct counting_host_resolver *)resolver;
+    out_stats->cache_hits = aws_atomic_load_int(&counting->cache_hits);
+    out_stats->cache_misses = aws_atomic_load_int(&counting->cache_misses);
+    out_stats->dns_queries = aws_atomic_load_int(&counting->dns_queries);
+    out_stats->dns_failures = aws_atomic_load_int(&counting->dns_failures);
+}
@@ -0,0 +1,50 @@
+#ifndef AWS_CRT_NODEJS_HOST_RESOLVER_H
+#define AWS_CRT_NODEJS_HOST_RESOLVER_H
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "module.h"
+
+struct aws_event_loop_group;
+struct aws_host_resolution_config;
+struct aws_host_resolver;
+
+/* Number of hosts cached by a resolver unless configured otherwise */
+#define AWS_NAPI_HOST_RESOLVER_DEFAULT_MAX_ENTRIES 64
+/* Seconds a resolved address is trusted for unless configured otherwise, the same as aws-c-io's default */
+#define AWS_NAPI_HOST_RESOLVER_DEFAULT_MAX_TTL_SECS 30
+
+struct aws_napi_host_resolver_options {
+    struct aws_event_loop_group *el_group;
+    size_t max_entries;
+    size_t max_ttl_secs;
+};
+
+struct aws_napi_host_resolver_stats {
+    /* Resolves answered with addresses that were already cached */
+    uint64_t cache_hits;
+    /* Resolves that had to wait on a DNS query */
+    uint64_t cache_misses;
+    /* DNS queries made, including the background refreshes of cached hosts */
+    uint64_t dns_queries;
+    uint64_t dns_failures;
+};
+
+/**
+ * Creates a default host resolver that also counts how often it is answered from its cache. Resolves should use the
+ * config returned by aws_napi_host_resolver_get_config(), so that its TTL applies and DNS queries are counted.
+ */
+struct aws_host_resolver *aws_napi_host_resolver_new(
+    struct aws_allocator *allocator,
+    const struct aws_napi_host_resolver_options *options);
+
+/* Resolution config for resolver, which must have come from aws_napi_host_resolver_new() */
+const struct aws_host_resolution_config *aws_napi_host_resolver_get_config(const struct aws_host_resolver *resolver);
+
+void aws_napi_host_resolver_get_stats(
+    const struct aws_host_resolver *resolver,
+    struct aws_napi_host_resolver_stats *out_stats);
+
+#endif /* AWS_CRT_NODEJS_HOST_RESOLVER_H */
@@ -0,0 +1,317 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "http2_stream_manager.h"
+#include "buffer_pool.h"
+#include "http_connection.h"
+#include "io.h"
+
+#include <aws/http/http2_stream_manager.h>
+#include <aws/http/proxy.h>
+#include <aws/io/socket.h>
+#include <aws/io/tls_channel_handler.h>
+
+/* Number of idle body chunks kept for reuse by each manager unless configured otherwise */
+#define AWS_NAPI_HTTP2_DEFAULT_BODY_POOL_SIZE 16
+
+struct http2_stream_manager_binding {
+    struct aws_http2_stream_manager *manager;
+    struct aws_allocator *allocator;
+    napi_env env;
+    napi_threadsafe_function on_shutdown;
+    struct aws_napi_buffer_pool *body_pool; /* recycles response body chunks for every stream on this manager */
+};
+
+struct aws_http2_stream_manager *aws_napi_get_http2_stream_manager(struct http2_stream_manager_binding *binding) {
+    return binding->manager;
+}
+
+struct aws_napi_buffer_pool *aws_napi_get_http2_stream_manager_body_pool(struct http2_stream_manager_binding *binding) {
+    return binding->body_pool;
+}
+
+static void s_http2_stream_manager_finalize(napi_env env, void *finalize_data, void *finalize_hint) {
+    (void)finalize_hint;
+    (void)env;
+    struct http2_stream_manager_binding *binding = finalize_data;
+    aws_napi_buffer_pool_release(binding->body_pool);
+    aws_mem_release(binding->allocator, binding);
+}
+
+static void s_http2_stream_manager_shutdown_call(napi_env env, napi_value on_shutdown, void *context, void *user_data) {
+    struct http2_stream_manager_binding *binding = context;
+    (void)user_data;
+    if (env) {
+        AWS_NAPI_ENSURE(
+            env, aws_napi_dispatch_threadsafe_function(env, binding->on_shutdown, NULL, on_shutdown, 0, NULL));
+    }
+}
+
+static void s_http2_stream_manager_shutdown_complete(void *user_data) {
+    struct http2_stream_manager_binding *binding = user_data;
+    if (binding->on_shutdown) {
+        AWS_NAPI_ENSURE(NULL, aws_napi_queue_threadsafe_function(binding->on_shutdown, NULL));
+    }
+    AWS_NAPI_ENSURE(binding->env, aws_napi_release_threadsafe_function(binding->on_shutdown, napi_tsfn_abort));
+}
+
+napi_value aws_napi_http2_stream_manager_new(napi_env env, napi_callback_info info) {
+
+    napi_value result = NULL;
+
+    napi_value node_args[14];
+    size_t num_args = AWS_ARRAY_SIZE(node_args);
+    napi_value *arg = &node_args[0];
+    AWS_NAPI_CALL(env, napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL), {
+        napi_throw_error(env, NULL, "Unable to get callback info");
+        return NULL;
+    });
+    if (num_args != AWS_ARRAY_SIZE(node_args)) {
+        napi_throw_error(env, NULL, "http2_stream_manager_new takes exactly 14 arguments");
+        return NULL;
+    }
+
+    struct aws_allocator *allocator = aws_napi_get_allocator();
+    struct aws_http2_stream_manager_options options;
+    AWS_ZERO_STRUCT(options);
+    struct aws_byte_buf host_buf;
+    AWS_ZERO_STRUCT(host_buf);
+    struct aws_tls_connection_options tls_connection_options;
+    AWS_ZERO_STRUCT(tls_connection_options);
+
+    napi_value node_bootstrap = *arg++;
+    struct client_bootstrap_binding *client_bootstrap_binding = NULL;
+    napi_get_value_external(env, node_bootstrap, (void **)&client_bootstrap_binding);
+    if (client_bootstrap_binding != NULL) {
+        options.bootstrap = aws_napi_get_client_bootstrap(client_bootstrap_binding);
+    } else {
+        options.bootstrap = aws_napi_get_default_client_bootstrap();
+    }
+
+    napi_value node_host = *arg++;
+    if (aws_byte_buf_init_from_napi(&host_buf, env, node_host)) {
+        napi_throw_type_error(env, NULL, "host must be a string");
+        return NULL;
+    }
+    options.host = aws_byte_cursor_from_buf(&host_buf);
+
+    struct http2_stream_manager_binding *binding =
+        aws_mem_calloc(allocator, 1, sizeof(struct http2_stream_manager_binding));
+    AWS_FATAL_ASSERT(binding);
+
+    binding->allocator = allocator;
+    binding->env = env;
+
+    napi_value node_port = *arg++;
+    uint32_t port = 0;
+    if (napi_get_value_uint32(env, node_port, &port) || port > UINT16_MAX) {
+        napi_throw_type_error(env, NULL, "port must be a number between 0 and 65535");
+        goto cleanup;
+    }
+    options.port = (uint16_t)port;
+
+    napi_value node_max_conns = *arg++;
+    uint32_t max_connections = 0;
+    AWS_NAPI_CALL(env, napi_get_value_uint32(env, node_max_conns, &max_connections), {
+        napi_throw_type_error(env, NULL, "max_connections must be a number");
+        goto cleanup;
+    });
+    options.max_connections = (size_t)max_connections;
+
+    napi_value node_window_size = *arg++;
+    uint32_t window_size = 16 * 1024;
+    AWS_NAPI_CALL(env, napi_get_value_uint32(env, node_window_size, &window_size), {
+        napi_throw_type_error(env, NULL, "initial_window_size must be a number");
+        goto cleanup;
+    });
+    options.initial_window_size = (size_t)window_size;
+
+    napi_value node_socket_options = *arg++;
+    const struct aws_socket_options *socket_options = NULL;
+    if (!aws_napi_is_null_or_undefined(env, node_socket_options)) {
+        AWS_NAPI_CALL(env, napi_get_value_external(env, node_socket_options, (void **)&socket_options), {
+            napi_throw_type_error(env, NULL, "socket_options must be undefined or a valid SocketOptions");
+            goto cleanup;
+        });
+    }
+    options.socket_options = socket_options;
+
+    napi_value node_tls_opts = *arg++;
+    if (!aws_napi_is_null_or_undefined(env, node_tls_opts)) {
+        struct aws_tls_connection_options *tls_opts = NULL;
+        AWS_NAPI_CALL(env, napi_get_value_external(env, node_tls_opts, (void **)&tls_opts), {
+            napi_throw_type_error(env, NULL, "tls_opts must be undefined or a valid TlsConnectionOptions");
+            goto cleanup;
+        });
+
+        /* Every connection must negotiate h2, so ask for it unless the caller chose their own ALPN list */
+        if (aws_tls_connection_options_copy(&tls_connection_options, tls_opts)) {
+            aws_napi_throw_last_error(env);
+            goto cleanup;
+        }
+        if (tls_connection_options.alpn_list == NULL &&
+            aws_tls_connection_options_set_alpn_list(&tls_connection_options, allocator, "h2")) {
+            aws_napi_throw_last_error(env);
+            goto cleanup;
+        }
+        options.tls_connection_options = &tls_connection_options;
+    }
+
+    napi_value node_proxy_options = *arg++;
+    struct aws_http_proxy_options *proxy_options = NULL;
+    if (!aws_napi_is_null_or_undefined(env, node_proxy_options)) {
+        struct http_proxy_options_binding *proxy_binding = NULL;
+        AWS_NAPI_CALL(env, napi_get_value_external(env, node_proxy_options, (void **)&proxy_binding), {
+            napi_throw_type_error(env, NULL, "proxy_options must be undefined or a valid HttpProxyOptions");
+            goto cleanup;
+        });
+        proxy_options = aws_napi_get_http_proxy_options(proxy_binding);
+    }
+    /* proxy_options are copied internally */
+    options.proxy_options = proxy_options;
+
+    napi_value node_on_shutdown = *arg++;
+    if (!aws_napi_is_null_or_undefined(env, node_on_shutdown)) {
+        AWS_NAPI_CALL(
+            env,
+            aws_napi_create_threadsafe_function(
+                env,
+                node_on_shutdown,
+                "aws_http2_stream_manager_on_shutdown",
+                s_http2_stream_manager_shutdown_call,
+                binding,
+                &binding->on_shutdown),
+            {
+                napi_throw_type_error(env, NULL, "on_shutdown must be a valid callback or undefined");
+                goto cleanup;
+            });
+    }
+
+    napi_value node_manual_window_management = *arg++;
+    if (!aws_napi_is_null_or_undefined(env, node_manual_window_management)) {
+        bool manual_window_management = false;
+        AWS_NAPI_CALL(env, napi_get_value_bool(env, node_manual_window_management, &manual_window_management), {
+            napi_throw_type_error(env, NULL, "manual_window_management must be a boolean or undefined");
+            goto cleanup;
+        });
+        options.enable_read_back_pressure = manual_window_management;
+    }
+
+    napi_value node_body_pool_size = *arg++;
+    uint32_t body_pool_size = AWS_NAPI_HTTP2_DEFAULT_BODY_POOL_SIZE;
+    if (!aws_napi_is_null_or_undefined(env, node_body_pool_size)) {
+        AWS_NAPI_CALL(env, napi_get_value_uint32(env, node_body_pool_size, &body_pool_size), {
+            napi_throw_type_error(env, NULL, "body_buffer_pool_size must be a number or undefined");
+            goto cleanup;
+        });
+    }
+
+    napi_value node_ideal_concurrent_streams = *arg++;
+    if (!aws_napi_is_null_or_undefined(env, node_ideal_concurrent_streams)) {
+        uint32_t ideal_concurrent_streams = 0;
+        AWS_NAPI_CALL(env, napi_get_value_uint32(env, node_ideal_concurrent_streams, &ideal_concurrent_streams), {
+            napi_throw_type_error(env, NULL, "ideal_concurrent_streams_per_connection must be a number or undefined");
+            goto cleanup;
+        });
+        /* A new connection is only made once every existing connection has this many streams open */
+        options.ideal_concurrent_streams_per_connection = (size_t)ideal_concurrent_streams;
+    }
+
+    napi_value node_max_concurrent_streams = *arg++;
+    if (!aws_napi_is_null_or_undefined(env, node_max_concurrent_streams)) {
+        uint32_t max_concurrent_streams = 0;
+        AWS_NAPI_CALL(env, napi_get_value_uint32(env, node_max_concurrent_streams, &max_concurrent_streams), {
+            napi_throw_type_error(env, NULL, "max_concurrent_streams_per_connection must be a number or undefined");
+            goto cleanup;
+        });
+        /* Further capped by the SETTINGS_MAX_CONCURRENT_STREAMS each server sends */
+        options.max_concurrent_streams_per_connection = (size_t)max_concurrent_streams;
+    }
+
+    napi_value node_prior_knowledge = *arg++;
+    if (!aws_napi_is_null_or_undefined(env, node_prior_knowledge)) {
+        bool prior_knowledge = false;
+        AWS_NAPI_CALL(env, napi_get_value_bool(env, node_prior_knowledge, &prior_knowledge), {
+            napi_throw_type_error(env, NULL, "http2_prior_knowledge must be a boolean or undefined");
+            goto cleanup;
+        });
+        /* Speak h2 straight away over cleartext connections, there's no TLS to negotiate it with */
+        options.http2_prior_knowledge = prior_knowledge;
+    }
+
+    if (options.tls_connection_options == NULL && !options.http2_prior_knowledge) {
+        napi_throw_error(env, NULL, "HTTP/2 needs either tls_opts to negotiate it with, or http2_prior_knowledge");
+        goto cleanup;
+    }
+
+    if (body_pool_size > 0) {
+        binding->body_pool =
+            aws_napi_buffer_pool_new(allocator, AWS_NAPI_BUFFER_POOL_DEFAULT_SLAB_SIZE, (size_t)body_pool_size);
+        AWS_FATAL_ASSERT(binding->body_pool);
+    }
+
+    options.shutdown_complete_callback = s_http2_stream_manager_shutdown_complete;
+    options.shutdown_complete_user_data = binding;
+    binding->manager = aws_http2_stream_manager_new(allocator, &options);
+    if (!binding->manager) {
+        aws_napi_throw_last_error(env);
+        goto cleanup;
+    }
+
+    napi_value node_external = NULL;
+    AWS_NAPI_CALL(env, napi_create_external(env, binding, s_http2_stream_manager_finalize, NULL, &node_external), {
+        napi_throw_error(env, NULL, "Unable to create node external");
+        goto external_failed;
+    });
+
+    /* success, set the return value */
+    result = node_external;
+    goto done;
+
+external_failed:
+    /* the shutdown callback releases on_shutdown, the binding itself is lost */
+    aws_http2_stream_manager_release(binding->manager);
+    binding = NULL;
+
+cleanup:
+    if (binding) {
+        AWS_NAPI_ENSURE(env, aws_napi_release_threadsafe_function(binding->on_shutdown, napi_tsfn_abort));
+        aws_napi_buffer_pool_release(binding->body_pool);
+        aws_mem_release(allocator, binding);
+    }
+
+done:
+    aws_tls_connection_options_clean_up(&tls_connection_options);
+    aws_byte_buf_clean_up(&host_buf);
+
+    return result;
+}
+
+napi_value aws_napi_http2_stream_manager_close(napi_env env, napi_callback_info info) {
+
+    napi_value node_args[1];
+    size_t num_args = AWS_ARRAY_SIZE(node_args);
+    napi_value *arg = &node_args[0];
+    AWS_NAPI_CALL(env, napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL), {
+        napi_throw_error(env, NULL, "Unable to get callback info");
+        return NULL;
+    });
+    if (num_args != AWS_ARRAY_SIZE(node_args)) {
+        napi_throw_error(env, NULL, "http2_stream_manager_close takes exactly 1 argument");
+        return NULL;
+    }
+
+    napi_value node_external = *arg++;
+    struct http2_stream_manager_binding *binding = NULL;
+    AWS_NAPI_CALL(env, napi_get_value_external(env, node_external, (void **)&binding), {
+        napi_throw_type_error(env, NULL, "stream_manager must be a valid Http2StreamManager");
+        return NULL;
+    });
+
+    /* Streams still in flight hold their own references, the manager shuts down once they're done */
+    aws_http2_stream_manager_release(binding->manager);
+
+    return NULL;
+}
@@ -0,0 +1,21 @@
+#ifndef AWS_CRT_NODEJS_HTTP2_STREAM_MANAGER_H
+#define AWS_CRT_NODEJS_HTTP2_STREAM_MANAGER_H
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "module.h"
+
+struct aws_http2_stream_manager;
+struct aws_napi_buffer_pool;
+struct http2_stream_manager_binding;
+
+struct aws_http2_stream_manager *aws_napi_get_http2_stream_manager(struct http2_stream_manager_binding *binding);
+/* Pool that response bodies of this manager's streams are delivered in, may be NULL */
+struct aws_napi_buffer_pool *aws_napi_get_http2_stream_manager_body_pool(struct http2_stream_manager_binding *binding);
+
+napi_value aws_napi_http2_stream_manager_new(napi_env env, napi_callback_info info);
+napi_value aws_napi_http2_stream_manager_close(napi_env env, napi_callback_info info);
+
+#endif /* AWS_CRT_NODEJS_HTTP2_STREAM_MANAGER_H */
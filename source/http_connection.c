@@ -4,6 +4,7 @@
  */
 
 #include "http_connection.h"
+#include "buffer_pool.h"
 #include "io.h"
 
 #include <aws/http/connection.h>
@@ -144,6 +145,7 @@ struct http_connection_binding {
     napi_env env;
     napi_threadsafe_function on_setup;
     napi_threadsafe_function on_shutdown;
+    struct aws_napi_buffer_pool *body_pool; /* shared with the connection manager, NULL for direct connections */
 };
 
 /* finalizer called when node cleans up this object */
@@ -153,6 +155,7 @@ static void s_http_connection_from_manager_binding_finalize(napi_env env, void *
     struct http_connection_binding *binding = finalize_data;
 
     /* no release call, the http_client_connection_manager has already released it */
+    aws_napi_buffer_pool_release(binding->body_pool);
     aws_mem_release(binding->allocator, binding);
 }
 
@@ -160,7 +163,14 @@ struct aws_http_connection *aws_napi_get_http_connection(struct http_connection_
     return binding->connection;
 }
 
-napi_value aws_napi_http_connection_from_manager(napi_env env, struct aws_http_connection *connection) {
+struct aws_napi_buffer_pool *aws_napi_get_http_connection_body_pool(struct http_connection_binding *binding) {
+    return binding->body_pool;
+}
+
+napi_value aws_napi_http_connection_from_manager(
+    napi_env env,
+    struct aws_http_connection *connection,
+    struct aws_napi_buffer_pool *body_pool) {
     struct http_connection_binding *binding =
         aws_mem_calloc(aws_napi_get_allocator(), 1, sizeof(struct http_connection_binding));
     if (!binding) {
@@ -170,6 +180,7 @@ napi_value aws_napi_http_connection_from_manager(napi_env env, struct aws_http_c
     binding->env = env;
     binding->connection = connection;
     binding->allocator = aws_napi_get_allocator();
+    binding->body_pool = aws_napi_buffer_pool_acquire(body_pool);
 
     napi_value node_external = NULL;
     AWS_NAPI_CALL(
@@ -177,6 +188,7 @@ napi_value aws_napi_http_connection_from_manager(napi_env env, struct aws_http_c
         napi_create_external(env, binding, s_http_connection_from_manager_binding_finalize, NULL, &node_external),
         {
             napi_throw_error(env, NULL, "Unable to create external for managed connection");
+            aws_napi_buffer_pool_release(binding->body_pool);
             aws_mem_release(aws_napi_get_allocator(), binding);
             return NULL;
         });
@@ -275,7 +287,7 @@ napi_value aws_napi_http_connection_new(napi_env env, napi_callback_info info) {
     options.allocator = allocator;
 
     /* parse/validate arguments */
-    napi_value node_args[8];
+    napi_value node_args[10];
     size_t num_args = AWS_ARRAY_SIZE(node_args);
     napi_value *arg = &node_args[0];
     AWS_NAPI_CALL(env, napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL), {
@@ -283,7 +295,7 @@ napi_value aws_napi_http_connection_new(napi_env env, napi_callback_info info) {
         return NULL;
     });
     if (num_args != AWS_ARRAY_SIZE(node_args)) {
-        napi_throw_error(env, NULL, "http_connection_new needs exactly 7 arguments");
+        napi_throw_error(env, NULL, "http_connection_new needs exactly 10 arguments");
         return NULL;
     }
 
@@ -379,6 +391,25 @@ napi_value aws_napi_http_connection_new(napi_env env, napi_callback_info info) {
         proxy_opts = &proxy_binding->native;
     }
 
+    napi_value node_window_size = *arg++;
+    if (!aws_napi_is_null_or_undefined(env, node_window_size)) {
+        uint32_t window_size = 0;
+        AWS_NAPI_CALL(env, napi_get_value_uint32(env, node_window_size, &window_size), {
+            napi_throw_type_error(env, NULL, "initial_window_size must be a Number or undefined");
+            goto argument_error;
+        });
+        options.initial_window_size = (size_t)window_size;
+    }
+
+    napi_value node_manual_window_management = *arg++;
+    if (!aws_napi_is_null_or_undefined(env, node_manual_window_management)) {
+        AWS_NAPI_CALL(
+            env, napi_get_value_bool(env, node_manual_window_management, &options.manual_window_management), {
+                napi_throw_type_error(env, NULL, "manual_window_management must be a Boolean or undefined");
+                goto argument_error;
+            });
+    }
+
     napi_value node_external = NULL;
     AWS_NAPI_CALL(
         env, napi_create_external(env, binding, s_http_connection_binding_finalize, binding, &node_external), {
@@ -4,20 +4,55 @@
  */
 
 #include "http_connection_manager.h"
+#include "buffer_pool.h"
 #include "http_connection.h"
 #include "io.h"
 
+#include <aws/common/atomics.h>
+#include <aws/common/clock.h>
+#include <aws/common/hash_table.h>
+#include <aws/common/math.h>
+#include <aws/common/mutex.h>
 #include <aws/http/connection_manager.h>
 #include <aws/http/proxy.h>
 #include <aws/io/socket.h>
 #include <aws/io/tls_channel_handler.h>
 
+/* Number of idle body chunks kept for reuse by each manager unless configured otherwise */
+#define AWS_NAPI_HTTP_DEFAULT_BODY_POOL_SIZE 16
+
+/* Upper bounds of the acquire wait histogram buckets, in microseconds. Anything slower lands in the last bucket. */
+static const uint64_t s_acquire_wait_bounds_us[] = {
+    10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000,
+    5000000, 10000000};
+#define ACQUIRE_WAIT_BUCKET_COUNT (AWS_ARRAY_SIZE(s_acquire_wait_bounds_us) + 1)
+
 struct http_connection_manager_binding {
     struct aws_http_connection_manager *manager;
     struct aws_allocator *allocator;
     napi_env env;
     napi_ref node_external;
     napi_threadsafe_function on_shutdown;
+    /* shared by every acquire, created by the first one. Only keeps node alive while acquires are pending. */
+    napi_threadsafe_function on_acquired;
+    struct aws_napi_buffer_pool *body_pool; /* recycles response body chunks for every stream on this manager */
+    size_t max_connections;
+    /* 0 for no limit */
+    size_t max_pending_acquisitions;
+    /* acquires not yet delivered to JS, only touched on the node thread */
+    size_t num_pending_acquisitions;
+    /* of those, the ones JS still waits on rather than has timed out, what max_pending_acquisitions limits */
+    size_t num_waiting_acquisitions;
+    /* acquire_id -> struct connection_acquired_args *, every acquire not yet delivered, node thread only */
+    struct aws_hash_table acquisitions;
+
+    /* Statistics, see aws_napi_http_connection_manager_get_stats() */
+    struct {
+        struct aws_mutex lock;
+        uint64_t acquires;
+        uint64_t acquire_wait_max_ns;
+        uint64_t acquire_wait_buckets[ACQUIRE_WAIT_BUCKET_COUNT];
+    } synced_data;
 };
 
 struct aws_http_connection_manager *aws_napi_get_http_connection_manager(
@@ -29,9 +64,35 @@ static void s_http_connection_manager_finalize(napi_env env, void *finalize_data
     (void)finalize_hint;
     (void)env;
     struct http_connection_manager_binding *binding = finalize_data;
+    aws_napi_buffer_pool_release(binding->body_pool);
+    aws_hash_table_clean_up(&binding->acquisitions);
+    aws_mutex_clean_up(&binding->synced_data.lock);
     aws_mem_release(binding->allocator, binding);
 }
 
+static uint64_t s_now_ns(void) {
+    uint64_t now = 0;
+    aws_high_res_clock_get_ticks(&now);
+    return now;
+}
+
+/* Records how long an acquire waited for its connection */
+static void s_record_acquire_wait(struct http_connection_manager_binding *binding, uint64_t acquire_started_ns) {
+    const uint64_t now = s_now_ns();
+    const uint64_t wait_ns = now > acquire_started_ns ? now - acquire_started_ns : 0;
+    const uint64_t wait_us = wait_ns / 1000;
+    size_t bucket = 0;
+    while (bucket < AWS_ARRAY_SIZE(s_acquire_wait_bounds_us) && wait_us > s_acquire_wait_bounds_us[bucket]) {
+        ++bucket;
+    }
+
+    aws_mutex_lock(&binding->synced_data.lock);
+    ++binding->synced_data.acquire_wait_buckets[bucket];
+    ++binding->synced_data.acquires;
+    binding->synced_data.acquire_wait_max_ns = aws_max_u64(binding->synced_data.acquire_wait_max_ns, wait_ns);
+    aws_mutex_unlock(&binding->synced_data.lock);
+}
+
 static void s_http_connection_manager_shutdown_call(
     napi_env env,
     napi_value on_shutdown,
@@ -51,13 +112,15 @@ static void s_http_connection_manager_shutdown_complete(void *user_data) {
         AWS_NAPI_ENSURE(NULL, aws_napi_queue_threadsafe_function(binding->on_shutdown, NULL));
     }
     AWS_NAPI_ENSURE(binding->env, aws_napi_release_threadsafe_function(binding->on_shutdown, napi_tsfn_abort));
+    /* every acquisition has completed by now, but their results may still be queued */
+    AWS_NAPI_ENSURE(binding->env, aws_napi_release_threadsafe_function(binding->on_acquired, napi_tsfn_release));
 }
 
 napi_value aws_napi_http_connection_manager_new(napi_env env, napi_callback_info info) {
 
     napi_value result = NULL;
 
-    napi_value node_args[9];
+    napi_value node_args[13];
     size_t num_args = AWS_ARRAY_SIZE(node_args);
     napi_value *arg = &node_args[0];
     AWS_NAPI_CALL(env, napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL), {
@@ -65,7 +128,7 @@ napi_value aws_napi_http_connection_manager_new(napi_env env, napi_callback_info
         return NULL;
     });
     if (num_args != AWS_ARRAY_SIZE(node_args)) {
-        napi_throw_error(env, NULL, "http_connection_manager_new takes exactly 8 arguments");
+        napi_throw_error(env, NULL, "http_connection_manager_new takes exactly 13 arguments");
         return NULL;
     }
 
@@ -99,6 +162,10 @@ napi_value aws_napi_http_connection_manager_new(napi_env env, napi_callback_info
 
     binding->allocator = allocator;
     binding->env = env;
+    aws_mutex_init(&binding->synced_data.lock);
+    AWS_FATAL_ASSERT(
+        aws_hash_table_init(&binding->acquisitions, allocator, 0, aws_hash_ptr, aws_ptr_eq, NULL, NULL) ==
+        AWS_OP_SUCCESS);
 
     napi_value node_port = *arg++;
     uint32_t port = 0;
@@ -115,6 +182,7 @@ napi_value aws_napi_http_connection_manager_new(napi_env env, napi_callback_info
         goto cleanup;
     });
     options.max_connections = (size_t)max_connections;
+    binding->max_connections = options.max_connections;
 
     napi_value node_window_size = *arg++;
     uint32_t window_size = 16 * 1024;
@@ -174,6 +242,56 @@ napi_value aws_napi_http_connection_manager_new(napi_env env, napi_callback_info
             });
     }
 
+    napi_value node_manual_window_management = *arg++;
+    if (!aws_napi_is_null_or_undefined(env, node_manual_window_management)) {
+        bool manual_window_management = false;
+        AWS_NAPI_CALL(env, napi_get_value_bool(env, node_manual_window_management, &manual_window_management), {
+            napi_throw_type_error(env, NULL, "manual_window_management must be a boolean or undefined");
+            goto cleanup;
+        });
+        /* streams will stop receiving body data once initial_window_size bytes are outstanding */
+        options.enable_read_back_pressure = manual_window_management;
+    }
+
+    napi_value node_body_pool_size = *arg++;
+    uint32_t body_pool_size = AWS_NAPI_HTTP_DEFAULT_BODY_POOL_SIZE;
+    if (!aws_napi_is_null_or_undefined(env, node_body_pool_size)) {
+        AWS_NAPI_CALL(env, napi_get_value_uint32(env, node_body_pool_size, &body_pool_size), {
+            napi_throw_type_error(env, NULL, "body_buffer_pool_size must be a number or undefined");
+            goto cleanup;
+        });
+    }
+    if (body_pool_size > 0) {
+        binding->body_pool =
+            aws_napi_buffer_pool_new(allocator, AWS_NAPI_BUFFER_POOL_DEFAULT_SLAB_SIZE, (size_t)body_pool_size);
+        AWS_FATAL_ASSERT(binding->body_pool);
+    }
+
+    napi_value node_max_idle_ms = *arg++;
+    if (!aws_napi_is_null_or_undefined(env, node_max_idle_ms)) {
+        int64_t max_idle_ms = 0;
+        AWS_NAPI_CALL(env, napi_get_value_int64(env, node_max_idle_ms, &max_idle_ms), {
+            napi_throw_type_error(env, NULL, "max_connection_idle_ms must be a number or undefined");
+            goto cleanup;
+        });
+        if (max_idle_ms < 0) {
+            napi_throw_range_error(env, NULL, "max_connection_idle_ms must not be negative");
+            goto cleanup;
+        }
+        /* idle connections are closed once unused for this long, 0 keeps them until the server closes them */
+        options.max_connection_idle_in_milliseconds = (uint64_t)max_idle_ms;
+    }
+
+    napi_value node_max_pending = *arg++;
+    if (!aws_napi_is_null_or_undefined(env, node_max_pending)) {
+        uint32_t max_pending = 0;
+        AWS_NAPI_CALL(env, napi_get_value_uint32(env, node_max_pending, &max_pending), {
+            napi_throw_type_error(env, NULL, "max_pending_acquisitions must be a number or undefined");
+            goto cleanup;
+        });
+        binding->max_pending_acquisitions = (size_t)max_pending;
+    }
+
     options.shutdown_complete_callback = s_http_connection_manager_shutdown_complete;
     options.shutdown_complete_user_data = binding;
     binding->manager = aws_http_connection_manager_new(allocator, &options);
@@ -197,9 +315,19 @@ napi_value aws_napi_http_connection_manager_new(napi_env env, napi_callback_info
     goto done;
 
 external_failed:
+    /* the shutdown callback releases the callbacks, the binding itself is lost */
     aws_http_connection_manager_release(binding->manager);
+    binding = NULL;
 
 cleanup:
+    if (binding) {
+        AWS_NAPI_ENSURE(env, aws_napi_release_threadsafe_function(binding->on_shutdown, napi_tsfn_abort));
+        aws_napi_buffer_pool_release(binding->body_pool);
+        aws_hash_table_clean_up(&binding->acquisitions);
+        aws_mutex_clean_up(&binding->synced_data.lock);
+        aws_mem_release(allocator, binding);
+    }
+
 done:
     aws_tls_connection_options_clean_up(&tls_connection_options);
     aws_byte_buf_clean_up(&host_buf);
@@ -235,11 +363,20 @@ napi_value aws_napi_http_connection_manager_close(napi_env env, napi_callback_in
 
 struct connection_acquired_args {
     struct http_connection_manager_binding *binding;
-    napi_threadsafe_function on_acquired;
+    uint32_t acquire_id;
     struct aws_http_connection *connection;
     int error_code;
+    uint64_t acquire_started_ns;
+    /* 0 for no deadline */
+    uint64_t deadline_ns;
+    /* JS timed out waiting, no longer counted in num_waiting_acquisitions. Only touched on the node thread */
+    bool abandoned;
 };
 
+static void *s_acquire_id_key(uint32_t acquire_id) {
+    return (void *)(uintptr_t)acquire_id;
+}
+
 static void s_http_connection_manager_on_acquired_call(
     napi_env env,
     napi_value on_acquired,
@@ -248,19 +385,32 @@ static void s_http_connection_manager_on_acquired_call(
     struct http_connection_manager_binding *binding = context;
     struct connection_acquired_args *args = user_data;
 
-    if (env) {
-        napi_value connection_external = aws_napi_http_connection_from_manager(env, args->connection);
-        AWS_FATAL_ASSERT(connection_external);
+    aws_hash_table_remove(&binding->acquisitions, s_acquire_id_key(args->acquire_id), NULL, NULL);
+    if (!args->abandoned) {
+        AWS_FATAL_ASSERT(binding->num_waiting_acquisitions > 0);
+        --binding->num_waiting_acquisitions;
+    }
 
-        napi_value params[2];
+    if (env) {
+        napi_value params[3];
         const size_t num_params = AWS_ARRAY_SIZE(params);
-        params[0] = connection_external;
-        AWS_NAPI_ENSURE(env, napi_create_int32(env, args->error_code, &params[1]));
+        AWS_NAPI_ENSURE(env, napi_create_uint32(env, args->acquire_id, &params[0]));
+        if (args->connection) {
+            params[1] = aws_napi_http_connection_from_manager(env, args->connection, binding->body_pool);
+            AWS_FATAL_ASSERT(params[1]);
+        } else {
+            AWS_NAPI_ENSURE(env, napi_get_undefined(env, &params[1]));
+        }
+        AWS_NAPI_ENSURE(env, napi_create_int32(env, args->error_code, &params[2]));
 
         AWS_NAPI_ENSURE(
-            env, aws_napi_dispatch_threadsafe_function(env, args->on_acquired, NULL, on_acquired, num_params, params));
+            env,
+            aws_napi_dispatch_threadsafe_function(env, binding->on_acquired, NULL, on_acquired, num_params, params));
 
-        AWS_NAPI_ENSURE(env, aws_napi_unref_threadsafe_function(env, args->on_acquired));
+        AWS_FATAL_ASSERT(binding->num_pending_acquisitions > 0);
+        if (--binding->num_pending_acquisitions == 0) {
+            AWS_NAPI_ENSURE(env, aws_napi_unref_threadsafe_function(env, binding->on_acquired));
+        }
     }
 
     aws_mem_release(binding->allocator, args);
@@ -271,14 +421,28 @@ static void s_http_connection_manager_acquired(
     int error_code,
     void *user_data) {
     struct connection_acquired_args *args = user_data;
+    struct http_connection_manager_binding *binding = args->binding;
     args->connection = connection;
     args->error_code = error_code;
 
-    AWS_NAPI_ENSURE(NULL, aws_napi_queue_threadsafe_function(args->on_acquired, args));
+    if (connection) {
+        s_record_acquire_wait(binding, args->acquire_started_ns);
+
+        /*
+         * The caller has given up on this connection, so put it straight back in the pool for the next acquire
+         * rather than taking a trip through the node thread. No connection and no error tells JS it expired.
+         */
+        if (args->deadline_ns && s_now_ns() >= args->deadline_ns) {
+            aws_http_connection_manager_release_connection(binding->manager, connection);
+            args->connection = NULL;
+        }
+    }
+
+    AWS_NAPI_ENSURE(NULL, aws_napi_queue_threadsafe_function(binding->on_acquired, args));
 }
 
 napi_value aws_napi_http_connection_manager_acquire(napi_env env, napi_callback_info info) {
-    napi_value node_args[2];
+    napi_value node_args[4];
     size_t num_args = AWS_ARRAY_SIZE(node_args);
     napi_value *arg = &node_args[0];
     AWS_NAPI_CALL(env, napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL), {
@@ -286,7 +450,7 @@ napi_value aws_napi_http_connection_manager_acquire(napi_env env, napi_callback_
         return NULL;
     });
     if (num_args != AWS_ARRAY_SIZE(node_args)) {
-        napi_throw_error(env, NULL, "http_connection_manager_acquire takes exactly 2 arguments");
+        napi_throw_error(env, NULL, "http_connection_manager_acquire takes exactly 4 arguments");
         return NULL;
     }
 
@@ -297,31 +461,114 @@ napi_value aws_napi_http_connection_manager_acquire(napi_env env, napi_callback_
         return NULL;
     });
 
+    napi_value node_acquire_id = *arg++;
+    uint32_t acquire_id = 0;
+    AWS_NAPI_CALL(env, napi_get_value_uint32(env, node_acquire_id, &acquire_id), {
+        napi_throw_type_error(env, NULL, "acquire_id must be a number");
+        return NULL;
+    });
+
+    napi_value node_timeout_ms = *arg++;
+    uint32_t timeout_ms = 0;
+    if (!aws_napi_is_null_or_undefined(env, node_timeout_ms)) {
+        AWS_NAPI_CALL(env, napi_get_value_uint32(env, node_timeout_ms, &timeout_ms), {
+            napi_throw_type_error(env, NULL, "timeout_ms must be a number or undefined");
+            return NULL;
+        });
+    }
+
+    /* Every acquire passes the same callback, which dispatches on acquire_id */
+    napi_value node_on_acquired = *arg++;
+    if (!binding->on_acquired) {
+        AWS_NAPI_CALL(
+            env,
+            aws_napi_create_threadsafe_function(
+                env,
+                node_on_acquired,
+                "aws_http_connection_manager_on_acquired",
+                s_http_connection_manager_on_acquired_call,
+                binding,
+                &binding->on_acquired),
+            {
+                napi_throw_type_error(env, NULL, "on_acquired should be a valid callback");
+                return NULL;
+            });
+        AWS_NAPI_ENSURE(env, aws_napi_unref_threadsafe_function(env, binding->on_acquired));
+    }
+
+    napi_value result = NULL;
+    /* Fail fast rather than joining a queue that is already too long to drain in time */
+    if (binding->max_pending_acquisitions && binding->num_waiting_acquisitions >= binding->max_pending_acquisitions) {
+        AWS_NAPI_ENSURE(env, napi_get_boolean(env, false, &result));
+        return result;
+    }
+
     struct connection_acquired_args *args =
         aws_mem_calloc(binding->allocator, 1, sizeof(struct connection_acquired_args));
     AWS_FATAL_ASSERT(args);
     args->binding = binding;
+    args->acquire_id = acquire_id;
+    args->acquire_started_ns = s_now_ns();
+    if (timeout_ms) {
+        args->deadline_ns = args->acquire_started_ns +
+                            aws_timestamp_convert(timeout_ms, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+    }
 
-    napi_value node_on_acquired = *arg++;
-    AWS_NAPI_CALL(
-        env,
-        aws_napi_create_threadsafe_function(
-            env,
-            node_on_acquired,
-            "aws_http_connection_manager_on_acquired",
-            s_http_connection_manager_on_acquired_call,
-            binding,
-            &args->on_acquired),
-        {
-            napi_throw_type_error(env, NULL, "on_acquired should be a valid callback");
-            goto failed;
-        });
+    if (aws_hash_table_put(&binding->acquisitions, s_acquire_id_key(acquire_id), args, NULL)) {
+        aws_mem_release(binding->allocator, args);
+        aws_napi_throw_last_error(env);
+        return NULL;
+    }
+
+    if (binding->num_pending_acquisitions++ == 0) {
+        AWS_NAPI_ENSURE(env, napi_ref_threadsafe_function(env, binding->on_acquired));
+    }
+    ++binding->num_waiting_acquisitions;
 
     aws_http_connection_manager_acquire_connection(binding->manager, s_http_connection_manager_acquired, args);
-    return NULL;
 
-failed:
-    aws_mem_release(binding->allocator, args);
+    AWS_NAPI_ENSURE(env, napi_get_boolean(env, true, &result));
+    return result;
+}
+
+napi_value aws_napi_http_connection_manager_abandon_acquire(napi_env env, napi_callback_info info) {
+    napi_value node_args[2];
+    size_t num_args = AWS_ARRAY_SIZE(node_args);
+    napi_value *arg = &node_args[0];
+    AWS_NAPI_CALL(env, napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL), {
+        napi_throw_error(env, NULL, "Unable to get callback info");
+        return NULL;
+    });
+    if (num_args != AWS_ARRAY_SIZE(node_args)) {
+        napi_throw_error(env, NULL, "http_connection_manager_abandon_acquire takes exactly 2 arguments");
+        return NULL;
+    }
+
+    napi_value node_external = *arg++;
+    struct http_connection_manager_binding *binding = NULL;
+    AWS_NAPI_CALL(env, napi_get_value_external(env, node_external, (void **)&binding), {
+        napi_throw_type_error(env, NULL, "connection_manager should be an external");
+        return NULL;
+    });
+
+    napi_value node_acquire_id = *arg++;
+    uint32_t acquire_id = 0;
+    AWS_NAPI_CALL(env, napi_get_value_uint32(env, node_acquire_id, &acquire_id), {
+        napi_throw_type_error(env, NULL, "acquire_id must be a number");
+        return NULL;
+    });
+
+    /* The acquire stays queued in the manager, but nobody waits on it, so it no longer counts against the limit */
+    struct aws_hash_element *elem = NULL;
+    aws_hash_table_find(&binding->acquisitions, s_acquire_id_key(acquire_id), &elem);
+    if (elem != NULL) {
+        struct connection_acquired_args *args = elem->value;
+        if (!args->abandoned) {
+            args->abandoned = true;
+            --binding->num_waiting_acquisitions;
+        }
+    }
+
     return NULL;
 }
 
@@ -360,3 +607,242 @@ napi_value aws_napi_http_connection_manager_release(napi_env env, napi_callback_
 
     return NULL;
 }
+
+/*
+ * Warming: acquires connections concurrently so the manager has to open that many, then returns them all to the
+ * pool at once, where they wait idle for the first requests.
+ */
+struct connection_manager_warm {
+    struct http_connection_manager_binding *binding;
+    napi_threadsafe_function on_complete;
+    struct aws_atomic_var pending;
+
+    struct {
+        struct aws_mutex lock;
+        /* holds every connection acquired so far, num_connections can't exceed the number of acquires */
+        struct aws_http_connection **connections;
+        size_t num_connections;
+        int error_code;
+    } synced_data;
+};
+
+static void s_connection_manager_warm_destroy(struct connection_manager_warm *warm) {
+    aws_mutex_clean_up(&warm->synced_data.lock);
+    aws_mem_release(warm->binding->allocator, warm);
+}
+
+static void s_http_connection_manager_on_warm_call(
+    napi_env env,
+    napi_value on_complete,
+    void *context,
+    void *user_data) {
+    (void)context;
+    struct connection_manager_warm *warm = user_data;
+
+    if (env) {
+        napi_value params[2];
+        const size_t num_params = AWS_ARRAY_SIZE(params);
+        AWS_NAPI_ENSURE(env, napi_create_uint32(env, (uint32_t)warm->synced_data.num_connections, &params[0]));
+        AWS_NAPI_ENSURE(env, napi_create_int32(env, warm->synced_data.error_code, &params[1]));
+
+        AWS_NAPI_ENSURE(
+            env, aws_napi_dispatch_threadsafe_function(env, warm->on_complete, NULL, on_complete, num_params, params));
+        AWS_NAPI_ENSURE(env, aws_napi_release_threadsafe_function(warm->on_complete, napi_tsfn_release));
+    }
+
+    s_connection_manager_warm_destroy(warm);
+}
+
+static void s_http_connection_manager_warm_acquired(
+    struct aws_http_connection *connection,
+    int error_code,
+    void *user_data) {
+    struct connection_manager_warm *warm = user_data;
+
+    aws_mutex_lock(&warm->synced_data.lock);
+    if (connection) {
+        warm->synced_data.connections[warm->synced_data.num_connections++] = connection;
+    } else if (!warm->synced_data.error_code) {
+        warm->synced_data.error_code = error_code;
+    }
+    aws_mutex_unlock(&warm->synced_data.lock);
+
+    if (aws_atomic_fetch_sub(&warm->pending, 1) != 1) {
+        return;
+    }
+
+    /* Every acquire has finished, so every connection is open and can go back to the pool */
+    struct aws_http_connection_manager *manager = warm->binding->manager;
+    for (size_t i = 0; i < warm->synced_data.num_connections; ++i) {
+        aws_http_connection_manager_release_connection(manager, warm->synced_data.connections[i]);
+    }
+
+    AWS_NAPI_ENSURE(NULL, aws_napi_queue_threadsafe_function(warm->on_complete, warm));
+}
+
+napi_value aws_napi_http_connection_manager_warm(napi_env env, napi_callback_info info) {
+    napi_value node_args[3];
+    size_t num_args = AWS_ARRAY_SIZE(node_args);
+    napi_value *arg = &node_args[0];
+    AWS_NAPI_CALL(env, napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL), {
+        napi_throw_error(env, NULL, "Unable to get callback info");
+        return NULL;
+    });
+    if (num_args != AWS_ARRAY_SIZE(node_args)) {
+        napi_throw_error(env, NULL, "http_connection_manager_warm takes exactly 3 arguments");
+        return NULL;
+    }
+
+    napi_value node_external = *arg++;
+    struct http_connection_manager_binding *binding = NULL;
+    AWS_NAPI_CALL(env, napi_get_value_external(env, node_external, (void **)&binding), {
+        napi_throw_type_error(env, NULL, "connection_manager should be an external");
+        return NULL;
+    });
+
+    napi_value node_num_connections = *arg++;
+    uint32_t num_connections = 0;
+    AWS_NAPI_CALL(env, napi_get_value_uint32(env, node_num_connections, &num_connections), {
+        napi_throw_type_error(env, NULL, "num_connections must be a number");
+        return NULL;
+    });
+    /* Holding more than the pool allows would wait forever on connections only this can release */
+    const size_t num_acquires = aws_min_size((size_t)num_connections, binding->max_connections);
+
+    struct connection_manager_warm *warm = NULL;
+    struct aws_http_connection **connections = NULL;
+    if (!aws_mem_acquire_many(
+            binding->allocator,
+            2,
+            &warm,
+            sizeof(struct connection_manager_warm),
+            &connections,
+            (num_acquires ? num_acquires : 1) * sizeof(struct aws_http_connection *))) {
+        aws_napi_throw_last_error(env);
+        return NULL;
+    }
+    AWS_ZERO_STRUCT(*warm);
+    warm->binding = binding;
+    warm->synced_data.connections = connections;
+    aws_mutex_init(&warm->synced_data.lock);
+    aws_atomic_init_int(&warm->pending, num_acquires);
+
+    napi_value node_on_complete = *arg++;
+    AWS_NAPI_CALL(
+        env,
+        aws_napi_create_threadsafe_function(
+            env,
+            node_on_complete,
+            "aws_http_connection_manager_on_warm",
+            s_http_connection_manager_on_warm_call,
+            binding,
+            &warm->on_complete),
+        {
+            napi_throw_type_error(env, NULL, "on_complete should be a valid callback");
+            s_connection_manager_warm_destroy(warm);
+            return NULL;
+        });
+
+    if (num_acquires == 0) {
+        AWS_NAPI_ENSURE(env, aws_napi_queue_threadsafe_function(warm->on_complete, warm));
+        return NULL;
+    }
+
+    for (size_t i = 0; i < num_acquires; ++i) {
+        aws_http_connection_manager_acquire_connection(
+            binding->manager, s_http_connection_manager_warm_acquired, warm);
+    }
+
+    return NULL;
+}
+
+/* Upper bound, in microseconds, of the bucket holding the given percentile of acquire waits, capped at max_us */
+static uint64_t s_acquire_wait_percentile_us(
+    const uint64_t *buckets,
+    uint64_t num_acquires,
+    uint64_t max_us,
+    uint32_t percentile) {
+
+    if (num_acquires == 0) {
+        return 0;
+    }
+
+    /* rank of the sample at the percentile, 1-based, rounded up */
+    const uint64_t rank = (num_acquires * percentile + 99) / 100;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < ACQUIRE_WAIT_BUCKET_COUNT; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return i < AWS_ARRAY_SIZE(s_acquire_wait_bounds_us) ? aws_min_u64(s_acquire_wait_bounds_us[i], max_us)
+                                                                 : max_us;
+        }
+    }
+    return max_us;
+}
+
+static napi_status s_set_int64_property(napi_env env, napi_value object, const char *name, int64_t value) {
+    napi_value node_value = NULL;
+    AWS_NAPI_CALL(env, napi_create_int64(env, value, &node_value), { return status; });
+    return napi_set_named_property(env, object, name, node_value);
+}
+
+napi_value aws_napi_http_connection_manager_get_stats(napi_env env, napi_callback_info info) {
+    napi_value node_args[1];
+    size_t num_args = AWS_ARRAY_SIZE(node_args);
+    napi_value *arg = &node_args[0];
+    AWS_NAPI_CALL(env, napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL), {
+        napi_throw_error(env, NULL, "Unable to get callback info");
+        return NULL;
+    });
+    if (num_args != AWS_ARRAY_SIZE(node_args)) {
+        napi_throw_error(env, NULL, "http_connection_manager_get_stats takes exactly 1 argument");
+        return NULL;
+    }
+
+    napi_value node_external = *arg++;
+    struct http_connection_manager_binding *binding = NULL;
+    AWS_NAPI_CALL(env, napi_get_value_external(env, node_external, (void **)&binding), {
+        napi_throw_type_error(env, NULL, "connection_manager should be an external");
+        return NULL;
+    });
+
+    struct aws_http_manager_metrics metrics;
+    AWS_ZERO_STRUCT(metrics);
+    aws_http_connection_manager_fetch_metrics(binding->manager, &metrics);
+
+    uint64_t buckets[ACQUIRE_WAIT_BUCKET_COUNT];
+    aws_mutex_lock(&binding->synced_data.lock);
+    const uint64_t num_acquires = binding->synced_data.acquires;
+    const uint64_t wait_max_us = binding->synced_data.acquire_wait_max_ns / 1000;
+    memcpy(buckets, binding->synced_data.acquire_wait_buckets, sizeof(buckets));
+    aws_mutex_unlock(&binding->synced_data.lock);
+
+    napi_value node_stats = NULL;
+    napi_value node_wait = NULL;
+    AWS_NAPI_CALL(env, napi_create_object(env, &node_stats), {
+        napi_throw_error(env, NULL, "Unable to create stats object");
+        return NULL;
+    });
+    AWS_NAPI_CALL(env, napi_create_object(env, &node_wait), {
+        napi_throw_error(env, NULL, "Unable to create stats object");
+        return NULL;
+    });
+
+    if (s_set_int64_property(env, node_stats, "available", (int64_t)metrics.available_concurrency) ||
+        s_set_int64_property(env, node_stats, "leased", (int64_t)metrics.leased_concurrency) ||
+        s_set_int64_property(env, node_stats, "pending_acquisitions", (int64_t)metrics.pending_concurrency_acquires) ||
+        s_set_int64_property(env, node_stats, "acquires", (int64_t)num_acquires) ||
+        s_set_int64_property(
+            env, node_wait, "p50", (int64_t)s_acquire_wait_percentile_us(buckets, num_acquires, wait_max_us, 50)) ||
+        s_set_int64_property(
+            env, node_wait, "p90", (int64_t)s_acquire_wait_percentile_us(buckets, num_acquires, wait_max_us, 90)) ||
+        s_set_int64_property(
+            env, node_wait, "p99", (int64_t)s_acquire_wait_percentile_us(buckets, num_acquires, wait_max_us, 99)) ||
+        s_set_int64_property(env, node_wait, "max", (int64_t)wait_max_us) ||
+        napi_set_named_property(env, node_stats, "acquire_wait_us", node_wait)) {
+        napi_throw_error(env, NULL, "Unable to populate stats object");
+        return NULL;
+    }
+
+    return node_stats;
+}
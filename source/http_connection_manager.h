@@ -15,7 +15,20 @@ struct aws_http_connection_manager *aws_napi_get_http_connection_manager(
 
 napi_value aws_napi_http_connection_manager_new(napi_env env, napi_callback_info info);
 napi_value aws_napi_http_connection_manager_acquire(napi_env env, napi_callback_info info);
+/* Tells the manager JS has stopped waiting on an acquire, so it no longer counts towards max_pending_acquisitions */
+napi_value aws_napi_http_connection_manager_abandon_acquire(napi_env env, napi_callback_info info);
 napi_value aws_napi_http_connection_manager_release(napi_env env, napi_callback_info info);
+/* Opens connections ahead of time, by acquiring them all at once and then returning them to the pool */
+napi_value aws_napi_http_connection_manager_warm(napi_env env, napi_callback_info info);
 napi_value aws_napi_http_connection_manager_close(napi_env env, napi_callback_info info);
+/**
+ * get_stats(manager): returns
+ * {
+ *   available, leased, pending_acquisitions, acquires,
+ *   acquire_wait_us: { p50, p90, p99, max }
+ * }
+ * Wait percentiles are the upper bounds of histogram buckets, so they are approximate.
+ */
+napi_value aws_napi_http_connection_manager_get_stats(napi_env env, napi_callback_info info);
 
 #endif /* AWS_CRT_NODEJS_HTTP_CONNECTION_MANAGER_H */
@@ -6,8 +6,10 @@
 
 #include "class_binder.h"
 #include "http_headers.h"
+#include "io.h"
 
 #include <aws/http/request_response.h>
+#include <aws/io/stream.h>
 
 static struct aws_napi_class_info s_request_class_info;
 
@@ -82,8 +84,22 @@ struct http_request_binding {
     struct aws_allocator *allocator;
 
     napi_ref node_headers;
+    /* The message only borrows its body, the binding owns it. See aws_napi_io_input_stream_acquire() */
+    struct aws_input_stream *body_stream;
 };
 
+static void s_request_set_body_stream(struct http_request_binding *binding, struct aws_input_stream *body_stream) {
+    if (body_stream) {
+        aws_napi_io_input_stream_acquire(body_stream);
+    }
+    aws_http_message_set_body_stream(binding->native, body_stream);
+
+    if (binding->body_stream) {
+        aws_input_stream_destroy(binding->body_stream);
+    }
+    binding->body_stream = body_stream;
+}
+
 /* Need a special finalizer to avoid releasing a request object we don't own */
 static void s_napi_wrapped_http_request_finalize(napi_env env, void *finalize_data, void *finalize_hint) {
     (void)env;
@@ -92,6 +108,10 @@ static void s_napi_wrapped_http_request_finalize(napi_env env, void *finalize_da
     struct http_request_binding *binding = finalize_data;
     struct aws_allocator *allocator = binding->allocator;
 
+    /* a body set from js goes with the wrapper, the message must not keep pointing at it */
+    if (binding->body_stream) {
+        s_request_set_body_stream(binding, NULL);
+    }
     aws_mem_release(allocator, binding);
 }
 
@@ -122,6 +142,9 @@ static void s_napi_http_request_finalize(napi_env env, void *finalize_data, void
     struct aws_allocator *allocator = finalize_hint;
 
     aws_http_message_destroy(binding->native);
+    if (binding->body_stream) {
+        aws_input_stream_destroy(binding->body_stream);
+    }
     aws_mem_release(allocator, binding);
 }
 
@@ -159,7 +182,7 @@ static napi_value s_request_constructor(napi_env env, const struct aws_napi_call
     aws_http_message_set_request_path(binding->native, path_cur);
 
     if (aws_napi_method_next_argument(napi_external, cb_info, &arg)) {
-        aws_http_message_set_body_stream(binding->native, arg->native.external);
+        s_request_set_body_stream(binding, arg->native.external);
     }
 
     napi_value node_this = cb_info->native_this;
@@ -175,6 +198,9 @@ cleanup:
         if (binding->native) {
             aws_http_message_destroy(binding->native);
         }
+        if (binding->body_stream) {
+            aws_input_stream_destroy(binding->body_stream);
+        }
         aws_mem_release(alloc, binding);
     }
     return NULL;
@@ -251,5 +277,6 @@ static void s_request_body_set(napi_env env, void *native_this, const struct aws
 
     struct http_request_binding *binding = native_this;
 
-    aws_http_message_set_body_stream(binding->native, value->native.external);
+    /* anything other than a stream's external clears the body */
+    s_request_set_body_stream(binding, value->type == napi_external ? value->native.external : NULL);
 }
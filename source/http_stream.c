@@ -4,28 +4,90 @@
  */
 #include "http_stream.h"
 
+#include "buffer_pool.h"
+#include "checksums.h"
+#include "http2_stream_manager.h"
 #include "http_connection.h"
+#include "http_headers.h"
 #include "http_message.h"
+#include "metrics.h"
 
 #include <aws/common/atomics.h>
+#include <aws/common/file.h>
+#include <aws/common/mutex.h>
+#include <aws/http/http2_stream_manager.h>
 #include <aws/http/request_response.h>
 #include <aws/io/stream.h>
 
 #ifdef _MSC_VER
+#    include <io.h>
 #    pragma warning(disable : 4204)
+#else
+#    include <unistd.h>
 #endif /* _MSC_VER */
 
+static int s_dup_fd(int fd) {
+#ifdef _MSC_VER
+    return _dup(fd);
+#else
+    return dup(fd);
+#endif
+}
+
+static void s_close_fd(int fd) {
+#ifdef _MSC_VER
+    _close(fd);
+#else
+    close(fd);
+#endif
+}
+
+static FILE *s_fdopen(int fd, const char *mode) {
+#ifdef _MSC_VER
+    return _fdopen(fd, mode);
+#else
+    return fdopen(fd, mode);
+#endif
+}
+
 struct http_stream_binding {
     struct aws_http_stream *stream;
     struct aws_allocator *allocator;
     napi_ref node_external;
     napi_threadsafe_function on_complete;
     napi_threadsafe_function on_response;
-    napi_threadsafe_function on_body;
+    struct aws_napi_batched_threadsafe_function *on_body; /* delivers all chunks received since the last call at once */
     struct aws_http_message *response; /* used to buffer response headers/status code */
     struct aws_http_message *request;
+    struct aws_napi_buffer_pool *body_pool; /* may be NULL, in which case each chunk is allocated individually */
+    /*
+     * Set for streams vended by an HTTP/2 stream manager, which holds a reference until the stream completes.
+     * Activating such a stream asks the manager for it, stream stays NULL until the manager has opened it.
+     */
+    struct aws_http2_stream_manager *stream_manager;
+
+    /*
+     * A manager hands the stream over on its own thread, while js may close the stream or open its window at any
+     * time, so stream is only written and read by js under the lock. Whatever js asks for before the stream arrives
+     * is applied when it does.
+     */
+    struct {
+        struct aws_mutex lock;
+        bool close_requested;
+        size_t window_increment;
+    } synced_data;
 
     struct aws_atomic_var pending_length; /* used to ensure that all of the body callbacks to node have been invoked */
+
+    /* Accounting for the response body, only touched by the stream's thread */
+    struct {
+        FILE *file; /* written natively rather than delivered to on_body, NULL unless a destination was given */
+        struct aws_napi_running_checksum checksum;
+        uint64_t length;    /* bytes received */
+        int error_code;     /* first write failure, reported on completion */
+        bool summarize;     /* whether completion reports the length and checksum */
+        bool manual_window; /* the connection only re-opens its window when told to */
+    } response_body;
 };
 
 static void s_on_response_call(napi_env env, napi_value on_response, void *context, void *user_data) {
@@ -40,33 +102,11 @@ static void s_on_response_call(napi_env env, napi_value on_response, void *conte
         aws_http_message_get_response_status(response, &status_code);
         AWS_NAPI_ENSURE(env, napi_create_int32(env, status_code, &params[0]));
 
-        napi_value node_headers = NULL;
-        AWS_NAPI_ENSURE(env, napi_create_array(env, &node_headers));
-        params[1] = node_headers;
-
-        size_t num_headers = aws_http_message_get_header_count(response);
-        /* This should never happen, but hey, you never know */
-        if (num_headers > UINT32_MAX) {
-            num_headers = UINT32_MAX;
-        }
-
-        for (uint32_t idx = 0; idx < num_headers; ++idx) {
-            struct aws_http_header header;
-            aws_http_message_get_header(response, &header, idx);
-
-            napi_value node_header = NULL;
-            AWS_NAPI_ENSURE(env, napi_create_array(env, &node_header));
-
-            napi_value node_name = NULL;
-            napi_value node_value = NULL;
-            AWS_NAPI_ENSURE(
-                env, napi_create_string_utf8(env, (const char *)header.name.ptr, header.name.len, &node_name));
-            AWS_NAPI_ENSURE(
-                env, napi_create_string_utf8(env, (const char *)header.value.ptr, header.value.len, &node_value));
-            AWS_NAPI_ENSURE(env, napi_set_element(env, node_header, 0, node_name));
-            AWS_NAPI_ENSURE(env, napi_set_element(env, node_header, 1, node_value));
-            AWS_NAPI_ENSURE(env, napi_set_element(env, node_headers, idx, node_header));
-        }
+        /*
+         * Hand the response's own headers to node rather than copying them, strings are only created for the headers
+         * that are actually read. The wrapper holds its own reference, so they outlive the response message.
+         */
+        AWS_NAPI_ENSURE(env, aws_napi_http_headers_wrap(env, aws_http_message_get_headers(response), &params[1]));
 
         AWS_NAPI_ENSURE(
             env,
@@ -113,60 +153,97 @@ static int s_on_response_header_block_done(
     return AWS_OP_SUCCESS;
 }
 
-struct on_body_args {
-    struct http_stream_binding *binding;
-    struct aws_byte_buf chunk;
-    struct aws_allocator *allocator;
-};
-
 static void s_external_arraybuffer_finalizer(napi_env env, void *finalize_data, void *finalize_hint) {
     (void)env;
     (void)finalize_data;
-    struct on_body_args *args = finalize_hint;
-    aws_byte_buf_clean_up(&args->chunk);
-    aws_mem_release(args->allocator, args);
+    struct aws_napi_buffer_slab *chunk = finalize_hint;
+    aws_napi_buffer_slab_release(chunk);
 }
 
-static void s_on_body_call(napi_env env, napi_value on_body, void *context, void *user_data) {
+static napi_status s_append_body_chunk(
+    napi_env env,
+    napi_value batch,
+    uint32_t *index,
+    struct aws_linked_list_node *item,
+    void *context) {
     struct http_stream_binding *binding = context;
-    struct on_body_args *args = user_data;
+    struct aws_napi_buffer_slab *chunk = AWS_CONTAINER_OF(item, struct aws_napi_buffer_slab, node);
 
     /* Callback is invoked for nodejs, update pending length */
-    aws_atomic_fetch_sub(&binding->pending_length, args->chunk.len);
+    aws_atomic_fetch_sub(&binding->pending_length, chunk->buffer.len);
+
+    /* the slab goes back to the pool when the ArrayBuffer is collected */
+    napi_value node_chunk = NULL;
+    napi_status status = napi_create_external_arraybuffer(
+        env, chunk->buffer.buffer, chunk->buffer.len, s_external_arraybuffer_finalizer, chunk, &node_chunk);
+    if (status != napi_ok) {
+        aws_napi_buffer_slab_release(chunk);
+        return status;
+    }
 
-    if (env) {
-        napi_value params[1];
-        const size_t num_params = AWS_ARRAY_SIZE(params);
+    return napi_set_element(env, batch, (*index)++, node_chunk);
+}
 
-        AWS_NAPI_ENSURE(
-            env,
-            napi_create_external_arraybuffer(
-                env, args->chunk.buffer, args->chunk.len, s_external_arraybuffer_finalizer, args, &params[0]));
+static void s_discard_body_chunk(struct aws_linked_list_node *item, void *context) {
+    struct http_stream_binding *binding = context;
+    struct aws_napi_buffer_slab *chunk = AWS_CONTAINER_OF(item, struct aws_napi_buffer_slab, node);
 
-        AWS_NAPI_ENSURE(
-            env, aws_napi_dispatch_threadsafe_function(env, binding->on_body, NULL, on_body, num_params, params));
+    /* node will never see this chunk, don't keep completion waiting on it */
+    if (binding) {
+        aws_atomic_fetch_sub(&binding->pending_length, chunk->buffer.len);
     }
+    aws_napi_buffer_slab_release(chunk);
+}
+
+static int s_write_body_to_sink(
+    struct http_stream_binding *binding,
+    struct aws_http_stream *stream,
+    const struct aws_byte_cursor *data) {
+
+    if (fwrite(data->ptr, 1, data->len, binding->response_body.file) < data->len) {
+        binding->response_body.error_code = AWS_ERROR_SYS_CALL_FAILURE;
+        return aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+    }
+    if (aws_napi_running_checksum_update(&binding->response_body.checksum, *data)) {
+        binding->response_body.error_code = aws_last_error();
+        return AWS_OP_ERR;
+    }
+    binding->response_body.length += data->len;
+
+    /* nothing is left for node to consume, so when the window is managed manually, re-open it right away */
+    if (binding->response_body.manual_window) {
+        aws_http_stream_update_window(stream, data->len);
+    }
+    return AWS_OP_SUCCESS;
 }
 
 static int s_on_response_body(struct aws_http_stream *stream, const struct aws_byte_cursor *data, void *user_data) {
-    (void)stream;
     struct http_stream_binding *binding = user_data;
+    if (binding->response_body.file) {
+        return s_write_body_to_sink(binding, stream, data);
+    }
     if (AWS_UNLIKELY(!binding->on_body)) {
         return AWS_OP_SUCCESS;
     }
 
-    struct on_body_args *args = aws_mem_calloc(binding->allocator, 1, sizeof(struct on_body_args));
-    AWS_FATAL_ASSERT(args);
-    args->allocator = binding->allocator;
+    if (aws_napi_running_checksum_update(&binding->response_body.checksum, *data)) {
+        return AWS_OP_ERR;
+    }
+    binding->response_body.length += data->len;
+
+    /* a single allocation (usually recycled) holds both the bookkeeping and the chunk's bytes */
+    struct aws_napi_buffer_slab *chunk =
+        aws_napi_buffer_slab_acquire(binding->allocator, binding->body_pool, data->len);
+    aws_byte_buf_write_from_whole_cursor(&chunk->buffer, *data);
 
     /* recording the length of data that has been pending to be invoked for nodejs */
     aws_atomic_fetch_add(&binding->pending_length, data->len);
-    args->binding = binding;
-    if (aws_byte_buf_init_copy_from_cursor(&args->chunk, binding->allocator, *data)) {
-        AWS_FATAL_ASSERT(args->chunk.buffer);
-    }
 
-    AWS_NAPI_CALL(NULL, aws_napi_queue_threadsafe_function(binding->on_body, args), { return AWS_OP_ERR; });
+    AWS_NAPI_CALL(NULL, aws_napi_queue_batched_threadsafe_function(binding->on_body, &chunk->node), {
+        aws_atomic_fetch_sub(&binding->pending_length, data->len);
+        aws_napi_buffer_slab_release(chunk);
+        return AWS_OP_ERR;
+    });
 
     return AWS_OP_SUCCESS;
 }
@@ -174,8 +251,26 @@ static int s_on_response_body(struct aws_http_stream *stream, const struct aws_b
 struct on_complete_args {
     struct http_stream_binding *binding;
     int error_code;
+    bool summarize_body;
 };
 
+/* Closes the body's destination, so everything written is visible to node by the time it hears of completion */
+static int s_body_sink_close(struct http_stream_binding *binding) {
+    if (!binding->response_body.file) {
+        return AWS_OP_SUCCESS;
+    }
+
+    int result = fclose(binding->response_body.file);
+    binding->response_body.file = NULL;
+    if (binding->response_body.error_code) {
+        return aws_raise_error(binding->response_body.error_code);
+    }
+    if (result) {
+        return aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+    }
+    return AWS_OP_SUCCESS;
+}
+
 static void s_on_complete_call(napi_env env, napi_value on_complete, void *context, void *user_data) {
     struct http_stream_binding *binding = context;
     struct on_complete_args *args = user_data;
@@ -188,19 +283,30 @@ static void s_on_complete_call(napi_env env, napi_value on_complete, void *conte
         return;
     }
 
-    napi_value params[1];
-    const size_t num_params = AWS_ARRAY_SIZE(params);
+    /* streams with a body destination or checksum also report the body's length and checksum */
+    napi_value params[3];
+    size_t num_params = 1;
 
     AWS_NAPI_ENSURE(env, napi_create_int32(env, args->error_code, &params[0]));
+    if (args->summarize_body) {
+        AWS_NAPI_ENSURE(env, napi_create_int64(env, (int64_t)binding->response_body.length, &params[1]));
+        AWS_NAPI_ENSURE(env, aws_napi_running_checksum_finalize(&binding->response_body.checksum, env, &params[2]));
+        num_params = 3;
+    }
     AWS_NAPI_ENSURE(
         env, aws_napi_dispatch_threadsafe_function(env, binding->on_complete, NULL, on_complete, num_params, params));
 
     /* No callbacks should happen now, cleanup all the threadsafe functions */
     AWS_NAPI_ENSURE(env, aws_napi_release_threadsafe_function(binding->on_response, napi_tsfn_abort));
-    AWS_NAPI_ENSURE(env, aws_napi_release_threadsafe_function(binding->on_body, napi_tsfn_abort));
+    AWS_NAPI_ENSURE(env, aws_napi_release_batched_threadsafe_function(binding->on_body, napi_tsfn_abort));
     AWS_NAPI_ENSURE(env, aws_napi_release_threadsafe_function(binding->on_complete, napi_tsfn_abort));
     AWS_NAPI_ENSURE(env, napi_delete_reference(env, binding->node_external));
 
+    if (binding->stream_manager) {
+        aws_http2_stream_manager_release(binding->stream_manager);
+        binding->stream_manager = NULL;
+    }
+
     aws_mem_release(binding->allocator, args);
 }
 
@@ -211,6 +317,10 @@ static void s_on_complete(struct aws_http_stream *stream, int error_code, void *
     AWS_FATAL_ASSERT(args);
     args->binding = binding;
     args->error_code = error_code;
+    args->summarize_body = binding->response_body.summarize;
+    if (s_body_sink_close(binding) && !args->error_code) {
+        args->error_code = aws_last_error();
+    }
     AWS_NAPI_ENSURE(NULL, aws_napi_queue_threadsafe_function(binding->on_complete, args));
 }
 
@@ -221,58 +331,118 @@ static void s_http_stream_binding_finalize(napi_env env, void *finalize_data, vo
 
     aws_http_message_release(binding->request);
     aws_http_message_release(binding->response);
+    aws_napi_buffer_pool_release(binding->body_pool);
+    if (binding->response_body.file) {
+        /* never completed */
+        fclose(binding->response_body.file);
+    }
+    aws_napi_running_checksum_clean_up(&binding->response_body.checksum);
+    if (binding->stream_manager) {
+        /* never activated */
+        aws_http2_stream_manager_release(binding->stream_manager);
+    }
+    aws_mutex_clean_up(&binding->synced_data.lock);
     aws_mem_release(binding->allocator, binding);
 }
 
-napi_value aws_napi_http_stream_new(napi_env env, napi_callback_info info) {
-    struct aws_allocator *allocator = aws_napi_get_allocator();
-    napi_value result = NULL;
-
-    napi_value node_args[5];
-    size_t num_args = AWS_ARRAY_SIZE(node_args);
-    napi_value *arg = &node_args[0];
-    AWS_NAPI_CALL(env, napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL), {
-        napi_throw_error(env, NULL, "Failed to retrieve callback information");
-        return NULL;
-    });
-    if (num_args != AWS_ARRAY_SIZE(node_args)) {
-        napi_throw_error(env, NULL, "http_stream_new needs exactly 5 arguments");
-        return NULL;
+/* Opens the file at a path, or a duplicate of a file descriptor so the caller's own stays open. Throws on failure */
+static FILE *s_body_sink_open(napi_env env, napi_value node_destination) {
+    napi_valuetype destination_type = napi_undefined;
+    AWS_NAPI_ENSURE(env, napi_typeof(env, node_destination, &destination_type));
+
+    FILE *file = NULL;
+    if (destination_type == napi_string) {
+        struct aws_string *path = aws_string_new_from_napi(env, node_destination);
+        if (!path) {
+            napi_throw_error(env, NULL, "Failed to read body destination path");
+            return NULL;
+        }
+        file = aws_fopen(aws_string_c_str(path), "wb");
+        aws_string_destroy(path);
+        if (!file) {
+            aws_napi_throw_last_error(env);
+        }
+    } else if (destination_type == napi_number) {
+        int32_t fd = -1;
+        AWS_NAPI_ENSURE(env, napi_get_value_int32(env, node_destination, &fd));
+        int dup_fd = fd >= 0 ? s_dup_fd(fd) : -1;
+        file = dup_fd >= 0 ? s_fdopen(dup_fd, "wb") : NULL;
+        if (!file) {
+            if (dup_fd >= 0) {
+                s_close_fd(dup_fd);
+            }
+            napi_throw_error(env, NULL, "Body destination is not a writable file descriptor");
+        }
+    } else {
+        napi_throw_type_error(env, NULL, "Body destination must be a file path or a file descriptor");
     }
+    return file;
+}
 
-    struct http_connection_binding *connection_binding = NULL;
-    napi_value node_binding = *arg++;
-    AWS_NAPI_CALL(env, napi_get_value_external(env, node_binding, (void **)&connection_binding), {
-        napi_throw_error(env, NULL, "Unable to extract connection from external");
+/*
+ * Creates the binding and its callbacks, taking a reference to request. Throws and returns NULL on failure, otherwise
+ * the binding is owned by the external returned in result.
+ */
+static struct http_stream_binding *s_http_stream_binding_new(
+    napi_env env,
+    struct aws_http_message *request,
+    struct aws_napi_buffer_pool *body_pool,
+    napi_value node_on_complete,
+    napi_value node_on_response,
+    napi_value node_on_body,
+    napi_value node_body_destination,
+    napi_value node_body_checksum,
+    napi_value node_manual_window_management,
+    napi_value *result) {
+
+    enum aws_napi_checksum_algorithm checksum_algorithm = AWS_NAPI_CHECKSUM_NONE;
+    if (!aws_napi_checksum_algorithm_from_napi(env, node_body_checksum, &checksum_algorithm)) {
         return NULL;
-    });
-
-    napi_value node_request = *arg++;
-    struct aws_http_message *request = aws_napi_http_message_unwrap(env, node_request);
-    /* adding a refcount for the request, which will be released as the stream object from JS land get destroyed */
-    aws_http_message_acquire(request);
-
-    napi_value node_on_complete = *arg++;
-    napi_value node_on_response = *arg++;
-    napi_value node_on_body = *arg++;
+    }
+    const bool has_body_destination = !aws_napi_is_null_or_undefined(env, node_body_destination);
+    bool manual_window = false;
+    if (!aws_napi_is_null_or_undefined(env, node_manual_window_management)) {
+        AWS_NAPI_CALL(env, napi_get_value_bool(env, node_manual_window_management, &manual_window), {
+            napi_throw_type_error(env, NULL, "manual_window_management must be a boolean or undefined");
+            return NULL;
+        });
+    }
 
+    struct aws_allocator *allocator = aws_napi_get_metrics_allocator(AWS_NAPI_METRICS_HTTP_STREAM);
     struct http_stream_binding *binding = aws_mem_calloc(allocator, 1, sizeof(struct http_stream_binding));
     if (!binding) {
         aws_napi_throw_last_error(env);
-        goto failed_binding_alloc;
+        return NULL;
     }
 
     binding->allocator = allocator;
-    binding->request = request;
     aws_atomic_init_int(&binding->pending_length, 0);
 
+    if (aws_napi_running_checksum_init(&binding->response_body.checksum, allocator, checksum_algorithm)) {
+        aws_napi_throw_last_error(env);
+        aws_mem_release(allocator, binding);
+        return NULL;
+    }
+    aws_mutex_init(&binding->synced_data.lock);
+    binding->response_body.summarize = has_body_destination || checksum_algorithm != AWS_NAPI_CHECKSUM_NONE;
+    binding->response_body.manual_window = manual_window;
+    if (has_body_destination) {
+        binding->response_body.file = s_body_sink_open(env, node_body_destination);
+        if (!binding->response_body.file) {
+            aws_napi_running_checksum_clean_up(&binding->response_body.checksum);
+            aws_mutex_clean_up(&binding->synced_data.lock);
+            aws_mem_release(allocator, binding);
+            return NULL;
+        }
+    }
+
     AWS_NAPI_CALL(
         env,
         aws_napi_create_threadsafe_function(
             env, node_on_complete, "aws_http_stream_on_complete", s_on_complete_call, binding, &binding->on_complete),
         {
             napi_throw_error(env, NULL, "on_complete must be a callback");
-            goto failed_callbacks;
+            goto failed;
         });
 
     if (!aws_napi_is_null_or_undefined(env, node_on_response)) {
@@ -287,63 +457,217 @@ napi_value aws_napi_http_stream_new(napi_env env, napi_callback_info info) {
                 &binding->on_response),
             {
                 napi_throw_error(env, NULL, "Unable to bind on_response callback");
-                goto failed_callbacks;
+                goto failed;
             });
     }
 
     if (!aws_napi_is_null_or_undefined(env, node_on_body)) {
         AWS_NAPI_CALL(
             env,
-            aws_napi_create_threadsafe_function(
-                env, node_on_body, "aws_http_stream_on_body", s_on_body_call, binding, &binding->on_body),
+            aws_napi_create_batched_threadsafe_function(
+                env,
+                node_on_body,
+                "aws_http_stream_on_body",
+                s_append_body_chunk,
+                s_discard_body_chunk,
+                binding,
+                &binding->on_body),
             {
                 napi_throw_error(env, NULL, "Unable to bind on_body callback");
-                goto failed_callbacks;
+                goto failed;
             });
     }
 
+    /* becomes the native_handle for the JS object */
+    AWS_NAPI_CALL(env, napi_create_external(env, binding, s_http_stream_binding_finalize, NULL, result), {
+        napi_throw_error(env, NULL, "Unable to create stream external");
+        goto failed;
+    });
+
+    /* adding a refcount for the request, which will be released as the stream object from JS land get destroyed */
+    aws_http_message_acquire(request);
+    binding->request = request;
+    binding->body_pool = aws_napi_buffer_pool_acquire(body_pool);
+
+    return binding;
+
+failed:
+    AWS_NAPI_ENSURE(env, aws_napi_release_threadsafe_function(binding->on_complete, napi_tsfn_abort));
+    AWS_NAPI_ENSURE(env, aws_napi_release_threadsafe_function(binding->on_response, napi_tsfn_abort));
+    AWS_NAPI_ENSURE(env, aws_napi_release_batched_threadsafe_function(binding->on_body, napi_tsfn_abort));
+    if (binding->response_body.file) {
+        fclose(binding->response_body.file);
+    }
+    aws_napi_running_checksum_clean_up(&binding->response_body.checksum);
+    aws_mutex_clean_up(&binding->synced_data.lock);
+    aws_mem_release(allocator, binding);
+    return NULL;
+}
+
+static struct aws_http_make_request_options s_http_stream_request_options(struct http_stream_binding *binding) {
     struct aws_http_make_request_options request_options = {
         .self_size = sizeof(struct aws_http_make_request_options),
-        .request = request,
+        .request = binding->request,
         .user_data = binding,
         .on_response_headers = s_on_response_headers,
         .on_response_header_block_done = s_on_response_header_block_done,
         .on_response_body = s_on_response_body,
         .on_complete = s_on_complete,
     };
+    return request_options;
+}
 
-    /* becomes the native_handle for the JS object */
-    AWS_NAPI_CALL(env, napi_create_external(env, binding, s_http_stream_binding_finalize, NULL, &result), {
-        napi_throw_error(env, NULL, "Unable to create stream external");
-        goto failed_external;
+napi_value aws_napi_http_stream_new(napi_env env, napi_callback_info info) {
+    napi_value node_args[8];
+    size_t num_args = AWS_ARRAY_SIZE(node_args);
+    napi_value *arg = &node_args[0];
+    AWS_NAPI_CALL(env, napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL), {
+        napi_throw_error(env, NULL, "Failed to retrieve callback information");
+        return NULL;
     });
+    if (num_args != AWS_ARRAY_SIZE(node_args)) {
+        napi_throw_error(env, NULL, "http_stream_new needs exactly 8 arguments");
+        return NULL;
+    }
+
+    struct http_connection_binding *connection_binding = NULL;
+    napi_value node_binding = *arg++;
+    AWS_NAPI_CALL(env, napi_get_value_external(env, node_binding, (void **)&connection_binding), {
+        napi_throw_error(env, NULL, "Unable to extract connection from external");
+        return NULL;
+    });
+
+    napi_value node_request = *arg++;
+    struct aws_http_message *request = aws_napi_http_message_unwrap(env, node_request);
 
+    napi_value node_on_complete = *arg++;
+    napi_value node_on_response = *arg++;
+    napi_value node_on_body = *arg++;
+    napi_value node_body_destination = *arg++;
+    napi_value node_body_checksum = *arg++;
+    napi_value node_manual_window_management = *arg++;
+
+    napi_value result = NULL;
+    struct http_stream_binding *binding = s_http_stream_binding_new(
+        env,
+        request,
+        aws_napi_get_http_connection_body_pool(connection_binding),
+        node_on_complete,
+        node_on_response,
+        node_on_body,
+        node_body_destination,
+        node_body_checksum,
+        node_manual_window_management,
+        &result);
+    if (!binding) {
+        return NULL;
+    }
+
+    struct aws_http_make_request_options request_options = s_http_stream_request_options(binding);
     struct aws_http_connection *connection = aws_napi_get_http_connection(connection_binding);
     binding->stream = aws_http_connection_make_request(connection, &request_options);
 
     if (!binding->stream) {
         napi_throw_error(env, NULL, "Unable to create native aws_http_stream");
-        result = NULL;
-        goto failed_request;
+        /* the external's finalizer frees the rest */
+        AWS_NAPI_ENSURE(env, aws_napi_release_threadsafe_function(binding->on_complete, napi_tsfn_abort));
+        AWS_NAPI_ENSURE(env, aws_napi_release_threadsafe_function(binding->on_response, napi_tsfn_abort));
+        AWS_NAPI_ENSURE(env, aws_napi_release_batched_threadsafe_function(binding->on_body, napi_tsfn_abort));
+        return NULL;
     }
 
-    goto done;
+    return result;
+}
 
-failed_request:
-failed_external:
-failed_callbacks:
-    if (binding) {
-        AWS_NAPI_ENSURE(env, aws_napi_release_threadsafe_function(binding->on_complete, napi_tsfn_abort));
-        AWS_NAPI_ENSURE(env, aws_napi_release_threadsafe_function(binding->on_response, napi_tsfn_abort));
-        AWS_NAPI_ENSURE(env, aws_napi_release_threadsafe_function(binding->on_body, napi_tsfn_abort));
+napi_value aws_napi_http_stream_new_from_manager(napi_env env, napi_callback_info info) {
+    napi_value node_args[8];
+    size_t num_args = AWS_ARRAY_SIZE(node_args);
+    napi_value *arg = &node_args[0];
+    AWS_NAPI_CALL(env, napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL), {
+        napi_throw_error(env, NULL, "Failed to retrieve callback information");
+        return NULL;
+    });
+    if (num_args != AWS_ARRAY_SIZE(node_args)) {
+        napi_throw_error(env, NULL, "http_stream_new_from_manager needs exactly 8 arguments");
+        return NULL;
     }
-    aws_mem_release(allocator, binding);
-failed_binding_alloc:
-done:
+
+    struct http2_stream_manager_binding *manager_binding = NULL;
+    napi_value node_manager = *arg++;
+    AWS_NAPI_CALL(env, napi_get_value_external(env, node_manager, (void **)&manager_binding), {
+        napi_throw_error(env, NULL, "Unable to extract stream manager from external");
+        return NULL;
+    });
+
+    napi_value node_request = *arg++;
+    struct aws_http_message *request = aws_napi_http_message_unwrap(env, node_request);
+
+    napi_value node_on_complete = *arg++;
+    napi_value node_on_response = *arg++;
+    napi_value node_on_body = *arg++;
+    napi_value node_body_destination = *arg++;
+    napi_value node_body_checksum = *arg++;
+    napi_value node_manual_window_management = *arg++;
+
+    /* HTTP/2 carries the method, path and authority as pseudo-headers, translate requests built for HTTP/1.1 */
+    struct aws_http_message *h2_request = NULL;
+    if (aws_http_message_get_protocol_version(request) != AWS_HTTP_VERSION_2) {
+        h2_request = aws_http2_message_new_from_http1(aws_napi_get_allocator(), request);
+        if (!h2_request) {
+            aws_napi_throw_last_error(env);
+            return NULL;
+        }
+        request = h2_request;
+    }
+
+    napi_value result = NULL;
+    struct http_stream_binding *binding = s_http_stream_binding_new(
+        env,
+        request,
+        aws_napi_get_http2_stream_manager_body_pool(manager_binding),
+        node_on_complete,
+        node_on_response,
+        node_on_body,
+        node_body_destination,
+        node_body_checksum,
+        node_manual_window_management,
+        &result);
+    /* the binding holds its own reference if it was created */
+    aws_http_message_release(h2_request);
+    if (!binding) {
+        return NULL;
+    }
+
+    binding->stream_manager = aws_http2_stream_manager_acquire(aws_napi_get_http2_stream_manager(manager_binding));
 
     return result;
 }
 
+static void s_on_stream_acquired(struct aws_http_stream *stream, int error_code, void *user_data) {
+    struct http_stream_binding *binding = user_data;
+    if (error_code) {
+        /* no stream will ever report completion, do it on its behalf */
+        s_on_complete(NULL, error_code, binding);
+        return;
+    }
+
+    /* the manager has already activated it */
+    aws_mutex_lock(&binding->synced_data.lock);
+    const bool close_requested = binding->synced_data.close_requested;
+    const size_t window_increment = binding->synced_data.window_increment;
+    binding->synced_data.window_increment = 0;
+    binding->stream = close_requested ? NULL : stream;
+    aws_mutex_unlock(&binding->synced_data.lock);
+
+    if (window_increment > 0) {
+        aws_http_stream_update_window(stream, window_increment);
+    }
+    if (close_requested) {
+        /* js closed it before it arrived, it runs to completion without anyone holding it */
+        aws_http_stream_release(stream);
+    }
+}
+
 napi_value aws_napi_http_stream_activate(napi_env env, napi_callback_info info) {
     napi_value node_args[1];
     size_t num_args = AWS_ARRAY_SIZE(node_args);
@@ -363,6 +687,18 @@ napi_value aws_napi_http_stream_activate(napi_env env, napi_callback_info info)
         napi_throw_error(env, NULL, "Unable to reference stream external");
     });
 
+    if (binding->stream_manager) {
+        struct aws_http_make_request_options request_options = s_http_stream_request_options(binding);
+        struct aws_http2_stream_manager_acquire_stream_options acquire_options = {
+            .options = &request_options,
+            .callback = s_on_stream_acquired,
+            .user_data = binding,
+        };
+        /* completion is reported through on_complete, including failure to acquire */
+        aws_http2_stream_manager_acquire_stream(binding->stream_manager, &acquire_options);
+        return NULL;
+    }
+
     if (aws_http_stream_activate(binding->stream)) {
         AWS_NAPI_ENSURE(env, napi_delete_reference(env, binding->node_external));
         aws_napi_throw_last_error(env);
@@ -386,7 +722,64 @@ napi_value aws_napi_http_stream_close(napi_env env, napi_callback_info info) {
     struct http_stream_binding *binding = NULL;
     AWS_NAPI_ENSURE(env, napi_get_value_external(env, node_args[0], (void **)&binding));
 
-    aws_http_stream_release(binding->stream);
+    /* a manager's stream that hasn't arrived yet is released as soon as it does */
+    aws_mutex_lock(&binding->synced_data.lock);
+    struct aws_http_stream *stream = binding->stream;
+    binding->stream = NULL;
+    binding->synced_data.close_requested = true;
+    aws_mutex_unlock(&binding->synced_data.lock);
+
+    aws_http_stream_release(stream);
+
+    return NULL;
+}
+
+napi_value aws_napi_http_stream_update_window(napi_env env, napi_callback_info info) {
+    napi_value node_args[2];
+    size_t num_args = AWS_ARRAY_SIZE(node_args);
+    napi_value *arg = &node_args[0];
+    AWS_NAPI_CALL(env, napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL), {
+        napi_throw_error(env, NULL, "Failed to retrieve callback information");
+        return NULL;
+    });
+    if (num_args != AWS_ARRAY_SIZE(node_args)) {
+        napi_throw_error(env, NULL, "http_stream_update_window needs exactly 2 arguments");
+        return NULL;
+    }
+
+    struct http_stream_binding *binding = NULL;
+    AWS_NAPI_CALL(env, napi_get_value_external(env, *arg++, (void **)&binding), {
+        napi_throw_error(env, NULL, "Unable to extract stream from external");
+        return NULL;
+    });
+
+    int64_t increment_size = 0;
+    AWS_NAPI_CALL(env, napi_get_value_int64(env, *arg++, &increment_size), {
+        napi_throw_type_error(env, NULL, "increment_size must be a number");
+        return NULL;
+    });
+    if (increment_size < 0) {
+        napi_throw_range_error(env, NULL, "increment_size must not be negative");
+        return NULL;
+    }
+
+    if (increment_size == 0) {
+        return NULL;
+    }
+
+    /* a manager's stream that hasn't arrived yet gets the whole increment once it does */
+    aws_mutex_lock(&binding->synced_data.lock);
+    struct aws_http_stream *stream = binding->stream;
+    if (!stream && !binding->synced_data.close_requested) {
+        binding->synced_data.window_increment =
+            aws_add_size_saturating(binding->synced_data.window_increment, (size_t)increment_size);
+    }
+    aws_mutex_unlock(&binding->synced_data.lock);
+
+    /* aws_http_stream_update_window() is thread-safe, the window update is scheduled onto the channel's thread */
+    if (stream) {
+        aws_http_stream_update_window(stream, (size_t)increment_size);
+    }
 
     return NULL;
 }
@@ -8,7 +8,10 @@
 #include "module.h"
 
 napi_value aws_napi_http_stream_new(napi_env env, napi_callback_info info);
+/* For streams from an HTTP/2 stream manager, which are acquired from the manager when activated */
+napi_value aws_napi_http_stream_new_from_manager(napi_env env, napi_callback_info info);
 napi_value aws_napi_http_stream_activate(napi_env env, napi_callback_info info);
 napi_value aws_napi_http_stream_close(napi_env env, napi_callback_info info);
+napi_value aws_napi_http_stream_update_window(napi_env env, napi_callback_info info);
 
 #endif /* AWS_CRT_NODEJS_HTTP_STREAM_H */
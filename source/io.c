@@ -3,8 +3,17 @@
  * SPDX-License-Identifier: Apache-2.0.
  */
 #include "io.h"
+#include "checksums.h"
+#include "host_resolver.h"
 #include "logger.h"
+#include "metrics.h"
 
+#include <aws/cal/hash.h>
+
+#include <aws/common/atomics.h>
+#include <aws/common/file.h>
+#include <aws/common/hash_table.h>
+#include <aws/common/linked_list.h>
 #include <aws/common/logging.h>
 #include <aws/common/mutex.h>
 #include <aws/io/channel_bootstrap.h>
@@ -14,8 +23,28 @@
 #include <aws/io/tls_channel_handler.h>
 
 #ifdef _MSC_VER
+#    include <io.h>
+#    define fdopen _fdopen
 #    pragma warning(disable : 4456) /* When nesting AWS_NAPI_CALL and AWS_NAPI_ENSURE, status's shadow eachother */
+#else
+#    include <unistd.h>
+#endif
+
+static int s_dup_fd(int fd) {
+#ifdef _MSC_VER
+    return _dup(fd);
+#else
+    return dup(fd);
+#endif
+}
+
+static void s_close_fd(int fd) {
+#ifdef _MSC_VER
+    _close(fd);
+#else
+    close(fd);
 #endif
+}
 
 napi_value aws_napi_error_code_to_string(napi_env env, napi_callback_info info) {
 
@@ -98,6 +127,58 @@ napi_value aws_napi_io_logging_enable(napi_env env, napi_callback_info info) {
         return NULL;
     }
 
+    /* optional native destination: a file path to append to, or an open file descriptor */
+    if (num_args > 1 && !aws_napi_is_null_or_undefined(env, node_args[1])) {
+        napi_valuetype destination_type = napi_undefined;
+        AWS_NAPI_ENSURE(env, napi_typeof(env, node_args[1], &destination_type));
+
+        if (destination_type == napi_string) {
+            struct aws_string *filename = aws_string_new_from_napi(env, node_args[1]);
+            if (!filename) {
+                napi_throw_error(env, NULL, "Failed to read log file name");
+                return NULL;
+            }
+            int result = aws_napi_logger_set_destination(aws_string_c_str(filename), NULL);
+            aws_string_destroy(filename);
+            if (result) {
+                aws_napi_throw_last_error(env);
+                return NULL;
+            }
+        } else if (destination_type == napi_number) {
+            int32_t fd = -1;
+            AWS_NAPI_ENSURE(env, napi_get_value_int32(env, node_args[1], &fd));
+            /* the logger closes its FILE when the destination goes away, which must not close the caller's fd */
+            FILE *file = NULL;
+            if (fd == 1 || fd == 2) {
+                file = (fd == 1) ? stdout : stderr;
+            } else if (fd >= 0) {
+                int dup_fd = s_dup_fd(fd);
+                file = dup_fd >= 0 ? fdopen(dup_fd, "a") : NULL;
+                if (!file && dup_fd >= 0) {
+                    s_close_fd(dup_fd);
+                }
+            }
+            if (!file) {
+                napi_throw_error(env, NULL, "Log destination is not a writable file descriptor");
+                return NULL;
+            }
+            if (aws_napi_logger_set_destination(NULL, file)) {
+                /* the logger never took ownership, and our FILE is the only thing left holding the dup'd fd */
+                if (file != stdout && file != stderr) {
+                    fclose(file);
+                }
+                aws_napi_throw_last_error(env);
+                return NULL;
+            }
+        } else {
+            napi_throw_type_error(env, NULL, "Log destination must be a file path or a file descriptor");
+            return NULL;
+        }
+    } else if (log_level == AWS_LL_NONE) {
+        /* disabling logging closes the native destination, rather than holding it open for nothing */
+        aws_napi_logger_clear_destination();
+    }
+
     aws_napi_logger_set_level(log_level);
 
     return NULL;
@@ -118,9 +199,125 @@ napi_value aws_napi_is_alpn_available(napi_env env, napi_callback_info info) {
     return node_bool;
 }
 
+napi_value aws_napi_io_set_default_event_loop_group_options(napi_env env, napi_callback_info info) {
+    napi_value node_args[2];
+    size_t num_args = AWS_ARRAY_SIZE(node_args);
+    napi_value *arg = &node_args[0];
+    AWS_NAPI_CALL(env, napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL), {
+        napi_throw_error(env, NULL, "Failed to retrieve callback information");
+        return NULL;
+    });
+    if (num_args != AWS_ARRAY_SIZE(node_args)) {
+        napi_throw_error(env, NULL, "io_set_default_event_loop_group_options needs exactly 2 arguments");
+        return NULL;
+    }
+
+    uint32_t num_threads = 0;
+    AWS_NAPI_CALL(env, napi_get_value_uint32(env, *arg++, &num_threads), {
+        napi_throw_type_error(env, NULL, "num_threads must be a number");
+        return NULL;
+    });
+    if (num_threads > UINT16_MAX) {
+        napi_throw_range_error(env, NULL, "num_threads must be less than 65536");
+        return NULL;
+    }
+
+    napi_value node_cpu_group = *arg++;
+    uint16_t cpu_group = 0;
+    bool has_cpu_group = false;
+    if (!aws_napi_is_null_or_undefined(env, node_cpu_group)) {
+        uint32_t cpu_group_value = 0;
+        AWS_NAPI_CALL(env, napi_get_value_uint32(env, node_cpu_group, &cpu_group_value), {
+            napi_throw_type_error(env, NULL, "cpu_group must be a number or undefined");
+            return NULL;
+        });
+        if (cpu_group_value > UINT16_MAX) {
+            napi_throw_range_error(env, NULL, "cpu_group must be less than 65536");
+            return NULL;
+        }
+        cpu_group = (uint16_t)cpu_group_value;
+        has_cpu_group = true;
+    }
+
+    if (aws_napi_set_default_event_loop_group_options((uint16_t)num_threads, has_cpu_group ? &cpu_group : NULL)) {
+        napi_throw_error(
+            env, NULL, "The default event loop group is already in use, its options must be set before first use");
+    }
+
+    return NULL;
+}
+
+/** Finalizer for an event_loop_group external */
+static void s_event_loop_group_finalize(napi_env env, void *finalize_data, void *finalize_hint) {
+    (void)env;
+    (void)finalize_hint;
+
+    struct aws_event_loop_group *elg = finalize_data;
+    aws_event_loop_group_release(elg);
+}
+
+napi_value aws_napi_io_event_loop_group_new(napi_env env, napi_callback_info info) {
+    napi_value node_args[2];
+    size_t num_args = AWS_ARRAY_SIZE(node_args);
+    napi_value *arg = &node_args[0];
+    AWS_NAPI_CALL(env, napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL), {
+        napi_throw_error(env, NULL, "Failed to retrieve callback information");
+        return NULL;
+    });
+    if (num_args != AWS_ARRAY_SIZE(node_args)) {
+        napi_throw_error(env, NULL, "io_event_loop_group_new needs exactly 2 arguments");
+        return NULL;
+    }
+
+    uint32_t num_threads = 0;
+    AWS_NAPI_CALL(env, napi_get_value_uint32(env, *arg++, &num_threads), {
+        napi_throw_type_error(env, NULL, "num_threads must be a number");
+        return NULL;
+    });
+    if (num_threads > UINT16_MAX) {
+        napi_throw_range_error(env, NULL, "num_threads must be less than 65536");
+        return NULL;
+    }
+
+    struct aws_allocator *allocator = aws_napi_get_allocator();
+    struct aws_event_loop_group *elg = NULL;
+
+    napi_value node_cpu_group = *arg++;
+    if (!aws_napi_is_null_or_undefined(env, node_cpu_group)) {
+        uint32_t cpu_group = 0;
+        AWS_NAPI_CALL(env, napi_get_value_uint32(env, node_cpu_group, &cpu_group), {
+            napi_throw_type_error(env, NULL, "cpu_group must be a number or undefined");
+            return NULL;
+        });
+        if (cpu_group > UINT16_MAX) {
+            napi_throw_range_error(env, NULL, "cpu_group must be less than 65536");
+            return NULL;
+        }
+        elg = aws_event_loop_group_new_default_pinned_to_cpu_group(
+            allocator, (uint16_t)num_threads, (uint16_t)cpu_group, NULL);
+    } else {
+        elg = aws_event_loop_group_new_default(allocator, (uint16_t)num_threads, NULL);
+    }
+
+    if (!elg) {
+        aws_napi_throw_last_error(env);
+        return NULL;
+    }
+
+    napi_value node_external = NULL;
+    AWS_NAPI_CALL(env, napi_create_external(env, elg, s_event_loop_group_finalize, NULL, &node_external), {
+        napi_throw_error(env, NULL, "Failed create n-api external");
+        aws_event_loop_group_release(elg);
+        return NULL;
+    });
+
+    return node_external;
+}
+
 struct client_bootstrap_binding {
     struct aws_client_bootstrap *bootstrap;
     struct aws_host_resolver *resolver;
+    struct aws_event_loop_group *elg;
 };
 
 struct aws_client_bootstrap *aws_napi_get_client_bootstrap(struct client_bootstrap_binding *binding) {
@@ -140,6 +337,7 @@ static void s_client_bootstrap_finalize(napi_env env, void *finalize_data, void
 
     aws_host_resolver_release(binding->resolver);
     aws_client_bootstrap_release(binding->bootstrap);
+    aws_event_loop_group_release(binding->elg);
 
     aws_mem_release(allocator, binding);
 }
@@ -149,27 +347,76 @@ static void s_client_bootstrap_finalize(napi_env env, void *finalize_data, void
 #    pragma warning(disable : 4204 4221) /* non-standard aggregate initializer warnings */
 #endif
 
+/* Reads an optional non-negative count, leaving out untouched if value is null or undefined */
+static bool s_get_optional_size(napi_env env, napi_value value, const char *type_error, size_t *out) {
+    if (aws_napi_is_null_or_undefined(env, value)) {
+        return true;
+    }
+    uint32_t result = 0;
+    AWS_NAPI_CALL(env, napi_get_value_uint32(env, value, &result), {
+        napi_throw_type_error(env, NULL, type_error);
+        return false;
+    });
+    *out = (size_t)result;
+    return true;
+}
+
 napi_value aws_napi_io_client_bootstrap_new(napi_env env, napi_callback_info info) {
-    (void)info;
+    napi_value node_args[3];
+    size_t num_args = AWS_ARRAY_SIZE(node_args);
+    napi_value *arg = &node_args[0];
+    AWS_NAPI_CALL(env, napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL), {
+        napi_throw_error(env, NULL, "Failed to retrieve callback information");
+        return NULL;
+    });
+    if (num_args != AWS_ARRAY_SIZE(node_args)) {
+        napi_throw_error(env, NULL, "io_client_bootstrap_new needs exactly 3 arguments");
+        return NULL;
+    }
+
+    struct aws_event_loop_group *elg = NULL;
+    napi_value node_elg = *arg++;
+    if (!aws_napi_is_null_or_undefined(env, node_elg)) {
+        AWS_NAPI_CALL(env, napi_get_value_external(env, node_elg, (void **)&elg), {
+            napi_throw_type_error(env, NULL, "event_loop_group must be undefined or a valid EventLoopGroup");
+            return NULL;
+        });
+    } else {
+        elg = aws_napi_get_node_elg();
+    }
+
+    struct aws_napi_host_resolver_options resolver_options = {
+        .el_group = elg,
+        .max_entries = AWS_NAPI_HOST_RESOLVER_DEFAULT_MAX_ENTRIES,
+        .max_ttl_secs = AWS_NAPI_HOST_RESOLVER_DEFAULT_MAX_TTL_SECS,
+    };
+    if (!s_get_optional_size(
+            env, *arg++, "max_entries must be a number or undefined", &resolver_options.max_entries) ||
+        !s_get_optional_size(
+            env, *arg++, "max_ttl_secs must be a number or undefined", &resolver_options.max_ttl_secs)) {
+        return NULL;
+    }
 
     struct aws_allocator *allocator = aws_napi_get_allocator();
 
-    struct client_bootstrap_binding *binding = aws_mem_acquire(allocator, sizeof(struct client_bootstrap_binding));
-    AWS_ZERO_STRUCT(*binding);
+    struct client_bootstrap_binding *binding = aws_mem_calloc(allocator, 1, sizeof(struct client_bootstrap_binding));
+    if (!binding) {
+        aws_napi_throw_last_error(env);
+        goto clean_up;
+    }
 
-    struct aws_host_resolver_default_options resolver_options = {
-        .max_entries = 64,
-        .el_group = aws_napi_get_node_elg(),
-    };
+    /* the bootstrap may outlive the javascript EventLoopGroup object */
+    binding->elg = aws_event_loop_group_acquire(elg);
 
-    binding->resolver = aws_host_resolver_new_default(allocator, &resolver_options);
+    binding->resolver = aws_napi_host_resolver_new(allocator, &resolver_options);
     if (binding->resolver == NULL) {
         goto clean_up;
     }
 
     struct aws_client_bootstrap_options options = {
-        .event_loop_group = aws_napi_get_node_elg(),
+        .event_loop_group = elg,
         .host_resolver = binding->resolver,
+        .host_resolution_config = aws_napi_host_resolver_get_config(binding->resolver),
     };
 
     binding->bootstrap = aws_client_bootstrap_new(allocator, &options);
@@ -187,173 +434,633 @@ napi_value aws_napi_io_client_bootstrap_new(napi_env env, napi_callback_info inf
     return node_external;
 
 clean_up:
-    if (binding->bootstrap) {
-        aws_client_bootstrap_release(binding->bootstrap);
-    }
-    if (binding->resolver) {
-        aws_host_resolver_release(binding->resolver);
-    }
     if (binding) {
+        if (binding->bootstrap) {
+            aws_client_bootstrap_release(binding->bootstrap);
+        }
+        if (binding->resolver) {
+            aws_host_resolver_release(binding->resolver);
+        }
+        aws_event_loop_group_release(binding->elg);
         aws_mem_release(allocator, binding);
     }
 
     return NULL;
 }
 
-#ifdef _MSC_VER
-#    pragma warning(pop)
-#endif
-
-/** Finalizer for a tls_ctx external */
-static void s_tls_ctx_finalize(napi_env env, void *finalize_data, void *finalize_hint) {
-
-    (void)env;
-    (void)finalize_hint;
-
-    struct aws_tls_ctx *tls_ctx = finalize_data;
-    AWS_ASSERT(tls_ctx);
+/* Resolver of the bootstrap in node_bootstrap, or the default resolver if it is null or undefined */
+static struct aws_host_resolver *s_get_host_resolver(napi_env env, napi_value node_bootstrap) {
+    if (aws_napi_is_null_or_undefined(env, node_bootstrap)) {
+        return aws_napi_get_default_host_resolver();
+    }
 
-    aws_tls_ctx_release(tls_ctx);
+    struct client_bootstrap_binding *binding = NULL;
+    AWS_NAPI_CALL(env, napi_get_value_external(env, node_bootstrap, (void **)&binding), {
+        napi_throw_type_error(env, NULL, "bootstrap must be undefined or a valid ClientBootstrap");
+        return NULL;
+    });
+    return binding->resolver;
 }
 
-napi_value aws_napi_io_tls_ctx_new(napi_env env, napi_callback_info info) {
-
-    struct aws_allocator *alloc = aws_napi_get_allocator();
-    napi_status status = napi_ok;
-    (void)status;
-
-    napi_value node_args[12];
+napi_value aws_napi_io_set_default_host_resolver_options(napi_env env, napi_callback_info info) {
+    napi_value node_args[2];
     size_t num_args = AWS_ARRAY_SIZE(node_args);
     napi_value *arg = &node_args[0];
-    if (napi_ok != napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL)) {
-        napi_throw_error(env, NULL, "Failed to retreive callback information");
+    AWS_NAPI_CALL(env, napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL), {
+        napi_throw_error(env, NULL, "Failed to retrieve callback information");
         return NULL;
-    }
+    });
     if (num_args != AWS_ARRAY_SIZE(node_args)) {
-        napi_throw_error(env, NULL, "aws_nodejs_io_client_tls_ctx_new needs exactly 12 arguments");
+        napi_throw_error(env, NULL, "io_set_default_host_resolver_options needs exactly 2 arguments");
         return NULL;
     }
 
-    napi_value result = NULL;
+    size_t max_entries = AWS_NAPI_HOST_RESOLVER_DEFAULT_MAX_ENTRIES;
+    size_t max_ttl_secs = AWS_NAPI_HOST_RESOLVER_DEFAULT_MAX_TTL_SECS;
+    if (!s_get_optional_size(env, *arg++, "max_entries must be a number or undefined", &max_entries) ||
+        !s_get_optional_size(env, *arg++, "max_ttl_secs must be a number or undefined", &max_ttl_secs)) {
+        return NULL;
+    }
 
-#ifdef __APPLE__
-    struct aws_byte_buf pkcs12_path;
-    AWS_ZERO_STRUCT(pkcs12_path);
-    struct aws_byte_buf pkcs12_pwd;
-    AWS_ZERO_STRUCT(pkcs12_pwd);
-#endif
+    if (aws_napi_set_default_host_resolver_options(max_entries, max_ttl_secs)) {
+        napi_throw_error(
+            env, NULL, "The default host resolver is already in use, its options must be set before first use");
+    }
 
-    struct aws_tls_ctx_options ctx_options;
-    AWS_ZERO_STRUCT(ctx_options);
+    return NULL;
+}
 
-    struct aws_string *ca_path = NULL;
-    struct aws_string *ca_file = NULL;
+/*
+ * Pre-resolution: resolves every host at once, and reports back when the last one completes. The addresses stay in
+ * the resolver's cache, so connections made to those hosts within the TTL skip DNS.
+ */
+struct host_pre_resolve;
+
+struct host_pre_resolution {
+    struct host_pre_resolve *pre_resolve;
+    struct aws_string *host_name;
+    int error_code;
+    /* struct aws_string *, initialized by the resolve callback */
+    struct aws_array_list addresses;
+};
 
-    struct aws_byte_buf certificate;
-    AWS_ZERO_STRUCT(certificate);
-    struct aws_byte_buf private_key;
-    AWS_ZERO_STRUCT(private_key);
-    struct aws_byte_buf ca_buf;
-    AWS_ZERO_STRUCT(ca_buf);
+struct host_pre_resolve {
+    struct aws_allocator *allocator;
+    napi_threadsafe_function on_resolved;
+    /* one per host, plus one held until every resolve has been started */
+    struct aws_atomic_var pending;
+    size_t num_hosts;
+    struct host_pre_resolution *hosts;
+};
 
-    struct aws_string *cert_path = NULL;
-    struct aws_string *pkey_path = NULL;
-    struct aws_string *alpn_list = NULL;
+/* the list of addresses stays zeroed if the host was never resolved, or copying its addresses failed */
+static size_t s_host_pre_resolution_num_addresses(const struct host_pre_resolution *host) {
+    return aws_array_list_is_valid(&host->addresses) ? aws_array_list_length(&host->addresses) : 0;
+}
 
-    uint32_t min_tls_version = AWS_IO_TLS_VER_SYS_DEFAULTS;
-    napi_value node_tls_version = *arg++;
-    if (!aws_napi_is_null_or_undefined(env, node_tls_version)) {
-        napi_value node_number;
-        if (napi_ok != napi_coerce_to_number(env, node_tls_version, &node_number)) {
-            napi_throw_type_error(env, NULL, "min_tls_version must be an enum/Number (or convertible to a Number)");
-            return result;
+static void s_host_pre_resolve_destroy(struct host_pre_resolve *pre_resolve) {
+    for (size_t i = 0; i < pre_resolve->num_hosts; ++i) {
+        struct host_pre_resolution *host = &pre_resolve->hosts[i];
+        const size_t num_addresses = s_host_pre_resolution_num_addresses(host);
+        for (size_t j = 0; j < num_addresses; ++j) {
+            struct aws_string *address = NULL;
+            aws_array_list_get_at(&host->addresses, &address, j);
+            aws_string_destroy(address);
         }
-        status = napi_get_value_uint32(env, node_number, &min_tls_version);
-        AWS_FATAL_ASSERT(status == napi_ok); /* We coerced the value to a number, so this must return ok */
+        aws_array_list_clean_up(&host->addresses);
+        aws_string_destroy(host->host_name);
     }
+    aws_mem_release(pre_resolve->allocator, pre_resolve);
+}
 
-    napi_value node_ca_file = *arg++;
-    if (!aws_napi_is_null_or_undefined(env, node_ca_file)) {
-        ca_file = aws_string_new_from_napi(env, node_ca_file);
-        if (!ca_file) {
-            napi_throw_type_error(env, NULL, "ca_filepath must be a String (or convertible to a String)");
-            goto cleanup;
-        }
+static void s_host_pre_resolve_complete_one(struct host_pre_resolve *pre_resolve) {
+    if (aws_atomic_fetch_sub(&pre_resolve->pending, 1) == 1) {
+        AWS_NAPI_ENSURE(NULL, aws_napi_queue_threadsafe_function(pre_resolve->on_resolved, pre_resolve));
     }
+}
 
-    napi_value node_ca_path = *arg++;
-    if (!aws_napi_is_null_or_undefined(env, node_ca_path)) {
-        ca_path = aws_string_new_from_napi(env, node_ca_path);
-        if (!ca_path) {
-            napi_throw_type_error(env, NULL, "ca_dirpath must be a String (or convertible to a String)");
-            goto cleanup;
+static void s_on_host_pre_resolved(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name,
+    int error_code,
+    const struct aws_array_list *host_addresses,
+    void *user_data) {
+    (void)resolver;
+    (void)host_name;
+    struct host_pre_resolution *host = user_data;
+    struct host_pre_resolve *pre_resolve = host->pre_resolve;
+
+    host->error_code = error_code;
+    const size_t num_addresses = host_addresses ? aws_array_list_length(host_addresses) : 0;
+    if (aws_array_list_init_dynamic(
+            &host->addresses, pre_resolve->allocator, num_addresses, sizeof(struct aws_string *))) {
+        host->error_code = aws_last_error();
+    } else {
+        for (size_t i = 0; i < num_addresses; ++i) {
+            struct aws_host_address *address = NULL;
+            aws_array_list_get_at_ptr(host_addresses, (void **)&address, i);
+            struct aws_string *address_copy = aws_string_new_from_string(pre_resolve->allocator, address->address);
+            if (address_copy) {
+                aws_array_list_push_back(&host->addresses, &address_copy);
+            }
         }
     }
 
-    napi_value node_ca_buf = *arg++;
-    if (!aws_napi_is_null_or_undefined(env, node_ca_buf)) {
-        if (aws_byte_buf_init_from_napi(&ca_buf, env, node_ca_buf)) {
-            napi_throw_type_error(env, NULL, "certificate_authority must be a String (or convertible to a String)");
-            goto cleanup;
-        }
-    }
+    s_host_pre_resolve_complete_one(pre_resolve);
+}
 
-    napi_value node_alpn = *arg++;
-    if (!aws_napi_is_null_or_undefined(env, node_alpn)) {
-        alpn_list = aws_string_new_from_napi(env, node_alpn);
-        if (!alpn_list) {
-            napi_throw_type_error(env, NULL, "alpn_list must be a String (or convertible to a String)");
-            goto cleanup;
+static void s_host_pre_resolve_call(napi_env env, napi_value on_resolved, void *context, void *user_data) {
+    (void)context;
+    struct host_pre_resolve *pre_resolve = user_data;
+
+    if (env) {
+        napi_value node_results = NULL;
+        AWS_NAPI_ENSURE(env, napi_create_array_with_length(env, pre_resolve->num_hosts, &node_results));
+        for (size_t i = 0; i < pre_resolve->num_hosts; ++i) {
+            const struct host_pre_resolution *host = &pre_resolve->hosts[i];
+            const size_t num_addresses = s_host_pre_resolution_num_addresses(host);
+
+            napi_value node_result = NULL;
+            napi_value node_value = NULL;
+            napi_value node_addresses = NULL;
+            AWS_NAPI_ENSURE(env, napi_create_object(env, &node_result));
+            AWS_NAPI_ENSURE(
+                env,
+                napi_create_string_utf8(env, aws_string_c_str(host->host_name), host->host_name->len, &node_value));
+            AWS_NAPI_ENSURE(env, napi_set_named_property(env, node_result, "host_name", node_value));
+            AWS_NAPI_ENSURE(env, napi_create_array_with_length(env, num_addresses, &node_addresses));
+            for (size_t j = 0; j < num_addresses; ++j) {
+                struct aws_string *address = NULL;
+                aws_array_list_get_at(&host->addresses, &address, j);
+                AWS_NAPI_ENSURE(
+                    env, napi_create_string_utf8(env, aws_string_c_str(address), address->len, &node_value));
+                AWS_NAPI_ENSURE(env, napi_set_element(env, node_addresses, (uint32_t)j, node_value));
+            }
+            AWS_NAPI_ENSURE(env, napi_set_named_property(env, node_result, "addresses", node_addresses));
+            AWS_NAPI_ENSURE(env, napi_create_int32(env, host->error_code, &node_value));
+            AWS_NAPI_ENSURE(env, napi_set_named_property(env, node_result, "error_code", node_value));
+            AWS_NAPI_ENSURE(env, napi_set_element(env, node_results, (uint32_t)i, node_result));
         }
+
+        AWS_NAPI_ENSURE(
+            env,
+            aws_napi_dispatch_threadsafe_function(env, pre_resolve->on_resolved, NULL, on_resolved, 1, &node_results));
+        AWS_NAPI_ENSURE(env, aws_napi_release_threadsafe_function(pre_resolve->on_resolved, napi_tsfn_release));
     }
 
-    napi_value node_cert_path = *arg++;
-    if (!aws_napi_is_null_or_undefined(env, node_cert_path)) {
-        cert_path = aws_string_new_from_napi(env, node_cert_path);
-        if (!cert_path) {
-            napi_throw_type_error(env, NULL, "cert_path must be a String (or convertible to a String)");
-            goto cleanup;
-        }
+    s_host_pre_resolve_destroy(pre_resolve);
+}
+
+napi_value aws_napi_io_host_resolver_pre_resolve(napi_env env, napi_callback_info info) {
+    napi_value node_args[3];
+    size_t num_args = AWS_ARRAY_SIZE(node_args);
+    napi_value *arg = &node_args[0];
+    AWS_NAPI_CALL(env, napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL), {
+        napi_throw_error(env, NULL, "Failed to retrieve callback information");
+        return NULL;
+    });
+    if (num_args != AWS_ARRAY_SIZE(node_args)) {
+        napi_throw_error(env, NULL, "io_host_resolver_pre_resolve needs exactly 3 arguments");
+        return NULL;
     }
 
-    napi_value node_cert_buf = *arg++;
-    if (!aws_napi_is_null_or_undefined(env, node_cert_buf)) {
-        if (aws_byte_buf_init_from_napi(&certificate, env, node_cert_buf)) {
-            napi_throw_type_error(env, NULL, "certificate must be a String (or convertible to a String)");
-            goto cleanup;
-        }
+    struct aws_host_resolver *resolver = s_get_host_resolver(env, *arg++);
+    if (!resolver) {
+        return NULL;
     }
 
-    napi_value node_key_path = *arg++;
-    if (!aws_napi_is_null_or_undefined(env, node_key_path)) {
-        pkey_path = aws_string_new_from_napi(env, node_key_path);
-        if (!pkey_path) {
-            napi_throw_type_error(env, NULL, "private_key_path must be a String (or convertible to a String)");
-            goto cleanup;
-        }
+    napi_value node_host_names = *arg++;
+    bool is_array = false;
+    uint32_t num_hosts = 0;
+    if (napi_is_array(env, node_host_names, &is_array) || !is_array ||
+        napi_get_array_length(env, node_host_names, &num_hosts)) {
+        napi_throw_type_error(env, NULL, "host_names must be an array of strings");
+        return NULL;
     }
 
-    napi_value node_key_buf = *arg++;
-    if (!aws_napi_is_null_or_undefined(env, node_key_buf)) {
-        if (aws_byte_buf_init_from_napi(&private_key, env, node_key_buf)) {
-            napi_throw_type_error(env, NULL, "private_key must be a String (or convertible to a String)");
-            goto cleanup;
+    struct aws_allocator *allocator = aws_napi_get_allocator();
+    struct host_pre_resolve *pre_resolve = NULL;
+    struct host_pre_resolution *hosts = NULL;
+    if (!aws_mem_acquire_many(
+            allocator,
+            2,
+            &pre_resolve,
+            sizeof(struct host_pre_resolve),
+            &hosts,
+            (num_hosts ? num_hosts : 1) * sizeof(struct host_pre_resolution))) {
+        aws_napi_throw_last_error(env);
+        return NULL;
+    }
+    AWS_ZERO_STRUCT(*pre_resolve);
+    memset(hosts, 0, (num_hosts ? num_hosts : 1) * sizeof(struct host_pre_resolution));
+    pre_resolve->allocator = allocator;
+    pre_resolve->hosts = hosts;
+    pre_resolve->num_hosts = num_hosts;
+    aws_atomic_init_int(&pre_resolve->pending, (size_t)num_hosts + 1);
+
+    for (uint32_t i = 0; i < num_hosts; ++i) {
+        napi_value node_host_name = NULL;
+        hosts[i].pre_resolve = pre_resolve;
+        if (napi_get_element(env, node_host_names, i, &node_host_name) ||
+            (hosts[i].host_name = aws_string_new_from_napi(env, node_host_name)) == NULL) {
+            napi_throw_type_error(env, NULL, "host_names must be an array of strings");
+            s_host_pre_resolve_destroy(pre_resolve);
+            return NULL;
         }
     }
 
-    napi_value node_pkcs12_path = *arg++;
-    napi_value node_pkcs12_password = *arg++;
-    (void)node_pkcs12_path;
-    (void)node_pkcs12_password;
-#ifdef __APPLE__
-    if (!aws_napi_is_null_or_undefined(env, node_pkcs12_path)) {
-        if (napi_ok != aws_byte_buf_init_from_napi(&pkcs12_path, env, node_pkcs12_path)) {
-            napi_throw_type_error(env, NULL, "pkcs12_path must be a String (or convertible to a String)");
-            goto cleanup;
+    napi_value node_on_resolved = *arg++;
+    AWS_NAPI_CALL(
+        env,
+        aws_napi_create_threadsafe_function(
+            env,
+            node_on_resolved,
+            "aws_host_resolver_on_pre_resolved",
+            s_host_pre_resolve_call,
+            pre_resolve,
+            &pre_resolve->on_resolved),
+        {
+            napi_throw_type_error(env, NULL, "on_resolved must be a valid callback");
+            s_host_pre_resolve_destroy(pre_resolve);
+            return NULL;
+        });
+
+    const struct aws_host_resolution_config *config = aws_napi_host_resolver_get_config(resolver);
+    for (uint32_t i = 0; i < num_hosts; ++i) {
+        /* cached hosts complete synchronously */
+        if (aws_host_resolver_resolve_host(resolver, hosts[i].host_name, s_on_host_pre_resolved, config, &hosts[i])) {
+            hosts[i].error_code = aws_last_error();
+            s_host_pre_resolve_complete_one(pre_resolve);
         }
     }
+    s_host_pre_resolve_complete_one(pre_resolve);
 
-    if (!aws_napi_is_null_or_undefined(env, node_pkcs12_password)) {
+    return NULL;
+}
+
+struct aws_napi_stats_field {
+    const char *name;
+    uint64_t value;
+};
+
+/* Creates a plain object with a Number property for every field */
+static napi_value s_create_stats_object(napi_env env, const struct aws_napi_stats_field *fields, size_t num_fields) {
+    napi_value node_stats = NULL;
+    AWS_NAPI_CALL(env, napi_create_object(env, &node_stats), {
+        napi_throw_error(env, NULL, "Unable to create stats object");
+        return NULL;
+    });
+    for (size_t i = 0; i < num_fields; ++i) {
+        napi_value node_value = NULL;
+        if (napi_create_int64(env, (int64_t)fields[i].value, &node_value) ||
+            napi_set_named_property(env, node_stats, fields[i].name, node_value)) {
+            napi_throw_error(env, NULL, "Unable to populate stats object");
+            return NULL;
+        }
+    }
+
+    return node_stats;
+}
+
+napi_value aws_napi_io_host_resolver_get_stats(napi_env env, napi_callback_info info) {
+    napi_value node_args[1];
+    size_t num_args = AWS_ARRAY_SIZE(node_args);
+    AWS_NAPI_CALL(env, napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL), {
+        napi_throw_error(env, NULL, "Failed to retrieve callback information");
+        return NULL;
+    });
+    if (num_args != AWS_ARRAY_SIZE(node_args)) {
+        napi_throw_error(env, NULL, "io_host_resolver_get_stats needs exactly 1 argument");
+        return NULL;
+    }
+
+    struct aws_host_resolver *resolver = s_get_host_resolver(env, node_args[0]);
+    if (!resolver) {
+        return NULL;
+    }
+
+    struct aws_napi_host_resolver_stats stats;
+    AWS_ZERO_STRUCT(stats);
+    aws_napi_host_resolver_get_stats(resolver, &stats);
+
+    const struct aws_napi_stats_field fields[] = {
+        {"cache_hits", stats.cache_hits},
+        {"cache_misses", stats.cache_misses},
+        {"dns_queries", stats.dns_queries},
+        {"dns_failures", stats.dns_failures},
+    };
+
+    return s_create_stats_object(env, fields, AWS_ARRAY_SIZE(fields));
+}
+
+#ifdef _MSC_VER
+#    pragma warning(pop)
+#endif
+
+/*
+ * Shared TLS contexts: contexts created from identical options with share_context set are cached, and reused for as
+ * long as any javascript TlsContext refers to them. Two identical contexts created concurrently may both be built,
+ * only the first one cached is kept. Building a context loads the trust store and parses certificates and keys, which
+ * is worth skipping when contexts are recreated for every reconnect.
+ *
+ * Entries are keyed by a SHA256 of the options, so secrets aren't kept around any longer than the context itself.
+ */
+struct tls_ctx_cache_entry {
+    uint8_t key_digest[AWS_SHA256_LEN];
+    struct aws_byte_cursor key;
+    /* the cache's own reference, every external holds another */
+    struct aws_tls_ctx *tls_ctx;
+    size_t num_externals;
+};
+
+static struct {
+    struct aws_mutex lock;
+    /* struct aws_byte_cursor * -> struct tls_ctx_cache_entry *, initialized on first use */
+    struct aws_hash_table entries;
+    bool initialized;
+    uint64_t hits;
+    uint64_t misses;
+} s_tls_ctx_cache = {
+    .lock = AWS_MUTEX_INIT,
+};
+
+/* Appends a field to a cache key, distinguishing absent fields from empty ones */
+static int s_tls_ctx_cache_key_append(struct aws_byte_buf *key_input, const uint8_t *ptr, size_t len, bool present) {
+    if (aws_byte_buf_append_byte_dynamic(key_input, present ? 1 : 0) ||
+        aws_byte_buf_reserve_relative(key_input, sizeof(uint64_t) + len)) {
+        return AWS_OP_ERR;
+    }
+    aws_byte_buf_write_be64(key_input, (uint64_t)len);
+    aws_byte_buf_write(key_input, ptr, len);
+    return AWS_OP_SUCCESS;
+}
+
+static int s_tls_ctx_cache_key_append_string(struct aws_byte_buf *key_input, const struct aws_string *str) {
+    return s_tls_ctx_cache_key_append(key_input, str ? aws_string_bytes(str) : NULL, str ? str->len : 0, str != NULL);
+}
+
+static int s_tls_ctx_cache_key_append_buf(struct aws_byte_buf *key_input, const struct aws_byte_buf *buf) {
+    return s_tls_ctx_cache_key_append(key_input, buf->buffer, buf->len, buf->buffer != NULL);
+}
+
+/* must be called with the lock held, returns the context with a reference acquired for the caller */
+static struct aws_tls_ctx *s_tls_ctx_cache_find(
+    struct aws_byte_cursor key,
+    struct tls_ctx_cache_entry **out_entry) {
+
+    if (!s_tls_ctx_cache.initialized) {
+        if (aws_hash_table_init(
+                &s_tls_ctx_cache.entries,
+                aws_napi_get_allocator(),
+                0,
+                aws_hash_byte_cursor_ptr,
+                (aws_hash_callback_eq_fn *)aws_byte_cursor_eq,
+                NULL,
+                NULL)) {
+            return NULL;
+        }
+        s_tls_ctx_cache.initialized = true;
+    }
+
+    struct aws_hash_element *elem = NULL;
+    aws_hash_table_find(&s_tls_ctx_cache.entries, &key, &elem);
+    if (elem == NULL) {
+        ++s_tls_ctx_cache.misses;
+        return NULL;
+    }
+
+    ++s_tls_ctx_cache.hits;
+    struct tls_ctx_cache_entry *entry = elem->value;
+    ++entry->num_externals;
+    *out_entry = entry;
+    return aws_tls_ctx_acquire(entry->tls_ctx);
+}
+
+/*
+ * must be called with the lock held. Contexts are built without the lock, so an identical one may have been cached in
+ * the meantime: that one is returned, with a reference acquired for the caller. Otherwise tls_ctx is cached, with a
+ * reference acquired for the cache, and returned. Returns NULL if the context couldn't be cached.
+ */
+static struct aws_tls_ctx *s_tls_ctx_cache_insert(
+    struct aws_byte_cursor key,
+    struct aws_tls_ctx *tls_ctx,
+    struct tls_ctx_cache_entry **out_entry) {
+
+    if (!s_tls_ctx_cache.initialized) {
+        return NULL;
+    }
+
+    struct aws_hash_element *elem = NULL;
+    aws_hash_table_find(&s_tls_ctx_cache.entries, &key, &elem);
+    if (elem != NULL) {
+        struct tls_ctx_cache_entry *existing = elem->value;
+        ++existing->num_externals;
+        *out_entry = existing;
+        return aws_tls_ctx_acquire(existing->tls_ctx);
+    }
+
+    struct aws_allocator *allocator = aws_napi_get_allocator();
+    struct tls_ctx_cache_entry *entry = aws_mem_calloc(allocator, 1, sizeof(struct tls_ctx_cache_entry));
+    if (!entry) {
+        return NULL;
+    }
+
+    AWS_FATAL_ASSERT(key.len == sizeof(entry->key_digest));
+    memcpy(entry->key_digest, key.ptr, key.len);
+    entry->key = aws_byte_cursor_from_array(entry->key_digest, sizeof(entry->key_digest));
+    if (aws_hash_table_put(&s_tls_ctx_cache.entries, &entry->key, entry, NULL)) {
+        aws_mem_release(allocator, entry);
+        return NULL;
+    }
+
+    entry->tls_ctx = aws_tls_ctx_acquire(tls_ctx);
+    entry->num_externals = 1;
+    *out_entry = entry;
+    return tls_ctx;
+}
+
+/** Finalizer for a tls_ctx external, finalize_hint is its struct tls_ctx_cache_entry if the context is shared */
+static void s_tls_ctx_finalize(napi_env env, void *finalize_data, void *finalize_hint) {
+
+    (void)env;
+
+    struct aws_tls_ctx *tls_ctx = finalize_data;
+    AWS_ASSERT(tls_ctx);
+
+    struct tls_ctx_cache_entry *entry = finalize_hint;
+    if (entry) {
+        aws_mutex_lock(&s_tls_ctx_cache.lock);
+        if (--entry->num_externals == 0) {
+            aws_hash_table_remove(&s_tls_ctx_cache.entries, &entry->key, NULL, NULL);
+            aws_tls_ctx_release(entry->tls_ctx);
+            aws_mem_release(aws_napi_get_allocator(), entry);
+        }
+        aws_mutex_unlock(&s_tls_ctx_cache.lock);
+    }
+
+    aws_tls_ctx_release(tls_ctx);
+}
+
+napi_value aws_napi_io_tls_ctx_cache_get_stats(napi_env env, napi_callback_info info) {
+    (void)info;
+
+    aws_mutex_lock(&s_tls_ctx_cache.lock);
+    const struct aws_napi_stats_field fields[] = {
+        {"hits", s_tls_ctx_cache.hits},
+        {"misses", s_tls_ctx_cache.misses},
+        {"entries", s_tls_ctx_cache.initialized ? aws_hash_table_get_entry_count(&s_tls_ctx_cache.entries) : 0},
+    };
+    aws_mutex_unlock(&s_tls_ctx_cache.lock);
+
+    return s_create_stats_object(env, fields, AWS_ARRAY_SIZE(fields));
+}
+
+napi_value aws_napi_io_tls_ctx_new(napi_env env, napi_callback_info info) {
+
+    struct aws_allocator *alloc = aws_napi_get_allocator();
+    napi_status status = napi_ok;
+    (void)status;
+
+    napi_value node_args[13];
+    size_t num_args = AWS_ARRAY_SIZE(node_args);
+    napi_value *arg = &node_args[0];
+    if (napi_ok != napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL)) {
+        napi_throw_error(env, NULL, "Failed to retreive callback information");
+        return NULL;
+    }
+    if (num_args != AWS_ARRAY_SIZE(node_args)) {
+        napi_throw_error(env, NULL, "aws_nodejs_io_client_tls_ctx_new needs exactly 13 arguments");
+        return NULL;
+    }
+
+    napi_value result = NULL;
+    napi_value node_external = NULL;
+
+#ifdef __APPLE__
+    struct aws_byte_buf pkcs12_path;
+    AWS_ZERO_STRUCT(pkcs12_path);
+    struct aws_byte_buf pkcs12_pwd;
+    AWS_ZERO_STRUCT(pkcs12_pwd);
+#endif
+
+    struct aws_tls_ctx_options ctx_options;
+    AWS_ZERO_STRUCT(ctx_options);
+
+    struct aws_string *ca_path = NULL;
+    struct aws_string *ca_file = NULL;
+
+    struct aws_byte_buf certificate;
+    AWS_ZERO_STRUCT(certificate);
+    struct aws_byte_buf private_key;
+    AWS_ZERO_STRUCT(private_key);
+    struct aws_byte_buf ca_buf;
+    AWS_ZERO_STRUCT(ca_buf);
+
+    struct aws_string *cert_path = NULL;
+    struct aws_string *pkey_path = NULL;
+    struct aws_string *alpn_list = NULL;
+
+    struct aws_byte_buf cache_key_input;
+    AWS_ZERO_STRUCT(cache_key_input);
+    uint8_t cache_key_storage[AWS_SHA256_LEN];
+    struct aws_byte_buf cache_key = aws_byte_buf_from_empty_array(cache_key_storage, sizeof(cache_key_storage));
+    struct tls_ctx_cache_entry *cache_entry = NULL;
+    struct aws_tls_ctx *tls_ctx = NULL;
+
+    uint32_t min_tls_version = AWS_IO_TLS_VER_SYS_DEFAULTS;
+    napi_value node_tls_version = *arg++;
+    if (!aws_napi_is_null_or_undefined(env, node_tls_version)) {
+        napi_value node_number;
+        if (napi_ok != napi_coerce_to_number(env, node_tls_version, &node_number)) {
+            napi_throw_type_error(env, NULL, "min_tls_version must be an enum/Number (or convertible to a Number)");
+            return result;
+        }
+        status = napi_get_value_uint32(env, node_number, &min_tls_version);
+        AWS_FATAL_ASSERT(status == napi_ok); /* We coerced the value to a number, so this must return ok */
+    }
+
+    napi_value node_ca_file = *arg++;
+    if (!aws_napi_is_null_or_undefined(env, node_ca_file)) {
+        ca_file = aws_string_new_from_napi(env, node_ca_file);
+        if (!ca_file) {
+            napi_throw_type_error(env, NULL, "ca_filepath must be a String (or convertible to a String)");
+            goto cleanup;
+        }
+    }
+
+    napi_value node_ca_path = *arg++;
+    if (!aws_napi_is_null_or_undefined(env, node_ca_path)) {
+        ca_path = aws_string_new_from_napi(env, node_ca_path);
+        if (!ca_path) {
+            napi_throw_type_error(env, NULL, "ca_dirpath must be a String (or convertible to a String)");
+            goto cleanup;
+        }
+    }
+
+    napi_value node_ca_buf = *arg++;
+    if (!aws_napi_is_null_or_undefined(env, node_ca_buf)) {
+        if (aws_byte_buf_init_from_napi(&ca_buf, env, node_ca_buf)) {
+            napi_throw_type_error(env, NULL, "certificate_authority must be a String (or convertible to a String)");
+            goto cleanup;
+        }
+    }
+
+    napi_value node_alpn = *arg++;
+    if (!aws_napi_is_null_or_undefined(env, node_alpn)) {
+        alpn_list = aws_string_new_from_napi(env, node_alpn);
+        if (!alpn_list) {
+            napi_throw_type_error(env, NULL, "alpn_list must be a String (or convertible to a String)");
+            goto cleanup;
+        }
+    }
+
+    napi_value node_cert_path = *arg++;
+    if (!aws_napi_is_null_or_undefined(env, node_cert_path)) {
+        cert_path = aws_string_new_from_napi(env, node_cert_path);
+        if (!cert_path) {
+            napi_throw_type_error(env, NULL, "cert_path must be a String (or convertible to a String)");
+            goto cleanup;
+        }
+    }
+
+    napi_value node_cert_buf = *arg++;
+    if (!aws_napi_is_null_or_undefined(env, node_cert_buf)) {
+        if (aws_byte_buf_init_from_napi(&certificate, env, node_cert_buf)) {
+            napi_throw_type_error(env, NULL, "certificate must be a String (or convertible to a String)");
+            goto cleanup;
+        }
+    }
+
+    napi_value node_key_path = *arg++;
+    if (!aws_napi_is_null_or_undefined(env, node_key_path)) {
+        pkey_path = aws_string_new_from_napi(env, node_key_path);
+        if (!pkey_path) {
+            napi_throw_type_error(env, NULL, "private_key_path must be a String (or convertible to a String)");
+            goto cleanup;
+        }
+    }
+
+    napi_value node_key_buf = *arg++;
+    if (!aws_napi_is_null_or_undefined(env, node_key_buf)) {
+        if (aws_byte_buf_init_from_napi(&private_key, env, node_key_buf)) {
+            napi_throw_type_error(env, NULL, "private_key must be a String (or convertible to a String)");
+            goto cleanup;
+        }
+    }
+
+    napi_value node_pkcs12_path = *arg++;
+    napi_value node_pkcs12_password = *arg++;
+    (void)node_pkcs12_path;
+    (void)node_pkcs12_password;
+#ifdef __APPLE__
+    if (!aws_napi_is_null_or_undefined(env, node_pkcs12_path)) {
+        if (napi_ok != aws_byte_buf_init_from_napi(&pkcs12_path, env, node_pkcs12_path)) {
+            napi_throw_type_error(env, NULL, "pkcs12_path must be a String (or convertible to a String)");
+            goto cleanup;
+        }
+    }
+
+    if (!aws_napi_is_null_or_undefined(env, node_pkcs12_password)) {
         if (napi_ok != aws_byte_buf_init_from_napi(&pkcs12_pwd, env, node_pkcs12_password)) {
             napi_throw_type_error(env, NULL, "pkcs12_password must be a String (or convertible to a String)");
             goto cleanup;
@@ -374,6 +1081,51 @@ napi_value aws_napi_io_tls_ctx_new(napi_env env, napi_callback_info info) {
         AWS_FATAL_ASSERT(status == napi_ok);
     }
 
+    bool share_context = false;
+    napi_value node_share_context = *arg++;
+    if (!aws_napi_is_null_or_undefined(env, node_share_context)) {
+        AWS_NAPI_CALL(env, napi_get_value_bool(env, node_share_context, &share_context), {
+            napi_throw_type_error(env, NULL, "share_context must be a boolean or undefined");
+            goto cleanup;
+        });
+    }
+
+    if (share_context) {
+        const uint8_t verify_peer_byte = verify_peer ? 1 : 0;
+        const uint8_t *min_tls_version_bytes = (const uint8_t *)&min_tls_version;
+        if (aws_byte_buf_init(&cache_key_input, alloc, 256) ||
+            s_tls_ctx_cache_key_append(&cache_key_input, min_tls_version_bytes, sizeof(min_tls_version), true) ||
+            s_tls_ctx_cache_key_append_string(&cache_key_input, ca_file) ||
+            s_tls_ctx_cache_key_append_string(&cache_key_input, ca_path) ||
+            s_tls_ctx_cache_key_append_buf(&cache_key_input, &ca_buf) ||
+            s_tls_ctx_cache_key_append_string(&cache_key_input, alpn_list) ||
+            s_tls_ctx_cache_key_append_string(&cache_key_input, cert_path) ||
+            s_tls_ctx_cache_key_append_buf(&cache_key_input, &certificate) ||
+            s_tls_ctx_cache_key_append_string(&cache_key_input, pkey_path) ||
+            s_tls_ctx_cache_key_append_buf(&cache_key_input, &private_key) ||
+#ifdef __APPLE__
+            s_tls_ctx_cache_key_append_buf(&cache_key_input, &pkcs12_path) ||
+            s_tls_ctx_cache_key_append_buf(&cache_key_input, &pkcs12_pwd) ||
+#endif
+            s_tls_ctx_cache_key_append(&cache_key_input, &verify_peer_byte, 1, true)) {
+            aws_napi_throw_last_error(env);
+            goto cleanup;
+        }
+
+        struct aws_byte_cursor key_input = aws_byte_cursor_from_buf(&cache_key_input);
+        if (aws_sha256_compute(alloc, &key_input, &cache_key, 0)) {
+            aws_napi_throw_last_error(env);
+            goto cleanup;
+        }
+
+        aws_mutex_lock(&s_tls_ctx_cache.lock);
+        tls_ctx = s_tls_ctx_cache_find(aws_byte_cursor_from_buf(&cache_key), &cache_entry);
+        aws_mutex_unlock(&s_tls_ctx_cache.lock);
+        if (tls_ctx) {
+            goto create_external;
+        }
+    }
+
     if (certificate.buffer && private_key.buffer) {
         struct aws_byte_cursor cert_cursor = aws_byte_cursor_from_buf(&certificate);
         struct aws_byte_cursor pkey_cursor = aws_byte_cursor_from_buf(&private_key);
@@ -411,21 +1163,39 @@ napi_value aws_napi_io_tls_ctx_new(napi_env env, napi_callback_info info) {
 
     aws_tls_ctx_options_set_verify_peer(&ctx_options, verify_peer);
 
-    struct aws_tls_ctx *tls_ctx = aws_tls_client_ctx_new(alloc, &ctx_options);
+    tls_ctx = aws_tls_client_ctx_new(alloc, &ctx_options);
     if (!tls_ctx) {
         napi_throw_error(env, NULL, "Unable to create TLS context");
         goto cleanup;
     }
 
-    napi_value node_external;
-    if (napi_ok != napi_create_external(env, tls_ctx, s_tls_ctx_finalize, NULL, &node_external)) {
+    /* Built outside the lock, so loading certificates doesn't hold up every other TLS context being created */
+    if (share_context) {
+        aws_mutex_lock(&s_tls_ctx_cache.lock);
+        struct aws_tls_ctx *shared_ctx =
+            s_tls_ctx_cache_insert(aws_byte_cursor_from_buf(&cache_key), tls_ctx, &cache_entry);
+        aws_mutex_unlock(&s_tls_ctx_cache.lock);
+
+        /* not being able to share the context is no reason to fail */
+        if (!shared_ctx) {
+            cache_entry = NULL;
+        } else if (shared_ctx != tls_ctx) {
+            aws_tls_ctx_release(tls_ctx);
+            tls_ctx = shared_ctx;
+        }
+    }
+
+create_external:
+    if (napi_ok != napi_create_external(env, tls_ctx, s_tls_ctx_finalize, cache_entry, &node_external)) {
         napi_throw_error(env, NULL, "Failed create n-api external");
+        s_tls_ctx_finalize(env, tls_ctx, cache_entry);
         goto cleanup;
     }
 
     result = node_external;
 
 cleanup:
+    aws_byte_buf_clean_up_secure(&cache_key_input);
 #ifdef __APPLE__
     aws_byte_buf_clean_up_secure(&pkcs12_path);
     aws_byte_buf_clean_up_secure(&pkcs12_pwd);
@@ -607,108 +1377,289 @@ napi_value aws_napi_io_socket_options_new(napi_env env, napi_callback_info info)
     return node_external;
 }
 
+/* An appended Buffer, referenced rather than copied until the reader has consumed all of it */
+struct input_stream_chunk {
+    struct aws_linked_list_node node;
+    napi_ref node_buffer;
+    struct aws_byte_cursor data; /* the part of the Buffer that has not been read yet */
+};
+
 struct aws_napi_input_stream_impl {
     /* this MUST be the first member, allows polymorphism with aws_input_stream* */
     struct aws_input_stream base;
-    struct aws_byte_buf buffer;
-    struct aws_byte_cursor cursor;
+    struct aws_allocator *allocator;
+    int64_t length;         /* total length of the stream, or -1 if not known up front */
+    size_t high_water_mark; /* 0 means unbounded */
+
+    /* Releases consumed chunks (napi refs can only be deleted on the node thread) and signals drain to js */
+    napi_threadsafe_function on_drain;
+
+    /* Held by the js external, each owner of the stream, and each queued on_drain call */
+    struct aws_atomic_var ref_count;
+
     struct aws_mutex mutex;
-    size_t bytes_read; /* bytes already consumed by the reader, flushed from the buffer */
-    bool eos;          /* end of stream */
+    struct {
+        struct aws_linked_list chunks;   /* unread chunks, in order */
+        struct aws_linked_list consumed; /* chunks waiting for their refs to be released */
+        size_t bytes_buffered;           /* unread bytes across all chunks */
+        size_t bytes_read;               /* bytes already consumed by the reader */
+        bool eos;                        /* end of stream */
+        bool paused;                     /* js was told to stop appending */
+        bool release_scheduled;
+        bool finished;  /* on_drain has been released, nothing more will be scheduled */
+        size_t owners;  /* the js external and every request the stream is the body of */
+        bool destroyed; /* every owner is done with it, all chunks are just waiting to be released */
+        struct aws_napi_running_checksum checksum; /* of the bytes read since the last seek */
+    } synced_data;
 };
 
-static int s_input_stream_seek(struct aws_input_stream *stream, int64_t offset, enum aws_stream_seek_basis basis) {
-    struct aws_napi_input_stream_impl *impl = stream->impl;
+/* Skips num_bytes of buffered data, retiring fully read chunks. Returns true if the node thread needs to run */
+static bool s_input_stream_consume_synced(
+    struct aws_napi_input_stream_impl *impl,
+    size_t num_bytes,
+    struct aws_byte_buf *dest) {
+
+    while (num_bytes > 0 && !aws_linked_list_empty(&impl->synced_data.chunks)) {
+        struct aws_linked_list_node *node = aws_linked_list_front(&impl->synced_data.chunks);
+        struct input_stream_chunk *chunk = AWS_CONTAINER_OF(node, struct input_stream_chunk, node);
+
+        size_t chunk_bytes = aws_min_size(num_bytes, chunk->data.len);
+        struct aws_byte_cursor consumed = aws_byte_cursor_advance(&chunk->data, chunk_bytes);
+        if (dest) {
+            aws_byte_buf_write_from_whole_cursor(dest, consumed);
+            /* only fails once finalized, and the checksum can't be read before the reader is done */
+            aws_napi_running_checksum_update(&impl->synced_data.checksum, consumed);
+        }
+
+        num_bytes -= chunk_bytes;
+        impl->synced_data.bytes_buffered -= chunk_bytes;
+        impl->synced_data.bytes_read += chunk_bytes;
+
+        if (chunk->data.len == 0) {
+            aws_linked_list_pop_front(&impl->synced_data.chunks);
+            aws_linked_list_push_back(&impl->synced_data.consumed, node);
+        }
+    }
+
+    const bool has_consumed = !aws_linked_list_empty(&impl->synced_data.consumed);
+    const bool drained = impl->synced_data.paused && impl->synced_data.bytes_buffered < impl->high_water_mark;
+    if ((has_consumed || drained) && !impl->synced_data.release_scheduled && !impl->synced_data.finished) {
+        impl->synced_data.release_scheduled = true;
+        return true;
+    }
+
+    return false;
+}
+
+static void s_input_stream_release_chunks(napi_env env, struct aws_allocator *allocator, struct aws_linked_list *list) {
+    while (!aws_linked_list_empty(list)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(list);
+        struct input_stream_chunk *chunk = AWS_CONTAINER_OF(node, struct input_stream_chunk, node);
+        if (env) {
+            napi_delete_reference(env, chunk->node_buffer);
+        }
+        aws_mem_release(allocator, chunk);
+    }
+}
+
+static void s_input_stream_acquire(struct aws_napi_input_stream_impl *impl) {
+    aws_atomic_fetch_add(&impl->ref_count, 1);
+}
+
+static void s_input_stream_release(struct aws_napi_input_stream_impl *impl) {
+    if (aws_atomic_fetch_sub(&impl->ref_count, 1) != 1) {
+        return;
+    }
+
+    struct aws_allocator *allocator = impl->allocator;
+    /* Only left over if node shut down before they could be released, node reclaims the refs with the environment */
+    s_input_stream_release_chunks(NULL, allocator, &impl->synced_data.chunks);
+    s_input_stream_release_chunks(NULL, allocator, &impl->synced_data.consumed);
+    aws_napi_running_checksum_clean_up(&impl->synced_data.checksum);
+    aws_mutex_clean_up(&impl->mutex);
+    aws_mem_release(allocator, impl);
+}
+
+static void s_input_stream_schedule_release(struct aws_napi_input_stream_impl *impl) {
+    /* the queued call keeps impl alive, even if the owner destroys the stream before node runs it */
+    s_input_stream_acquire(impl);
+    if (aws_napi_queue_threadsafe_function(impl->on_drain, impl)) {
+        /* node is shutting down, the chunks will be reclaimed when the stream is freed */
+        aws_mutex_lock(&impl->mutex);
+        impl->synced_data.release_scheduled = false;
+        aws_mutex_unlock(&impl->mutex);
+        s_input_stream_release(impl);
+    }
+}
+
+/*
+ * Must be called on the node thread with the lock held. Once all data is in and read, or the owner has destroyed the
+ * stream, there's nothing left to drain
+ */
+static bool s_input_stream_try_finish_synced(struct aws_napi_input_stream_impl *impl) {
+    if (impl->synced_data.finished || impl->synced_data.release_scheduled ||
+        !(impl->synced_data.eos || impl->synced_data.destroyed) || !aws_linked_list_empty(&impl->synced_data.chunks) ||
+        !aws_linked_list_empty(&impl->synced_data.consumed)) {
+        return false;
+    }
+
+    impl->synced_data.finished = true;
+    return true;
+}
+
+static void s_input_stream_on_drain_call(napi_env env, napi_value on_drain, void *context, void *user_data) {
+    struct aws_napi_input_stream_impl *impl = context;
+    (void)user_data;
+
+    struct aws_linked_list consumed;
+    aws_linked_list_init(&consumed);
+
+    aws_mutex_lock(&impl->mutex);
+    aws_linked_list_swap_contents(&consumed, &impl->synced_data.consumed);
+    impl->synced_data.release_scheduled = false;
+    /* nobody reads a destroyed stream, so there's no point resuming the source */
+    bool drained = impl->synced_data.paused && impl->synced_data.bytes_buffered < impl->high_water_mark &&
+                   !impl->synced_data.destroyed;
+    if (drained) {
+        impl->synced_data.paused = false;
+    }
+    bool finished = s_input_stream_try_finish_synced(impl);
+    aws_mutex_unlock(&impl->mutex);
+
+    s_input_stream_release_chunks(env, impl->allocator, &consumed);
+
+    if (env) {
+        if (drained) {
+            AWS_NAPI_ENSURE(env, aws_napi_dispatch_threadsafe_function(env, impl->on_drain, NULL, on_drain, 0, NULL));
+        } else {
+            AWS_NAPI_ENSURE(env, aws_napi_release_threadsafe_function(impl->on_drain, napi_tsfn_release));
+        }
+
+        if (finished) {
+            AWS_NAPI_ENSURE(env, aws_napi_release_threadsafe_function(impl->on_drain, napi_tsfn_release));
+        }
+    }
+
+    /* the reference taken when this call was queued */
+    s_input_stream_release(impl);
+}
+
+static int s_input_stream_seek(struct aws_input_stream *stream, int64_t offset, enum aws_stream_seek_basis basis) {
+    struct aws_napi_input_stream_impl *impl = stream->impl;
 
     int result = AWS_OP_SUCCESS;
-    uint64_t final_offset = 0;
+    bool schedule_release = false;
 
     aws_mutex_lock(&impl->mutex);
-    uint64_t total_bytes = impl->bytes_read + impl->buffer.len;
+    uint64_t bytes_read = impl->synced_data.bytes_read;
+    uint64_t bytes_buffered = impl->synced_data.bytes_buffered;
+    uint64_t bytes_to_skip = 0;
 
     switch (basis) {
         case AWS_SSB_BEGIN:
             /* Offset must be positive, must be greater than the bytes already read (because those
              * bytes are gone from the buffer), and must not be greater than the sum of the bytes
-             * read so far and the size of the buffer
+             * read so far and the bytes still buffered
              */
-            if (offset < 0 || (uint64_t)offset > total_bytes || (uint64_t)offset < impl->bytes_read) {
+            if (offset < 0 || (uint64_t)offset > bytes_read + bytes_buffered || (uint64_t)offset < bytes_read) {
                 result = aws_raise_error(AWS_IO_STREAM_INVALID_SEEK_POSITION);
                 goto failed;
             }
-            final_offset = (uint64_t)offset - impl->bytes_read;
+            bytes_to_skip = (uint64_t)offset - bytes_read;
             break;
         case AWS_SSB_END:
             /* Offset must be negative, and must not be trying to go further back than the
-             * current length of the buffer, because those bytes have been purged
+             * bytes still buffered, because those bytes have been purged
              */
-            if (offset > 0 || offset == INT64_MIN || (uint64_t)(-offset) > impl->buffer.len) {
+            if (offset > 0 || offset == INT64_MIN || (uint64_t)(-offset) > bytes_buffered) {
                 result = aws_raise_error(AWS_IO_STREAM_INVALID_SEEK_POSITION);
                 goto failed;
             }
-            final_offset = (uint64_t)impl->buffer.len - (uint64_t)(-offset);
+            bytes_to_skip = bytes_buffered - (uint64_t)(-offset);
             break;
         default:
             result = aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
             goto failed;
     }
 
-    AWS_ASSERT(final_offset <= SIZE_MAX);
-    size_t buf_offset = (size_t)final_offset;
-    AWS_ASSERT(buf_offset <= impl->buffer.len);
-
-    if (buf_offset == impl->buffer.len) {
-        impl->bytes_read += impl->buffer.len;
-        impl->buffer.len = 0;
-    } else if (buf_offset > 0) {
-        size_t new_len = impl->buffer.len - buf_offset;
-        memmove(impl->buffer.buffer, impl->buffer.buffer + buf_offset, new_len);
-        impl->buffer.len = new_len;
-    }
+    schedule_release = s_input_stream_consume_synced(impl, (size_t)bytes_to_skip, NULL);
+    result = aws_napi_running_checksum_reset(&impl->synced_data.checksum, impl->allocator);
 
 failed:
     aws_mutex_unlock(&impl->mutex);
+
+    if (schedule_release) {
+        s_input_stream_schedule_release(impl);
+    }
     return result;
 }
 
 static int s_input_stream_read(struct aws_input_stream *stream, struct aws_byte_buf *dest) {
     struct aws_napi_input_stream_impl *impl = stream->impl;
 
-    size_t bytes_to_read = dest->capacity - dest->len;
-    if (bytes_to_read > impl->buffer.len) {
-        bytes_to_read = impl->buffer.len;
-    }
+    aws_mutex_lock(&impl->mutex);
+    bool schedule_release = s_input_stream_consume_synced(impl, dest->capacity - dest->len, dest);
+    aws_mutex_unlock(&impl->mutex);
 
-    if (!aws_byte_buf_write(dest, impl->buffer.buffer, bytes_to_read)) {
-        return AWS_OP_ERR;
+    if (schedule_release) {
+        s_input_stream_schedule_release(impl);
     }
-
-    /* seek the stream past what's been read to advance the buffer/bytes_read */
-    aws_input_stream_seek(&impl->base, impl->bytes_read + bytes_to_read, AWS_SSB_BEGIN);
     return AWS_OP_SUCCESS;
 }
 
 static int s_input_stream_get_status(struct aws_input_stream *stream, struct aws_stream_status *status) {
     struct aws_napi_input_stream_impl *impl = stream->impl;
     aws_mutex_lock(&impl->mutex);
-    status->is_end_of_stream = impl->eos;
+    status->is_end_of_stream = impl->synced_data.eos && impl->synced_data.bytes_buffered == 0;
     aws_mutex_unlock(&impl->mutex);
     status->is_valid = true;
     return AWS_OP_SUCCESS;
 }
 
 static int s_input_stream_get_length(struct aws_input_stream *stream, int64_t *out_length) {
-    (void)stream;
-    (void)out_length;
-    return aws_raise_error(AWS_ERROR_UNIMPLEMENTED);
+    struct aws_napi_input_stream_impl *impl = stream->impl;
+    if (impl->length < 0) {
+        return aws_raise_error(AWS_ERROR_UNIMPLEMENTED);
+    }
+
+    *out_length = impl->length;
+    return AWS_OP_SUCCESS;
+}
+
+/* Drops an owner's share of the stream. Once nobody is left to read it, its chunks and on_drain are released */
+static void s_input_stream_detach(struct aws_napi_input_stream_impl *impl) {
+    bool schedule_release = false;
+
+    aws_mutex_lock(&impl->mutex);
+    AWS_FATAL_ASSERT(impl->synced_data.owners > 0);
+    if (--impl->synced_data.owners == 0) {
+        /* The refs pinning unread Buffers can only be deleted on the node thread, hand them all to on_drain */
+        impl->synced_data.destroyed = true;
+        while (!aws_linked_list_empty(&impl->synced_data.chunks)) {
+            aws_linked_list_push_back(
+                &impl->synced_data.consumed, aws_linked_list_pop_front(&impl->synced_data.chunks));
+        }
+        impl->synced_data.bytes_buffered = 0;
+        /* a call already scheduled will also finish the stream, as it now sees it destroyed */
+        schedule_release = !impl->synced_data.finished && !impl->synced_data.release_scheduled;
+        impl->synced_data.release_scheduled |= schedule_release;
+    }
+    aws_mutex_unlock(&impl->mutex);
+
+    if (schedule_release) {
+        s_input_stream_schedule_release(impl);
+    }
+    s_input_stream_release(impl);
 }
 
 static void s_input_stream_destroy(struct aws_input_stream *stream) {
-    struct aws_napi_input_stream_impl *impl = stream->impl;
-    struct aws_allocator *allocator = impl->buffer.allocator;
-    aws_mutex_clean_up(&impl->mutex);
-    aws_byte_buf_clean_up(&impl->buffer);
-    aws_mem_release(allocator, impl);
+    s_input_stream_detach(stream->impl);
+}
+
+static void s_input_stream_external_finalize(napi_env env, void *finalize_data, void *finalize_hint) {
+    (void)env;
+    (void)finalize_hint;
+    s_input_stream_detach(finalize_data);
 }
 
 static struct aws_input_stream_vtable s_input_stream_vtable = {
@@ -720,24 +1671,41 @@ static struct aws_input_stream_vtable s_input_stream_vtable = {
 };
 
 napi_value aws_napi_io_input_stream_new(napi_env env, napi_callback_info info) {
-    napi_value node_args[1];
+    napi_value node_args[4];
     size_t num_args = AWS_ARRAY_SIZE(node_args);
+    napi_value *arg = &node_args[0];
     if (napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL)) {
         napi_throw_error(env, NULL, "Failed to retrieve callback information");
         return NULL;
     }
     if (num_args != AWS_ARRAY_SIZE(node_args)) {
-        napi_throw_error(env, NULL, "io_input_stream_new requires exactly 1 arguments");
+        napi_throw_error(env, NULL, "io_input_stream_new requires exactly 4 arguments");
         return NULL;
     }
 
-    int64_t capacity = 0;
-    if (napi_get_value_int64(env, node_args[0], &capacity)) {
-        napi_throw_error(env, NULL, "capacity must be a number");
+    int64_t high_water_mark = 0;
+    if (napi_get_value_int64(env, *arg++, &high_water_mark) || high_water_mark < 0) {
+        napi_throw_error(env, NULL, "high_water_mark must be a positive number");
         return NULL;
     }
 
-    struct aws_allocator *allocator = aws_napi_get_allocator();
+    int64_t length = -1;
+    napi_value node_length = *arg++;
+    if (!aws_napi_is_null_or_undefined(env, node_length)) {
+        if (napi_get_value_int64(env, node_length, &length) || length < 0) {
+            napi_throw_error(env, NULL, "length must be a positive number or undefined");
+            return NULL;
+        }
+    }
+
+    napi_value node_on_drain = *arg++;
+
+    enum aws_napi_checksum_algorithm checksum_algorithm = AWS_NAPI_CHECKSUM_NONE;
+    if (!aws_napi_checksum_algorithm_from_napi(env, *arg++, &checksum_algorithm)) {
+        return NULL;
+    }
+
+    struct aws_allocator *allocator = aws_napi_get_metrics_allocator(AWS_NAPI_METRICS_INPUT_STREAM);
     struct aws_napi_input_stream_impl *impl = aws_mem_calloc(allocator, 1, sizeof(struct aws_napi_input_stream_impl));
     if (!impl) {
         napi_throw_error(env, NULL, "Unable to allocate native aws_input_stream");
@@ -747,18 +1715,39 @@ napi_value aws_napi_io_input_stream_new(napi_env env, napi_callback_info info) {
     impl->base.allocator = allocator;
     impl->base.impl = impl;
     impl->base.vtable = &s_input_stream_vtable;
+    impl->allocator = allocator;
+    impl->length = length;
+    impl->high_water_mark = (size_t)high_water_mark;
+    aws_atomic_init_int(&impl->ref_count, 1);
+    impl->synced_data.owners = 1;
+    aws_linked_list_init(&impl->synced_data.chunks);
+    aws_linked_list_init(&impl->synced_data.consumed);
+    if (aws_napi_running_checksum_init(&impl->synced_data.checksum, allocator, checksum_algorithm)) {
+        aws_napi_throw_last_error(env);
+        aws_mem_release(allocator, impl);
+        return NULL;
+    }
     if (aws_mutex_init(&impl->mutex)) {
         aws_napi_throw_last_error(env);
-        goto failed;
+        aws_napi_running_checksum_clean_up(&impl->synced_data.checksum);
+        aws_mem_release(allocator, impl);
+        return NULL;
     }
 
-    if (aws_byte_buf_init(&impl->buffer, allocator, 16 * 1024)) {
-        napi_throw_error(env, NULL, "Unable to allocate stream buffer");
-        goto failed;
-    }
+    AWS_NAPI_CALL(
+        env,
+        aws_napi_create_threadsafe_function(
+            env, node_on_drain, "aws_input_stream_on_drain", s_input_stream_on_drain_call, impl, &impl->on_drain),
+        {
+            napi_throw_error(env, NULL, "Unable to bind on_drain callback");
+            goto failed;
+        });
+    /* the stream must not hold the process open while it waits for the reader */
+    AWS_NAPI_ENSURE(env, aws_napi_unref_threadsafe_function(env, impl->on_drain));
 
+    /* the initial reference now belongs to the external, js may still append to the stream after a request is done */
     napi_value node_external = NULL;
-    if (napi_create_external(env, impl, NULL, NULL, &node_external)) {
+    if (napi_create_external(env, impl, s_input_stream_external_finalize, NULL, &node_external)) {
         napi_throw_error(env, NULL, "Unable to create external for native aws_input_stream");
         goto failed;
     }
@@ -766,9 +1755,10 @@ napi_value aws_napi_io_input_stream_new(napi_env env, napi_callback_info info) {
     return node_external;
 
 failed:
-    if (impl) {
-        s_input_stream_destroy(&impl->base);
-    }
+    AWS_NAPI_ENSURE(env, aws_napi_release_threadsafe_function(impl->on_drain, napi_tsfn_abort));
+    /* on_drain is gone, so there is nothing to schedule */
+    impl->synced_data.finished = true;
+    s_input_stream_destroy(&impl->base);
 
     return NULL;
 }
@@ -794,8 +1784,13 @@ napi_value aws_napi_io_input_stream_append(napi_env env, napi_callback_info info
     /* null means end of stream */
     if (aws_napi_is_null_or_undefined(env, node_args[1])) {
         aws_mutex_lock(&impl->mutex);
-        impl->eos = true;
+        impl->synced_data.eos = true;
+        bool finished = s_input_stream_try_finish_synced(impl);
         aws_mutex_unlock(&impl->mutex);
+
+        if (finished) {
+            AWS_NAPI_ENSURE(env, aws_napi_release_threadsafe_function(impl->on_drain, napi_tsfn_release));
+        }
         return NULL;
     }
 
@@ -812,9 +1807,447 @@ napi_value aws_napi_io_input_stream_append(napi_env env, napi_callback_info info
         return NULL;
     }
 
+    bool below_high_water_mark = true;
+    if (data.len > 0) {
+        /* The Buffer is referenced in place until the reader has consumed it, no copy is made */
+        struct input_stream_chunk *chunk = aws_mem_calloc(impl->allocator, 1, sizeof(struct input_stream_chunk));
+        AWS_FATAL_ASSERT(chunk);
+        chunk->data = data;
+        AWS_NAPI_CALL(env, napi_create_reference(env, node_args[1], 1, &chunk->node_buffer), {
+            aws_mem_release(impl->allocator, chunk);
+            napi_throw_error(env, NULL, "Unable to reference buffer");
+            return NULL;
+        });
+
+        aws_mutex_lock(&impl->mutex);
+        if (impl->synced_data.destroyed) {
+            /* nothing will ever read it, let the caller stop producing */
+            aws_mutex_unlock(&impl->mutex);
+            napi_delete_reference(env, chunk->node_buffer);
+            aws_mem_release(impl->allocator, chunk);
+            napi_value node_result = NULL;
+            AWS_NAPI_ENSURE(env, napi_get_boolean(env, false, &node_result));
+            return node_result;
+        }
+        aws_linked_list_push_back(&impl->synced_data.chunks, &chunk->node);
+        impl->synced_data.bytes_buffered += data.len;
+        if (impl->high_water_mark > 0 && impl->synced_data.bytes_buffered >= impl->high_water_mark) {
+            impl->synced_data.paused = true;
+        }
+        below_high_water_mark = !impl->synced_data.paused;
+        aws_mutex_unlock(&impl->mutex);
+    }
+
+    napi_value node_result = NULL;
+    AWS_NAPI_ENSURE(env, napi_get_boolean(env, below_high_water_mark, &node_result));
+    return node_result;
+}
+
+/* Reads a range of a file straight into the reader's buffer, the bytes never pass through node */
+struct aws_napi_file_input_stream_impl {
+    /* this MUST be the first member, allows polymorphism with aws_input_stream* */
+    struct aws_input_stream base;
+    struct aws_allocator *allocator;
+    FILE *file;
+    uint64_t offset; /* where the range starts in the file */
+    uint64_t length; /* length of the range */
+
+    /* Held by the js external and each owner of the stream, the file is closed once all of them are done with it */
+    struct aws_atomic_var ref_count;
+
+    /* Advanced by the reader, and read by node when js asks for the checksum */
+    struct aws_mutex mutex;
+    struct {
+        uint64_t position;                         /* bytes of the range already read */
+        struct aws_napi_running_checksum checksum; /* of the bytes read since the last seek */
+    } synced_data;
+};
+
+static void s_file_input_stream_release(struct aws_napi_file_input_stream_impl *impl) {
+    if (aws_atomic_fetch_sub(&impl->ref_count, 1) != 1) {
+        return;
+    }
+
+    if (impl->file) {
+        fclose(impl->file);
+    }
+    aws_napi_running_checksum_clean_up(&impl->synced_data.checksum);
+    aws_mutex_clean_up(&impl->mutex);
+    aws_mem_release(impl->allocator, impl);
+}
+
+static int s_file_input_stream_seek(
+    struct aws_input_stream *stream,
+    int64_t offset,
+    enum aws_stream_seek_basis basis) {
+
+    struct aws_napi_file_input_stream_impl *impl = stream->impl;
+
+    uint64_t position = 0;
+    switch (basis) {
+        case AWS_SSB_BEGIN:
+            if (offset < 0 || (uint64_t)offset > impl->length) {
+                return aws_raise_error(AWS_IO_STREAM_INVALID_SEEK_POSITION);
+            }
+            position = (uint64_t)offset;
+            break;
+        case AWS_SSB_END:
+            if (offset > 0 || offset == INT64_MIN || (uint64_t)(-offset) > impl->length) {
+                return aws_raise_error(AWS_IO_STREAM_INVALID_SEEK_POSITION);
+            }
+            position = impl->length - (uint64_t)(-offset);
+            break;
+        default:
+            return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    if (aws_fseek(impl->file, (int64_t)(impl->offset + position), SEEK_SET)) {
+        return AWS_OP_ERR;
+    }
+
     aws_mutex_lock(&impl->mutex);
-    aws_byte_buf_append(&impl->buffer, &data);
+    impl->synced_data.position = position;
+    int result = aws_napi_running_checksum_reset(&impl->synced_data.checksum, impl->allocator);
     aws_mutex_unlock(&impl->mutex);
+    return result;
+}
+
+static int s_file_input_stream_read(struct aws_input_stream *stream, struct aws_byte_buf *dest) {
+    struct aws_napi_file_input_stream_impl *impl = stream->impl;
+
+    /* only the reader moves position, so it can be read without the lock on this thread */
+    size_t to_read = dest->capacity - dest->len;
+    if ((uint64_t)to_read > impl->length - impl->synced_data.position) {
+        to_read = (size_t)(impl->length - impl->synced_data.position);
+    }
+    if (to_read == 0) {
+        return AWS_OP_SUCCESS;
+    }
+
+    size_t bytes_read = fread(dest->buffer + dest->len, 1, to_read, impl->file);
+
+    aws_mutex_lock(&impl->mutex);
+    int result = aws_napi_running_checksum_update(
+        &impl->synced_data.checksum, aws_byte_cursor_from_array(dest->buffer + dest->len, bytes_read));
+    if (result == AWS_OP_SUCCESS) {
+        impl->synced_data.position += bytes_read;
+    }
+    aws_mutex_unlock(&impl->mutex);
+    if (result) {
+        return AWS_OP_ERR;
+    }
+    dest->len += bytes_read;
+
+    /* A short read at EOF means the file shrank, the length promised to the reader can no longer be met */
+    if (bytes_read < to_read && (ferror(impl->file) || feof(impl->file))) {
+        return aws_raise_error(AWS_IO_STREAM_READ_FAILED);
+    }
+    return AWS_OP_SUCCESS;
+}
+
+static int s_file_input_stream_get_status(struct aws_input_stream *stream, struct aws_stream_status *status) {
+    struct aws_napi_file_input_stream_impl *impl = stream->impl;
+    status->is_end_of_stream = impl->synced_data.position == impl->length;
+    status->is_valid = !ferror(impl->file);
+    return AWS_OP_SUCCESS;
+}
+
+static int s_file_input_stream_get_length(struct aws_input_stream *stream, int64_t *out_length) {
+    struct aws_napi_file_input_stream_impl *impl = stream->impl;
+    *out_length = (int64_t)impl->length;
+    return AWS_OP_SUCCESS;
+}
+
+static void s_file_input_stream_destroy(struct aws_input_stream *stream) {
+    s_file_input_stream_release(stream->impl);
+}
+
+static struct aws_input_stream_vtable s_file_input_stream_vtable = {
+    .seek = s_file_input_stream_seek,
+    .read = s_file_input_stream_read,
+    .get_status = s_file_input_stream_get_status,
+    .get_length = s_file_input_stream_get_length,
+    .destroy = s_file_input_stream_destroy,
+};
+
+static void s_file_input_stream_external_finalize(napi_env env, void *finalize_data, void *finalize_hint) {
+    (void)env;
+    (void)finalize_hint;
+    s_file_input_stream_release(finalize_data);
+}
+
+napi_value aws_napi_io_file_input_stream_new(napi_env env, napi_callback_info info) {
+    napi_value node_args[4];
+    size_t num_args = AWS_ARRAY_SIZE(node_args);
+    napi_value *arg = &node_args[0];
+    if (napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL)) {
+        napi_throw_error(env, NULL, "Failed to retrieve callback information");
+        return NULL;
+    }
+    if (num_args != AWS_ARRAY_SIZE(node_args)) {
+        napi_throw_error(env, NULL, "io_file_input_stream_new requires exactly 4 arguments");
+        return NULL;
+    }
+
+    struct aws_allocator *allocator = aws_napi_get_metrics_allocator(AWS_NAPI_METRICS_INPUT_STREAM);
+    struct aws_napi_file_input_stream_impl *impl = NULL;
+
+    struct aws_string *path = aws_string_new_from_napi(env, *arg++);
+    if (!path) {
+        napi_throw_type_error(env, NULL, "path must be a String");
+        return NULL;
+    }
+
+    int64_t offset = 0;
+    napi_value node_offset = *arg++;
+    if (!aws_napi_is_null_or_undefined(env, node_offset)) {
+        if (napi_get_value_int64(env, node_offset, &offset) || offset < 0) {
+            napi_throw_error(env, NULL, "offset must be a positive number or undefined");
+            goto cleanup;
+        }
+    }
+
+    int64_t length = -1;
+    napi_value node_length = *arg++;
+    if (!aws_napi_is_null_or_undefined(env, node_length)) {
+        if (napi_get_value_int64(env, node_length, &length) || length < 0) {
+            napi_throw_error(env, NULL, "length must be a positive number or undefined");
+            goto cleanup;
+        }
+    }
+
+    enum aws_napi_checksum_algorithm checksum_algorithm = AWS_NAPI_CHECKSUM_NONE;
+    if (!aws_napi_checksum_algorithm_from_napi(env, *arg++, &checksum_algorithm)) {
+        goto cleanup;
+    }
+
+    impl = aws_mem_calloc(allocator, 1, sizeof(struct aws_napi_file_input_stream_impl));
+    if (!impl) {
+        aws_napi_throw_last_error(env);
+        goto cleanup;
+    }
+    impl->base.allocator = allocator;
+    impl->base.impl = impl;
+    impl->base.vtable = &s_file_input_stream_vtable;
+    impl->allocator = allocator;
+    aws_atomic_init_int(&impl->ref_count, 1);
+    if (aws_mutex_init(&impl->mutex)) {
+        aws_napi_throw_last_error(env);
+        aws_mem_release(allocator, impl);
+        impl = NULL;
+        goto cleanup;
+    }
+    if (aws_napi_running_checksum_init(&impl->synced_data.checksum, allocator, checksum_algorithm)) {
+        aws_napi_throw_last_error(env);
+        goto cleanup;
+    }
+
+    impl->file = aws_fopen(aws_string_c_str(path), "rb");
+    if (!impl->file) {
+        aws_napi_throw_last_error(env);
+        goto cleanup;
+    }
+
+    int64_t file_length = 0;
+    if (aws_file_get_length(impl->file, &file_length)) {
+        aws_napi_throw_last_error(env);
+        goto cleanup;
+    }
+    if (offset > file_length || (length >= 0 && length > file_length - offset)) {
+        napi_throw_range_error(env, NULL, "offset and length must lie within the file");
+        goto cleanup;
+    }
+    impl->offset = (uint64_t)offset;
+    impl->length = (uint64_t)(length >= 0 ? length : file_length - offset);
+
+    if (aws_fseek(impl->file, offset, SEEK_SET)) {
+        aws_napi_throw_last_error(env);
+        goto cleanup;
+    }
+
+    /* the initial reference now belongs to the external */
+    napi_value node_external = NULL;
+    AWS_NAPI_CALL(env, napi_create_external(env, impl, s_file_input_stream_external_finalize, NULL, &node_external), {
+        napi_throw_error(env, NULL, "Unable to create external for native aws_input_stream");
+        goto cleanup;
+    });
+
+    aws_string_destroy(path);
+    return node_external;
+
+cleanup:
+    if (impl) {
+        s_file_input_stream_destroy(&impl->base);
+    }
+    aws_string_destroy(path);
+    return NULL;
+}
+
+void aws_napi_io_input_stream_acquire(struct aws_input_stream *stream) {
+    if (stream->vtable == &s_input_stream_vtable) {
+        struct aws_napi_input_stream_impl *impl = stream->impl;
+        aws_mutex_lock(&impl->mutex);
+        ++impl->synced_data.owners;
+        aws_mutex_unlock(&impl->mutex);
+        s_input_stream_acquire(impl);
+    } else {
+        AWS_FATAL_ASSERT(stream->vtable == &s_file_input_stream_vtable);
+        struct aws_napi_file_input_stream_impl *impl = stream->impl;
+        aws_atomic_fetch_add(&impl->ref_count, 1);
+    }
+}
+
+napi_value aws_napi_io_input_stream_get_length(napi_env env, napi_callback_info info) {
+    napi_value node_args[1];
+    size_t num_args = AWS_ARRAY_SIZE(node_args);
+    if (napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL)) {
+        napi_throw_error(env, NULL, "Failed to retrieve callback information");
+        return NULL;
+    }
+    if (num_args != AWS_ARRAY_SIZE(node_args)) {
+        napi_throw_error(env, NULL, "io_input_stream_get_length requires exactly 1 argument");
+        return NULL;
+    }
+
+    struct aws_input_stream *stream = NULL;
+    if (napi_get_value_external(env, node_args[0], (void **)&stream)) {
+        napi_throw_error(env, NULL, "stream must be a node external");
+        return NULL;
+    }
+
+    /* undefined for streams whose length isn't known up front */
+    int64_t length = 0;
+    if (aws_input_stream_get_length(stream, &length)) {
+        return NULL;
+    }
+
+    napi_value node_length = NULL;
+    AWS_NAPI_ENSURE(env, napi_create_int64(env, length, &node_length));
+    return node_length;
+}
+
+napi_value aws_napi_io_input_stream_get_checksum(napi_env env, napi_callback_info info) {
+    napi_value node_args[1];
+    size_t num_args = AWS_ARRAY_SIZE(node_args);
+    if (napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL)) {
+        napi_throw_error(env, NULL, "Failed to retrieve callback information");
+        return NULL;
+    }
+    if (num_args != AWS_ARRAY_SIZE(node_args)) {
+        napi_throw_error(env, NULL, "io_input_stream_get_checksum requires exactly 1 argument");
+        return NULL;
+    }
+
+    struct aws_input_stream *stream = NULL;
+    if (napi_get_value_external(env, node_args[0], (void **)&stream)) {
+        napi_throw_error(env, NULL, "stream must be a node external");
+        return NULL;
+    }
 
+    /* Finalizing ends the checksum, so it's only done once every byte has been read and nothing more can be added */
+    napi_value node_checksum = NULL;
+    napi_status status = napi_ok;
+    bool read_to_end = false;
+    if (stream->vtable == &s_input_stream_vtable) {
+        struct aws_napi_input_stream_impl *impl = stream->impl;
+        aws_mutex_lock(&impl->mutex);
+        read_to_end = impl->synced_data.checksum.algorithm == AWS_NAPI_CHECKSUM_NONE ||
+                      (impl->synced_data.eos && impl->synced_data.bytes_buffered == 0);
+        if (read_to_end) {
+            status = aws_napi_running_checksum_finalize(&impl->synced_data.checksum, env, &node_checksum);
+        }
+        aws_mutex_unlock(&impl->mutex);
+    } else {
+        struct aws_napi_file_input_stream_impl *impl = stream->impl;
+        aws_mutex_lock(&impl->mutex);
+        read_to_end = impl->synced_data.checksum.algorithm == AWS_NAPI_CHECKSUM_NONE ||
+                      impl->synced_data.position == impl->length;
+        if (read_to_end) {
+            status = aws_napi_running_checksum_finalize(&impl->synced_data.checksum, env, &node_checksum);
+        }
+        aws_mutex_unlock(&impl->mutex);
+    }
+
+    if (!read_to_end) {
+        napi_throw_error(env, NULL, "The stream checksum is only available once the stream has been read to the end");
+        return NULL;
+    }
+    if (status != napi_ok) {
+        napi_throw_error(env, NULL, "Unable to finalize stream checksum");
+        return NULL;
+    }
+    return node_checksum;
+}
+
+napi_value aws_napi_io_input_stream_read(napi_env env, napi_callback_info info) {
+    napi_value node_args[2];
+    size_t num_args = AWS_ARRAY_SIZE(node_args);
+    if (napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL)) {
+        napi_throw_error(env, NULL, "Failed to retrieve callback information");
+        return NULL;
+    }
+    if (num_args != AWS_ARRAY_SIZE(node_args)) {
+        napi_throw_error(env, NULL, "io_input_stream_read requires exactly 2 arguments");
+        return NULL;
+    }
+
+    struct aws_input_stream *stream = NULL;
+    if (napi_get_value_external(env, node_args[0], (void **)&stream)) {
+        napi_throw_error(env, NULL, "stream must be a node external");
+        return NULL;
+    }
+
+    uint32_t max_bytes = 0;
+    if (napi_get_value_uint32(env, node_args[1], &max_bytes)) {
+        napi_throw_type_error(env, NULL, "max_bytes must be a number");
+        return NULL;
+    }
+
+    struct aws_byte_buf read_buf;
+    if (aws_byte_buf_init(&read_buf, aws_napi_get_allocator(), max_bytes)) {
+        aws_napi_throw_last_error(env);
+        return NULL;
+    }
+
+    napi_value node_data = NULL;
+    if (aws_input_stream_read(stream, &read_buf)) {
+        aws_napi_throw_last_error(env);
+    } else {
+        AWS_NAPI_CALL(env, napi_create_buffer_copy(env, read_buf.len, read_buf.buffer, NULL, &node_data), {
+            napi_throw_error(env, NULL, "Unable to create buffer");
+        });
+    }
+
+    aws_byte_buf_clean_up(&read_buf);
+    return node_data;
+}
+
+napi_value aws_napi_io_input_stream_seek(napi_env env, napi_callback_info info) {
+    napi_value node_args[2];
+    size_t num_args = AWS_ARRAY_SIZE(node_args);
+    if (napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL)) {
+        napi_throw_error(env, NULL, "Failed to retrieve callback information");
+        return NULL;
+    }
+    if (num_args != AWS_ARRAY_SIZE(node_args)) {
+        napi_throw_error(env, NULL, "io_input_stream_seek requires exactly 2 arguments");
+        return NULL;
+    }
+
+    struct aws_input_stream *stream = NULL;
+    if (napi_get_value_external(env, node_args[0], (void **)&stream)) {
+        napi_throw_error(env, NULL, "stream must be a node external");
+        return NULL;
+    }
+
+    int64_t offset = 0;
+    if (napi_get_value_int64(env, node_args[1], &offset)) {
+        napi_throw_type_error(env, NULL, "offset must be a number");
+        return NULL;
+    }
+
+    if (aws_input_stream_seek(stream, offset, AWS_SSB_BEGIN)) {
+        aws_napi_throw_last_error(env);
+    }
     return NULL;
 }
@@ -10,6 +10,7 @@
 #include <aws/io/channel_bootstrap.h>
 #include <aws/io/host_resolver.h>
 
+struct aws_input_stream;
 struct client_bootstrap_binding;
 
 AWS_EXTERN_C_BEGIN
@@ -29,11 +30,36 @@ napi_value aws_napi_error_code_to_name(napi_env env, napi_callback_info info);
  */
 napi_value aws_napi_is_alpn_available(napi_env env, napi_callback_info info);
 
+/**
+ * Sets the thread count and cpu group of the default event loop group, must be called before first use.
+ */
+napi_value aws_napi_io_set_default_event_loop_group_options(napi_env env, napi_callback_info info);
+
+/**
+ * Create a new aws_event_loop_group to be managed by an napi_external.
+ */
+napi_value aws_napi_io_event_loop_group_new(napi_env env, napi_callback_info info);
+
 /**
  * Create a new aws_client_bootstrap to be managed by an napi_external.
  */
 napi_value aws_napi_io_client_bootstrap_new(napi_env env, napi_callback_info info);
 
+/**
+ * Sets the cache size and TTL of the default host resolver, must be called before first use.
+ */
+napi_value aws_napi_io_set_default_host_resolver_options(napi_env env, napi_callback_info info);
+
+/**
+ * Resolves a list of hosts ahead of connecting to them, with the resolver of a bootstrap or the default resolver.
+ */
+napi_value aws_napi_io_host_resolver_pre_resolve(napi_env env, napi_callback_info info);
+
+/**
+ * Returns the cache hit/miss and DNS query counts of a bootstrap's resolver, or of the default resolver.
+ */
+napi_value aws_napi_io_host_resolver_get_stats(napi_env env, napi_callback_info info);
+
 /* extracts the underlying aws_client_bootstrap from an opaque binding, usually found in a node external */
 struct aws_client_bootstrap *aws_napi_get_client_bootstrap(struct client_bootstrap_binding *binding);
 
@@ -42,6 +68,11 @@ struct aws_client_bootstrap *aws_napi_get_client_bootstrap(struct client_bootstr
  */
 napi_value aws_napi_io_tls_ctx_new(napi_env env, napi_callback_info info);
 
+/**
+ * Returns the hit/miss counts of the cache of shared TLS contexts, and how many contexts it holds.
+ */
+napi_value aws_napi_io_tls_ctx_cache_get_stats(napi_env env, napi_callback_info info);
+
 /**
  * Create a new aws_tls_connection_options to be managed by a napi_external
  */
@@ -67,6 +98,38 @@ napi_value aws_napi_io_input_stream_new(napi_env, napi_callback_info info);
  */
 napi_value aws_napi_io_input_stream_append(napi_env env, napi_callback_info info);
 
+/**
+ * Create an input stream that reads a range of a file natively
+ */
+napi_value aws_napi_io_file_input_stream_new(napi_env env, napi_callback_info info);
+
+/**
+ * Makes the caller an owner of a stream created by io_input_stream_new or io_file_input_stream_new. aws-c-io streams
+ * aren't reference counted, so each owner gives up its share with aws_input_stream_destroy(), and the stream is freed
+ * once every owner and the js external are done with it.
+ */
+void aws_napi_io_input_stream_acquire(struct aws_input_stream *stream);
+
+/**
+ * Get the length of an input stream, or undefined if it isn't known
+ */
+napi_value aws_napi_io_input_stream_get_length(napi_env env, napi_callback_info info);
+
+/**
+ * Finish and get the checksum of the bytes read from an input stream since it was last rewound
+ */
+napi_value aws_napi_io_input_stream_get_checksum(napi_env env, napi_callback_info info);
+
+/**
+ * Read up to max_bytes from an input stream into a new Buffer, the way a connection would. Used by tests.
+ */
+napi_value aws_napi_io_input_stream_read(napi_env env, napi_callback_info info);
+
+/**
+ * Rewind an input stream to an offset from its start, the way a retried request would. Used by tests.
+ */
+napi_value aws_napi_io_input_stream_seek(napi_env env, napi_callback_info info);
+
 AWS_EXTERN_C_END
 
 #endif /* AWS_CRT_NODEJS_IO_H */
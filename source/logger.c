@@ -4,18 +4,16 @@
  */
 
 #include "logger.h"
+#include "metrics.h"
 
-#include <aws/common/linked_list.h>
+#include <aws/common/atomics.h>
 #include <aws/common/log_channel.h>
 #include <aws/common/log_formatter.h>
 #include <aws/common/log_writer.h>
 #include <aws/common/mutex.h>
-#include <aws/common/ring_buffer.h>
 
 #include <ctype.h>
 
-#define LOG_RING_BUFFER_CAPACITY (128 * 1024)
-
 #ifdef _MSC_VER
 #    pragma warning(disable : 4204)
 #endif /* _MSC_VER */
@@ -28,14 +26,16 @@
 struct aws_napi_logger_ctx {
     napi_env env;
     struct aws_allocator *allocator;
-    /* ring buffer for copying log messages for queueing */
-    struct aws_ring_buffer buffer;
-    /* allocator that uses the ring buffer */
-    struct aws_allocator buffer_allocator;
-    /* messages to be logged, filled from any thread, drained from node thread */
+    /* allocator for copying log messages for queueing */
+    struct aws_allocator *message_allocator;
+    /*
+     * messages to be logged, pushed from any thread without taking a lock, drained from node thread.
+     * head is a stack (most recent first), the drain takes the whole stack at once and reverses it.
+     */
     struct {
-        struct aws_mutex mutex;
-        struct aws_linked_list messages;
+        struct aws_atomic_var head;
+        /* set by the first message of each batch, which is the only one to wake up node */
+        struct aws_atomic_var drain_scheduled;
     } msg_queue;
     /* log function in node */
     napi_threadsafe_function log_drain;
@@ -50,16 +50,76 @@ static struct {
     struct aws_log_writer writer;
     struct aws_log_channel channel;
     struct aws_napi_logger_ctx *default_ctx;
+    /*
+     * writer for a native destination (file or fd), while set every thread writes straight to it instead of node.
+     * direct_writer_ptr is only a hint for skipping the lock, the writer is only used, replaced or cleaned up while
+     * holding s_direct_writer_lock.
+     */
+    struct aws_log_writer direct_writer;
+    struct aws_atomic_var direct_writer_ptr;
+    /* FILE handed over by aws_napi_logger_set_destination(), which the file writer won't close itself */
+    FILE *direct_file;
 } s_napi_logger;
 
+static struct aws_mutex s_direct_writer_lock = AWS_MUTEX_INIT;
+
 struct log_message {
-    struct aws_linked_list_node node;
-    struct aws_string *message;
+    struct log_message *next;
+    size_t len;
+    /* message bytes follow */
 };
 
+static const uint8_t *s_log_message_bytes(const struct log_message *msg) {
+    return (const uint8_t *)(msg + 1);
+}
+
+static void s_msg_queue_push(struct aws_napi_logger_ctx *ctx, struct log_message *msg) {
+    void *head = aws_atomic_load_ptr(&ctx->msg_queue.head);
+    do {
+        msg->next = head;
+    } while (!aws_atomic_compare_exchange_ptr(&ctx->msg_queue.head, &head, msg));
+}
+
+/* Takes every queued message, oldest first */
+static struct log_message *s_msg_queue_take_all(struct aws_napi_logger_ctx *ctx) {
+    struct log_message *msg = aws_atomic_exchange_ptr(&ctx->msg_queue.head, NULL);
+    struct log_message *oldest = NULL;
+    while (msg) {
+        struct log_message *next = msg->next;
+        msg->next = oldest;
+        oldest = msg;
+        msg = next;
+    }
+    return oldest;
+}
+
+static void s_destroy_messages(struct aws_napi_logger_ctx *ctx, struct log_message *msg) {
+    while (msg) {
+        struct log_message *next = msg->next;
+        aws_mem_release(ctx->message_allocator, msg);
+        msg = next;
+    }
+}
+
 /* custom aws_log_writer that writes via process._rawDebug() within the node env via threadsafe function */
 static int s_napi_log_writer_write(struct aws_log_writer *writer, const struct aws_string *output) {
     (void)writer;
+
+    /* a native destination skips node entirely */
+    if (aws_atomic_load_ptr(&s_napi_logger.direct_writer_ptr)) {
+        aws_mutex_lock(&s_direct_writer_lock);
+        struct aws_log_writer *direct_writer = aws_atomic_load_ptr(&s_napi_logger.direct_writer_ptr);
+        int result = AWS_OP_SUCCESS;
+        if (direct_writer) {
+            result = direct_writer->vtable->write(direct_writer, output);
+        }
+        aws_mutex_unlock(&s_direct_writer_lock);
+        if (direct_writer) {
+            return result;
+        }
+        /* cleared while we were waiting on the lock, so this goes to node after all */
+    }
+
     struct aws_napi_logger_ctx *ctx = tl_logger_ctx ? tl_logger_ctx : s_napi_logger.default_ctx;
     /* this can only happen if someone tries to log after the main thread has cleaned up */
     AWS_FATAL_ASSERT(ctx && "No TLS log context, and no default fallback");
@@ -82,25 +142,33 @@ static int s_napi_log_writer_write(struct aws_log_writer *writer, const struct a
         return AWS_OP_SUCCESS;
     }
 
+    size_t len = output->len - newlines;
+    struct log_message *msg = aws_mem_acquire(ctx->message_allocator, sizeof(struct log_message) + len);
+    AWS_FATAL_ASSERT(msg);
+    msg->len = len;
+    memcpy(msg + 1, aws_string_bytes(output), len);
+
+    /* queue up the message to be logged next time the function runs */
+    s_msg_queue_push(ctx, msg);
+
+    /* if a drain is already scheduled, it will pick this message up */
+    if (aws_atomic_exchange_int(&ctx->msg_queue.drain_scheduled, 1) != 0) {
+        return AWS_OP_SUCCESS;
+    }
+
     /*
-     * Pin the log drain function until we try to call it. If napi_closing is returned, the function
-     * has been released, which means we are shutting down, so we just bail
+     * Pin the log drain function until the call runs. If napi_closing is returned, the function
+     * has been released, which means we are shutting down, so we just bail. The message is freed with the context.
+     * Any other failure leaves the drain unscheduled, so let the next message try again.
      */
     AWS_NAPI_CALL(env, napi_acquire_threadsafe_function(ctx->log_drain), {
-        return (status == napi_closing) ? AWS_OP_SUCCESS : AWS_OP_ERR;
+        if (status == napi_closing) {
+            return AWS_OP_SUCCESS;
+        }
+        aws_atomic_store_int(&ctx->msg_queue.drain_scheduled, 0);
+        return AWS_OP_ERR;
     });
 
-    /* must allocate in the order things will be freed because we use a ring buffer */
-    struct aws_string *message =
-        aws_string_new_from_array(&ctx->buffer_allocator, aws_string_bytes(output), output->len - newlines);
-    struct log_message *msg = aws_mem_calloc(&ctx->buffer_allocator, 1, sizeof(struct log_message));
-    msg->message = message;
-
-    /* queue up the message to be logged next time the function runs */
-    aws_mutex_lock(&ctx->msg_queue.mutex);
-    aws_linked_list_push_back(&ctx->msg_queue.messages, &msg->node);
-    aws_mutex_unlock(&ctx->msg_queue.mutex);
-
     /* queue the call */
     AWS_NAPI_ENSURE(ctx->env, napi_call_threadsafe_function(ctx->log_drain, NULL, napi_tsfn_nonblocking));
     return AWS_OP_SUCCESS;
@@ -120,43 +188,47 @@ void aws_napi_logger_set_level(enum aws_log_level level) {
     aws_atomic_store_int(&((struct aws_logger_pipeline *)s_napi_logger.logger.p_impl)->level, level);
 }
 
-/* Allocator used to allocate buffered log messages from a ring buffer */
-static void *s_ring_buffer_mem_acquire(struct aws_allocator *allocator, size_t size) {
-    struct aws_ring_buffer *buffer = allocator->impl;
-    struct aws_byte_buf buf;
-    AWS_ZERO_STRUCT(buf);
-    /* if the ring buffer is full, fall back to the normal allocator */
-    if (aws_ring_buffer_acquire(buffer, size + sizeof(size_t), &buf)) {
-        AWS_FATAL_ASSERT(AWS_OP_SUCCESS == aws_byte_buf_init(&buf, buffer->allocator, size + sizeof(size_t)));
+/* must be called with s_direct_writer_lock held */
+static void s_clear_destination_synced(void) {
+    if (!aws_atomic_load_ptr(&s_napi_logger.direct_writer_ptr)) {
+        return;
+    }
+
+    aws_atomic_store_ptr(&s_napi_logger.direct_writer_ptr, NULL);
+    aws_log_writer_clean_up(&s_napi_logger.direct_writer);
+    if (s_napi_logger.direct_file && s_napi_logger.direct_file != stdout && s_napi_logger.direct_file != stderr) {
+        fclose(s_napi_logger.direct_file);
     }
-    *((size_t *)buf.buffer) = buf.capacity;
-    return buf.buffer + sizeof(size_t);
+    s_napi_logger.direct_file = NULL;
 }
 
-static void s_ring_buffer_mem_release(struct aws_allocator *allocator, void *ptr) {
-    void *addr = ((uint8_t *)ptr - sizeof(size_t));
-    size_t size = *((size_t *)addr);
-    struct aws_byte_buf buf = {
-        .allocator = allocator,
-        .buffer = addr,
-        .capacity = size,
-        .len = 0,
+int aws_napi_logger_set_destination(const char *filename, FILE *file) {
+    int result = AWS_OP_SUCCESS;
+    aws_mutex_lock(&s_direct_writer_lock);
+
+    /* nobody can be writing to the old destination while we hold the lock */
+    s_clear_destination_synced();
+
+    struct aws_log_writer_file_options options = {
+        .filename = filename,
+        .file = file,
     };
-    struct aws_ring_buffer *buffer = allocator->impl;
-
-    /* see if the memory comes from the ring buffer */
-    if (aws_ring_buffer_buf_belongs_to_pool(buffer, &buf)) {
-        aws_ring_buffer_release(buffer, &buf);
-    } else {
-        /* release to the fallback allocator */
-        aws_mem_release(buffer->allocator, addr);
+    if (aws_log_writer_init_file(&s_napi_logger.direct_writer, aws_napi_get_allocator(), &options)) {
+        result = AWS_OP_ERR;
+        goto done;
     }
+    s_napi_logger.direct_file = file;
+    aws_atomic_store_ptr(&s_napi_logger.direct_writer_ptr, &s_napi_logger.direct_writer);
+
+done:
+    aws_mutex_unlock(&s_direct_writer_lock);
+    return result;
 }
 
-static void *s_ring_buffer_mem_calloc(struct aws_allocator *allocator, size_t num, size_t size) {
-    void *mem = s_ring_buffer_mem_acquire(allocator, num * size);
-    memset(mem, 0, size);
-    return mem;
+void aws_napi_logger_clear_destination(void) {
+    aws_mutex_lock(&s_direct_writer_lock);
+    s_clear_destination_synced();
+    aws_mutex_unlock(&s_direct_writer_lock);
 }
 
 /* called from every thread as its node environment shuts down */
@@ -166,17 +238,13 @@ void s_threadsafe_log_finalize(napi_env env, void *finalize_data, void *finalize
 
     struct aws_napi_logger_ctx *ctx = finalize_data;
 
-    /* empty message queue, do not need to delete messages as they all come from the ring buffer */
-    struct aws_linked_list msgs;
-    aws_linked_list_init(&msgs);
-    aws_mutex_lock(&ctx->msg_queue.mutex);
-    aws_linked_list_swap_contents(&ctx->msg_queue.messages, &msgs);
-    aws_mutex_unlock(&ctx->msg_queue.mutex);
-
     /* Drop the ref to the function. All attempts to acquire will return napi_closing after this */
     AWS_NAPI_ENSURE(env, napi_release_threadsafe_function(ctx->log_drain, napi_tsfn_abort));
     ctx->log_drain = NULL;
 
+    /* empty message queue, they will never be delivered */
+    s_destroy_messages(ctx, s_msg_queue_take_all(ctx));
+
     /* The rest is cleaned up by the env context clean up via aws_napi_logger_destroy() */
 }
 
@@ -185,29 +253,24 @@ static void s_threadsafe_log_call(napi_env env, napi_value node_log_fn, void *co
     (void)user_data;
     struct aws_napi_logger_ctx *ctx = context;
 
-    /* transfer the messages under lock */
-    struct aws_linked_list msgs;
-    aws_linked_list_init(&msgs);
-    aws_mutex_lock(&ctx->msg_queue.mutex);
-    aws_linked_list_swap_contents(&ctx->msg_queue.messages, &msgs);
-    aws_mutex_unlock(&ctx->msg_queue.mutex);
+    /* clear the flag before taking the messages, so anything queued after this schedules another call */
+    aws_atomic_store_int(&ctx->msg_queue.drain_scheduled, 0);
+    struct log_message *msgs = s_msg_queue_take_all(ctx);
 
     /*
      * If env is null, that means that the function is simply requesting that any resources be
      * freed for shutdown
      */
     if (!env) {
-        while (!aws_linked_list_empty(&msgs)) {
-            struct aws_linked_list_node *list_node = aws_linked_list_pop_front(&msgs);
-            struct log_message *msg = AWS_CONTAINER_OF(list_node, struct log_message, node);
-            aws_string_destroy(msg->message);
-            aws_mem_release(&ctx->buffer_allocator, msg);
-        }
+        s_destroy_messages(ctx, msgs);
         return;
     }
 
+    struct aws_byte_buf joined;
+    AWS_ZERO_STRUCT(joined);
+
     /* nothing to do, maybe next time... */
-    if (aws_linked_list_empty(&msgs)) {
+    if (!msgs) {
         goto done;
     }
 
@@ -220,21 +283,27 @@ static void s_threadsafe_log_call(napi_env env, napi_value node_log_fn, void *co
     napi_value node_process = NULL;
     AWS_NAPI_CALL(env, napi_get_named_property(env, node_global, "process", &node_process), { goto done; });
 
-    while (!aws_linked_list_empty(&msgs)) {
-        struct aws_linked_list_node *list_node = aws_linked_list_pop_front(&msgs);
-        struct log_message *msg = AWS_CONTAINER_OF(list_node, struct log_message, node);
-
-        napi_value node_message = NULL;
-        AWS_NAPI_ENSURE(
-            env, napi_create_string_utf8(env, aws_string_c_str(msg->message), msg->message->len, &node_message));
-        AWS_NAPI_ENSURE(env, napi_call_function(env, node_process, node_log_fn, 1, &node_message, NULL));
-
-        aws_string_destroy(msg->message);
-        aws_mem_release(&ctx->buffer_allocator, msg);
+    /* the whole batch goes to node in one call, one line per message */
+    size_t joined_len = 0;
+    for (struct log_message *msg = msgs; msg; msg = msg->next) {
+        joined_len += msg->len + (msg->next ? 1 : 0);
+    }
+    AWS_FATAL_ASSERT(AWS_OP_SUCCESS == aws_byte_buf_init(&joined, ctx->allocator, joined_len));
+    for (struct log_message *msg = msgs; msg; msg = msg->next) {
+        aws_byte_buf_write(&joined, s_log_message_bytes(msg), msg->len);
+        if (msg->next) {
+            aws_byte_buf_write_u8(&joined, '\n');
+        }
     }
 
+    napi_value node_message = NULL;
+    AWS_NAPI_ENSURE(env, napi_create_string_utf8(env, (const char *)joined.buffer, joined.len, &node_message));
+    AWS_NAPI_ENSURE(env, napi_call_function(env, node_process, node_log_fn, 1, &node_message, NULL));
+
     /* un-pin the log drain function */
 done:
+    aws_byte_buf_clean_up(&joined);
+    s_destroy_messages(ctx, msgs);
     AWS_NAPI_ENSURE(env, napi_release_threadsafe_function(ctx->log_drain, napi_tsfn_release));
 }
 
@@ -279,20 +348,14 @@ struct aws_napi_logger_ctx *aws_napi_logger_new(struct aws_allocator *allocator,
     AWS_FATAL_ASSERT(ctx && "Failed to allocate new logging context");
     ctx->env = env;
     ctx->allocator = allocator;
-    aws_mutex_init(&ctx->msg_queue.mutex);
-    aws_linked_list_init(&ctx->msg_queue.messages);
+    ctx->message_allocator = aws_napi_get_metrics_allocator(AWS_NAPI_METRICS_LOGGER);
+    aws_atomic_init_ptr(&ctx->msg_queue.head, NULL);
+    aws_atomic_init_int(&ctx->msg_queue.drain_scheduled, 0);
 
     /* store this thread's context */
     AWS_FATAL_ASSERT(tl_logger_ctx == NULL && "Cannot initialize multiple logging contexts in a single thread");
     tl_logger_ctx = ctx;
 
-    /* stand up the ring buffer allocator for copying/queueing log messages */
-    AWS_FATAL_ASSERT(AWS_OP_SUCCESS == aws_ring_buffer_init(&ctx->buffer, ctx->allocator, LOG_RING_BUFFER_CAPACITY));
-    ctx->buffer_allocator.mem_acquire = s_ring_buffer_mem_acquire;
-    ctx->buffer_allocator.mem_release = s_ring_buffer_mem_release;
-    ctx->buffer_allocator.mem_calloc = s_ring_buffer_mem_calloc;
-    ctx->buffer_allocator.impl = &ctx->buffer;
-
     /* create the log drain */
     s_threadsafe_log_create(ctx, ctx->env);
 
@@ -317,9 +380,8 @@ void aws_napi_logger_destroy(struct aws_napi_logger_ctx *ctx) {
         s_napi_logger.default_ctx = NULL;
     }
 
-    aws_mutex_clean_up(&ctx->msg_queue.mutex);
-    /* don't need to worry about cleaning up the message queue, all of the memory comes from the ring buffer */
-    aws_ring_buffer_clean_up(&ctx->buffer);
+    /* anything logged since the drain function was finalized */
+    s_destroy_messages(ctx, s_msg_queue_take_all(ctx));
     aws_mem_release(ctx->allocator, ctx);
 }
 
@@ -7,6 +7,8 @@
 
 #include "module.h"
 
+#include <stdio.h>
+
 struct aws_napi_logger_ctx;
 
 /**
@@ -26,4 +28,17 @@ struct aws_napi_logger_ctx *aws_napi_logger_new(struct aws_allocator *allocator,
 void aws_napi_logger_destroy(struct aws_napi_logger_ctx *logger);
 void aws_napi_logger_set_level(enum aws_log_level level);
 
+/**
+ * Sends all log output straight to a file (opened for append) or an already open FILE, from whichever thread logs it,
+ * instead of queueing it to node. Exactly one of filename or file must be set. Replaces, and closes, any previous
+ * destination. On success the logger owns file and closes it when the destination is replaced or cleared, unless it
+ * is stdout or stderr. On failure the caller keeps file, and there is no native destination.
+ */
+int aws_napi_logger_set_destination(const char *filename, FILE *file);
+
+/**
+ * Closes the native destination, if any, log output goes back to node.
+ */
+void aws_napi_logger_clear_destination(void);
+
 #endif /* AWS_CRT_NODEJS_LOGGER_H */
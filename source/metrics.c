@@ -0,0 +1,327 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include "metrics.h"
+
+#include <aws/common/atomics.h>
+#include <aws/common/environment.h>
+#include <aws/common/mutex.h>
+#include <aws/common/string.h>
+
+#include <stdlib.h>
+
+/*
+ * Subsystem allocation counters
+ */
+struct subsystem_metrics {
+    struct aws_allocator allocator;
+    const char *name;
+    struct aws_atomic_var live_allocations;
+    struct aws_atomic_var allocations;
+};
+
+static void *s_metrics_mem_acquire(struct aws_allocator *allocator, size_t size);
+static void s_metrics_mem_release(struct aws_allocator *allocator, void *ptr);
+static void *s_metrics_mem_realloc(struct aws_allocator *allocator, void *old_ptr, size_t old_size, size_t new_size);
+static void *s_metrics_mem_calloc(struct aws_allocator *allocator, size_t num, size_t size);
+
+#define SUBSYSTEM_METRICS_INIT(subsystem_name)                                                                         \
+    {                                                                                                                  \
+        .allocator =                                                                                                   \
+            {                                                                                                          \
+                .mem_acquire = s_metrics_mem_acquire,                                                                  \
+                .mem_release = s_metrics_mem_release,                                                                  \
+                .mem_realloc = s_metrics_mem_realloc,                                                                  \
+                .mem_calloc = s_metrics_mem_calloc,                                                                    \
+            },                                                                                                         \
+        .name = (subsystem_name), .live_allocations = AWS_ATOMIC_INIT_INT(0), .allocations = AWS_ATOMIC_INIT_INT(0),   \
+    }
+
+static struct subsystem_metrics s_subsystems[AWS_NAPI_METRICS_SUBSYSTEM_COUNT] = {
+    [AWS_NAPI_METRICS_HTTP_STREAM] = SUBSYSTEM_METRICS_INIT("http_stream"),
+    [AWS_NAPI_METRICS_MQTT] = SUBSYSTEM_METRICS_INIT("mqtt"),
+    [AWS_NAPI_METRICS_LOGGER] = SUBSYSTEM_METRICS_INIT("logger"),
+    [AWS_NAPI_METRICS_INPUT_STREAM] = SUBSYSTEM_METRICS_INIT("input_stream"),
+};
+
+static void s_record_allocation(struct subsystem_metrics *subsystem) {
+    aws_atomic_fetch_add(&subsystem->live_allocations, 1);
+    aws_atomic_fetch_add(&subsystem->allocations, 1);
+}
+
+static void s_record_release(struct subsystem_metrics *subsystem) {
+    aws_atomic_fetch_sub(&subsystem->live_allocations, 1);
+}
+
+static void *s_metrics_mem_acquire(struct aws_allocator *allocator, size_t size) {
+    void *ptr = aws_mem_acquire(aws_napi_get_allocator(), size);
+    if (ptr) {
+        s_record_allocation(AWS_CONTAINER_OF(allocator, struct subsystem_metrics, allocator));
+    }
+    return ptr;
+}
+
+static void s_metrics_mem_release(struct aws_allocator *allocator, void *ptr) {
+    s_record_release(AWS_CONTAINER_OF(allocator, struct subsystem_metrics, allocator));
+    aws_mem_release(aws_napi_get_allocator(), ptr);
+}
+
+static void *s_metrics_mem_realloc(struct aws_allocator *allocator, void *old_ptr, size_t old_size, size_t new_size) {
+    void *ptr = old_ptr;
+    if (aws_mem_realloc(aws_napi_get_allocator(), &ptr, old_size, new_size)) {
+        return NULL;
+    }
+    /* growing an existing allocation doesn't change how many are live */
+    if (!old_ptr) {
+        s_record_allocation(AWS_CONTAINER_OF(allocator, struct subsystem_metrics, allocator));
+    }
+    return ptr;
+}
+
+static void *s_metrics_mem_calloc(struct aws_allocator *allocator, size_t num, size_t size) {
+    void *ptr = aws_mem_calloc(aws_napi_get_allocator(), num, size);
+    if (ptr) {
+        s_record_allocation(AWS_CONTAINER_OF(allocator, struct subsystem_metrics, allocator));
+    }
+    return ptr;
+}
+
+struct aws_allocator *aws_napi_get_metrics_allocator(enum aws_napi_metrics_subsystem subsystem) {
+    AWS_FATAL_ASSERT(subsystem < AWS_NAPI_METRICS_SUBSYSTEM_COUNT);
+    return &s_subsystems[subsystem].allocator;
+}
+
+/*
+ * Callback metrics
+ */
+
+/* Upper bounds of the latency histogram buckets, in microseconds. Anything slower lands in the overflow bucket. */
+static const uint64_t s_latency_bounds_us[] = {
+    50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000};
+#define LATENCY_BUCKET_COUNT (AWS_ARRAY_SIZE(s_latency_bounds_us) + 1)
+
+/* Increment this as more callback types are added */
+#define MAX_CALLBACK_TYPES 64
+
+struct aws_napi_callback_metrics {
+    const char *name;
+    struct aws_atomic_var queued;
+    struct aws_atomic_var dispatched;
+    struct aws_atomic_var latency_sum_us;
+    struct aws_atomic_var latency_buckets[LATENCY_BUCKET_COUNT];
+};
+
+static struct {
+    struct aws_mutex lock;
+    /* entries below count are fully initialized and never change name, so readers only need count */
+    struct aws_atomic_var count;
+    struct aws_napi_callback_metrics entries[MAX_CALLBACK_TYPES];
+} s_callbacks = {
+    .lock = AWS_MUTEX_INIT,
+    .count = AWS_ATOMIC_INIT_INT(0),
+};
+
+AWS_STATIC_STRING_FROM_LITERAL(s_callback_metrics_env_var, "AWS_CRT_CALLBACK_METRICS");
+
+/* Only ever called from the node thread, as threadsafe functions are created */
+static bool s_callback_metrics_enabled(void) {
+    static int s_enabled = -1;
+    if (AWS_UNLIKELY(s_enabled < 0)) {
+        struct aws_string *value = NULL;
+        s_enabled = 0;
+        if (aws_get_environment_value(aws_default_allocator(), s_callback_metrics_env_var, &value) == AWS_OP_SUCCESS &&
+            value != NULL) {
+            s_enabled = atoi(aws_string_c_str(value)) > 0;
+            aws_string_destroy(value);
+        }
+    }
+    return s_enabled > 0;
+}
+
+struct aws_napi_callback_metrics *aws_napi_callback_metrics_for_name(const char *name) {
+    if (!s_callback_metrics_enabled()) {
+        return NULL;
+    }
+
+    struct aws_napi_callback_metrics *metrics = NULL;
+
+    aws_mutex_lock(&s_callbacks.lock);
+    size_t count = aws_atomic_load_int(&s_callbacks.count);
+    for (size_t i = 0; i < count; ++i) {
+        if (strcmp(s_callbacks.entries[i].name, name) == 0) {
+            metrics = &s_callbacks.entries[i];
+            break;
+        }
+    }
+
+    if (!metrics && count < MAX_CALLBACK_TYPES) {
+        metrics = &s_callbacks.entries[count];
+        metrics->name = name;
+        aws_atomic_init_int(&metrics->queued, 0);
+        aws_atomic_init_int(&metrics->dispatched, 0);
+        aws_atomic_init_int(&metrics->latency_sum_us, 0);
+        for (size_t i = 0; i < LATENCY_BUCKET_COUNT; ++i) {
+            aws_atomic_init_int(&metrics->latency_buckets[i], 0);
+        }
+        aws_atomic_store_int(&s_callbacks.count, count + 1);
+    }
+    aws_mutex_unlock(&s_callbacks.lock);
+
+    return metrics;
+}
+
+void aws_napi_callback_metrics_record_queued(struct aws_napi_callback_metrics *metrics) {
+    if (metrics) {
+        aws_atomic_fetch_add(&metrics->queued, 1);
+    }
+}
+
+void aws_napi_callback_metrics_record_dropped(struct aws_napi_callback_metrics *metrics) {
+    if (metrics) {
+        aws_atomic_fetch_sub(&metrics->queued, 1);
+    }
+}
+
+void aws_napi_callback_metrics_record_dispatched(struct aws_napi_callback_metrics *metrics, uint64_t latency_ns) {
+    if (!metrics) {
+        return;
+    }
+
+    uint64_t latency_us = latency_ns / 1000;
+    size_t bucket = 0;
+    while (bucket < AWS_ARRAY_SIZE(s_latency_bounds_us) && latency_us > s_latency_bounds_us[bucket]) {
+        ++bucket;
+    }
+
+    aws_atomic_fetch_add(&metrics->latency_buckets[bucket], 1);
+    aws_atomic_fetch_add(&metrics->latency_sum_us, (size_t)latency_us);
+    aws_atomic_fetch_add(&metrics->dispatched, 1);
+}
+
+/*
+ * Snapshot
+ */
+static napi_status s_set_int64_property(napi_env env, napi_value object, const char *name, int64_t value) {
+    napi_value node_value = NULL;
+    AWS_NAPI_CALL(env, napi_create_int64(env, value, &node_value), { return status; });
+    return napi_set_named_property(env, object, name, node_value);
+}
+
+static napi_status s_create_subsystems(napi_env env, napi_value *result) {
+    AWS_NAPI_CALL(env, napi_create_object(env, result), { return status; });
+
+    for (size_t i = 0; i < AWS_NAPI_METRICS_SUBSYSTEM_COUNT; ++i) {
+        struct subsystem_metrics *subsystem = &s_subsystems[i];
+        napi_value node_subsystem = NULL;
+        AWS_NAPI_CALL(env, napi_create_object(env, &node_subsystem), { return status; });
+        /* releases through a different allocator can briefly drive this negative, report what was counted */
+        int64_t live = (int64_t)(intptr_t)aws_atomic_load_int(&subsystem->live_allocations);
+        AWS_NAPI_CALL(env, s_set_int64_property(env, node_subsystem, "live_allocations", live), { return status; });
+        AWS_NAPI_CALL(
+            env,
+            s_set_int64_property(
+                env, node_subsystem, "allocations", (int64_t)aws_atomic_load_int(&subsystem->allocations)),
+            { return status; });
+        AWS_NAPI_CALL(env, napi_set_named_property(env, *result, subsystem->name, node_subsystem), {
+            return status;
+        });
+    }
+
+    return napi_ok;
+}
+
+static napi_status s_create_latency(napi_env env, struct aws_napi_callback_metrics *metrics, napi_value *result) {
+    AWS_NAPI_CALL(env, napi_create_object(env, result), { return status; });
+
+    napi_value node_bounds = NULL;
+    napi_value node_counts = NULL;
+    AWS_NAPI_CALL(env, napi_create_array_with_length(env, AWS_ARRAY_SIZE(s_latency_bounds_us), &node_bounds), {
+        return status;
+    });
+    AWS_NAPI_CALL(env, napi_create_array_with_length(env, LATENCY_BUCKET_COUNT, &node_counts), { return status; });
+
+    for (uint32_t i = 0; i < LATENCY_BUCKET_COUNT; ++i) {
+        napi_value node_value = NULL;
+        if (i < AWS_ARRAY_SIZE(s_latency_bounds_us)) {
+            AWS_NAPI_CALL(env, napi_create_int64(env, (int64_t)s_latency_bounds_us[i], &node_value), {
+                return status;
+            });
+            AWS_NAPI_CALL(env, napi_set_element(env, node_bounds, i, node_value), { return status; });
+        }
+        AWS_NAPI_CALL(
+            env, napi_create_int64(env, (int64_t)aws_atomic_load_int(&metrics->latency_buckets[i]), &node_value), {
+                return status;
+            });
+        AWS_NAPI_CALL(env, napi_set_element(env, node_counts, i, node_value), { return status; });
+    }
+
+    AWS_NAPI_CALL(env, napi_set_named_property(env, *result, "bounds_us", node_bounds), { return status; });
+    AWS_NAPI_CALL(env, napi_set_named_property(env, *result, "counts", node_counts), { return status; });
+    return s_set_int64_property(env, *result, "sum_us", (int64_t)aws_atomic_load_int(&metrics->latency_sum_us));
+}
+
+static napi_status s_create_callbacks(napi_env env, napi_value *result) {
+    size_t count = aws_atomic_load_int(&s_callbacks.count);
+    AWS_NAPI_CALL(env, napi_create_array_with_length(env, count, result), { return status; });
+
+    for (uint32_t i = 0; i < count; ++i) {
+        struct aws_napi_callback_metrics *metrics = &s_callbacks.entries[i];
+        napi_value node_callback = NULL;
+        AWS_NAPI_CALL(env, napi_create_object(env, &node_callback), { return status; });
+
+        napi_value node_name = NULL;
+        AWS_NAPI_CALL(env, napi_create_string_utf8(env, metrics->name, NAPI_AUTO_LENGTH, &node_name), {
+            return status;
+        });
+        AWS_NAPI_CALL(env, napi_set_named_property(env, node_callback, "name", node_name), { return status; });
+
+        /* read dispatched first, so a call finishing in between can't make the depth negative */
+        int64_t dispatched = (int64_t)aws_atomic_load_int(&metrics->dispatched);
+        int64_t queued = (int64_t)aws_atomic_load_int(&metrics->queued);
+        AWS_NAPI_CALL(env, s_set_int64_property(env, node_callback, "queued", queued), { return status; });
+        AWS_NAPI_CALL(env, s_set_int64_property(env, node_callback, "dispatched", dispatched), { return status; });
+        AWS_NAPI_CALL(
+            env, s_set_int64_property(env, node_callback, "queue_depth", queued > dispatched ? queued - dispatched : 0), {
+                return status;
+            });
+
+        napi_value node_latency = NULL;
+        AWS_NAPI_CALL(env, s_create_latency(env, metrics, &node_latency), { return status; });
+        AWS_NAPI_CALL(env, napi_set_named_property(env, node_callback, "latency", node_latency), { return status; });
+
+        AWS_NAPI_CALL(env, napi_set_element(env, *result, i, node_callback), { return status; });
+    }
+
+    return napi_ok;
+}
+
+napi_value aws_napi_native_metrics(napi_env env, napi_callback_info info) {
+    (void)info;
+
+    napi_value node_metrics = NULL;
+    napi_value node_subsystems = NULL;
+    napi_value node_callbacks = NULL;
+    AWS_NAPI_CALL(env, napi_create_object(env, &node_metrics), {
+        napi_throw_error(env, NULL, "Failed to create metrics object");
+        return NULL;
+    });
+    AWS_NAPI_CALL(env, s_create_subsystems(env, &node_subsystems), {
+        napi_throw_error(env, NULL, "Failed to collect subsystem metrics");
+        return NULL;
+    });
+    AWS_NAPI_CALL(env, s_create_callbacks(env, &node_callbacks), {
+        napi_throw_error(env, NULL, "Failed to collect callback metrics");
+        return NULL;
+    });
+    AWS_NAPI_CALL(env, napi_set_named_property(env, node_metrics, "subsystems", node_subsystems), {
+        napi_throw_error(env, NULL, "Failed to set subsystems");
+        return NULL;
+    });
+    AWS_NAPI_CALL(env, napi_set_named_property(env, node_metrics, "callbacks", node_callbacks), {
+        napi_throw_error(env, NULL, "Failed to set callbacks");
+        return NULL;
+    });
+
+    return node_metrics;
+}
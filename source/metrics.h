@@ -0,0 +1,54 @@
+#ifndef AWS_CRT_NODEJS_METRICS_H
+#define AWS_CRT_NODEJS_METRICS_H
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "module.h"
+
+/* Subsystems whose live native allocations are tracked individually */
+enum aws_napi_metrics_subsystem {
+    AWS_NAPI_METRICS_HTTP_STREAM,
+    AWS_NAPI_METRICS_MQTT,
+    AWS_NAPI_METRICS_LOGGER,
+    AWS_NAPI_METRICS_INPUT_STREAM,
+    AWS_NAPI_METRICS_SUBSYSTEM_COUNT,
+};
+
+/**
+ * Returns an allocator that forwards to aws_napi_get_allocator() and counts allocations against subsystem.
+ * Memory may be released through either allocator, but only releases through this one are counted.
+ */
+struct aws_allocator *aws_napi_get_metrics_allocator(enum aws_napi_metrics_subsystem subsystem);
+
+/*
+ * Per callback type statistics for threadsafe functions: how many calls are waiting on the node thread, and how long
+ * each waited between being queued and being dispatched. Timing every call costs a lock per call, so these are only
+ * collected when the AWS_CRT_CALLBACK_METRICS environment variable is set to 1.
+ */
+struct aws_napi_callback_metrics;
+
+/**
+ * Finds or creates the metrics for a callback type. name must be a string literal, or otherwise live as long as the
+ * process. Returns NULL if callback metrics are off or too many callback types have been registered, the record
+ * functions accept NULL.
+ */
+struct aws_napi_callback_metrics *aws_napi_callback_metrics_for_name(const char *name);
+
+void aws_napi_callback_metrics_record_queued(struct aws_napi_callback_metrics *metrics);
+/* A queued call that will never be dispatched, because queueing it failed */
+void aws_napi_callback_metrics_record_dropped(struct aws_napi_callback_metrics *metrics);
+void aws_napi_callback_metrics_record_dispatched(struct aws_napi_callback_metrics *metrics, uint64_t latency_ns);
+
+/**
+ * native_metrics(): returns a snapshot of every metric as
+ * {
+ *   subsystems: { [name]: { live_allocations, allocations } },
+ *   callbacks: [ { name, queued, dispatched, queue_depth, latency: { bounds_us, counts, sum_us } } ]
+ * }
+ * latency.counts has one more entry than bounds_us, the last being the overflow bucket.
+ */
+napi_value aws_napi_native_metrics(napi_env env, napi_callback_info info);
+
+#endif /* AWS_CRT_NODEJS_METRICS_H */
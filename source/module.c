@@ -6,6 +6,8 @@
 #include "auth.h"
 #include "checksums.h"
 #include "crypto.h"
+#include "host_resolver.h"
+#include "http2_stream_manager.h"
 #include "http_connection.h"
 #include "http_connection_manager.h"
 #include "http_headers.h"
@@ -13,14 +15,18 @@
 #include "http_stream.h"
 #include "io.h"
 #include "logger.h"
+#include "metrics.h"
 #include "mqtt_client.h"
 #include "mqtt_client_connection.h"
 
 #include <aws/cal/cal.h>
 
+#include <aws/common/atomics.h>
 #include <aws/common/clock.h>
 #include <aws/common/environment.h>
+#include <aws/common/linked_list.h>
 #include <aws/common/logging.h>
+#include <aws/common/mutex.h>
 #include <aws/common/ref_count.h>
 #include <aws/common/system_info.h>
 
@@ -66,7 +72,110 @@ static struct aws_event_loop_group *s_node_uv_elg = NULL;
 static struct aws_host_resolver *s_default_host_resolver = NULL;
 static struct aws_client_bootstrap *s_default_client_bootstrap = NULL;
 
+/*
+ * The default event loop group, host resolver and client bootstrap are created on first use, so that the
+ * event loop group can be configured from javascript before anything needs it.
+ */
+static struct aws_mutex s_default_io_lock = AWS_MUTEX_INIT;
+static struct {
+    uint16_t num_threads;
+    bool pin_to_cpu_group;
+    uint16_t cpu_group;
+} s_default_elg_options = {
+    .num_threads = 1,
+};
+static struct {
+    size_t max_entries;
+    size_t max_ttl_secs;
+} s_default_host_resolver_options = {
+    .max_entries = AWS_NAPI_HOST_RESOLVER_DEFAULT_MAX_ENTRIES,
+    .max_ttl_secs = AWS_NAPI_HOST_RESOLVER_DEFAULT_MAX_TTL_SECS,
+};
+
+/* Largest number of bytes a single code unit (or surrogate pair) can expand to in UTF-8 */
+#define AWS_NAPI_UTF8_MAX_CHAR_SIZE 4
+
+/*
+ * Writes node_str as UTF-8 into storage if capacity fits, otherwise into a new heap buffer. Returns whether the whole
+ * string was written: node stops short of a character that doesn't fit, so with less than a full character's worth of
+ * room left over, the output may have been truncated.
+ */
+static napi_status s_write_utf8(
+    struct aws_byte_buf *buf,
+    napi_env env,
+    napi_value node_str,
+    size_t capacity,
+    uint8_t *storage,
+    size_t storage_size,
+    bool *complete) {
+
+    if (storage && capacity <= storage_size) {
+        *buf = aws_byte_buf_from_empty_array(storage, storage_size);
+    } else if (aws_byte_buf_init(buf, aws_napi_get_allocator(), capacity)) {
+        return napi_generic_failure;
+    }
+
+    /* Node requires that the null terminator be written */
+    AWS_NAPI_CALL(env, napi_get_value_string_utf8(env, node_str, (char *)buf->buffer, buf->capacity, &buf->len), {
+        aws_byte_buf_clean_up(buf);
+        return status;
+    });
+
+    *complete = (buf->capacity - 1 - buf->len) >= AWS_NAPI_UTF8_MAX_CHAR_SIZE;
+    return napi_ok;
+}
+
+static napi_status s_byte_buf_init_from_napi_string(
+    struct aws_byte_buf *buf,
+    napi_env env,
+    napi_value node_str,
+    uint8_t *storage,
+    size_t storage_size) {
+
+    /*
+     * The UTF-16 length is known without walking the string. Most strings that cross into native code (header values,
+     * regions, topics, keys) are ASCII, which is exactly one byte per code unit, so size for that and write once
+     * rather than asking node for the UTF-8 length first.
+     */
+    size_t utf16_length = 0;
+    AWS_NAPI_CALL(env, napi_get_value_string_utf16(env, node_str, NULL, 0, &utf16_length), { return status; });
+
+    bool complete = false;
+    size_t capacity = utf16_length + 1 + AWS_NAPI_UTF8_MAX_CHAR_SIZE;
+    if (storage && capacity < storage_size) {
+        capacity = storage_size;
+    }
+    AWS_NAPI_CALL(env, s_write_utf8(buf, env, node_str, capacity, storage, storage_size, &complete), {
+        return status;
+    });
+    if (complete) {
+        return napi_ok;
+    }
+
+    /* Multi-byte content that didn't fit, only this case walks the string twice */
+    aws_byte_buf_clean_up(buf);
+
+    size_t length = 0;
+    AWS_NAPI_CALL(env, napi_get_value_string_utf8(env, node_str, NULL, 0, &length), { return status; });
+
+    AWS_NAPI_CALL(
+        env,
+        s_write_utf8(buf, env, node_str, length + 1 + AWS_NAPI_UTF8_MAX_CHAR_SIZE, storage, storage_size, &complete),
+        { return status; });
+    AWS_ASSERT(complete && length == buf->len);
+    return napi_ok;
+}
+
 napi_status aws_byte_buf_init_from_napi(struct aws_byte_buf *buf, napi_env env, napi_value node_str) {
+    return aws_byte_buf_init_from_napi_with_storage(buf, env, node_str, NULL, 0);
+}
+
+napi_status aws_byte_buf_init_from_napi_with_storage(
+    struct aws_byte_buf *buf,
+    napi_env env,
+    napi_value node_str,
+    uint8_t *storage,
+    size_t storage_size) {
 
     AWS_ASSERT(buf);
 
@@ -75,19 +184,7 @@ napi_status aws_byte_buf_init_from_napi(struct aws_byte_buf *buf, napi_env env,
 
     if (type == napi_string) {
 
-        size_t length = 0;
-        AWS_NAPI_CALL(env, napi_get_value_string_utf8(env, node_str, NULL, 0, &length), { return status; });
-
-        /* Node requires that the null terminator be written */
-        if (aws_byte_buf_init(buf, aws_napi_get_allocator(), length + 1)) {
-            return napi_generic_failure;
-        }
-
-        AWS_NAPI_CALL(env, napi_get_value_string_utf8(env, node_str, (char *)buf->buffer, buf->capacity, &buf->len), {
-            return status;
-        });
-        AWS_ASSERT(length == buf->len);
-        return napi_ok;
+        return s_byte_buf_init_from_napi_string(buf, env, node_str, storage, storage_size);
 
     } else if (type == napi_object) {
 
@@ -159,8 +256,9 @@ napi_status aws_byte_buf_init_from_napi(struct aws_byte_buf *buf, napi_env env,
 
 struct aws_string *aws_string_new_from_napi(napi_env env, napi_value node_str) {
 
+    uint8_t temp_storage[AWS_NAPI_SMALL_STRING_SIZE];
     struct aws_byte_buf temp_buf;
-    if (aws_byte_buf_init_from_napi(&temp_buf, env, node_str)) {
+    if (aws_byte_buf_init_from_napi_with_storage(&temp_buf, env, node_str, temp_storage, sizeof(temp_storage))) {
         return NULL;
     }
 
@@ -212,14 +310,102 @@ struct aws_event_loop *aws_napi_get_node_event_loop(void) {
     return s_node_uv_event_loop;
 }
 
+int aws_napi_set_default_event_loop_group_options(uint16_t num_threads, const uint16_t *cpu_group) {
+    int result = AWS_OP_SUCCESS;
+    aws_mutex_lock(&s_default_io_lock);
+    if (s_node_uv_elg != NULL) {
+        /* too late, something has already started using the default event loop group */
+        result = aws_raise_error(AWS_ERROR_INVALID_STATE);
+        goto done;
+    }
+
+    s_default_elg_options.num_threads = num_threads;
+    s_default_elg_options.pin_to_cpu_group = cpu_group != NULL;
+    s_default_elg_options.cpu_group = cpu_group ? *cpu_group : 0;
+
+done:
+    aws_mutex_unlock(&s_default_io_lock);
+    return result;
+}
+
+/* must be called with s_default_io_lock held */
+static void s_init_default_elg(void) {
+    if (s_node_uv_elg != NULL) {
+        return;
+    }
+
+    struct aws_allocator *allocator = aws_napi_get_allocator();
+    if (s_default_elg_options.pin_to_cpu_group) {
+        s_node_uv_elg = aws_event_loop_group_new_default_pinned_to_cpu_group(
+            allocator, s_default_elg_options.num_threads, s_default_elg_options.cpu_group, NULL);
+    } else {
+        s_node_uv_elg = aws_event_loop_group_new_default(allocator, s_default_elg_options.num_threads, NULL);
+    }
+    AWS_FATAL_ASSERT(s_node_uv_elg != NULL);
+}
+
 struct aws_event_loop_group *aws_napi_get_node_elg(void) {
+    aws_mutex_lock(&s_default_io_lock);
+    s_init_default_elg();
+    aws_mutex_unlock(&s_default_io_lock);
     return s_node_uv_elg;
 }
 
+int aws_napi_set_default_host_resolver_options(size_t max_entries, size_t max_ttl_secs) {
+    int result = AWS_OP_SUCCESS;
+    aws_mutex_lock(&s_default_io_lock);
+    if (s_default_host_resolver != NULL) {
+        result = aws_raise_error(AWS_ERROR_INVALID_STATE);
+        goto done;
+    }
+
+    s_default_host_resolver_options.max_entries = max_entries;
+    s_default_host_resolver_options.max_ttl_secs = max_ttl_secs;
+
+done:
+    aws_mutex_unlock(&s_default_io_lock);
+    return result;
+}
+
 struct aws_client_bootstrap *aws_napi_get_default_client_bootstrap(void) {
+    aws_mutex_lock(&s_default_io_lock);
+    if (s_default_client_bootstrap != NULL) {
+        goto done;
+    }
+
+    s_init_default_elg();
+
+    /*
+     * Default host resolver and client bootstrap to use if none specific at the javascript level.  In most
+     * cases the user doesn't even need to know about these, so let's let them leave it out completely.
+     */
+    struct aws_allocator *allocator = aws_napi_get_allocator();
+    struct aws_napi_host_resolver_options resolver_options = {
+        .el_group = s_node_uv_elg,
+        .max_entries = s_default_host_resolver_options.max_entries,
+        .max_ttl_secs = s_default_host_resolver_options.max_ttl_secs,
+    };
+    s_default_host_resolver = aws_napi_host_resolver_new(allocator, &resolver_options);
+    AWS_FATAL_ASSERT(s_default_host_resolver != NULL);
+
+    struct aws_client_bootstrap_options bootstrap_options = {
+        .event_loop_group = s_node_uv_elg,
+        .host_resolver = s_default_host_resolver,
+        .host_resolution_config = aws_napi_host_resolver_get_config(s_default_host_resolver),
+    };
+    s_default_client_bootstrap = aws_client_bootstrap_new(allocator, &bootstrap_options);
+    AWS_FATAL_ASSERT(s_default_client_bootstrap != NULL);
+
+done:
+    aws_mutex_unlock(&s_default_io_lock);
     return s_default_client_bootstrap;
 }
 
+struct aws_host_resolver *aws_napi_get_default_host_resolver(void) {
+    aws_napi_get_default_client_bootstrap();
+    return s_default_host_resolver;
+}
+
 /* The napi_status enum has grown, and is not bound by N-API versioning */
 #if defined(__clang__) || defined(__GNUC__)
 #    pragma GCC diagnostic push
@@ -395,19 +581,169 @@ napi_status aws_napi_dispatch_threadsafe_function(
     return (call_status != napi_ok) ? call_status : release_status;
 }
 
-napi_status aws_napi_create_threadsafe_function(
+/*
+ * Every threadsafe function is created with one of these as its context, wrapping the caller's context. When callback
+ * metrics are on, it records when each pending call was queued: node runs calls in the order they were queued, so the
+ * oldest timestamp belongs to the call being run. Calls queued from different threads at nearly the same moment may
+ * swap timestamps, which only skews their latencies by the width of that race.
+ */
+struct threadsafe_function_context {
+    struct aws_allocator *allocator;
+    napi_threadsafe_function_call_js call_js;
+    void *context;
+    napi_finalize finalize;
+    void *finalize_data;
+    struct aws_napi_callback_metrics *metrics; /* NULL when callback metrics are off, nothing below is used then */
+
+    struct {
+        struct aws_mutex lock;
+        /* ring of the times pending calls were queued, oldest at head */
+        uint64_t *queued_at;
+        size_t capacity;
+        size_t head;
+        size_t count;
+    } synced_data;
+};
+
+static void s_threadsafe_function_push_queued_at(struct threadsafe_function_context *tsfn_ctx) {
+    uint64_t now = 0;
+    aws_high_res_clock_get_ticks(&now);
+
+    aws_mutex_lock(&tsfn_ctx->synced_data.lock);
+    if (tsfn_ctx->synced_data.count == tsfn_ctx->synced_data.capacity) {
+        size_t capacity = tsfn_ctx->synced_data.capacity ? tsfn_ctx->synced_data.capacity * 2 : 8;
+        uint64_t *queued_at = aws_mem_acquire(tsfn_ctx->allocator, capacity * sizeof(uint64_t));
+        AWS_FATAL_ASSERT(queued_at);
+        for (size_t i = 0; i < tsfn_ctx->synced_data.count; ++i) {
+            queued_at[i] =
+                tsfn_ctx->synced_data.queued_at[(tsfn_ctx->synced_data.head + i) % tsfn_ctx->synced_data.capacity];
+        }
+        aws_mem_release(tsfn_ctx->allocator, tsfn_ctx->synced_data.queued_at);
+        tsfn_ctx->synced_data.queued_at = queued_at;
+        tsfn_ctx->synced_data.capacity = capacity;
+        tsfn_ctx->synced_data.head = 0;
+    }
+    size_t tail = (tsfn_ctx->synced_data.head + tsfn_ctx->synced_data.count) % tsfn_ctx->synced_data.capacity;
+    tsfn_ctx->synced_data.queued_at[tail] = now;
+    ++tsfn_ctx->synced_data.count;
+    aws_mutex_unlock(&tsfn_ctx->synced_data.lock);
+
+    aws_napi_callback_metrics_record_queued(tsfn_ctx->metrics);
+}
+
+/* Forgets the most recently queued call, because queueing it failed */
+static void s_threadsafe_function_drop_queued_at(struct threadsafe_function_context *tsfn_ctx) {
+    aws_mutex_lock(&tsfn_ctx->synced_data.lock);
+    if (tsfn_ctx->synced_data.count) {
+        --tsfn_ctx->synced_data.count;
+    }
+    aws_mutex_unlock(&tsfn_ctx->synced_data.lock);
+
+    aws_napi_callback_metrics_record_dropped(tsfn_ctx->metrics);
+}
+
+static void s_threadsafe_function_call(napi_env env, napi_value function, void *context, void *user_data) {
+    struct threadsafe_function_context *tsfn_ctx = context;
+
+    if (!tsfn_ctx->metrics) {
+        tsfn_ctx->call_js(env, function, tsfn_ctx->context, user_data);
+        return;
+    }
+
+    bool was_queued = false;
+    uint64_t queued_at = 0;
+    aws_mutex_lock(&tsfn_ctx->synced_data.lock);
+    if (tsfn_ctx->synced_data.count) {
+        was_queued = true;
+        queued_at = tsfn_ctx->synced_data.queued_at[tsfn_ctx->synced_data.head];
+        tsfn_ctx->synced_data.head = (tsfn_ctx->synced_data.head + 1) % tsfn_ctx->synced_data.capacity;
+        --tsfn_ctx->synced_data.count;
+    }
+    aws_mutex_unlock(&tsfn_ctx->synced_data.lock);
+
+    if (was_queued) {
+        uint64_t now = 0;
+        aws_high_res_clock_get_ticks(&now);
+        aws_napi_callback_metrics_record_dispatched(tsfn_ctx->metrics, now > queued_at ? now - queued_at : 0);
+    }
+
+    tsfn_ctx->call_js(env, function, tsfn_ctx->context, user_data);
+}
+
+static void s_threadsafe_function_finalize(napi_env env, void *finalize_data, void *finalize_hint) {
+    (void)finalize_hint;
+    struct threadsafe_function_context *tsfn_ctx = finalize_data;
+
+    if (tsfn_ctx->finalize) {
+        tsfn_ctx->finalize(env, tsfn_ctx->finalize_data, NULL);
+    }
+
+    /* calls that never ran will not be dispatched now, stop counting them as queued */
+    for (size_t i = 0; i < tsfn_ctx->synced_data.count; ++i) {
+        aws_napi_callback_metrics_record_dropped(tsfn_ctx->metrics);
+    }
+
+    aws_mem_release(tsfn_ctx->allocator, tsfn_ctx->synced_data.queued_at);
+    aws_mutex_clean_up(&tsfn_ctx->synced_data.lock);
+    aws_mem_release(tsfn_ctx->allocator, tsfn_ctx);
+}
+
+static napi_status s_create_threadsafe_function(
     napi_env env,
     napi_value function,
     const char *name,
     napi_threadsafe_function_call_js call_js,
     void *context,
+    napi_finalize finalize,
+    void *finalize_data,
     napi_threadsafe_function *result) {
 
+    AWS_FATAL_ASSERT(call_js);
+
+    struct aws_allocator *allocator = aws_napi_get_allocator();
+    struct threadsafe_function_context *tsfn_ctx =
+        aws_mem_calloc(allocator, 1, sizeof(struct threadsafe_function_context));
+    AWS_FATAL_ASSERT(tsfn_ctx);
+
+    tsfn_ctx->allocator = allocator;
+    tsfn_ctx->call_js = call_js;
+    tsfn_ctx->context = context;
+    tsfn_ctx->finalize = finalize;
+    tsfn_ctx->finalize_data = finalize_data;
+    tsfn_ctx->metrics = aws_napi_callback_metrics_for_name(name);
+    aws_mutex_init(&tsfn_ctx->synced_data.lock);
+
     napi_value resource_name = NULL;
     AWS_NAPI_ENSURE(env, napi_create_string_utf8(env, name, NAPI_AUTO_LENGTH, &resource_name));
 
-    return napi_create_threadsafe_function(
-        env, function, NULL, resource_name, 0, 1, NULL, NULL, context, call_js, result);
+    napi_status status = napi_create_threadsafe_function(
+        env,
+        function,
+        NULL,
+        resource_name,
+        0,
+        1,
+        tsfn_ctx,
+        s_threadsafe_function_finalize,
+        tsfn_ctx,
+        s_threadsafe_function_call,
+        result);
+    if (status != napi_ok) {
+        aws_mutex_clean_up(&tsfn_ctx->synced_data.lock);
+        aws_mem_release(allocator, tsfn_ctx);
+    }
+    return status;
+}
+
+napi_status aws_napi_create_threadsafe_function(
+    napi_env env,
+    napi_value function,
+    const char *name,
+    napi_threadsafe_function_call_js call_js,
+    void *context,
+    napi_threadsafe_function *result) {
+
+    return s_create_threadsafe_function(env, function, name, call_js, context, NULL, NULL, result);
 }
 
 napi_status aws_napi_release_threadsafe_function(
@@ -436,11 +772,214 @@ napi_status aws_napi_unref_threadsafe_function(napi_env env, napi_threadsafe_fun
 napi_status aws_napi_queue_threadsafe_function(napi_threadsafe_function function, void *user_data) {
     /* increase the ref count, gets decreased when the call completes */
     AWS_NAPI_ENSURE(NULL, napi_acquire_threadsafe_function(function));
-    return napi_call_threadsafe_function(function, user_data, napi_tsfn_nonblocking);
+
+    struct threadsafe_function_context *tsfn_ctx = NULL;
+    AWS_NAPI_ENSURE(NULL, napi_get_threadsafe_function_context(function, (void **)&tsfn_ctx));
+    if (!tsfn_ctx->metrics) {
+        return napi_call_threadsafe_function(function, user_data, napi_tsfn_nonblocking);
+    }
+
+    /* must be recorded first, node may run the call before napi_call_threadsafe_function returns */
+    s_threadsafe_function_push_queued_at(tsfn_ctx);
+
+    napi_status status = napi_call_threadsafe_function(function, user_data, napi_tsfn_nonblocking);
+    if (status != napi_ok) {
+        s_threadsafe_function_drop_queued_at(tsfn_ctx);
+    }
+    return status;
+}
+
+struct aws_napi_batched_threadsafe_function {
+    struct aws_allocator *allocator;
+    napi_threadsafe_function tsfn;
+    aws_napi_batch_append_fn *append;
+    aws_napi_batch_discard_fn *discard;
+    void *context;
+
+    struct {
+        struct aws_mutex lock;
+        struct aws_linked_list items;
+        bool flush_scheduled;
+    } synced_data;
+};
+
+/* context is NULL once the owner of the batch may already be gone */
+static void s_batch_discard_items(
+    struct aws_napi_batched_threadsafe_function *batch,
+    struct aws_linked_list *items,
+    void *context) {
+    while (!aws_linked_list_empty(items)) {
+        batch->discard(aws_linked_list_pop_front(items), context);
+    }
+}
+
+static void s_batched_threadsafe_function_call(napi_env env, napi_value function, void *context, void *user_data) {
+    (void)user_data;
+    struct aws_napi_batched_threadsafe_function *batch = context;
+
+    /* take everything queued so far, anything queued from here on schedules a new call */
+    struct aws_linked_list items;
+    aws_linked_list_init(&items);
+    aws_mutex_lock(&batch->synced_data.lock);
+    aws_linked_list_swap_contents(&items, &batch->synced_data.items);
+    batch->synced_data.flush_scheduled = false;
+    aws_mutex_unlock(&batch->synced_data.lock);
+
+    if (!env) {
+        s_batch_discard_items(batch, &items, NULL);
+        return;
+    }
+
+    napi_value node_batch = NULL;
+    AWS_NAPI_CALL(env, napi_create_array(env, &node_batch), {
+        s_batch_discard_items(batch, &items, batch->context);
+        napi_release_threadsafe_function(batch->tsfn, napi_tsfn_release);
+        return;
+    });
+
+    uint32_t index = 0;
+    while (!aws_linked_list_empty(&items)) {
+        struct aws_linked_list_node *item = aws_linked_list_pop_front(&items);
+        /* append owns item even when it fails, so a failure only costs that item, the rest are still delivered */
+        AWS_NAPI_CALL(env, batch->append(env, node_batch, &index, item, batch->context), {});
+    }
+
+    AWS_NAPI_ENSURE(env, aws_napi_dispatch_threadsafe_function(env, batch->tsfn, NULL, function, 1, &node_batch));
+}
+
+static void s_batched_threadsafe_function_finalize(napi_env env, void *finalize_data, void *finalize_hint) {
+    (void)env;
+    (void)finalize_hint;
+    struct aws_napi_batched_threadsafe_function *batch = finalize_data;
+
+    /* no more calls can happen, whatever is left will never be delivered */
+    s_batch_discard_items(batch, &batch->synced_data.items, NULL);
+    aws_mutex_clean_up(&batch->synced_data.lock);
+    aws_mem_release(batch->allocator, batch);
+}
+
+napi_status aws_napi_create_batched_threadsafe_function(
+    napi_env env,
+    napi_value function,
+    const char *name,
+    aws_napi_batch_append_fn *append,
+    aws_napi_batch_discard_fn *discard,
+    void *context,
+    struct aws_napi_batched_threadsafe_function **result) {
+
+    struct aws_allocator *allocator = aws_napi_get_allocator();
+    struct aws_napi_batched_threadsafe_function *batch =
+        aws_mem_calloc(allocator, 1, sizeof(struct aws_napi_batched_threadsafe_function));
+    AWS_FATAL_ASSERT(batch);
+
+    batch->allocator = allocator;
+    batch->append = append;
+    batch->discard = discard;
+    batch->context = context;
+    aws_mutex_init(&batch->synced_data.lock);
+    aws_linked_list_init(&batch->synced_data.items);
+
+    napi_status status = s_create_threadsafe_function(
+        env,
+        function,
+        name,
+        s_batched_threadsafe_function_call,
+        batch,
+        s_batched_threadsafe_function_finalize,
+        batch,
+        &batch->tsfn);
+    if (status != napi_ok) {
+        aws_mutex_clean_up(&batch->synced_data.lock);
+        aws_mem_release(allocator, batch);
+        return status;
+    }
+
+    *result = batch;
+    return napi_ok;
+}
+
+napi_status aws_napi_queue_batched_threadsafe_function(
+    struct aws_napi_batched_threadsafe_function *batch,
+    struct aws_linked_list_node *item) {
+
+    aws_mutex_lock(&batch->synced_data.lock);
+    bool schedule_flush = !batch->synced_data.flush_scheduled;
+    batch->synced_data.flush_scheduled = true;
+    aws_linked_list_push_back(&batch->synced_data.items, item);
+    aws_mutex_unlock(&batch->synced_data.lock);
+
+    if (!schedule_flush) {
+        return napi_ok;
+    }
+
+    napi_status status = aws_napi_queue_threadsafe_function(batch->tsfn, NULL);
+    if (status != napi_ok) {
+        /*
+         * node will never flush this batch: hand the item back to the caller, and discard whatever other threads
+         * appended meanwhile, since they were told it was queued and no flush will come for it
+         */
+        struct aws_linked_list orphaned;
+        aws_linked_list_init(&orphaned);
+        aws_mutex_lock(&batch->synced_data.lock);
+        aws_linked_list_remove(item);
+        aws_linked_list_swap_contents(&orphaned, &batch->synced_data.items);
+        batch->synced_data.flush_scheduled = false;
+        aws_mutex_unlock(&batch->synced_data.lock);
+
+        s_batch_discard_items(batch, &orphaned, batch->context);
+    }
+    return status;
+}
+
+napi_status aws_napi_release_batched_threadsafe_function(
+    struct aws_napi_batched_threadsafe_function *batch,
+    napi_threadsafe_function_release_mode mode) {
+    if (batch) {
+        return aws_napi_release_threadsafe_function(batch->tsfn, mode);
+    }
+    return napi_ok;
 }
 
 AWS_STATIC_STRING_FROM_LITERAL(s_mem_tracing_env_var, "AWS_CRT_MEMORY_TRACING");
 static struct aws_allocator *s_allocator = NULL;
+
+/*
+ * When memory tracing is on, allocations go through this counter before reaching the tracer. The tracer only knows
+ * what's live, benchmarks also need to know how many allocations an operation made.
+ */
+static struct {
+    struct aws_allocator base;
+    struct aws_allocator *tracer;
+    struct aws_atomic_var num_allocations;
+} s_counting_allocator;
+
+static void *s_counting_mem_acquire(struct aws_allocator *allocator, size_t size) {
+    (void)allocator;
+    aws_atomic_fetch_add(&s_counting_allocator.num_allocations, 1);
+    return aws_mem_acquire(s_counting_allocator.tracer, size);
+}
+
+static void s_counting_mem_release(struct aws_allocator *allocator, void *ptr) {
+    (void)allocator;
+    aws_mem_release(s_counting_allocator.tracer, ptr);
+}
+
+static void *s_counting_mem_realloc(struct aws_allocator *allocator, void *old_ptr, size_t old_size, size_t new_size) {
+    (void)allocator;
+    aws_atomic_fetch_add(&s_counting_allocator.num_allocations, 1);
+    void *ptr = old_ptr;
+    if (aws_mem_realloc(s_counting_allocator.tracer, &ptr, old_size, new_size)) {
+        return NULL;
+    }
+    return ptr;
+}
+
+static void *s_counting_mem_calloc(struct aws_allocator *allocator, size_t num, size_t size) {
+    (void)allocator;
+    aws_atomic_fetch_add(&s_counting_allocator.num_allocations, 1);
+    return aws_mem_calloc(s_counting_allocator.tracer, num, size);
+}
+
 struct aws_allocator *aws_napi_get_allocator() {
     if (AWS_UNLIKELY(s_allocator == NULL)) {
         struct aws_string *value = NULL;
@@ -457,7 +996,13 @@ struct aws_allocator *aws_napi_get_allocator() {
                 aws_string_bytes(value));
             level = AWS_MEMTRACE_NONE;
         }
-        s_allocator = aws_mem_tracer_new(aws_default_allocator(), NULL, level, 16);
+        s_counting_allocator.tracer = aws_mem_tracer_new(aws_default_allocator(), NULL, level, 16);
+        s_counting_allocator.base.mem_acquire = s_counting_mem_acquire;
+        s_counting_allocator.base.mem_release = s_counting_mem_release;
+        s_counting_allocator.base.mem_realloc = s_counting_mem_realloc;
+        s_counting_allocator.base.mem_calloc = s_counting_mem_calloc;
+        aws_atomic_init_int(&s_counting_allocator.num_allocations, 0);
+        s_allocator = &s_counting_allocator.base;
     }
     return s_allocator;
 }
@@ -467,17 +1012,28 @@ napi_value aws_napi_native_memory(napi_env env, napi_callback_info info) {
     napi_value node_allocated = NULL;
     size_t allocated = 0;
     if (aws_napi_get_allocator() != aws_default_allocator()) {
-        allocated = aws_mem_tracer_bytes(aws_napi_get_allocator());
+        allocated = aws_mem_tracer_bytes(s_counting_allocator.tracer);
     }
     AWS_NAPI_CALL(env, napi_create_int64(env, allocated, &node_allocated), { return NULL; });
     return node_allocated;
 }
 
+napi_value aws_napi_native_allocation_count(napi_env env, napi_callback_info info) {
+    (void)info;
+    napi_value node_count = NULL;
+    size_t count = 0;
+    if (aws_napi_get_allocator() != aws_default_allocator()) {
+        count = aws_atomic_load_int(&s_counting_allocator.num_allocations);
+    }
+    AWS_NAPI_CALL(env, napi_create_int64(env, (int64_t)count, &node_count), { return NULL; });
+    return node_count;
+}
+
 napi_value aws_napi_native_memory_dump(napi_env env, napi_callback_info info) {
     (void)info;
     (void)env;
     if (aws_napi_get_allocator() != aws_default_allocator()) {
-        aws_mem_tracer_dump(aws_napi_get_allocator());
+        aws_mem_tracer_dump(s_counting_allocator.tracer);
     }
     return NULL;
 }
@@ -520,9 +1076,19 @@ static void s_install_crash_handler(void) {
 static void s_napi_context_finalize(napi_env env, void *user_data, void *finalize_hint) {
     (void)env;
     (void)finalize_hint;
-    aws_client_bootstrap_release(s_default_client_bootstrap);
-    aws_host_resolver_release(s_default_host_resolver);
-    aws_event_loop_group_release(s_node_uv_elg);
+    /* any of these may never have been created */
+    if (s_default_client_bootstrap) {
+        aws_client_bootstrap_release(s_default_client_bootstrap);
+        s_default_client_bootstrap = NULL;
+    }
+    if (s_default_host_resolver) {
+        aws_host_resolver_release(s_default_host_resolver);
+        s_default_host_resolver = NULL;
+    }
+    if (s_node_uv_elg) {
+        aws_event_loop_group_release(s_node_uv_elg);
+        s_node_uv_elg = NULL;
+    }
 
     aws_thread_join_all_managed();
 
@@ -536,7 +1102,8 @@ static void s_napi_context_finalize(napi_env env, void *user_data, void *finaliz
     aws_mem_release(ctx->allocator, ctx);
 
     if (ctx->allocator != aws_default_allocator()) {
-        aws_mem_tracer_destroy(ctx->allocator);
+        aws_mem_tracer_destroy(s_counting_allocator.tracer);
+        s_counting_allocator.tracer = NULL;
         if (s_allocator == ctx->allocator) {
             s_allocator = NULL;
         }
@@ -592,8 +1159,8 @@ static bool s_create_and_register_function(
     aws_register_error_info(&s_error_list);
     aws_register_log_subject_info_list(&s_log_subject_list);
 
-    /* Initialize the event loop group */
     /*
+     * The event loop group is initialized lazily, see aws_napi_get_node_elg().
      * We don't currently support multi-init of the module, but we should.
      * Things that would need to be solved:
      *    (1) global objects (event loop group, logger, allocator, more)
@@ -601,32 +1168,6 @@ static bool s_create_and_register_function(
      *    (3) allocator cross-talk/lifetimes
      */
     AWS_FATAL_ASSERT(s_node_uv_elg == NULL);
-    s_node_uv_elg = aws_event_loop_group_new_default(allocator, 1, NULL);
-    AWS_FATAL_ASSERT(s_node_uv_elg != NULL);
-
-    /*
-     * Default host resolver and client bootstrap to use if none specific at the javascript level.  In most
-     * cases the user doesn't even need to know about these, so let's let them leave it out completely.
-     */
-    AWS_FATAL_ASSERT(s_default_host_resolver == NULL);
-
-    struct aws_host_resolver_default_options resolver_options = {
-        .max_entries = 64,
-        .el_group = s_node_uv_elg,
-    };
-    s_default_host_resolver = aws_host_resolver_new_default(allocator, &resolver_options);
-    AWS_FATAL_ASSERT(s_default_host_resolver != NULL);
-
-    AWS_FATAL_ASSERT(s_default_client_bootstrap == NULL);
-
-    struct aws_client_bootstrap_options bootstrap_options = {
-        .event_loop_group = s_node_uv_elg,
-        .host_resolver = s_default_host_resolver,
-    };
-
-    s_default_client_bootstrap = aws_client_bootstrap_new(allocator, &bootstrap_options);
-
-    AWS_FATAL_ASSERT(s_default_client_bootstrap != NULL);
 
     napi_value null;
     napi_get_null(env, &null);
@@ -639,18 +1180,31 @@ static bool s_create_and_register_function(
     /* Common */
     CREATE_AND_REGISTER_FN(native_memory)
     CREATE_AND_REGISTER_FN(native_memory_dump)
+    CREATE_AND_REGISTER_FN(native_allocation_count)
+    CREATE_AND_REGISTER_FN(native_metrics)
     CREATE_AND_REGISTER_FN(error_code_to_string)
     CREATE_AND_REGISTER_FN(error_code_to_name)
 
     /* IO */
     CREATE_AND_REGISTER_FN(io_logging_enable)
     CREATE_AND_REGISTER_FN(is_alpn_available)
+    CREATE_AND_REGISTER_FN(io_set_default_event_loop_group_options)
+    CREATE_AND_REGISTER_FN(io_event_loop_group_new)
     CREATE_AND_REGISTER_FN(io_client_bootstrap_new)
+    CREATE_AND_REGISTER_FN(io_set_default_host_resolver_options)
+    CREATE_AND_REGISTER_FN(io_host_resolver_pre_resolve)
+    CREATE_AND_REGISTER_FN(io_host_resolver_get_stats)
     CREATE_AND_REGISTER_FN(io_tls_ctx_new)
+    CREATE_AND_REGISTER_FN(io_tls_ctx_cache_get_stats)
     CREATE_AND_REGISTER_FN(io_tls_connection_options_new);
     CREATE_AND_REGISTER_FN(io_socket_options_new)
     CREATE_AND_REGISTER_FN(io_input_stream_new)
     CREATE_AND_REGISTER_FN(io_input_stream_append)
+    CREATE_AND_REGISTER_FN(io_file_input_stream_new)
+    CREATE_AND_REGISTER_FN(io_input_stream_get_length)
+    CREATE_AND_REGISTER_FN(io_input_stream_get_checksum)
+    CREATE_AND_REGISTER_FN(io_input_stream_read)
+    CREATE_AND_REGISTER_FN(io_input_stream_seek)
 
     /* MQTT Client */
     CREATE_AND_REGISTER_FN(mqtt_client_new)
@@ -660,8 +1214,15 @@ static bool s_create_and_register_function(
     CREATE_AND_REGISTER_FN(mqtt_client_connection_connect)
     CREATE_AND_REGISTER_FN(mqtt_client_connection_reconnect)
     CREATE_AND_REGISTER_FN(mqtt_client_connection_publish)
+    CREATE_AND_REGISTER_FN(mqtt_client_connection_publish_batch)
     CREATE_AND_REGISTER_FN(mqtt_client_connection_subscribe)
     CREATE_AND_REGISTER_FN(mqtt_client_connection_on_message)
+    CREATE_AND_REGISTER_FN(mqtt_client_connection_add_topic_handler)
+    CREATE_AND_REGISTER_FN(mqtt_client_connection_remove_topic_handler)
+    CREATE_AND_REGISTER_FN(mqtt_client_connection_forward_all_messages)
+    CREATE_AND_REGISTER_FN(mqtt_client_connection_share_with_workers)
+    CREATE_AND_REGISTER_FN(mqtt_message_worker_attach)
+    CREATE_AND_REGISTER_FN(mqtt_message_worker_detach)
     CREATE_AND_REGISTER_FN(mqtt_client_connection_unsubscribe)
     CREATE_AND_REGISTER_FN(mqtt_client_connection_disconnect)
     CREATE_AND_REGISTER_FN(mqtt_client_connection_close)
@@ -671,30 +1232,53 @@ static bool s_create_and_register_function(
     CREATE_AND_REGISTER_FN(hash_sha1_new)
     CREATE_AND_REGISTER_FN(hash_sha256_new)
     CREATE_AND_REGISTER_FN(hash_update)
+    CREATE_AND_REGISTER_FN(hash_update_many)
     CREATE_AND_REGISTER_FN(hash_digest)
+    CREATE_AND_REGISTER_FN(hash_digest_into)
+    CREATE_AND_REGISTER_FN(hash_reset)
     CREATE_AND_REGISTER_FN(hash_md5_compute)
     CREATE_AND_REGISTER_FN(hash_sha1_compute)
     CREATE_AND_REGISTER_FN(hash_sha256_compute)
+    CREATE_AND_REGISTER_FN(hash_md5_compute_async)
+    CREATE_AND_REGISTER_FN(hash_sha1_compute_async)
+    CREATE_AND_REGISTER_FN(hash_sha256_compute_async)
     CREATE_AND_REGISTER_FN(hmac_sha256_new)
     CREATE_AND_REGISTER_FN(hmac_update)
+    CREATE_AND_REGISTER_FN(hmac_update_many)
     CREATE_AND_REGISTER_FN(hmac_digest)
+    CREATE_AND_REGISTER_FN(hmac_digest_into)
+    CREATE_AND_REGISTER_FN(hmac_reset)
     CREATE_AND_REGISTER_FN(hmac_sha256_compute)
+    CREATE_AND_REGISTER_FN(hmac_sha256_compute_async)
 
     /* Checksums */
     CREATE_AND_REGISTER_FN(checksums_crc32)
     CREATE_AND_REGISTER_FN(checksums_crc32c)
+    CREATE_AND_REGISTER_FN(checksums_crc32_async)
+    CREATE_AND_REGISTER_FN(checksums_crc32c_async)
+    CREATE_AND_REGISTER_FN(checksums_crc32_combine)
+    CREATE_AND_REGISTER_FN(checksums_crc32c_combine)
+    CREATE_AND_REGISTER_FN(checksums_crc32_parts_async)
+    CREATE_AND_REGISTER_FN(checksums_crc32c_parts_async)
 
     /* HTTP */
     CREATE_AND_REGISTER_FN(http_proxy_options_new)
     CREATE_AND_REGISTER_FN(http_connection_new)
     CREATE_AND_REGISTER_FN(http_connection_close)
     CREATE_AND_REGISTER_FN(http_stream_new)
+    CREATE_AND_REGISTER_FN(http_stream_new_from_manager)
     CREATE_AND_REGISTER_FN(http_stream_activate)
     CREATE_AND_REGISTER_FN(http_stream_close)
+    CREATE_AND_REGISTER_FN(http_stream_update_window)
     CREATE_AND_REGISTER_FN(http_connection_manager_new)
     CREATE_AND_REGISTER_FN(http_connection_manager_close)
     CREATE_AND_REGISTER_FN(http_connection_manager_acquire)
+    CREATE_AND_REGISTER_FN(http_connection_manager_abandon_acquire)
     CREATE_AND_REGISTER_FN(http_connection_manager_release)
+    CREATE_AND_REGISTER_FN(http_connection_manager_warm)
+    CREATE_AND_REGISTER_FN(http_connection_manager_get_stats)
+    CREATE_AND_REGISTER_FN(http2_stream_manager_new)
+    CREATE_AND_REGISTER_FN(http2_stream_manager_close)
 
 #undef CREATE_AND_REGISTER_FN
 
@@ -18,6 +18,7 @@
 struct aws_client_bootstrap;
 struct aws_event_loop;
 struct aws_event_loop_group;
+struct aws_host_resolver;
 
 enum aws_crt_nodejs_errors {
     AWS_CRT_NODEJS_ERROR_THREADSAFE_FUNCTION_NULL_NAPI_ENV = AWS_ERROR_ENUM_BEGIN_RANGE(AWS_CRT_NODEJS_PACKAGE_ID),
@@ -31,7 +32,21 @@ enum aws_napi_log_subject {
     AWS_LS_NODEJS_CRT_LAST = AWS_LOG_SUBJECT_END_RANGE(AWS_CRT_NODEJS_PACKAGE_ID),
 };
 
+/* Size of the stack storage hot paths use for short strings (keys, regions, topics), including the null terminator */
+#define AWS_NAPI_SMALL_STRING_SIZE 128
+
 napi_status aws_byte_buf_init_from_napi(struct aws_byte_buf *buf, napi_env env, napi_value node_str);
+/**
+ * Same as aws_byte_buf_init_from_napi(), but strings that fit in storage are written there instead of being heap
+ * allocated. buf->allocator is only set if an allocation was needed, so aws_byte_buf_clean_up() is always safe to call.
+ * storage must outlive buf.
+ */
+napi_status aws_byte_buf_init_from_napi_with_storage(
+    struct aws_byte_buf *buf,
+    napi_env env,
+    napi_value node_str,
+    uint8_t *storage,
+    size_t storage_size);
 struct aws_string *aws_string_new_from_napi(napi_env env, napi_value node_str);
 /** Copies data from cur into a new ArrayBuffer, then returns a DataView to the buffer. */
 napi_status aws_napi_create_dataview_from_byte_cursor(
@@ -45,8 +60,22 @@ void aws_napi_throw_last_error(napi_env env);
 
 struct uv_loop_s *aws_napi_get_node_uv_loop(void);
 struct aws_event_loop *aws_napi_get_node_event_loop(void);
+/* The default event loop group, host resolver and client bootstrap are created on first use */
 struct aws_event_loop_group *aws_napi_get_node_elg(void);
 struct aws_client_bootstrap *aws_napi_get_default_client_bootstrap(void);
+struct aws_host_resolver *aws_napi_get_default_host_resolver(void);
+
+/**
+ * Configures the default event loop group. num_threads of 0 means one per processor, cpu_group may be NULL.
+ * Fails with AWS_ERROR_INVALID_STATE once the default event loop group has been created.
+ */
+int aws_napi_set_default_event_loop_group_options(uint16_t num_threads, const uint16_t *cpu_group);
+
+/**
+ * Configures the default host resolver, see aws_napi_host_resolver_new(). Fails with AWS_ERROR_INVALID_STATE once the
+ * default host resolver has been created.
+ */
+int aws_napi_set_default_host_resolver_options(size_t max_entries, size_t max_ttl_secs);
 
 const char *aws_napi_status_to_str(napi_status status);
 
@@ -115,6 +144,59 @@ napi_status aws_napi_unref_threadsafe_function(napi_env env, napi_threadsafe_fun
  */
 napi_status aws_napi_queue_threadsafe_function(napi_threadsafe_function function, void *user_data);
 
+/*
+ * Batched threadsafe functions coalesce every item queued before node gets around to running the function, and
+ * deliver them in a single call with one argument: an array built by the append callback.
+ */
+struct aws_linked_list_node;
+struct aws_napi_batched_threadsafe_function;
+
+/**
+ * Appends the JS representation of item to the batch array, starting at *index, and advances *index past whatever
+ * was written. Takes ownership of item.
+ */
+typedef napi_status(aws_napi_batch_append_fn)(
+    napi_env env,
+    napi_value batch,
+    uint32_t *index,
+    struct aws_linked_list_node *item,
+    void *context);
+
+/**
+ * Destroys an item that will never be delivered. context is the batch's context while its owner is known to be alive,
+ * e.g. when a flush could not be scheduled, and NULL when the function is shutting down, since by then the owner of
+ * context may have been destroyed.
+ */
+typedef void(aws_napi_batch_discard_fn)(struct aws_linked_list_node *item, void *context);
+
+/**
+ * Creates a batched threadsafe function. Release it with aws_napi_release_batched_threadsafe_function, the batch
+ * is destroyed along with the underlying threadsafe function.
+ */
+napi_status aws_napi_create_batched_threadsafe_function(
+    napi_env env,
+    napi_value function,
+    const char *name,
+    aws_napi_batch_append_fn *append,
+    aws_napi_batch_discard_fn *discard,
+    void *context,
+    struct aws_napi_batched_threadsafe_function **result);
+
+/**
+ * Adds item to the pending batch, from any thread. Only the first item of each batch wakes up node.
+ * On failure the caller keeps ownership of item.
+ */
+napi_status aws_napi_queue_batched_threadsafe_function(
+    struct aws_napi_batched_threadsafe_function *batch,
+    struct aws_linked_list_node *item);
+
+/**
+ * aws_napi_release_threadsafe_function for batched threadsafe functions, batch may be NULL.
+ */
+napi_status aws_napi_release_batched_threadsafe_function(
+    struct aws_napi_batched_threadsafe_function *batch,
+    napi_threadsafe_function_release_mode mode);
+
 /*
  * One of these will be allocated each time the module init function is called
  * Any global state that isn't thread safe or requires clean up should be stored
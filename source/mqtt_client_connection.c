@@ -8,6 +8,8 @@
 
 #include "http_connection.h"
 #include "http_message.h"
+#include "metrics.h"
+#include "mqtt_topic_filter.h"
 
 #include <aws/mqtt/client.h>
 
@@ -16,6 +18,9 @@
 #include <aws/io/socket.h>
 #include <aws/io/tls_channel_handler.h>
 
+#include <aws/common/array_list.h>
+#include <aws/common/atomics.h>
+#include <aws/common/hash_table.h>
 #include <aws/common/linked_list.h>
 #include <aws/common/mutex.h>
 
@@ -37,12 +42,33 @@ struct mqtt_connection_binding {
     napi_ref node_external;
     napi_threadsafe_function on_connection_interrupted;
     napi_threadsafe_function on_connection_resumed;
-    napi_threadsafe_function on_any_publish;
+    struct aws_napi_batched_threadsafe_function *on_any_publish;
     napi_threadsafe_function transform_websocket;
+
+    /* Which messages on_any_publish delivers, read on the CRT thread and changed from node */
+    struct {
+        struct aws_mutex lock;
+        /* Handlers registered by aws_napi_mqtt_client_connection_add_topic_handler(), created with the first one */
+        struct aws_napi_topic_filter_trie *filters;
+        /* Deliver messages that match no filter too, tagged with no handlers */
+        bool forward_all;
+        /* Set by aws_napi_mqtt_client_connection_share_with_workers(), takes over on_any_publish's messages */
+        struct mqtt_message_worker_group *workers;
+    } message_routing;
 };
 
+static void s_message_worker_group_shutdown(struct mqtt_message_worker_group *group);
+
 static void s_mqtt_client_connection_release_threadsafe_function(struct mqtt_connection_binding *binding) {
 
+    aws_mutex_lock(&binding->message_routing.lock);
+    struct mqtt_message_worker_group *workers = binding->message_routing.workers;
+    binding->message_routing.workers = NULL;
+    aws_mutex_unlock(&binding->message_routing.lock);
+    if (workers != NULL) {
+        s_message_worker_group_shutdown(workers);
+    }
+
     if (binding->on_connection_interrupted != NULL) {
         AWS_NAPI_ENSURE(
             binding->env, aws_napi_release_threadsafe_function(binding->on_connection_interrupted, napi_tsfn_abort));
@@ -56,7 +82,8 @@ static void s_mqtt_client_connection_release_threadsafe_function(struct mqtt_con
     }
 
     if (binding->on_any_publish != NULL) {
-        AWS_NAPI_ENSURE(binding->env, aws_napi_release_threadsafe_function(binding->on_any_publish, napi_tsfn_abort));
+        AWS_NAPI_ENSURE(
+            binding->env, aws_napi_release_batched_threadsafe_function(binding->on_any_publish, napi_tsfn_abort));
         binding->on_any_publish = NULL;
     }
 
@@ -84,6 +111,9 @@ static void s_mqtt_client_connection_finalize(napi_env env, void *finalize_data,
         aws_mqtt_client_connection_release(binding->connection);
     }
 
+    aws_napi_topic_filter_trie_destroy(binding->message_routing.filters);
+    aws_mutex_clean_up(&binding->message_routing.lock);
+
     aws_mem_release(binding->allocator, binding);
 }
 
@@ -222,7 +252,7 @@ static void s_on_connection_resumed(
 
 napi_value aws_napi_mqtt_client_connection_new(napi_env env, napi_callback_info cb_info) {
 
-    struct aws_allocator *allocator = aws_napi_get_allocator();
+    struct aws_allocator *allocator = aws_napi_get_metrics_allocator(AWS_NAPI_METRICS_MQTT);
 
     napi_value node_args[10];
     size_t num_args = AWS_ARRAY_SIZE(node_args);
@@ -240,10 +270,13 @@ napi_value aws_napi_mqtt_client_connection_new(napi_env env, napi_callback_info
     AWS_FATAL_ASSERT(binding);
     binding->env = env;
     binding->allocator = allocator;
+    aws_mutex_init(&binding->message_routing.lock);
+    binding->message_routing.forward_all = true;
 
     napi_value node_external;
     AWS_NAPI_CALL(env, napi_create_external(env, binding, s_mqtt_client_connection_finalize, NULL, &node_external), {
         napi_throw_error(env, NULL, "Failed create n-api external");
+        aws_mutex_clean_up(&binding->message_routing.lock);
         aws_mem_release(allocator, binding);
         return NULL;
     });
@@ -857,6 +890,9 @@ struct puback_args {
     uint16_t packet_id;
     int error_code;
     napi_threadsafe_function on_puback;
+    /* The client encodes from the payload until the publish completes, so it is kept alive until then */
+    struct aws_byte_buf payload; /* converted copy of a String payload, or a view of a Buffer's memory */
+    napi_ref node_payload;       /* pins a Buffer payload */
 };
 
 static void s_destroy_puback_args(struct puback_args *args) {
@@ -871,6 +907,12 @@ static void s_destroy_puback_args(struct puback_args *args) {
         AWS_NAPI_ENSURE(args->binding->env, aws_napi_release_threadsafe_function(args->on_puback, napi_tsfn_abort));
     }
 
+    if (args->node_payload != NULL) {
+        AWS_FATAL_ASSERT(args->binding != NULL);
+        AWS_NAPI_ENSURE(args->binding->env, napi_delete_reference(args->binding->env, args->node_payload));
+    }
+    aws_byte_buf_clean_up(&args->payload);
+
     aws_mem_release(args->allocator, args);
 }
 
@@ -910,16 +952,15 @@ static void s_on_publish_complete(
 
 napi_value aws_napi_mqtt_client_connection_publish(napi_env env, napi_callback_info info) {
 
-    struct aws_allocator *allocator = aws_napi_get_allocator();
+    struct aws_allocator *allocator = aws_napi_get_metrics_allocator(AWS_NAPI_METRICS_MQTT);
 
     struct puback_args *args = aws_mem_calloc(allocator, 1, sizeof(struct puback_args));
     AWS_FATAL_ASSERT(args);
     args->allocator = allocator;
 
+    uint8_t topic_storage[AWS_NAPI_SMALL_STRING_SIZE];
     struct aws_byte_buf topic_buf;
-    struct aws_byte_buf payload_buf;
     AWS_ZERO_STRUCT(topic_buf);
-    AWS_ZERO_STRUCT(payload_buf);
 
     napi_value node_args[6];
     size_t num_args = AWS_ARRAY_SIZE(node_args);
@@ -943,13 +984,15 @@ napi_value aws_napi_mqtt_client_connection_publish(napi_env env, napi_callback_i
     args->binding = binding;
 
     napi_value node_topic = *arg++;
-    AWS_NAPI_CALL(env, aws_byte_buf_init_from_napi(&topic_buf, env, node_topic), {
-        napi_throw_type_error(env, NULL, "topic must be a String");
-        goto cleanup;
-    });
+    AWS_NAPI_CALL(
+        env, aws_byte_buf_init_from_napi_with_storage(&topic_buf, env, node_topic, topic_storage, sizeof(topic_storage)), {
+            napi_throw_type_error(env, NULL, "topic must be a String");
+            goto cleanup;
+        });
 
+    /* Strings are converted to a native copy, Buffers and other views are published from their own memory */
     napi_value node_payload = *arg++;
-    AWS_NAPI_CALL(env, aws_byte_buf_init_from_napi(&payload_buf, env, node_payload), {
+    AWS_NAPI_CALL(env, aws_byte_buf_init_from_napi(&args->payload, env, node_payload), {
         napi_throw_type_error(env, NULL, "payload is invalid type");
         goto cleanup;
     });
@@ -983,8 +1026,20 @@ napi_value aws_napi_mqtt_client_connection_publish(napi_env env, napi_callback_i
             { goto cleanup; });
     }
 
+    /*
+     * aws-c-mqtt copies the topic, but not the payload: it keeps our cursor and encodes from it every time the PUBLISH
+     * is sent, including QoS 1 retries. So the payload lives in args until the publish completes (PUBACK for QoS 1,
+     * the write for QoS 0), and borrowed payloads are pinned for as long.
+     */
+    if (args->payload.allocator == NULL && args->payload.len > 0) {
+        AWS_NAPI_CALL(env, napi_create_reference(env, node_payload, 1, &args->node_payload), {
+            napi_throw_error(env, NULL, "Unable to reference payload");
+            goto cleanup;
+        });
+    }
+
     const struct aws_byte_cursor topic_cur = aws_byte_cursor_from_buf(&topic_buf);
-    const struct aws_byte_cursor payload_cur = aws_byte_cursor_from_buf(&payload_buf);
+    const struct aws_byte_cursor payload_cur = aws_byte_cursor_from_buf(&args->payload);
     uint16_t pub_id = aws_mqtt_client_connection_publish(
         binding->connection, &topic_cur, qos, retain, &payload_cur, s_on_publish_complete, args);
     if (!pub_id) {
@@ -992,13 +1047,12 @@ napi_value aws_napi_mqtt_client_connection_publish(napi_env env, napi_callback_i
         goto cleanup;
     }
 
-    aws_byte_buf_clean_up(&payload_buf);
+    /* the payload now belongs to the publish, and is freed with args once it completes */
     aws_byte_buf_clean_up(&topic_buf);
     return NULL;
 
 cleanup:
 
-    aws_byte_buf_clean_up(&payload_buf);
     aws_byte_buf_clean_up(&topic_buf);
 
     s_destroy_puback_args(args);
@@ -1006,6 +1060,231 @@ cleanup:
     return NULL;
 }
 
+/*
+ * Many publishes made by a single call from node. Completions are collected natively and reported back to node in
+ * one call, once every message has completed.
+ */
+struct publish_batch;
+
+struct publish_batch_item {
+    struct publish_batch *batch;
+    uint16_t packet_id;
+    int error_code;
+    /* the client encodes from the payload until this item completes, see aws_napi_mqtt_client_connection_publish() */
+    struct aws_byte_buf payload;
+};
+
+struct publish_batch {
+    struct aws_allocator *allocator;
+    struct mqtt_connection_binding *binding;
+    napi_threadsafe_function on_complete;
+    /* The flattened messages array, which keeps every borrowed payload alive until the batch completes */
+    napi_ref node_messages;
+
+    /* Publishes still in flight, whoever completes the last one calls back to node */
+    struct aws_atomic_var pending;
+
+    size_t num_items;
+    struct publish_batch_item *items;
+};
+
+/* env is NULL when node is shutting down, in which case the reference and function are already gone */
+static void s_destroy_publish_batch(napi_env env, struct publish_batch *batch) {
+    if (env) {
+        if (batch->node_messages != NULL) {
+            AWS_NAPI_ENSURE(env, napi_delete_reference(env, batch->node_messages));
+        }
+        AWS_NAPI_ENSURE(env, aws_napi_release_threadsafe_function(batch->on_complete, napi_tsfn_abort));
+    }
+
+    aws_mem_release(batch->allocator, batch);
+}
+
+static void s_on_publish_batch_complete_call(napi_env env, napi_value on_complete, void *context, void *user_data) {
+    (void)user_data;
+    struct publish_batch *batch = context;
+
+    if (env) {
+        napi_value params[2];
+        const size_t num_params = AWS_ARRAY_SIZE(params);
+
+        AWS_NAPI_ENSURE(env, napi_create_array_with_length(env, batch->num_items, &params[0]));
+        AWS_NAPI_ENSURE(env, napi_create_array_with_length(env, batch->num_items, &params[1]));
+        for (size_t i = 0; i < batch->num_items; ++i) {
+            napi_value packet_id = NULL;
+            napi_value error_code = NULL;
+            AWS_NAPI_ENSURE(env, napi_create_uint32(env, batch->items[i].packet_id, &packet_id));
+            AWS_NAPI_ENSURE(env, napi_create_int32(env, batch->items[i].error_code, &error_code));
+            AWS_NAPI_ENSURE(env, napi_set_element(env, params[0], (uint32_t)i, packet_id));
+            AWS_NAPI_ENSURE(env, napi_set_element(env, params[1], (uint32_t)i, error_code));
+        }
+
+        AWS_NAPI_ENSURE(
+            env, aws_napi_dispatch_threadsafe_function(env, batch->on_complete, NULL, on_complete, num_params, params));
+    }
+
+    s_destroy_publish_batch(env, batch);
+}
+
+static void s_publish_batch_item_done(struct publish_batch *batch) {
+    if (aws_atomic_fetch_sub(&batch->pending, 1) == 1) {
+        AWS_NAPI_ENSURE(NULL, aws_napi_queue_threadsafe_function(batch->on_complete, NULL));
+    }
+}
+
+static void s_on_publish_batch_item_complete(
+    struct aws_mqtt_client_connection *connection,
+    uint16_t packet_id,
+    int error_code,
+    void *user_data) {
+
+    (void)connection;
+
+    struct publish_batch_item *item = user_data;
+    item->packet_id = packet_id;
+    item->error_code = error_code;
+    aws_byte_buf_clean_up(&item->payload);
+
+    s_publish_batch_item_done(item->batch);
+}
+
+/* messages is flattened (topic, payload, qos, retain) tuples */
+napi_value aws_napi_mqtt_client_connection_publish_batch(napi_env env, napi_callback_info info) {
+
+    struct aws_allocator *allocator = aws_napi_get_metrics_allocator(AWS_NAPI_METRICS_MQTT);
+
+    napi_value node_args[3];
+    size_t num_args = AWS_ARRAY_SIZE(node_args);
+    napi_value *arg = &node_args[0];
+    AWS_NAPI_CALL(env, napi_get_cb_info(env, info, &num_args, node_args, NULL, NULL), {
+        napi_throw_error(env, NULL, "Failed to retreive callback information");
+        return NULL;
+    });
+    if (num_args != AWS_ARRAY_SIZE(node_args)) {
+        napi_throw_error(env, NULL, "mqtt_client_connection_publish_batch needs exactly 3 arguments");
+        return NULL;
+    }
+
+    napi_value node_binding = *arg++;
+    struct mqtt_connection_binding *binding = NULL;
+    AWS_NAPI_CALL(env, napi_get_value_external(env, node_binding, (void **)&binding), {
+        napi_throw_error(env, NULL, "Failed to extract binding from external");
+        return NULL;
+    });
+
+    napi_value node_messages = *arg++;
+    uint32_t num_values = 0;
+    AWS_NAPI_CALL(env, napi_get_array_length(env, node_messages, &num_values), {
+        napi_throw_type_error(env, NULL, "messages must be an array");
+        return NULL;
+    });
+    if (num_values == 0 || num_values % 4 != 0) {
+        napi_throw_type_error(env, NULL, "messages must be a non-empty array of (topic, payload, qos, retain)");
+        return NULL;
+    }
+    const size_t num_messages = num_values / 4;
+
+    struct publish_batch *batch = NULL;
+    struct publish_batch_item *items = NULL;
+    if (!aws_mem_acquire_many(
+            allocator,
+            2,
+            &batch,
+            sizeof(struct publish_batch),
+            &items,
+            num_messages * sizeof(struct publish_batch_item))) {
+        aws_napi_throw_last_error(env);
+        return NULL;
+    }
+    AWS_ZERO_STRUCT(*batch);
+    memset(items, 0, num_messages * sizeof(struct publish_batch_item));
+    batch->allocator = allocator;
+    batch->binding = binding;
+    batch->num_items = num_messages;
+    batch->items = items;
+    aws_atomic_init_int(&batch->pending, num_messages);
+
+    napi_value node_on_complete = *arg++;
+    AWS_NAPI_CALL(
+        env,
+        aws_napi_create_threadsafe_function(
+            env,
+            node_on_complete,
+            "aws_mqtt_client_connection_on_publish_batch",
+            s_on_publish_batch_complete_call,
+            batch,
+            &batch->on_complete),
+        {
+            napi_throw_type_error(env, NULL, "on_complete must be a valid callback");
+            aws_mem_release(allocator, batch);
+            return NULL;
+        });
+
+    /* Payloads are borrowed from node rather than copied, see aws_napi_mqtt_client_connection_publish() */
+    AWS_NAPI_CALL(env, napi_create_reference(env, node_messages, 1, &batch->node_messages), {
+        napi_throw_error(env, NULL, "Unable to reference messages");
+        s_destroy_publish_batch(env, batch);
+        return NULL;
+    });
+
+    /*
+     * Once the first message is handed to the client, the batch belongs to the completion callbacks. Messages that
+     * can't be published from here on are reported through the callback too, rather than thrown.
+     */
+    for (size_t idx = 0; idx < num_messages; ++idx) {
+        struct publish_batch_item *item = &batch->items[idx];
+        item->batch = batch;
+
+        napi_value node_topic = NULL;
+        napi_value node_payload = NULL;
+        napi_value node_qos = NULL;
+        napi_value node_retain = NULL;
+        uint32_t qos_uint = 0;
+        bool retain = false;
+        uint8_t topic_storage[AWS_NAPI_SMALL_STRING_SIZE];
+        struct aws_byte_buf topic_buf;
+        AWS_ZERO_STRUCT(topic_buf);
+
+        const uint32_t base = (uint32_t)idx * 4;
+        if (napi_get_element(env, node_messages, base, &node_topic) ||
+            napi_get_element(env, node_messages, base + 1, &node_payload) ||
+            napi_get_element(env, node_messages, base + 2, &node_qos) ||
+            napi_get_element(env, node_messages, base + 3, &node_retain) ||
+            napi_get_value_uint32(env, node_qos, &qos_uint) || napi_get_value_bool(env, node_retain, &retain) ||
+            aws_byte_buf_init_from_napi_with_storage(
+                &topic_buf, env, node_topic, topic_storage, sizeof(topic_storage)) ||
+            aws_byte_buf_init_from_napi(&item->payload, env, node_payload)) {
+
+            aws_byte_buf_clean_up(&item->payload);
+            aws_byte_buf_clean_up(&topic_buf);
+            item->error_code = AWS_ERROR_INVALID_ARGUMENT;
+            s_publish_batch_item_done(batch);
+            continue;
+        }
+
+        const struct aws_byte_cursor topic_cur = aws_byte_cursor_from_buf(&topic_buf);
+        const struct aws_byte_cursor payload_cur = aws_byte_cursor_from_buf(&item->payload);
+        uint16_t pub_id = aws_mqtt_client_connection_publish(
+            binding->connection,
+            &topic_cur,
+            (enum aws_mqtt_qos)qos_uint,
+            retain,
+            &payload_cur,
+            s_on_publish_batch_item_complete,
+            item);
+        if (!pub_id) {
+            item->error_code = aws_last_error();
+            aws_byte_buf_clean_up(&item->payload);
+            s_publish_batch_item_done(batch);
+        }
+
+        /* the client copies the topic, the payload is freed when the item completes */
+        aws_byte_buf_clean_up(&topic_buf);
+    }
+
+    return NULL;
+}
+
 /*******************************************************************************
  * Subscribe
  ******************************************************************************/
@@ -1088,7 +1367,7 @@ static void s_on_suback(
 struct subscription {
     struct aws_allocator *allocator;
     struct aws_byte_buf topic; /* stored here as long as the sub is active, referenced by callbacks */
-    napi_threadsafe_function on_publish;
+    struct aws_napi_batched_threadsafe_function *on_publish;
 };
 
 static void s_destroy_subscription(struct subscription *sub) {
@@ -1098,8 +1377,8 @@ static void s_destroy_subscription(struct subscription *sub) {
 
     AWS_FATAL_ASSERT(sub->allocator != NULL);
 
-    if (sub->on_publish != 0) {
-        AWS_NAPI_ENSURE(NULL, aws_napi_release_threadsafe_function(sub->on_publish, napi_tsfn_release));
+    if (sub->on_publish != NULL) {
+        AWS_NAPI_ENSURE(NULL, aws_napi_release_batched_threadsafe_function(sub->on_publish, napi_tsfn_release));
     }
 
     aws_byte_buf_clean_up(&sub->topic);
@@ -1110,16 +1389,21 @@ static void s_on_publish_user_data_clean_up(void *user_data) {
     s_destroy_subscription(user_data);
 }
 
-/* arguments for publish callbacks */
+/*
+ * Arguments for publish callbacks, shared by the subscription and on-any handlers.  Messages are delivered to node
+ * in batches, as a flat array of (topic, payload, dup, qos, retain) tuples.
+ */
+#define PUBLISH_BATCH_STRIDE 5
+
 struct on_publish_args {
     struct aws_allocator *allocator;
-    struct aws_byte_buf topic;    /* owned by this */
+    struct aws_linked_list_node node; /* links the message into its pending batch */
+    struct aws_byte_buf topic;        /* owned by this */
     struct aws_byte_buf *payload; /* owned by this until the external array buffer in the direct callback is created */
     bool dup;
     enum aws_mqtt_qos qos;
     bool retain;
-    /* created by subscription, but we add/dec ref on our copy of the pointer too */
-    napi_threadsafe_function on_publish;
+    struct aws_array_list handler_ids; /* uint32_t, the topic handlers this matched, on-any messages only */
 };
 
 static void s_destroy_on_publish_args(struct on_publish_args *args) {
@@ -1129,16 +1413,18 @@ static void s_destroy_on_publish_args(struct on_publish_args *args) {
 
     AWS_FATAL_ASSERT(args->allocator != NULL);
 
-    if (args->on_publish != NULL) {
-        AWS_NAPI_ENSURE(NULL, aws_napi_release_threadsafe_function(args->on_publish, napi_tsfn_release));
-    }
-
+    /*
+     * Between payload construction and transfer to the external array the only failure options are fatal, but
+     * as a pattern I believe it to be better (future-proofing, consistency) to properly handle the possibility
+     * of the payload getting created but not transferred to the external array's finalizer
+     */
     if (args->payload != NULL) {
         aws_byte_buf_clean_up(args->payload);
         aws_mem_release(args->allocator, args->payload);
     }
 
     aws_byte_buf_clean_up(&args->topic);
+    aws_array_list_clean_up(&args->handler_ids);
 
     aws_mem_release(args->allocator, args);
 }
@@ -1155,64 +1441,94 @@ static void s_publish_external_arraybuffer_finalizer(napi_env env, void *finaliz
     aws_mem_release(allocator, buf);
 }
 
-static void s_on_publish_call(napi_env env, napi_value on_publish, void *context, void *user_data) {
+static napi_status s_append_publish(
+    napi_env env,
+    napi_value batch,
+    uint32_t *index,
+    struct aws_linked_list_node *item,
+    void *context) {
     (void)context;
-    struct on_publish_args *args = user_data;
-
-    if (env) {
-        napi_value params[5];
-        const size_t num_params = AWS_ARRAY_SIZE(params);
+    struct on_publish_args *args = AWS_CONTAINER_OF(item, struct on_publish_args, node);
 
-        AWS_NAPI_ENSURE(
-            env, napi_create_string_utf8(env, (const char *)args->topic.buffer, args->topic.len, &params[0]));
-        AWS_NAPI_ENSURE(
+    napi_value params[PUBLISH_BATCH_STRIDE];
+    AWS_NAPI_ENSURE(env, napi_create_string_utf8(env, (const char *)args->topic.buffer, args->topic.len, &params[0]));
+    AWS_NAPI_ENSURE(
+        env,
+        napi_create_external_arraybuffer(
             env,
-            napi_create_external_arraybuffer(
-                env,
-                args->payload->buffer,
-                args->payload->len,
-                s_publish_external_arraybuffer_finalizer,
-                args->payload,
-                &params[1]));
-        AWS_NAPI_ENSURE(env, napi_get_boolean(env, args->dup, &params[2]));
-        AWS_NAPI_ENSURE(env, napi_create_int32(env, args->qos, &params[3]));
-        AWS_NAPI_ENSURE(env, napi_get_boolean(env, args->retain, &params[4]));
+            args->payload->buffer,
+            args->payload->len,
+            s_publish_external_arraybuffer_finalizer,
+            args->payload,
+            &params[1]));
+    AWS_NAPI_ENSURE(env, napi_get_boolean(env, args->dup, &params[2]));
+    AWS_NAPI_ENSURE(env, napi_create_int32(env, args->qos, &params[3]));
+    AWS_NAPI_ENSURE(env, napi_get_boolean(env, args->retain, &params[4]));
 
-        /*
-         * We've successfully created the external array buffer whose finalizer will clean this byte_buf up.
-         * It's now safe and correct to set this to NULL in the args so that the args destructor does not clean it up.
-         */
-        args->payload = NULL;
+    /*
+     * We've successfully created the external array buffer whose finalizer will clean this byte_buf up.
+     * It's now safe and correct to set this to NULL in the args so that the args destructor does not clean it up.
+     */
+    args->payload = NULL;
+    s_destroy_on_publish_args(args);
 
-        AWS_NAPI_ENSURE(
-            env, aws_napi_dispatch_threadsafe_function(env, args->on_publish, NULL, on_publish, num_params, params));
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(params); ++i) {
+        AWS_NAPI_ENSURE(env, napi_set_element(env, batch, (*index)++, params[i]));
     }
 
-    s_destroy_on_publish_args(args);
+    return napi_ok;
 }
 
-/* called in response to a message being published to an active subscription */
-static void s_on_publish(
-    struct aws_mqtt_client_connection *connection,
+/*
+ * The on-any handler appends one more element to each tuple: the ids of the topic handlers the message matched, or
+ * null if it matched none.
+ */
+static napi_status s_append_any_publish(
+    napi_env env,
+    napi_value batch,
+    uint32_t *index,
+    struct aws_linked_list_node *item,
+    void *context) {
+    struct on_publish_args *args = AWS_CONTAINER_OF(item, struct on_publish_args, node);
+
+    napi_value node_handler_ids = NULL;
+    const size_t num_handlers = aws_array_list_length(&args->handler_ids);
+    if (num_handlers == 0) {
+        AWS_NAPI_ENSURE(env, napi_get_null(env, &node_handler_ids));
+    } else {
+        AWS_NAPI_ENSURE(env, napi_create_array_with_length(env, num_handlers, &node_handler_ids));
+        for (size_t i = 0; i < num_handlers; ++i) {
+            uint32_t id = 0;
+            aws_array_list_get_at(&args->handler_ids, &id, i);
+            napi_value node_id = NULL;
+            AWS_NAPI_ENSURE(env, napi_create_uint32(env, id, &node_id));
+            AWS_NAPI_ENSURE(env, napi_set_element(env, node_handler_ids, (uint32_t)i, node_id));
+        }
+    }
+
+    /* args are destroyed by this */
+    AWS_NAPI_ENSURE(env, s_append_publish(env, batch, index, item, context));
+    AWS_NAPI_ENSURE(env, napi_set_element(env, batch, (*index)++, node_handler_ids));
+
+    return napi_ok;
+}
+
+static void s_discard_publish(struct aws_linked_list_node *item, void *context) {
+    (void)context;
+    s_destroy_on_publish_args(AWS_CONTAINER_OF(item, struct on_publish_args, node));
+}
+
+/* handler_ids, if not NULL, is moved into the queued message */
+static void s_queue_publish(
+    struct aws_allocator *allocator,
+    struct aws_napi_batched_threadsafe_function *on_publish,
     const struct aws_byte_cursor *topic,
     const struct aws_byte_cursor *payload,
     bool dup,
     enum aws_mqtt_qos qos,
     bool retain,
-    void *user_data) {
+    struct aws_array_list *handler_ids) {
 
-    (void)connection;
-
-    struct subscription *sub = user_data;
-    /* users can use a null handler to sub to a topic, and then handle it with the any handler */
-    if (!sub->on_publish) {
-        return;
-    }
-
-    struct mqtt_connection_binding *binding = NULL;
-    AWS_NAPI_ENSURE(NULL, napi_get_threadsafe_function_context(sub->on_publish, (void **)&binding));
-
-    struct aws_allocator *allocator = binding->allocator;
     struct on_publish_args *args = aws_mem_calloc(allocator, 1, sizeof(struct on_publish_args));
     AWS_FATAL_ASSERT(args);
 
@@ -1220,15 +1536,9 @@ static void s_on_publish(
     args->dup = dup;
     args->qos = qos;
     args->retain = retain;
-    args->on_publish = sub->on_publish;
-
-    /*
-     * We share this threadsafe function with the subscription structure.  Each applies a inc/dec ref because
-     * it isn't clear that we can guarantee the order of destruction because we don't really have any
-     * guarantees about V8's internal scheduling/ordering invariants for queued functions.
-     */
-    if (args->on_publish != 0) {
-        AWS_NAPI_ENSURE(NULL, aws_napi_acquire_threadsafe_function(args->on_publish));
+    if (handler_ids) {
+        args->handler_ids = *handler_ids;
+        AWS_ZERO_STRUCT(*handler_ids);
     }
 
     if (aws_byte_buf_init_copy_from_cursor(&args->topic, allocator, *topic)) {
@@ -1245,13 +1555,13 @@ static void s_on_publish(
         goto on_error;
     }
 
-    /* this is freed after being delivered to node in s_on_publish_call */
+    /* this is freed after being delivered to node in s_append_publish */
     if (aws_byte_buf_init_copy_from_cursor(args->payload, allocator, *payload)) {
         AWS_LOGF_ERROR(AWS_LS_NODEJS_CRT_GENERAL, "Failed to copy MQTT payload buffer, message will not be delivered");
         goto on_error;
     }
 
-    AWS_NAPI_ENSURE(NULL, aws_napi_queue_threadsafe_function(args->on_publish, args));
+    AWS_NAPI_CALL(NULL, aws_napi_queue_batched_threadsafe_function(on_publish, &args->node), { goto on_error; });
 
     return;
 
@@ -1260,6 +1570,27 @@ on_error:
     s_destroy_on_publish_args(args);
 }
 
+/* called in response to a message being published to an active subscription */
+static void s_on_publish(
+    struct aws_mqtt_client_connection *connection,
+    const struct aws_byte_cursor *topic,
+    const struct aws_byte_cursor *payload,
+    bool dup,
+    enum aws_mqtt_qos qos,
+    bool retain,
+    void *user_data) {
+
+    (void)connection;
+
+    struct subscription *sub = user_data;
+    /* users can use a null handler to sub to a topic, and then handle it with the any handler */
+    if (!sub->on_publish) {
+        return;
+    }
+
+    s_queue_publish(sub->allocator, sub->on_publish, topic, payload, dup, qos, retain, NULL);
+}
+
 napi_value aws_napi_mqtt_client_connection_subscribe(napi_env env, napi_callback_info cb_info) {
 
     napi_value node_args[5];
@@ -1305,11 +1636,12 @@ napi_value aws_napi_mqtt_client_connection_subscribe(napi_env env, napi_callback
     if (!aws_napi_is_null_or_undefined(env, node_on_publish)) {
         AWS_NAPI_CALL(
             env,
-            aws_napi_create_threadsafe_function(
+            aws_napi_create_batched_threadsafe_function(
                 env,
                 node_on_publish,
                 "aws_mqtt_client_connection_on_publish",
-                s_on_publish_call,
+                s_append_publish,
+                s_discard_publish,
                 binding,
                 &sub->on_publish),
             { goto cleanup; });
@@ -1354,85 +1686,409 @@ cleanup:
 }
 
 /*
- * on-any publish
+ * Message workers: other napi_envs, usually worker_threads, that on-any messages are distributed between.
+ *
+ * The group is shared between the connection and every attached worker, each holding a reference. Workers find it
+ * by id, since externals can't be passed between envs.
  */
-struct on_any_publish_args {
+enum mqtt_worker_distribution {
+    MQTT_WORKER_DISTRIBUTION_ROUND_ROBIN,
+    /* Every message on a topic goes to the same worker, preserving per-topic ordering */
+    MQTT_WORKER_DISTRIBUTION_TOPIC_HASH,
+    MQTT_WORKER_DISTRIBUTION_COUNT,
+};
+
+struct mqtt_message_worker;
+
+struct mqtt_message_worker_group {
     struct aws_allocator *allocator;
-    struct aws_string *topic;
-    struct aws_byte_buf *payload;
-    bool dup;
-    enum aws_mqtt_qos qos;
-    bool retain;
+    struct aws_linked_list_node registry_node;
+    uint32_t id;
+    enum mqtt_worker_distribution distribution;
+    struct aws_atomic_var ref_count;
+
+    struct {
+        struct aws_mutex lock;
+        /* struct mqtt_message_worker *, the workers messages can currently be delivered to */
+        struct aws_array_list workers;
+        size_t next_worker;
+        /* Set when the connection is closed, no more workers can attach */
+        bool closed;
+    } synced_data;
 };
 
-static void s_destroy_on_any_publish_args(struct on_any_publish_args *args) {
-    if (args == NULL) {
+struct mqtt_message_worker {
+    struct aws_allocator *allocator;
+    napi_env env;
+    /* Only touched on the worker's own thread, NULL once detached */
+    struct mqtt_message_worker_group *group;
+    /* Guarded by the group's lock, NULL once released */
+    struct aws_napi_batched_threadsafe_function *on_publish;
+    bool cleanup_hook_registered;
+};
+
+static struct aws_mutex s_worker_groups_lock = AWS_MUTEX_INIT;
+/* struct mqtt_message_worker_group, every group whose connection is still open */
+static struct aws_linked_list s_worker_groups;
+static bool s_worker_groups_initialized = false;
+static uint32_t s_next_worker_group_id = 1;
+
+static void s_message_worker_group_release(struct mqtt_message_worker_group *group) {
+    if (aws_atomic_fetch_sub(&group->ref_count, 1) != 1) {
         return;
     }
 
-    aws_string_destroy(args->topic);
+    AWS_FATAL_ASSERT(aws_array_list_length(&group->synced_data.workers) == 0);
+    aws_array_list_clean_up(&group->synced_data.workers);
+    aws_mutex_clean_up(&group->synced_data.lock);
+    aws_mem_release(group->allocator, group);
+}
 
-    /*
-     * Between payload construction and transfer to the external array the only failure options are fatal, but
-     * as a pattern I believe it to be better (future-proofing, consistency) to properly handle the possibility
-     * of the payload getting created but not transferred to the external array's finalizer
-     */
-    if (args->payload) {
-        aws_byte_buf_clean_up(args->payload);
-        aws_mem_release(args->allocator, args->payload);
+static struct mqtt_message_worker_group *s_message_worker_group_new(
+    struct aws_allocator *allocator,
+    enum mqtt_worker_distribution distribution) {
+
+    struct mqtt_message_worker_group *group = aws_mem_calloc(allocator, 1, sizeof(struct mqtt_message_worker_group));
+    if (!group) {
+        return NULL;
     }
 
-    aws_mem_release(args->allocator, args);
+    group->allocator = allocator;
+    group->distribution = distribution;
+    aws_atomic_init_int(&group->ref_count, 1);
+    aws_mutex_init(&group->synced_data.lock);
+    if (aws_array_list_init_dynamic(
+            &group->synced_data.workers, allocator, 4, sizeof(struct mqtt_message_worker *))) {
+        aws_mutex_clean_up(&group->synced_data.lock);
+        aws_mem_release(allocator, group);
+        return NULL;
+    }
+
+    aws_mutex_lock(&s_worker_groups_lock);
+    if (!s_worker_groups_initialized) {
+        aws_linked_list_init(&s_worker_groups);
+        s_worker_groups_initialized = true;
+    }
+    group->id = s_next_worker_group_id++;
+    aws_linked_list_push_back(&s_worker_groups, &group->registry_node);
+    aws_mutex_unlock(&s_worker_groups_lock);
+
+    return group;
 }
 
-static void s_any_publish_external_arraybuffer_finalizer(napi_env env, void *finalize_data, void *finalize_hint) {
+/* Returns a new reference to the group with this id, or NULL if there's no such group */
+static struct mqtt_message_worker_group *s_message_worker_group_find(uint32_t id) {
+    struct mqtt_message_worker_group *result = NULL;
+
+    aws_mutex_lock(&s_worker_groups_lock);
+    if (s_worker_groups_initialized) {
+        for (struct aws_linked_list_node *node = aws_linked_list_begin(&s_worker_groups);
+             node != aws_linked_list_end(&s_worker_groups);
+             node = aws_linked_list_next(node)) {
+            struct mqtt_message_worker_group *group =
+                AWS_CONTAINER_OF(node, struct mqtt_message_worker_group, registry_node);
+            if (group->id == id) {
+                aws_atomic_fetch_add(&group->ref_count, 1);
+                result = group;
+                break;
+            }
+        }
+    }
+    aws_mutex_unlock(&s_worker_groups_lock);
+
+    return result;
+}
+
+/* Called once the connection is closed: releases every worker so their envs can exit, and drops the connection's ref */
+static void s_message_worker_group_shutdown(struct mqtt_message_worker_group *group) {
+    aws_mutex_lock(&s_worker_groups_lock);
+    aws_linked_list_remove(&group->registry_node);
+    aws_mutex_unlock(&s_worker_groups_lock);
+
+    aws_mutex_lock(&group->synced_data.lock);
+    group->synced_data.closed = true;
+    const size_t num_workers = aws_array_list_length(&group->synced_data.workers);
+    for (size_t i = 0; i < num_workers; ++i) {
+        struct mqtt_message_worker *worker = NULL;
+        aws_array_list_get_at(&group->synced_data.workers, &worker, i);
+        AWS_NAPI_ENSURE(NULL, aws_napi_release_batched_threadsafe_function(worker->on_publish, napi_tsfn_abort));
+        worker->on_publish = NULL;
+    }
+    aws_array_list_clear(&group->synced_data.workers);
+    aws_mutex_unlock(&group->synced_data.lock);
+
+    s_message_worker_group_release(group);
+}
+
+/*
+ * Queues the message for one of the group's workers. Returns false if there are none, in which case the connection
+ * delivers it itself. Topic handlers live on the connection's thread, so workers get the message without the ids of
+ * the handlers it matched.
+ */
+static bool s_message_worker_group_deliver(
+    struct mqtt_message_worker_group *group,
+    struct aws_allocator *allocator,
+    const struct aws_byte_cursor *topic,
+    const struct aws_byte_cursor *payload,
+    bool dup,
+    enum aws_mqtt_qos qos,
+    bool retain) {
+
+    bool delivered = false;
+
+    aws_mutex_lock(&group->synced_data.lock);
+    const size_t num_workers = aws_array_list_length(&group->synced_data.workers);
+    if (num_workers > 0) {
+        size_t index = 0;
+        if (group->distribution == MQTT_WORKER_DISTRIBUTION_TOPIC_HASH) {
+            index = (size_t)(aws_hash_byte_cursor_ptr(topic) % num_workers);
+        } else {
+            index = group->synced_data.next_worker++ % num_workers;
+        }
+
+        struct mqtt_message_worker *worker = NULL;
+        aws_array_list_get_at(&group->synced_data.workers, &worker, index);
+        s_queue_publish(allocator, worker->on_publish, topic, payload, dup, qos, retain, NULL);
+        delivered = true;
+    }
+    aws_mutex_unlock(&group->synced_data.lock);
+
+    return delivered;
+}
+
+static void s_message_worker_env_cleanup(void *user_data);
+
+/* Called on the worker's thread, stops delivery to it. Safe to call more than once. */
+static void s_message_worker_detach(struct mqtt_message_worker *worker) {
+    struct mqtt_message_worker_group *group = worker->group;
+    if (group == NULL) {
+        return;
+    }
+    worker->group = NULL;
+
+    aws_mutex_lock(&group->synced_data.lock);
+    const size_t num_workers = aws_array_list_length(&group->synced_data.workers);
+    for (size_t i = 0; i < num_workers; ++i) {
+        struct mqtt_message_worker *attached = NULL;
+        aws_array_list_get_at(&group->synced_data.workers, &attached, i);
+        if (attached == worker) {
+            aws_array_list_swap(&group->synced_data.workers, i, num_workers - 1);
+            aws_array_list_pop_back(&group->synced_data.workers);
+            break;
+        }
+    }
+    struct aws_napi_batched_threadsafe_function *on_publish = worker->on_publish;
+    worker->on_publish = NULL;
+    aws_mutex_unlock(&group->synced_data.lock);
+
+    if (on_publish != NULL) {
+        AWS_NAPI_ENSURE(worker->env, aws_napi_release_batched_threadsafe_function(on_publish, napi_tsfn_release));
+    }
+
+    if (worker->cleanup_hook_registered) {
+        AWS_NAPI_ENSURE(worker->env, napi_remove_env_cleanup_hook(worker->env, s_message_worker_env_cleanup, worker));
+        worker->cleanup_hook_registered = false;
+    }
+
+    s_message_worker_group_release(group);
+}
+
+/* The worker's env is exiting without having detached, which must happen before its threadsafe function is torn down */
+static void s_message_worker_env_cleanup(void *user_data) {
+    struct mqtt_message_worker *worker = user_data;
+    worker->cleanup_hook_registered = false;
+    s_message_worker_detach(worker);
+}
+
+static void s_message_worker_finalize(napi_env env, void *finalize_data, void *finalize_hint) {
     (void)env;
-    (void)finalize_data;
+    (void)finalize_hint;
+    struct mqtt_message_worker *worker = finalize_data;
 
-    struct aws_byte_buf *payload = finalize_hint;
-    struct aws_allocator *allocator = payload->allocator;
-    AWS_FATAL_ASSERT(allocator != NULL);
+    s_message_worker_detach(worker);
+    aws_mem_release(worker->allocator, worker);
+}
+
+napi_value aws_napi_mqtt_client_connection_share_with_workers(napi_env env, napi_callback_info cb_info) {
+    napi_value node_args[2];
+    size_t num_args = AWS_ARRAY_SIZE(node_args);
+    napi_value *arg = &node_args[0];
+    AWS_NAPI_CALL(env, napi_get_cb_info(env, cb_info, &num_args, node_args, NULL, NULL), {
+        napi_throw_error(env, NULL, "Failed to retreive callback information");
+        return NULL;
+    });
+    if (num_args != AWS_ARRAY_SIZE(node_args)) {
+        napi_throw_error(env, NULL, "mqtt_client_connection_share_with_workers needs exactly 2 arguments");
+        return NULL;
+    }
+
+    napi_value node_binding = *arg++;
+    struct mqtt_connection_binding *binding = NULL;
+    AWS_NAPI_CALL(env, napi_get_value_external(env, node_binding, (void **)&binding), {
+        napi_throw_error(env, NULL, "Unable to extract external");
+        return NULL;
+    });
 
-    aws_byte_buf_clean_up(payload);
-    aws_mem_release(allocator, payload);
+    napi_value node_distribution = *arg++;
+    uint32_t distribution = 0;
+    AWS_NAPI_CALL(env, napi_get_value_uint32(env, node_distribution, &distribution), {
+        napi_throw_type_error(env, NULL, "distribution must be a Number");
+        return NULL;
+    });
+    if (distribution >= MQTT_WORKER_DISTRIBUTION_COUNT) {
+        napi_throw_range_error(env, NULL, "distribution is not a valid MqttWorkerDistribution");
+        return NULL;
+    }
+
+    if (binding->on_any_publish == NULL) {
+        napi_throw_error(env, NULL, "on_any_publish handler must be set before sharing with workers");
+        return NULL;
+    }
+
+    aws_mutex_lock(&binding->message_routing.lock);
+    struct mqtt_message_worker_group *group = binding->message_routing.workers;
+    aws_mutex_unlock(&binding->message_routing.lock);
+
+    if (group == NULL) {
+        group = s_message_worker_group_new(binding->allocator, distribution);
+        if (group == NULL) {
+            aws_napi_throw_last_error(env);
+            return NULL;
+        }
+
+        aws_mutex_lock(&binding->message_routing.lock);
+        binding->message_routing.workers = group;
+        aws_mutex_unlock(&binding->message_routing.lock);
+    } else if (group->distribution != distribution) {
+        napi_throw_error(env, NULL, "connection is already shared with a different distribution");
+        return NULL;
+    }
+
+    napi_value node_id = NULL;
+    AWS_NAPI_CALL(env, napi_create_uint32(env, group->id, &node_id), {
+        napi_throw_error(env, NULL, "Failed to create worker group id");
+        return NULL;
+    });
+
+    return node_id;
 }
 
-static void s_on_any_publish_call(napi_env env, napi_value on_publish, void *context, void *user_data) {
-    struct mqtt_connection_binding *binding = context;
-    struct on_any_publish_args *args = user_data;
+napi_value aws_napi_mqtt_message_worker_attach(napi_env env, napi_callback_info cb_info) {
+    napi_value node_args[2];
+    size_t num_args = AWS_ARRAY_SIZE(node_args);
+    napi_value *arg = &node_args[0];
+    AWS_NAPI_CALL(env, napi_get_cb_info(env, cb_info, &num_args, node_args, NULL, NULL), {
+        napi_throw_error(env, NULL, "Failed to retreive callback information");
+        return NULL;
+    });
+    if (num_args != AWS_ARRAY_SIZE(node_args)) {
+        napi_throw_error(env, NULL, "mqtt_message_worker_attach needs exactly 2 arguments");
+        return NULL;
+    }
 
-    if (env) {
-        napi_value params[5];
-        const size_t num_params = AWS_ARRAY_SIZE(params);
+    napi_value node_id = *arg++;
+    uint32_t id = 0;
+    AWS_NAPI_CALL(env, napi_get_value_uint32(env, node_id, &id), {
+        napi_throw_type_error(env, NULL, "id must be a Number");
+        return NULL;
+    });
 
-        AWS_NAPI_ENSURE(env, napi_create_string_utf8(env, aws_string_c_str(args->topic), args->topic->len, &params[0]));
-        AWS_NAPI_ENSURE(
-            env,
-            napi_create_external_arraybuffer(
-                env,
-                args->payload->buffer,
-                args->payload->len,
-                s_any_publish_external_arraybuffer_finalizer,
-                args->payload,
-                &params[1]));
-        AWS_NAPI_ENSURE(env, napi_get_boolean(env, args->dup, &params[2]));
-        AWS_NAPI_ENSURE(env, napi_create_int32(env, args->qos, &params[3]));
-        AWS_NAPI_ENSURE(env, napi_get_boolean(env, args->retain, &params[4]));
+    napi_value node_on_publish = *arg++;
+    if (aws_napi_is_null_or_undefined(env, node_on_publish)) {
+        napi_throw_error(env, NULL, "on_publish must not be null or undefined");
+        return NULL;
+    }
 
-        /*
-         * We've successfully created the external array buffer whose finalizer will clean this byte_buf up.
-         * It's now safe and correct to set this to NULL in the args so that the args destructor does not clean it up.
-         */
-        args->payload = NULL;
+    struct mqtt_message_worker_group *group = s_message_worker_group_find(id);
+    if (group == NULL) {
+        napi_throw_error(env, NULL, "No open connection is shared with this id");
+        return NULL;
+    }
 
-        AWS_NAPI_ENSURE(
+    struct aws_allocator *allocator = aws_napi_get_metrics_allocator(AWS_NAPI_METRICS_MQTT);
+    struct mqtt_message_worker *worker = aws_mem_calloc(allocator, 1, sizeof(struct mqtt_message_worker));
+    AWS_FATAL_ASSERT(worker);
+    worker->allocator = allocator;
+    worker->env = env;
+
+    napi_value node_external = NULL;
+    AWS_NAPI_CALL(env, napi_create_external(env, worker, s_message_worker_finalize, NULL, &node_external), {
+        napi_throw_error(env, NULL, "Failed create n-api external");
+        aws_mem_release(allocator, worker);
+        s_message_worker_group_release(group);
+        return NULL;
+    });
+
+    /* From here on, the finalizer cleans up the worker, and detaching releases the group */
+    worker->group = group;
+
+    AWS_NAPI_CALL(
+        env,
+        aws_napi_create_batched_threadsafe_function(
             env,
-            aws_napi_dispatch_threadsafe_function(env, binding->on_any_publish, NULL, on_publish, num_params, params));
+            node_on_publish,
+            "mqtt_message_worker_publish",
+            s_append_publish,
+            s_discard_publish,
+            NULL,
+            &worker->on_publish),
+        {
+            napi_throw_error(env, NULL, "Failed to create threadsafe function for worker");
+            s_message_worker_detach(worker);
+            return NULL;
+        });
+
+    AWS_NAPI_CALL(env, napi_add_env_cleanup_hook(env, s_message_worker_env_cleanup, worker), {
+        napi_throw_error(env, NULL, "Failed to register env cleanup hook");
+        s_message_worker_detach(worker);
+        return NULL;
+    });
+    worker->cleanup_hook_registered = true;
+
+    aws_mutex_lock(&group->synced_data.lock);
+    const bool closed = group->synced_data.closed;
+    const int push_result = closed ? AWS_OP_ERR : aws_array_list_push_back(&group->synced_data.workers, &worker);
+    aws_mutex_unlock(&group->synced_data.lock);
+
+    if (push_result) {
+        if (closed) {
+            napi_throw_error(env, NULL, "No open connection is shared with this id");
+        } else {
+            aws_napi_throw_last_error(env);
+        }
+        s_message_worker_detach(worker);
+        return NULL;
+    }
+
+    return node_external;
+}
+
+napi_value aws_napi_mqtt_message_worker_detach(napi_env env, napi_callback_info cb_info) {
+    napi_value node_args[1];
+    size_t num_args = AWS_ARRAY_SIZE(node_args);
+    AWS_NAPI_CALL(env, napi_get_cb_info(env, cb_info, &num_args, node_args, NULL, NULL), {
+        napi_throw_error(env, NULL, "Failed to retreive callback information");
+        return NULL;
+    });
+    if (num_args != AWS_ARRAY_SIZE(node_args)) {
+        napi_throw_error(env, NULL, "mqtt_message_worker_detach needs exactly 1 argument");
+        return NULL;
     }
 
-    s_destroy_on_any_publish_args(args);
+    struct mqtt_message_worker *worker = NULL;
+    AWS_NAPI_CALL(env, napi_get_value_external(env, node_args[0], (void **)&worker), {
+        napi_throw_error(env, NULL, "Unable to extract external");
+        return NULL;
+    });
+
+    s_message_worker_detach(worker);
+
+    return NULL;
 }
 
+/*
+ * on-any publish
+ */
 static void s_on_any_publish(
     struct aws_mqtt_client_connection *connection,
     const struct aws_byte_cursor *topic,
@@ -1449,30 +2105,33 @@ static void s_on_any_publish(
         return;
     }
 
-    struct aws_allocator *allocator = binding->allocator;
-    struct on_any_publish_args *args = aws_mem_calloc(allocator, 1, sizeof(struct on_publish_args));
-    AWS_FATAL_ASSERT(args);
-
-    args->allocator = allocator;
-    args->topic = aws_string_new_from_array(allocator, topic->ptr, topic->len);
-    args->dup = dup;
-    args->qos = qos;
-    args->retain = retain;
-    args->payload = aws_mem_calloc(allocator, 1, sizeof(struct aws_byte_buf));
+    /* Matched here so that messages nothing is listening for never cross into node */
+    struct aws_array_list handler_ids;
+    aws_array_list_init_dynamic(&handler_ids, binding->allocator, 0, sizeof(uint32_t));
 
-    /* this is freed after being delivered to node in s_on_any_publish_call */
-    if (aws_byte_buf_init_copy_from_cursor(args->payload, allocator, *payload)) {
-        AWS_LOGF_ERROR(AWS_LS_NODEJS_CRT_GENERAL, "Failed to copy MQTT payload buffer, payload will not be delivered");
-        goto on_error;
+    aws_mutex_lock(&binding->message_routing.lock);
+    int match_result = AWS_OP_SUCCESS;
+    if (binding->message_routing.filters) {
+        match_result = aws_napi_topic_filter_trie_match(binding->message_routing.filters, *topic, &handler_ids);
     }
+    /* workers only take over messages the connection would have delivered itself */
+    const bool wanted = binding->message_routing.forward_all || aws_array_list_length(&handler_ids) > 0;
+    bool delivered = false;
+    if (match_result == AWS_OP_SUCCESS && wanted && binding->message_routing.workers) {
+        delivered = s_message_worker_group_deliver(
+            binding->message_routing.workers, binding->allocator, topic, payload, dup, qos, retain);
+    }
+    aws_mutex_unlock(&binding->message_routing.lock);
 
-    AWS_NAPI_ENSURE(NULL, aws_napi_queue_threadsafe_function(binding->on_any_publish, args));
-
-    return;
-
-on_error:
+    if (match_result) {
+        AWS_LOGF_ERROR(
+            AWS_LS_NODEJS_CRT_GENERAL, "Failed to match MQTT topic against handlers, message will not be delivered");
+    } else if (wanted && !delivered) {
+        s_queue_publish(
+            binding->allocator, binding->on_any_publish, topic, payload, dup, qos, retain, &handler_ids);
+    }
 
-    s_destroy_on_any_publish_args(args);
+    aws_array_list_clean_up(&handler_ids);
 }
 
 napi_value aws_napi_mqtt_client_connection_on_message(napi_env env, napi_callback_info cb_info) {
@@ -1512,8 +2171,14 @@ napi_value aws_napi_mqtt_client_connection_on_message(napi_env env, napi_callbac
 
     AWS_NAPI_CALL(
         env,
-        aws_napi_create_threadsafe_function(
-            env, node_handler, "on_any_publish", s_on_any_publish_call, binding, &binding->on_any_publish),
+        aws_napi_create_batched_threadsafe_function(
+            env,
+            node_handler,
+            "on_any_publish",
+            s_append_any_publish,
+            s_discard_publish,
+            binding,
+            &binding->on_any_publish),
         { return NULL; });
 
     if (aws_mqtt_client_connection_set_on_any_publish_handler(binding->connection, s_on_any_publish, binding)) {
@@ -1524,6 +2189,122 @@ napi_value aws_napi_mqtt_client_connection_on_message(napi_env env, napi_callbac
     return NULL;
 }
 
+/*
+ * Topic handlers: local routing of on-any messages, see aws_napi_mqtt_client_connection_add_topic_handler()
+ */
+static napi_value s_update_topic_handler(napi_env env, napi_callback_info cb_info, bool add) {
+    uint8_t filter_storage[AWS_NAPI_SMALL_STRING_SIZE];
+    struct aws_byte_buf filter_buf;
+    AWS_ZERO_STRUCT(filter_buf);
+
+    napi_value node_args[3];
+    size_t num_args = AWS_ARRAY_SIZE(node_args);
+    napi_value *arg = &node_args[0];
+    AWS_NAPI_CALL(env, napi_get_cb_info(env, cb_info, &num_args, node_args, NULL, NULL), {
+        napi_throw_error(env, NULL, "Failed to retreive callback information");
+        return NULL;
+    });
+    if (num_args != AWS_ARRAY_SIZE(node_args)) {
+        napi_throw_error(
+            env,
+            NULL,
+            add ? "mqtt_client_connection_add_topic_handler needs exactly 3 arguments"
+                : "mqtt_client_connection_remove_topic_handler needs exactly 3 arguments");
+        return NULL;
+    }
+
+    napi_value node_binding = *arg++;
+    struct mqtt_connection_binding *binding = NULL;
+    AWS_NAPI_CALL(env, napi_get_value_external(env, node_binding, (void **)&binding), {
+        napi_throw_error(env, NULL, "Unable to extract external");
+        return NULL;
+    });
+
+    napi_value node_filter = *arg++;
+    AWS_NAPI_CALL(
+        env,
+        aws_byte_buf_init_from_napi_with_storage(
+            &filter_buf, env, node_filter, filter_storage, sizeof(filter_storage)),
+        {
+            napi_throw_type_error(env, NULL, "topic_filter must be a String");
+            return NULL;
+        });
+
+    napi_value node_handler_id = *arg++;
+    uint32_t handler_id = 0;
+    AWS_NAPI_CALL(env, napi_get_value_uint32(env, node_handler_id, &handler_id), {
+        napi_throw_type_error(env, NULL, "handler_id must be a Number");
+        goto done;
+    });
+
+    int result = AWS_OP_SUCCESS;
+    aws_mutex_lock(&binding->message_routing.lock);
+    if (add) {
+        if (!binding->message_routing.filters) {
+            binding->message_routing.filters = aws_napi_topic_filter_trie_new(binding->allocator);
+        }
+        result = binding->message_routing.filters
+                     ? aws_napi_topic_filter_trie_add(
+                           binding->message_routing.filters, aws_byte_cursor_from_buf(&filter_buf), handler_id)
+                     : AWS_OP_ERR;
+    } else if (binding->message_routing.filters) {
+        aws_napi_topic_filter_trie_remove(
+            binding->message_routing.filters, aws_byte_cursor_from_buf(&filter_buf), handler_id);
+    }
+    aws_mutex_unlock(&binding->message_routing.lock);
+
+    if (result) {
+        aws_napi_throw_last_error(env);
+    }
+
+done:
+    aws_byte_buf_clean_up(&filter_buf);
+
+    return NULL;
+}
+
+napi_value aws_napi_mqtt_client_connection_add_topic_handler(napi_env env, napi_callback_info cb_info) {
+    return s_update_topic_handler(env, cb_info, true);
+}
+
+napi_value aws_napi_mqtt_client_connection_remove_topic_handler(napi_env env, napi_callback_info cb_info) {
+    return s_update_topic_handler(env, cb_info, false);
+}
+
+napi_value aws_napi_mqtt_client_connection_forward_all_messages(napi_env env, napi_callback_info cb_info) {
+    napi_value node_args[2];
+    size_t num_args = AWS_ARRAY_SIZE(node_args);
+    napi_value *arg = &node_args[0];
+    AWS_NAPI_CALL(env, napi_get_cb_info(env, cb_info, &num_args, node_args, NULL, NULL), {
+        napi_throw_error(env, NULL, "Failed to retreive callback information");
+        return NULL;
+    });
+    if (num_args != AWS_ARRAY_SIZE(node_args)) {
+        napi_throw_error(env, NULL, "mqtt_client_connection_forward_all_messages needs exactly 2 arguments");
+        return NULL;
+    }
+
+    napi_value node_binding = *arg++;
+    struct mqtt_connection_binding *binding = NULL;
+    AWS_NAPI_CALL(env, napi_get_value_external(env, node_binding, (void **)&binding), {
+        napi_throw_error(env, NULL, "Unable to extract external");
+        return NULL;
+    });
+
+    napi_value node_forward_all = *arg++;
+    bool forward_all = true;
+    AWS_NAPI_CALL(env, napi_get_value_bool(env, node_forward_all, &forward_all), {
+        napi_throw_type_error(env, NULL, "forward_all must be a Boolean");
+        return NULL;
+    });
+
+    aws_mutex_lock(&binding->message_routing.lock);
+    binding->message_routing.forward_all = forward_all;
+    aws_mutex_unlock(&binding->message_routing.lock);
+
+    return NULL;
+}
+
 /*******************************************************************************
  * Unsubscribe
  ******************************************************************************/
@@ -12,8 +12,27 @@ napi_value aws_napi_mqtt_client_connection_close(napi_env env, napi_callback_inf
 napi_value aws_napi_mqtt_client_connection_connect(napi_env env, napi_callback_info info);
 napi_value aws_napi_mqtt_client_connection_reconnect(napi_env env, napi_callback_info info);
 napi_value aws_napi_mqtt_client_connection_publish(napi_env env, napi_callback_info info);
+napi_value aws_napi_mqtt_client_connection_publish_batch(napi_env env, napi_callback_info info);
 napi_value aws_napi_mqtt_client_connection_subscribe(napi_env env, napi_callback_info info);
 napi_value aws_napi_mqtt_client_connection_on_message(napi_env env, napi_callback_info info);
+
+/*
+ * Topic handlers route on_message deliveries natively: each message is tagged with the ids of the handlers whose
+ * filter it matches. Unless forward_all_messages has been turned off, messages matching no handler are still
+ * delivered, tagged with none.
+ */
+napi_value aws_napi_mqtt_client_connection_add_topic_handler(napi_env env, napi_callback_info info);
+napi_value aws_napi_mqtt_client_connection_remove_topic_handler(napi_env env, napi_callback_info info);
+napi_value aws_napi_mqtt_client_connection_forward_all_messages(napi_env env, napi_callback_info info);
+
+/*
+ * Sharing a connection hands its on_message deliveries to workers attached from other envs, one worker per message.
+ * share_with_workers returns the id workers attach with.
+ */
+napi_value aws_napi_mqtt_client_connection_share_with_workers(napi_env env, napi_callback_info info);
+napi_value aws_napi_mqtt_message_worker_attach(napi_env env, napi_callback_info info);
+napi_value aws_napi_mqtt_message_worker_detach(napi_env env, napi_callback_info info);
+
 napi_value aws_napi_mqtt_client_connection_unsubscribe(napi_env env, napi_callback_info info);
 napi_value aws_napi_mqtt_client_connection_disconnect(napi_env env, napi_callback_info info);
 
@@ -0,0 +1,295 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include "mqtt_topic_filter.h"
+
+#include <aws/mqtt/mqtt.h>
+
+#include <aws/common/array_list.h>
+#include <aws/common/hash_table.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+struct topic_filter_node {
+    struct topic_filter_node *parent;
+    struct aws_byte_buf level;
+    struct aws_byte_cursor key; /* points into level, the key of this node in parent->children */
+    /* struct aws_byte_cursor * -> struct topic_filter_node *, wildcards are children named "+" and "#" */
+    struct aws_hash_table children;
+    /* uint32_t, the handlers whose filter ends at this node */
+    struct aws_array_list handler_ids;
+};
+
+struct aws_napi_topic_filter_trie {
+    struct aws_allocator *allocator;
+    struct topic_filter_node *root;
+    size_t handler_count;
+};
+
+static void s_node_destroy(struct aws_allocator *allocator, struct topic_filter_node *node) {
+    for (struct aws_hash_iter iter = aws_hash_iter_begin(&node->children); !aws_hash_iter_done(&iter);
+         aws_hash_iter_next(&iter)) {
+        s_node_destroy(allocator, iter.element.value);
+    }
+
+    aws_hash_table_clean_up(&node->children);
+    aws_array_list_clean_up(&node->handler_ids);
+    aws_byte_buf_clean_up(&node->level);
+    aws_mem_release(allocator, node);
+}
+
+static struct topic_filter_node *s_node_new(
+    struct aws_allocator *allocator,
+    struct topic_filter_node *parent,
+    struct aws_byte_cursor level) {
+
+    struct topic_filter_node *node = aws_mem_calloc(allocator, 1, sizeof(struct topic_filter_node));
+    if (!node) {
+        return NULL;
+    }
+
+    node->parent = parent;
+    if (aws_byte_buf_init_copy_from_cursor(&node->level, allocator, level)) {
+        goto on_error;
+    }
+    node->key = aws_byte_cursor_from_buf(&node->level);
+
+    if (aws_hash_table_init(
+            &node->children,
+            allocator,
+            0,
+            aws_hash_byte_cursor_ptr,
+            (aws_hash_callback_eq_fn *)aws_byte_cursor_eq,
+            NULL,
+            NULL)) {
+        goto on_error;
+    }
+
+    if (aws_array_list_init_dynamic(&node->handler_ids, allocator, 0, sizeof(uint32_t))) {
+        goto on_error;
+    }
+
+    return node;
+
+on_error:
+    aws_hash_table_clean_up(&node->children);
+    aws_byte_buf_clean_up(&node->level);
+    aws_mem_release(allocator, node);
+    return NULL;
+}
+
+static struct topic_filter_node *s_find_child(const struct topic_filter_node *node, struct aws_byte_cursor level) {
+    struct aws_hash_element *elem = NULL;
+    aws_hash_table_find(&node->children, &level, &elem);
+    return elem ? elem->value : NULL;
+}
+
+/* Removes nodes that no longer lead to any handler, from node up towards the root */
+static void s_prune(struct aws_napi_topic_filter_trie *trie, struct topic_filter_node *node) {
+    while (node != trie->root && aws_array_list_length(&node->handler_ids) == 0 &&
+           aws_hash_table_get_entry_count(&node->children) == 0) {
+        struct topic_filter_node *parent = node->parent;
+        aws_hash_table_remove(&parent->children, &node->key, NULL, NULL);
+        s_node_destroy(trie->allocator, node);
+        node = parent;
+    }
+}
+
+struct aws_napi_topic_filter_trie *aws_napi_topic_filter_trie_new(struct aws_allocator *allocator) {
+    struct aws_napi_topic_filter_trie *trie = aws_mem_calloc(allocator, 1, sizeof(struct aws_napi_topic_filter_trie));
+    if (!trie) {
+        return NULL;
+    }
+
+    trie->allocator = allocator;
+    trie->root = s_node_new(allocator, NULL, aws_byte_cursor_from_c_str(""));
+    if (!trie->root) {
+        aws_mem_release(allocator, trie);
+        return NULL;
+    }
+
+    return trie;
+}
+
+void aws_napi_topic_filter_trie_destroy(struct aws_napi_topic_filter_trie *trie) {
+    if (trie == NULL) {
+        return;
+    }
+
+    s_node_destroy(trie->allocator, trie->root);
+    aws_mem_release(trie->allocator, trie);
+}
+
+int aws_napi_topic_filter_trie_add(
+    struct aws_napi_topic_filter_trie *trie,
+    struct aws_byte_cursor filter,
+    uint32_t handler_id) {
+
+    if (!aws_mqtt_is_valid_topic_filter(&filter)) {
+        return aws_raise_error(AWS_ERROR_MQTT_INVALID_TOPIC);
+    }
+
+    struct topic_filter_node *node = trie->root;
+    struct aws_byte_cursor level;
+    AWS_ZERO_STRUCT(level);
+    while (aws_byte_cursor_next_split(&filter, '/', &level)) {
+        struct topic_filter_node *child = s_find_child(node, level);
+        if (!child) {
+            child = s_node_new(trie->allocator, node, level);
+            if (!child) {
+                goto on_error;
+            }
+            if (aws_hash_table_put(&node->children, &child->key, child, NULL)) {
+                s_node_destroy(trie->allocator, child);
+                goto on_error;
+            }
+        }
+        node = child;
+    }
+
+    if (aws_array_list_push_back(&node->handler_ids, &handler_id)) {
+        goto on_error;
+    }
+    ++trie->handler_count;
+
+    return AWS_OP_SUCCESS;
+
+on_error:
+    s_prune(trie, node);
+    return AWS_OP_ERR;
+}
+
+void aws_napi_topic_filter_trie_remove(
+    struct aws_napi_topic_filter_trie *trie,
+    struct aws_byte_cursor filter,
+    uint32_t handler_id) {
+
+    struct topic_filter_node *node = trie->root;
+    struct aws_byte_cursor level;
+    AWS_ZERO_STRUCT(level);
+    while (aws_byte_cursor_next_split(&filter, '/', &level)) {
+        node = s_find_child(node, level);
+        if (!node) {
+            return;
+        }
+    }
+
+    const size_t num_handlers = aws_array_list_length(&node->handler_ids);
+    for (size_t i = 0; i < num_handlers; ++i) {
+        uint32_t id = 0;
+        aws_array_list_get_at(&node->handler_ids, &id, i);
+        if (id == handler_id) {
+            aws_array_list_swap(&node->handler_ids, i, num_handlers - 1);
+            aws_array_list_pop_back(&node->handler_ids);
+            --trie->handler_count;
+            s_prune(trie, node);
+            return;
+        }
+    }
+}
+
+size_t aws_napi_topic_filter_trie_handler_count(const struct aws_napi_topic_filter_trie *trie) {
+    return trie->handler_count;
+}
+
+static int s_append_handlers(const struct topic_filter_node *node, struct aws_array_list *handler_ids) {
+    const size_t num_handlers = aws_array_list_length(&node->handler_ids);
+    for (size_t i = 0; i < num_handlers; ++i) {
+        uint32_t id = 0;
+        aws_array_list_get_at(&node->handler_ids, &id, i);
+        if (aws_array_list_push_back(handler_ids, &id)) {
+            return AWS_OP_ERR;
+        }
+    }
+    return AWS_OP_SUCCESS;
+}
+
+/* topic is the remainder of the topic below node, or NULL once every level has been consumed */
+static int s_match(
+    const struct topic_filter_node *node,
+    const struct aws_byte_cursor *topic,
+    bool first_level,
+    struct aws_array_list *handler_ids) {
+
+    const struct topic_filter_node *multi_level = s_find_child(node, aws_byte_cursor_from_c_str("#"));
+
+    if (topic == NULL) {
+        /* "a/#" also matches "a" */
+        if (s_append_handlers(node, handler_ids) ||
+            (multi_level && s_append_handlers(multi_level, handler_ids))) {
+            return AWS_OP_ERR;
+        }
+        return AWS_OP_SUCCESS;
+    }
+
+    const uint8_t *separator = topic->len ? memchr(topic->ptr, '/', topic->len) : NULL;
+    struct aws_byte_cursor level = *topic;
+    struct aws_byte_cursor rest;
+    AWS_ZERO_STRUCT(rest);
+    if (separator) {
+        level.len = (size_t)(separator - topic->ptr);
+        rest = aws_byte_cursor_from_array(separator + 1, topic->len - level.len - 1);
+    }
+    const struct aws_byte_cursor *next = separator ? &rest : NULL;
+
+    const struct topic_filter_node *single_level = NULL;
+    if (!first_level || level.len == 0 || level.ptr[0] != '$') {
+        if (multi_level && s_append_handlers(multi_level, handler_ids)) {
+            return AWS_OP_ERR;
+        }
+        single_level = s_find_child(node, aws_byte_cursor_from_c_str("+"));
+        if (single_level && s_match(single_level, next, false, handler_ids)) {
+            return AWS_OP_ERR;
+        }
+    } else {
+        multi_level = NULL;
+    }
+
+    /* Topic names can't contain wildcards, but don't match the same node twice if one does */
+    const struct topic_filter_node *exact = s_find_child(node, level);
+    if (exact && exact != single_level && exact != multi_level && s_match(exact, next, false, handler_ids)) {
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_compare_handler_ids(const void *a, const void *b) {
+    const uint32_t lhs = *(const uint32_t *)a;
+    const uint32_t rhs = *(const uint32_t *)b;
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+int aws_napi_topic_filter_trie_match(
+    const struct aws_napi_topic_filter_trie *trie,
+    struct aws_byte_cursor topic,
+    struct aws_array_list *handler_ids) {
+
+    const size_t num_existing = aws_array_list_length(handler_ids);
+    if (s_match(trie->root, &topic, true, handler_ids)) {
+        return AWS_OP_ERR;
+    }
+
+    /* A handler registered under overlapping filters matches once per filter, but must only be called once */
+    const size_t num_ids = aws_array_list_length(handler_ids);
+    if (num_ids - num_existing < 2) {
+        return AWS_OP_SUCCESS;
+    }
+
+    uint32_t *matched = (uint32_t *)handler_ids->data + num_existing;
+    const size_t num_matched = num_ids - num_existing;
+    qsort(matched, num_matched, sizeof(uint32_t), s_compare_handler_ids);
+    size_t num_unique = 1;
+    for (size_t i = 1; i < num_matched; ++i) {
+        if (matched[i] != matched[num_unique - 1]) {
+            matched[num_unique++] = matched[i];
+        }
+    }
+    for (size_t i = num_unique; i < num_matched; ++i) {
+        aws_array_list_pop_back(handler_ids);
+    }
+
+    return AWS_OP_SUCCESS;
+}
@@ -0,0 +1,50 @@
+#ifndef AWS_CRT_NODEJS_MQTT_TOPIC_FILTER_H
+#define AWS_CRT_NODEJS_MQTT_TOPIC_FILTER_H
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "module.h"
+
+struct aws_array_list;
+
+/*
+ * A trie of MQTT topic filters, each level of a filter being a node. Every filter maps to the ids of the handlers
+ * registered against it, so matching a topic costs one lookup per level per wildcard branch rather than one
+ * comparison per filter. Not thread safe, callers must synchronize access.
+ */
+struct aws_napi_topic_filter_trie;
+
+struct aws_napi_topic_filter_trie *aws_napi_topic_filter_trie_new(struct aws_allocator *allocator);
+void aws_napi_topic_filter_trie_destroy(struct aws_napi_topic_filter_trie *trie);
+
+/**
+ * Registers handler_id against filter, which may contain wildcards. Raises AWS_ERROR_MQTT_INVALID_TOPIC if filter
+ * is not a valid topic filter.
+ */
+int aws_napi_topic_filter_trie_add(
+    struct aws_napi_topic_filter_trie *trie,
+    struct aws_byte_cursor filter,
+    uint32_t handler_id);
+
+/* Unregisters handler_id from filter, does nothing if it was not registered */
+void aws_napi_topic_filter_trie_remove(
+    struct aws_napi_topic_filter_trie *trie,
+    struct aws_byte_cursor filter,
+    uint32_t handler_id);
+
+/* Number of handlers currently registered, across every filter */
+size_t aws_napi_topic_filter_trie_handler_count(const struct aws_napi_topic_filter_trie *trie);
+
+/**
+ * Appends the id of every handler whose filter matches topic to handler_ids, an initialized list of uint32_t. Each id
+ * is appended once, in ascending order, even if several of its filters match. Following the MQTT spec, wildcards at
+ * the first level do not match topics starting with '$'.
+ */
+int aws_napi_topic_filter_trie_match(
+    const struct aws_napi_topic_filter_trie *trie,
+    struct aws_byte_cursor topic,
+    struct aws_array_list *handler_ids);
+
+#endif /* AWS_CRT_NODEJS_MQTT_TOPIC_FILTER_H */